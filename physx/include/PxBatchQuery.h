@@ -45,6 +45,7 @@ namespace physx
 
 class PxBoxGeometry;
 class PxSphereGeometry;
+class PxCpuDispatcher;
 struct PxQueryCache;
 
 /**
@@ -63,6 +64,28 @@ class PX_DEPRECATED PxBatchQuery
 	*/
 	virtual	void							execute() = 0;
 
+	/**
+	\brief Executes batched queries on the worker threads of a CPU dispatcher.
+
+	The batch is cut into groups of consecutive queries, which are submitted to the dispatcher as tasks. The calling
+	thread processes groups as well and returns once the whole batch has been executed, without waiting for tasks
+	that have not started yet. It is therefore safe to call this function from a task running on the same dispatcher.
+
+	Result buffers are filled in submission order and touch buffers are packed in the same way as execute(), whatever
+	the number of threads and the order in which the groups complete. The results are identical to those of execute()
+	unless a touch buffer overflows: the affected queries then report PxBatchQueryStatus::eOVERFLOW as they do with
+	execute(), but may return a different subset of their touches.
+
+	\param[in] dispatcher			Dispatcher running the tasks, typically the scene's CPU dispatcher.
+	\param[in] nbQueriesPerTask	Number of consecutive queries processed by a task. Batches that do not exceed
+									this size are executed on the calling thread.
+
+	\note The filter shaders are called from the dispatcher's worker threads and must be thread safe.
+
+	@see execute() PxScene.getCpuDispatcher()
+	*/
+	virtual	void							execute(PxCpuDispatcher& dispatcher, PxU32 nbQueriesPerTask = 32) = 0;
+
 	/**
 	\brief Gets the prefilter shader in use for this scene query.
 
@@ -76,6 +76,26 @@ namespace physx
 		};
 	};
 
+	/**
+	\brief Instruction set used by the box pruning kernels of the eMBP and eABP broad-phases.
+
+	By default the widest instruction set supported by both the CPU and the OS is selected at runtime. The scalar kernels are
+	always available and are the reference implementation: all kernels find the same pairs, in the same order.
+
+	\note The wide kernels are only available on x86 and x64 platforms.
+
+	@see PxSetBroadPhaseKernel PxGetBroadPhaseKernel
+	*/
+	struct PxBroadPhaseKernel
+	{
+		enum Enum
+		{
+			eSCALAR,	//!< Tests one candidate box at a time (using SSE2 on x86 and x64 platforms)
+			eAVX2,		//!< Tests 8 candidate boxes at a time
+			eAVX512		//!< Tests 16 candidate boxes at a time (requires AVX-512F)
+		};
+	};
+
 	/**
 	\brief Broad-phase callback to receive broad-phase related events.
 
@@ -134,9 +154,10 @@ namespace physx
 	The number of regions has a direct impact on performance and memory usage, so it is recommended to experiment with
 	various settings to find the best combination for your game. A good default setup is to start with global bounds
 	around the whole world, and subdivide these bounds into 4*4 regions. The PxBroadPhaseExt::createRegionsFromWorldBounds
-	function can do that for you.
+	function can do that for you. Alternatively, PxBroadPhaseRegionManager adapts the regions to the distribution of the
+	objects at runtime.
 
-	@see PxBroadPhaseCallback PxBroadPhaseExt.createRegionsFromWorldBounds
+	@see PxBroadPhaseCallback PxBroadPhaseExt.createRegionsFromWorldBounds PxBroadPhaseRegionManager
 	*/
 	struct PxBroadPhaseRegion
 	{
@@ -166,9 +187,55 @@ namespace physx
 		bool	needsPredefinedBounds;	//!< If true, broad-phase needs 'regions' to work
 	};
 
+	/**
+	\brief State of the hash table storing the pairs of the broad-phase.
+
+	The table has hashSize buckets and room for hashSize pairs. It grows when a new pair does not fit, and shrinks after
+	the update when it is larger than needed, unless PxSceneFlag::eENABLE_PERSISTENT_BROADPHASE_PAIRS is set. Both
+	events rehash all the pairs. Set PxSceneLimits::maxNbBroadPhaseOverlaps to the expected peak number of pairs to
+	allocate the table once at scene creation.
+
+	@see PxScene::getBroadPhasePairStatistics() PxSceneLimits::maxNbBroadPhaseOverlaps
+	*/
+	struct PxBroadPhasePairStatistics
+	{
+		PxU32	nbPairs;			//!< Number of pairs currently stored
+		PxU32	peakNbPairs;		//!< Largest number of pairs stored since the scene was created
+		PxU32	hashSize;			//!< Number of buckets in the hash table, which is also the capacity of the pair array
+		PxReal	loadFactor;			//!< nbPairs/hashSize, or 0 when the table is not allocated
+		PxU32	nbCollisions;		//!< Number of pairs that are not the first pair of their bucket
+		PxU32	maxChainLength;		//!< Largest number of pairs stored in a single bucket
+		PxU32	nbGrowths;			//!< Number of times the table grew since the scene was created
+		PxU32	nbShrinks;			//!< Number of times the table shrank since the scene was created
+	};
+
 #if !PX_DOXYGEN
 } // namespace physx
 #endif
 
+/**
+\brief Selects the box pruning kernels used by the eMBP and eABP broad-phases.
+
+The selection is global to the process. Instruction sets that are not supported by the CPU or the OS fall back to the widest
+supported one. This is mainly useful to benchmark the kernels against each other.
+
+\note This should not be called while a scene is simulating.
+
+\param[in] kernel	The desired kernel
+\return The selected kernel
+
+@see PxBroadPhaseKernel PxGetBroadPhaseKernel
+*/
+PX_C_EXPORT PX_PHYSX_CORE_API physx::PxBroadPhaseKernel::Enum PX_CALL_CONV PxSetBroadPhaseKernel(physx::PxBroadPhaseKernel::Enum kernel);
+
+/**
+\brief Returns the box pruning kernels used by the eMBP and eABP broad-phases.
+
+\return The selected kernel
+
+@see PxBroadPhaseKernel PxSetBroadPhaseKernel
+*/
+PX_C_EXPORT PX_PHYSX_CORE_API physx::PxBroadPhaseKernel::Enum PX_CALL_CONV PxGetBroadPhaseKernel();
+
 /** @} */
 #endif
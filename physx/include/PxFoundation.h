@@ -143,8 +143,35 @@ PX_C_EXPORT PX_FOUNDATION_API physx::PxFoundation& PX_CALL_CONV PxGetFoundation(
 namespace physx
 {
 class PxProfilerCallback;
+
+/**
+\brief Counters of the per-thread caches in front of the SDK's temporary allocator.
+
+A low hit ratio, or a high number of overflows, means that the temporary allocations mostly go through the mutex
+protected free lists shared by all threads.
+
+@see PxGetTempAllocatorStatistics()
+*/
+struct PxTempAllocatorStatistics
+{
+	PxU32 nbThreadCacheHits;			//!< Allocations served from the calling thread's cache
+	PxU32 nbThreadCacheMisses;		//!< Allocations that had to go to the shared free lists
+	PxU32 nbThreadCacheOverflows;	//!< Deallocations that did not fit into the calling thread's cache
+	PxU32 nbThreadCaches;			//!< Threads currently owning a cache
+};
 }
 
+/**
+\brief Retrieves the counters of the temporary allocator's thread caches, accumulated since the foundation was created.
+
+The threads using their caches update the counters without locking, so the totals are approximate while they run.
+
+\note The behavior of this method is undefined if the foundation instance has not been created already.
+
+@see PxTempAllocatorStatistics
+*/
+PX_C_EXPORT PX_FOUNDATION_API void PX_CALL_CONV PxGetTempAllocatorStatistics(physx::PxTempAllocatorStatistics& stats);
+
 /**
 \brief Get the callback that will be used for all profiling.
 */
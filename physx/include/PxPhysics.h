@@ -57,6 +57,7 @@ class PxSerializationRegistry;
 
 class PxPruningStructure;
 class PxBVHStructure;
+class PxCpuDispatcher;
 
 /**
 \brief Abstract singleton factory class used for instancing objects in the Physics SDK.
@@ -350,10 +351,11 @@ public:
 
 	\param	[in] actors		Array of actors to add to the pruning structure. Must be non NULL.
 	\param	[in] nbActors	Number of actors in the array. Must be >0.
+	\param	[in] dispatcher	Optional CPU dispatcher. The subtrees of large trees are then built on its worker threads, the calling thread taking part.
 	\return Pruning structure created from given actors, or NULL if any of the actors did not comply with the above requirements.
 	@see PxActor PxPruningStructure
 	*/
-	virtual PxPruningStructure*	createPruningStructure(PxRigidActor*const* actors, PxU32 nbActors)	= 0;
+	virtual PxPruningStructure*	createPruningStructure(PxRigidActor*const* actors, PxU32 nbActors, PxCpuDispatcher* dispatcher = NULL)	= 0;
 
 	//@}
 	/** @name Shapes
@@ -72,6 +72,10 @@ struct PxQueryFlag
 		eNO_BLOCK			= (1<<5),	//!< All hits are reported as touching. Overrides eBLOCK returned from user filters with eTOUCH.
 										//!< This is also an optimization hint that may improve query performance.
 
+		eCOHERENT			= (1<<6),	//!< Overlaps and sweeps only. Reuse the objects found by a previous query of the same type in the same area,
+										//!< if the scene query structures didn't change. For queries repeated every frame with little motion.
+										//!< See #PxScene::setSceneQueryCacheParams().
+
 		eRESERVED			= (1<<15)	//!< Reserved for internal use
 	};
 };
@@ -157,6 +157,155 @@ struct PxQueryCache
 	PxU32			faceIndex;		//!< Triangle index to test first - NOT CURRENTLY SUPPORTED
 };
 
+/**
+\brief Usage of the scratch memory of the simulation steps.
+
+The scratch memory is either the block passed to PxScene::simulate() or PxScene::collide(), or the frame arena of the scene
+if no block was passed.
+
+@see PxScene::getFrameArenaStatistics() PxSceneDesc::frameArenaSize
+*/
+struct PxFrameArenaStatistics
+{
+	PxU32	blockSize;			//!< Size of the scratch memory used by the last simulation step
+	PxU32	lastStepUsage;		//!< Peak number of bytes used from the scratch memory during the last simulation step
+	PxU32	peakUsage;			//!< Peak number of bytes used from the scratch memory over all simulation steps
+	PxU32	nbHeapFallbacks;	//!< Number of allocations of the last simulation step that did not fit and were made from the heap
+	PxU32	heapFallbackBytes;	//!< Number of bytes allocated from the heap by these allocations
+};
+
+/**
+\brief Statistics of the last tree built by a scene query pruning structure.
+
+Static trees are rebuilt at once, on the scene's CPU dispatcher when they are large enough. Dynamic trees are rebuilt
+over several steps, the build time then adds up over the steps.
+
+@see PxScene::getSceneQueryBuildStatistics()
+*/
+struct PxSceneQueryBuildStatistics
+{
+	PxReal	buildTime;		//!< Time in seconds spent building the tree
+	PxU32	nbSubtrees;		//!< Number of subtrees built in parallel, 0 if the tree was built on a single thread
+	PxU32	nbNodes;		//!< Number of nodes of the tree
+	PxU32	nbLeaves;		//!< Number of leaf nodes
+	PxU32	maxDepth;		//!< Depth of the deepest leaf, the root being at depth 0
+	PxReal	sahCost;		//!< Expected cost of a query in node visits and object tests, computed with the surface area heuristic. Lower is better.
+};
+
+/**
+\brief Progress and timing of the progressive rebuilds of a #PxPruningStructureType::eDYNAMIC_AABB_TREE pruning structure.
+
+A work unit is about one object moved down one level of the tree being built. The total number of work units of a rebuild is
+an estimate, made when the rebuild starts.
+
+@see PxScene::getSceneQueryRebuildStatistics() PxScene::setDynamicTreeRebuildTimeBudget()
+*/
+struct PxSceneQueryRebuildStatistics
+{
+	PxU32	nbRemainingWorkUnits;	//!< Estimated number of work units left before the new tree is built, 0 if no rebuild is in progress
+	PxU32	nbTotalWorkUnits;		//!< Estimated number of work units of the rebuild in progress, or of the last one
+	PxU32	nbSteps;				//!< Number of build steps run by the rebuild in progress, or by the last one
+	PxU32	nbRebuilds;				//!< Number of rebuilt trees switched in since the scene was created
+	PxU32	nbBudgetOverruns;		//!< Number of build steps that took longer than the time budget since the scene was created
+	PxReal	lastStepTime;			//!< Time in seconds of the last build step
+	PxReal	maxStepTime;			//!< Time in seconds of the longest build step since the scene was created
+};
+
+/**
+\brief Statistics of the scene query cache used by the queries with PxQueryFlag::eCOHERENT.
+
+Each query is counted once per pruning structure it visits, i.e. once for the static and once for the dynamic objects.
+
+@see PxScene::getSceneQueryCacheStatistics() PxScene::setSceneQueryCacheParams()
+*/
+struct PxSceneQueryCacheStatistics
+{
+	PxU32	nbHits;			//!< Number of queries that reused the objects found by a previous query
+	PxU32	nbMisses;		//!< Number of queries that searched the pruning structure and cached the objects they found
+	PxU32	nbStaleMisses;	//!< Number of misses due to a change to the pruning structure since the objects were cached
+	PxU32	nbOverflows;	//!< Number of queries that found too many objects to be cached
+
+	/**
+	\brief Ratio of the queries served from the cache, 0 if there were no queries.
+	*/
+	PX_INLINE PxReal getHitRate() const
+	{
+		const PxU32 nbQueries = nbHits + nbMisses + nbOverflows;
+		return nbQueries ? PxReal(nbHits) / PxReal(nbQueries) : 0.0f;
+	}
+};
+
+/**
+\brief Costs of the scene queries of a frame, per pruning structure and query type.
+
+A frame covers the queries run between two calls to PxScene::fetchResults(), batched queries included. A query is counted once
+for each pruning structure it searches. A query using a PxQueryCache is only counted if it searches the pruning structures
+after testing the cached shape.
+
+@see PxScene::setSceneQueryStatisticsEnabled() PxScene::getSceneQueryStatistics()
+*/
+struct PxSceneQueryStatistics
+{
+	/**
+	\brief Pruning structures of a scene.
+	*/
+	enum PrunerType
+	{
+		eSTATIC,	//!< Static objects, see PxSceneDesc::staticStructure
+		eDYNAMIC,	//!< Dynamic objects, see PxSceneDesc::dynamicStructure
+		eCOMPOUND,	//!< Shapes of the actors added with a PxBVHStructure
+		ePRUNER_COUNT
+	};
+
+	/**
+	\brief Query types. Packet raycasts are counted as one raycast per ray.
+	*/
+	enum QueryType
+	{
+		eRAYCAST,
+		eSWEEP,
+		eOVERLAP,
+		eQUERY_TYPE_COUNT
+	};
+
+	/**
+	\brief Counters of the queries of one type in one pruning structure.
+
+	\note nbVisitedNodes and nbLeafTests are not gathered by PxPruningStructureType::eNONE, which is also used for the objects
+	added to a PxPruningStructureType::eDYNAMIC_AABB_TREE structure while its tree is rebuilt.
+	*/
+	struct Counters
+	{
+		PxU32	nbQueries;		//!< Number of queries that searched the pruning structure
+		PxU32	nbVisitedNodes;	//!< Number of tree nodes or grid cells whose bounds were tested against the queries
+		PxU32	nbLeafTests;	//!< Number of objects in the tree leaves or grid cells reached by the queries
+		PxU32	nbNarrowTests;	//!< Number of objects tested against the query geometry, after the bounds test and pre-filtering
+		PxU32	nbHits;			//!< Number of hits found by these tests, before post-filtering
+		PxReal	time;			//!< Time in seconds spent in the pruning structure, including the tests and filter callbacks
+	};
+
+	Counters	counters[ePRUNER_COUNT][eQUERY_TYPE_COUNT];	//!< Counters indexed by PrunerType and QueryType
+
+	/**
+	\brief Sums the counters of a query type over the pruning structures.
+	*/
+	PX_INLINE Counters getTotal(QueryType type) const
+	{
+		Counters total = counters[0][type];
+		for(PxU32 i=1;i<ePRUNER_COUNT;i++)
+		{
+			const Counters& c = counters[i][type];
+			total.nbQueries			+= c.nbQueries;
+			total.nbVisitedNodes	+= c.nbVisitedNodes;
+			total.nbLeafTests		+= c.nbLeafTests;
+			total.nbNarrowTests		+= c.nbNarrowTests;
+			total.nbHits			+= c.nbHits;
+			total.time				+= c.time;
+		}
+		return total;
+	}
+};
+
 /** 
  \brief A scene is a collection of bodies and constraints which can interact.
 
@@ -249,6 +398,17 @@ class PxScene
 	*/
 	virtual	PxU32				getTimestamp()	const	= 0;
 
+	/**
+	\brief Retrieves the context id of the scene, passed to the profiler and to the CPU dispatcher with each task of the scene.
+
+	This is the id to pass explicitly to the per-scene methods of the CPU dispatcher.
+
+	\return The context id.
+
+	@see PxBaseTask::getContextId() PxDefaultCpuDispatcher::setSceneSchedulingParams()
+	*/
+	virtual	PxU64				getTaskContextId()	const	= 0;
+
 	
 	//@}
 	/************************************************************************************************/
@@ -1242,6 +1402,37 @@ class PxScene
 	*/
 	virtual PxU32				getDynamicTreeRebuildRateHint() const = 0;
 
+	/**
+	\brief Sets the time budget of each build step of the dynamic tree pruning structures.
+
+	\param[in] microseconds Time budget of a build step in microseconds, 0 to spread the rebuilds over the number of steps given
+	by the rebuild rate hint instead.
+
+	@see PxSceneDesc.dynamicTreeRebuildTimeBudget getDynamicTreeRebuildTimeBudget() getSceneQueryRebuildStatistics()
+	*/
+	virtual	void				setDynamicTreeRebuildTimeBudget(PxU32 microseconds) = 0;
+
+	/**
+	\brief Retrieves the time budget of each build step of the dynamic tree pruning structures.
+
+	\return The time budget in microseconds, 0 if the rebuilds follow the rebuild rate hint.
+
+	@see PxSceneDesc.dynamicTreeRebuildTimeBudget setDynamicTreeRebuildTimeBudget()
+	*/
+	virtual	PxU32				getDynamicTreeRebuildTimeBudget() const = 0;
+
+	/**
+	\brief Retrieves the progress and timing of the rebuilds of the dynamic tree pruning structures.
+
+	The statistics are zero for pruning structures that are not #PxPruningStructureType::eDYNAMIC_AABB_TREE.
+
+	\param[out] staticStats	Statistics of the static pruning structure
+	\param[out] dynamicStats	Statistics of the dynamic pruning structure
+
+	@see PxSceneQueryRebuildStatistics setDynamicTreeRebuildTimeBudget()
+	*/
+	virtual	void				getSceneQueryRebuildStatistics(PxSceneQueryRebuildStatistics& staticStats, PxSceneQueryRebuildStatistics& dynamicStats) const = 0;
+
 	/**
 	\brief Forces dynamic trees to be immediately rebuilt.
 
@@ -1252,6 +1443,19 @@ class PxScene
 	*/
 	virtual void				forceDynamicTreeRebuild(bool rebuildStaticStructure, bool rebuildDynamicStructure)	= 0;
 
+	/**
+	\brief Retrieves the statistics of the trees currently used by the scene query pruning structures.
+
+	The statistics are zero for a pruning structure without a tree, i.e. PxPruningStructureType::eNONE, or before the first
+	tree has been built. Trees extended with a PxPruningStructure keep the statistics of their last build.
+
+	\param[out] staticStats	Statistics of the tree of the static pruning structure
+	\param[out] dynamicStats	Statistics of the tree of the dynamic pruning structure
+
+	@see PxSceneQueryBuildStatistics PxSceneDesc.staticStructure PxSceneDesc.dynamicStructure
+	*/
+	virtual void				getSceneQueryBuildStatistics(PxSceneQueryBuildStatistics& staticStats, PxSceneQueryBuildStatistics& dynamicStats) const = 0;
+
 	/**
 	\brief Sets scene query update mode	
 
@@ -1341,6 +1545,36 @@ class PxScene
 									const PxQueryFilterData& filterData = PxQueryFilterData(), PxQueryFilterCallback* filterCall = NULL,
 									const PxQueryCache* cache = NULL) const = 0;
 
+	/**
+	\brief Performs raycasts for an array of rays against objects in the scene, returns the closest blocking hit of each ray.
+
+	This is intended for large numbers of coherent rays, for example sensors sweeping a scene with rays sharing
+	the same origin. Consecutive rays are grouped in packets of 4 which traverse the pruning structures together.
+	Packets whose rays point in different directions (i.e. do not share the same direction octant) fall back to
+	single ray traversal. The results are the same as calling #raycast for each ray with a PxRaycastBuffer
+	without touch buffer.
+
+	\note	Only blocking hits are reported. Hits reported as touching by the filter callback are discarded.
+	\note	Each ray is tested against the shapes individually, i.e. the triangle mesh midphase is traversed once per ray.
+
+	\param[in] origins		Origins of the rays.
+	\param[in] unitDirs		Normalized directions of the rays.
+	\param[in] nbRays		Number of rays.
+	\param[in] distance		Length of the rays. Has to be in the (0, inf) range.
+	\param[out] hits		Closest blocking hit of each ray, nbRays entries. Hits of the rays that did not hit anything have NULL actor and shape pointers.
+	\param[in] hitFlags		Specifies which properties per hit should be computed and returned in the hits.
+	\param[in] filterData	Filtering data passed to the filter callback. See #PxQueryFilterData
+	\param[in] filterCall	Custom filtering logic (optional). Only used if the corresponding #PxQueryFlag flags are set. If NULL, all hits are assumed to be blocking.
+
+	\return The number of rays which hit something.
+
+	@see raycast PxRaycastHit PxQueryFilterData PxQueryFilterCallback PxQueryFlag PxQueryFlag::eANY_HIT
+	*/
+	virtual PxU32				raycastPacket(
+									const PxVec3* origins, const PxVec3* unitDirs, PxU32 nbRays, const PxReal distance,
+									PxRaycastHit* hits, PxHitFlags hitFlags = PxHitFlags(PxHitFlag::eDEFAULT),
+									const PxQueryFilterData& filterData = PxQueryFilterData(), PxQueryFilterCallback* filterCall = NULL) const = 0;
+
 	/**
 	\brief Performs a sweep test against objects in the scene, returns results in a PxSweepBuffer object
 	or via a custom user callback implementation inheriting from PxSweepCallback.
@@ -1405,6 +1639,78 @@ class PxScene
 	\return scene query static timestamp
 	*/
 	virtual	PxU32	getSceneQueryStaticTimestamp()	const	= 0;
+
+	/**
+	\brief Sets the parameters of the cache used by overlaps and sweeps with PxQueryFlag::eCOHERENT.
+
+	Such a query looks for an entry cached by a previous query of the same geometry type in the same area. The entry holds the
+	objects whose bounds overlap the bounds of that previous query enlarged by the tolerance. If the bounds of the new query
+	are contained in this region and the scene query structure didn't change since, these objects are tested instead of
+	searching the structure. Otherwise the structure is searched and the entry replaced. The structure containing the
+	dynamic objects changes whenever one of them moves, so the cache mostly benefits queries against static objects.
+
+	A larger tolerance lets queries move further while reusing an entry, but increases the number of objects to test.
+
+	\note Changing the parameters clears the cache.
+
+	Entries are indexed by the query area and replace each other when their indices collide, so the cache should hold several
+	times the number of coherent queries issued per frame. A query takes one entry for the static and one for the dynamic objects.
+
+	<b>Default:</b> 1024 entries, a tolerance of 0.25 * PxTolerancesScale::length
+
+	\param[in] maxNbEntries	Number of entries, rounded up to a power of two. 0 disables the cache, the flag is then ignored.
+	\param[in] tolerance		Distance a query can move while reusing a cache entry. <b>Range:</b> (0, PX_MAX_F32)
+
+	@see PxQueryFlag::eCOHERENT getSceneQueryCacheStatistics()
+	*/
+	virtual	void	setSceneQueryCacheParams(PxU32 maxNbEntries, PxReal tolerance)	= 0;
+
+	/**
+	\brief Retrieves the hit counts of the cache used by overlaps and sweeps with PxQueryFlag::eCOHERENT.
+
+	\param[out] stats The counts accumulated since the scene was created or the counts were last reset.
+
+	@see PxSceneQueryCacheStatistics resetSceneQueryCacheStatistics() setSceneQueryCacheParams()
+	*/
+	virtual	void	getSceneQueryCacheStatistics(PxSceneQueryCacheStatistics& stats)	const	= 0;
+
+	/**
+	\brief Resets the hit counts of the cache used by overlaps and sweeps with PxQueryFlag::eCOHERENT.
+
+	@see getSceneQueryCacheStatistics()
+	*/
+	virtual	void	resetSceneQueryCacheStatistics()	= 0;
+
+	/**
+	\brief Enables or disables the gathering of the scene query statistics.
+
+	The counters are gathered per query and added to the scene under a lock, which adds a small cost to each query.
+
+	<b>Default:</b> false
+
+	\param[in] enabled True to gather the statistics
+
+	@see getSceneQueryStatistics() PxSceneQueryStatistics
+	*/
+	virtual	void	setSceneQueryStatisticsEnabled(bool enabled)	= 0;
+
+	/**
+	\brief Returns whether the scene query statistics are gathered.
+
+	@see setSceneQueryStatisticsEnabled()
+	*/
+	virtual	bool	isSceneQueryStatisticsEnabled()	const	= 0;
+
+	/**
+	\brief Retrieves the costs of the scene queries run during the last frame.
+
+	The statistics are zero if they were not enabled during the last frame. They are also sent to PVD as properties of the scene.
+
+	\param[out] stats The costs of the queries run between the last two calls to fetchResults()
+
+	@see PxSceneQueryStatistics setSceneQueryStatisticsEnabled()
+	*/
+	virtual	void	getSceneQueryStatistics(PxSceneQueryStatistics& stats)	const	= 0;
 	//@}
 	
 	/************************************************************************************************/
@@ -1427,6 +1733,20 @@ class PxScene
 	*/
 	virtual	bool					getBroadPhaseCaps(PxBroadPhaseCaps& caps)			const = 0;
 
+	/**
+	\brief Gets the state of the hash table storing the broad-phase pairs.
+
+	Use it to size PxSceneLimits::maxNbBroadPhaseOverlaps, so that the table does not grow during the simulation.
+
+	\note Not allowed while the simulation is running.
+
+	\param[out]	stats	Broad-phase pair statistics
+	\return True if success, false if the broad-phase does not support pair statistics (PxBroadPhaseType::eGPU)
+
+	@see PxBroadPhasePairStatistics PxSceneFlag::eENABLE_PERSISTENT_BROADPHASE_PAIRS
+	*/
+	virtual	bool					getBroadPhasePairStatistics(PxBroadPhasePairStatistics& stats)	const = 0;
+
 	/**
 	\brief Returns number of regions currently registered in the broad-phase.
 
@@ -1593,6 +1913,19 @@ class PxScene
 	*/
 	virtual         PxU32				getMaxNbContactDataBlocksUsed() const = 0;
 
+	/**
+	\brief Retrieves the usage of the scratch memory of the simulation steps.
+
+	Useful to size PxSceneDesc::frameArenaSize so that steady-state simulation steps don't allocate temporary memory from the heap.
+
+	This function may not be called while the scene is simulating
+
+	\param[out] stats The scratch memory usage.
+
+	@see PxFrameArenaStatistics PxSceneDesc::frameArenaSize
+	*/
+	virtual         void				getFrameArenaStatistics(PxFrameArenaStatistics& stats) const = 0;
+
 
 	/**
 	\brief Return the value of PxSceneDesc::contactReportStreamBufferSize that was set when creating the scene with PxPhysics::createScene
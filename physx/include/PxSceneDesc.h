@@ -66,6 +66,23 @@ objects, if no static objects are added, moved or removed after the scene has be
 created. If there is no such guarantee (e.g. when streaming parts of the world in and out),
 then the dynamic version is a better choice even for static objects.
 
+eSTATIC_WIDE_AABB_TREE is the same as eSTATIC_AABB_TREE, but the built tree is collapsed into a
+4-wide tree with quantized bounds for the queries. It uses less memory per node and touches fewer
+cache lines than the binary tree, which speeds up queries on large static worlds. Rebuilding the
+tree is slightly more expensive.
+
+eSTATIC_COMPRESSED_AABB_TREE is the same as eSTATIC_AABB_TREE, but the built tree is converted to a compact binary
+tree whose bounds are stored as 16-bit integers relative to their parent node, and the float tree is released. The
+objects are sorted in the tree's order so the tree needs no index array. It uses about a third of the memory of the
+binary tree, for large static worlds where memory matters more than the cost of adding, removing or moving objects.
+The stored bounds are conservative, so the queries return the same results as with the binary tree.
+
+eHASHED_GRID stores the objects in a uniform grid whose occupied cells are found by hashing their coordinates.
+Adding, removing or moving an object is O(1) and there is no tree to rebuild, which makes it a good choice for
+many small dynamic objects of similar sizes, spread uniformly over the scene. Objects much larger than a cell are
+stored in a separate list that is tested linearly by all the queries. The cell size is given by
+#PxSceneDesc::gridPrunerCellSize. Only allowed for #PxSceneDesc::dynamicStructure.
+
 */
 struct PxPruningStructureType
 {
@@ -74,6 +91,9 @@ struct PxPruningStructureType
 		eNONE,					//!< Using a simple data structure
 		eDYNAMIC_AABB_TREE,		//!< Using a dynamic AABB tree
 		eSTATIC_AABB_TREE,		//!< Using a static AABB tree
+		eSTATIC_WIDE_AABB_TREE,	//!< Using a static AABB tree collapsed into a 4-wide quantized tree
+		eHASHED_GRID,			//!< Using a hashed uniform grid
+		eSTATIC_COMPRESSED_AABB_TREE,	//!< Using a static AABB tree with 16-bit quantized bounds
 
 		eLAST
 	};
@@ -349,6 +369,25 @@ struct PxSceneFlag
 		*/
 		eENABLE_FRICTION_EVERY_ITERATION = (1 << 15),
 
+		/**
+		\brief Keeps the broad-phase pair storage at its peak size.
+
+		By default the hash table storing the broad-phase pairs, and the arrays reporting the created and deleted pairs, are
+		shrunk after each update when they are larger than needed, and grown again when the number of pairs increases. Each
+		resize rehashes all the pairs. With this flag the storage never shrinks below its largest size, and all of it is
+		allocated for PxSceneLimits::maxNbBroadPhaseOverlaps pairs at scene creation. Scenes whose number of pairs
+		oscillates avoid repeated rehashing at the cost of memory.
+
+		\note This flag is not mutable, and must be set in PxSceneDesc at scene creation.
+
+		\note It has no effect with PxBroadPhaseType::eGPU.
+
+		<b>Default:</b> false
+
+		@see PxSceneLimits::maxNbBroadPhaseOverlaps PxScene::getBroadPhasePairStatistics()
+		*/
+		eENABLE_PERSISTENT_BROADPHASE_PAIRS = (1 << 16),
+
 		eMUTABLE_FLAGS = eENABLE_ACTIVE_ACTORS|eEXCLUDE_KINEMATICS_FROM_ACTIVE_ACTORS
 	};
 };
@@ -689,7 +728,8 @@ public:
 	/**
 	\brief Defines the structure used to store static objects.
 
-	\note Only PxPruningStructureType::eSTATIC_AABB_TREE and PxPruningStructureType::eDYNAMIC_AABB_TREE are allowed here.
+	\note Only PxPruningStructureType::eSTATIC_AABB_TREE, PxPruningStructureType::eSTATIC_WIDE_AABB_TREE,
+	PxPruningStructureType::eSTATIC_COMPRESSED_AABB_TREE and PxPruningStructureType::eDYNAMIC_AABB_TREE are allowed here.
 	*/
 	PxPruningStructureType::Enum	staticStructure;
 
@@ -717,6 +757,40 @@ public:
 	*/
 	PxU32					dynamicTreeRebuildRateHint;
 
+	/**
+	\brief Time budget of each build step of the dynamic AABB tree pruning structures, in microseconds.
+
+	When non-zero, each build step processes as much of the rebuild as fits in the budget, instead of the fraction of the
+	rebuild given by #dynamicTreeRebuildRateHint. The build steps run in PxScene::fetchResults(), or in the tasks started by
+	PxScene::sceneQueriesUpdate() with PxSceneQueryUpdateMode::eBUILD_DISABLED_COMMIT_DISABLED, which keeps them entirely off
+	the simulation. Some parts of the rebuild cannot be split and may exceed a small budget, see
+	PxSceneQueryRebuildStatistics::nbBudgetOverruns.
+
+	\note Only used for #PxPruningStructureType::eDYNAMIC_AABB_TREE pruning structure.
+
+	<b>Default:</b> 0 (use #dynamicTreeRebuildRateHint)
+
+	@see PxScene::setDynamicTreeRebuildTimeBudget() PxScene::getSceneQueryRebuildStatistics()
+	*/
+	PxU32					dynamicTreeRebuildTimeBudget;
+
+	/**
+	\brief Size of the cells of the #PxPruningStructureType::eHASHED_GRID pruning structure.
+
+	Objects whose bounds are up to about a cell wide are stored in the grid, larger objects are stored in a list that
+	all the queries test linearly. A good cell size is about the size of the typical dynamic object. Smaller cells make
+	the queries more selective, but raycasts and sweeps then walk more cells.
+
+	When set to 0, the cell size is computed automatically from the average size of the objects available in the first
+	scene query update, and kept afterwards.
+
+	\note Only used for #PxPruningStructureType::eHASHED_GRID pruning structure.
+
+	<b>Range:</b> [0, PX_MAX_F32)<br>
+	<b>Default:</b> 0 (automatic)
+	*/
+	PxReal					gridPrunerCellSize;
+
 	/**
 	\brief Defines the scene query update mode.
 	<b>Default:</b> PxSceneQueryUpdateMode::eBUILD_ENABLED_COMMIT_ENABLED
@@ -799,6 +873,24 @@ public:
 	*/
 	PxU32					maxNbContactDataBlocks;
 
+	/**
+	\brief Size in bytes of the frame arena, a block of memory owned by the scene for the temporary allocations of a simulation step.
+
+	The frame arena is allocated from the user allocator when the scene is created. It is used as scratch memory by the
+	simulation steps for which no scratch block is passed to PxScene::simulate() or PxScene::collide(). Temporary data of the
+	step, such as broad phase buffers and constraint data, is then bump-allocated from the arena, which is released as a whole
+	when the step completes in PxScene::fetchResults(). Allocations that don't fit in the arena fall back to the user allocator.
+
+	\note Must be a multiple of 16K.
+
+	<b>Default:</b> 0 (no frame arena)
+
+	<b>Range:</b> [0, PX_MAX_U32]<br>
+
+	@see PxScene::simulate() PxScene::getFrameArenaStatistics()
+	*/
+	PxU32					frameArenaSize;
+
 	/**
 	\brief The maximum bias coefficient used in the constraint solver
 
@@ -982,6 +1074,8 @@ PX_INLINE PxSceneDesc::PxSceneDesc(const PxTolerancesScale& scale):
 	staticStructure						(PxPruningStructureType::eDYNAMIC_AABB_TREE),
 	dynamicStructure					(PxPruningStructureType::eDYNAMIC_AABB_TREE),
 	dynamicTreeRebuildRateHint			(100),
+	dynamicTreeRebuildTimeBudget		(0),
+	gridPrunerCellSize					(0.0f),
 	sceneQueryUpdateMode				(PxSceneQueryUpdateMode::eBUILD_ENABLED_COMMIT_ENABLED),
 
 	userData							(NULL),
@@ -991,6 +1085,7 @@ PX_INLINE PxSceneDesc::PxSceneDesc(const PxTolerancesScale& scale):
 
 	nbContactDataBlocks					(0),
 	maxNbContactDataBlocks				(1<<16),
+	frameArenaSize						(0),
 	maxBiasCoefficient					(PX_MAX_F32),
 	contactReportStreamBufferSize		(8192),
 	ccdMaxPasses						(1),
@@ -1020,12 +1115,16 @@ PX_INLINE bool PxSceneDesc::isValid() const
 	if(!limits.isValid())
 		return false;
 
-	if(staticStructure!=PxPruningStructureType::eSTATIC_AABB_TREE && staticStructure!=PxPruningStructureType::eDYNAMIC_AABB_TREE)
+	if(staticStructure!=PxPruningStructureType::eSTATIC_AABB_TREE && staticStructure!=PxPruningStructureType::eSTATIC_WIDE_AABB_TREE &&
+		staticStructure!=PxPruningStructureType::eSTATIC_COMPRESSED_AABB_TREE && staticStructure!=PxPruningStructureType::eDYNAMIC_AABB_TREE)
 		return false;
 
 	if(dynamicTreeRebuildRateHint < 4)
 		return false;
 
+	if(!(gridPrunerCellSize >= 0.0f && gridPrunerCellSize < PX_MAX_F32))
+		return false;
+
 	if(bounceThresholdVelocity < 0.0f)
 		return false;
 	if(frictionOffsetThreshold < 0.0f)
@@ -1047,6 +1146,9 @@ PX_INLINE bool PxSceneDesc::isValid() const
 	if(maxNbContactDataBlocks < nbContactDataBlocks)
 		return false;
 
+	if(frameArenaSize & 16383)
+		return false;
+
 	if(wakeCounterResetValue <= 0.0f)
 		return false;
 
@@ -44,6 +44,8 @@ namespace physx
 {
 #endif
 
+class PxCpuDispatcher;
+
 /**
 
 \brief Descriptor class for #PxBVHStructure.
@@ -60,6 +62,14 @@ public:
 	*/
 	PxBoundedData bounds;
 
+	/**
+	\brief Optional CPU dispatcher. The subtrees of large BVH structures are then built on its worker threads,
+	the calling thread taking part.
+
+	<b>Default:</b> NULL
+	*/
+	PxCpuDispatcher* buildDispatcher;
+
 	/**
 	\brief	Initialize the BVH structure descriptor
 	*/
@@ -77,7 +87,7 @@ protected:
 
 
 
-PX_INLINE PxBVHStructureDesc::PxBVHStructureDesc()
+PX_INLINE PxBVHStructureDesc::PxBVHStructureDesc() : buildDispatcher(NULL)
 {
 }
 
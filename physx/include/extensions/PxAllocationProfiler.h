@@ -0,0 +1,149 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+
+
+#ifndef PX_PHYSICS_EXTENSIONS_ALLOCATION_PROFILER_H
+#define PX_PHYSICS_EXTENSIONS_ALLOCATION_PROFILER_H
+/** \addtogroup extensions
+  @{
+*/
+
+#include "common/PxPhysXCommonConfig.h"
+#include "foundation/PxProfiler.h"
+
+#if !PX_DOXYGEN
+namespace physx
+{
+#endif
+
+class PxOutputStream;
+
+/**
+\brief Allocations made by the SDK from one source location inside one profile zone.
+
+@see PxAllocationProfiler::getSites()
+*/
+struct PxAllocationSite
+{
+	const char*	zoneName;					//!< Innermost profile zone open on the allocating thread, NULL if none
+	const char*	typeName;					//!< Type name passed to the allocator, see PxFoundation::setReportAllocationNames()
+	const char*	fileName;					//!< Source file of the allocation
+	PxU32		line;						//!< Source line of the allocation
+	PxU32		nbAllocations;				//!< Number of allocations since creation or the last reset
+	PxU32		nbSteadyStateAllocations;	//!< Number of allocations made while in steady state
+	PxU64		nbBytes;					//!< Number of bytes allocated since creation or the last reset
+	PxU64		nbSteadyStateBytes;			//!< Number of bytes allocated while in steady state
+};
+
+/**
+\brief Attributes the SDK's heap allocations to the profile zone and source location they come from.
+
+The profiler listens to all allocations going through the foundation allocator, and doubles as the
+profiler callback in order to know which profile zone is open on the allocating thread. Profile zones
+are only emitted by debug, checked and profile builds; in release builds all allocations are reported
+without a zone.
+
+A simulation that has warmed up should not need to allocate anymore. Call setSteadyState(true) once the
+scene has run its warm-up frames: every allocation made from then on is additionally counted as a steady-state
+allocation, and writeReport() can list just those.
+
+\note Creating and releasing the profiler is not thread safe with respect to SDK allocations, do it while
+no simulation or other SDK call is in progress.
+
+@see PxAllocationProfilerCreate()
+*/
+class PxAllocationProfiler : public PxProfilerCallback
+{
+public:
+	/**
+	\brief Unregisters the profiler, restores the previous profiler callback and deletes the object.
+	*/
+	virtual void	release() = 0;
+
+	/**
+	\brief Enters or leaves steady state.
+
+	\param[in] steadyState True to count the following allocations as steady-state allocations.
+	*/
+	virtual void	setSteadyState(bool steadyState) = 0;
+
+	/**
+	\brief Returns whether the profiler is in steady state.
+	*/
+	virtual bool	isSteadyState() const = 0;
+
+	/**
+	\brief Returns the number of allocation sites recorded so far.
+	*/
+	virtual PxU32	getNbSites() const = 0;
+
+	/**
+	\brief Copies the recorded allocation sites into a user buffer.
+
+	\param[out] userBuffer	Buffer to fill.
+	\param[in] bufferSize	Number of elements the buffer can hold.
+	\param[in] startIndex	Index of the first site to copy.
+	\return Number of sites written to the buffer.
+	*/
+	virtual PxU32	getSites(PxAllocationSite* userBuffer, PxU32 bufferSize, PxU32 startIndex = 0) const = 0;
+
+	/**
+	\brief Discards all recorded allocation sites.
+	*/
+	virtual void	reset() = 0;
+
+	/**
+	\brief Writes a text report of the recorded sites, sorted by decreasing number of steady-state allocations
+	then decreasing number of allocations.
+
+	\param[in] stream			Stream to write the report to.
+	\param[in] steadyStateOnly	Only report the sites that allocated while in steady state.
+	*/
+	virtual void	writeReport(PxOutputStream& stream, bool steadyStateOnly) const = 0;
+
+protected:
+	virtual			~PxAllocationProfiler()	{}
+};
+
+/**
+\brief Creates an allocation profiler and installs it as the foundation's profiler callback.
+
+The profiler callback that was installed before (for example the PVD profiler) keeps receiving all profile
+zones, and is restored when the allocation profiler is released.
+
+\return The new allocation profiler.
+
+@see PxAllocationProfiler PxSetProfilerCallback()
+*/
+PxAllocationProfiler* PxAllocationProfilerCreate();
+
+#if !PX_DOXYGEN
+} // namespace physx
+#endif
+
+/** @} */
+#endif
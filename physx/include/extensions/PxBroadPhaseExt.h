@@ -36,12 +36,16 @@
 
 #include "PxPhysXConfig.h"
 #include "common/PxPhysXCommonConfig.h"
+#include "foundation/PxBounds3.h"
 
 #if !PX_DOXYGEN
 namespace physx
 {
 #endif
 
+class PxScene;
+class BroadPhaseRegionManagerInternal;
+
 class PxBroadPhaseExt
 {
 public:
@@ -67,6 +71,173 @@ public:
 	static	PxU32	createRegionsFromWorldBounds(PxBounds3* regions, const PxBounds3& globalBounds, PxU32 nbSubdiv, PxU32 upAxis=1);
 };
 
+/**
+\brief Descriptor for PxBroadPhaseRegionManager.
+
+@see PxBroadPhaseRegionManager
+*/
+class PxBroadPhaseRegionManagerDesc
+{
+public:
+	/**
+	\brief World-space box covering the game world.
+
+	This is the region created by the manager at startup. It can be much larger than the area actually occupied by the objects,
+	since empty parts of the world end up in a few large regions. Objects leaving this box are still reported as out-of-bounds.
+	*/
+	PxBounds3	worldBounds;
+
+	/**
+	\brief Up axis (0 for X, 1 for Y, 2 for Z). Regions are never split along this axis.
+
+	<b>Default:</b> 1
+	*/
+	PxU32		upAxis;
+
+	/**
+	\brief A region is split in two when its average number of objects exceeds this value.
+
+	<b>Default:</b> 512
+	*/
+	PxU32		maxNbObjectsPerRegion;
+
+	/**
+	\brief Two sibling regions are merged back when their total average number of objects falls below this value.
+
+	Must be smaller than maxNbObjectsPerRegion, to avoid splitting and merging the same regions over and over.
+
+	<b>Default:</b> 128
+	*/
+	PxU32		minNbObjectsPerRegion;
+
+	/**
+	\brief Regions are not split along axes shorter than twice this size.
+
+	<b>Default:</b> 0.0
+	*/
+	PxReal		minRegionSize;
+
+	/**
+	\brief Max number of regions used by the manager. It is clamped to PxBroadPhaseCaps::maxNbRegions minus the number of
+	regions that are not owned by the manager.
+
+	<b>Default:</b> 64
+	*/
+	PxU32		maxNbRegions;
+
+	/**
+	\brief Max number of splits and merges performed by a single PxBroadPhaseRegionManager::update() call.
+
+	Each split or merge migrates the objects of the concerned regions, so this bounds the cost of an update.
+
+	<b>Default:</b> 2
+	*/
+	PxU32		maxNbChangesPerUpdate;
+
+	/**
+	\brief Weight of the latest number of objects in the average number of objects of a region, in ]0, 1].
+
+	Small values make the manager react slowly to transient changes in the object distribution.
+
+	<b>Default:</b> 0.1
+	*/
+	PxReal		smoothing;
+
+	/**
+	\brief Constructor sets to default.
+	*/
+	PX_INLINE	PxBroadPhaseRegionManagerDesc();
+
+	/**
+	\brief (Re)sets the structure to the default.
+	*/
+	PX_INLINE	void	setToDefault();
+
+	/**
+	\brief Returns true if the descriptor is valid.
+	\return true if the current settings are valid.
+	*/
+	PX_INLINE	bool	isValid() const;
+};
+
+PX_INLINE PxBroadPhaseRegionManagerDesc::PxBroadPhaseRegionManagerDesc() :
+	worldBounds				(PxBounds3::empty()),
+	upAxis					(1),
+	maxNbObjectsPerRegion	(512),
+	minNbObjectsPerRegion	(128),
+	minRegionSize			(0.0f),
+	maxNbRegions			(64),
+	maxNbChangesPerUpdate	(2),
+	smoothing				(0.1f)
+{
+}
+
+PX_INLINE void PxBroadPhaseRegionManagerDesc::setToDefault()
+{
+	*this = PxBroadPhaseRegionManagerDesc();
+}
+
+PX_INLINE bool PxBroadPhaseRegionManagerDesc::isValid() const
+{
+	if(!worldBounds.isValid() || worldBounds.isEmpty())
+		return false;
+	if(upAxis>2)
+		return false;
+	if(minNbObjectsPerRegion>=maxNbObjectsPerRegion)
+		return false;
+	if(!(minRegionSize>=0.0f))
+		return false;
+	if(maxNbRegions<1 || maxNbChangesPerUpdate<1)
+		return false;
+	if(!(smoothing>0.0f && smoothing<=1.0f))
+		return false;
+	return true;
+}
+
+/**
+\brief Adaptive region manager for PxBroadPhaseType::eMBP.
+
+The manager replaces the user-defined regions of the MBP broad-phase with a binary space partition of the world bounds, which
+follows the distribution of the objects over time:
+- a region whose average number of objects exceeds PxBroadPhaseRegionManagerDesc::maxNbObjectsPerRegion is split in two
+halves, along its longest axis (excluding the up axis).
+- two sibling regions whose total average number of objects falls below PxBroadPhaseRegionManagerDesc::minNbObjectsPerRegion
+are merged back into their parent region.
+
+The new regions are added with PxScene::addBroadPhaseRegion(region, true) before the old ones are removed, so objects are
+migrated from region to region by the broad-phase and never become out-of-bounds in the process. The number of splits and
+merges per update is bounded, so a large change in the object distribution is absorbed over several frames.
+
+The regions owned by the manager have their PxBroadPhaseRegion::userData set to the manager. They are not removed when the
+manager is deleted. Other regions can be added to the scene, they are not touched by the manager.
+
+\note The manager does nothing if the scene's broad-phase does not use regions (see PxBroadPhaseCaps::needsPredefinedBounds).
+
+@see PxBroadPhaseRegionManagerDesc PxScene::addBroadPhaseRegion PxScene::getBroadPhaseRegions
+*/
+class PxBroadPhaseRegionManager
+{
+public:
+			PxBroadPhaseRegionManager(PxScene* scene, const PxBroadPhaseRegionManagerDesc& desc);
+			~PxBroadPhaseRegionManager();
+
+	/**
+	\brief Samples the number of objects in each region, then splits and merges regions. Call this after your
+	simulate/fetchResults calls.
+	*/
+	void	update();
+
+	/**
+	\brief Returns the number of regions currently owned by the manager.
+
+	\return Number of regions
+	*/
+	PxU32	getNbRegions()	const;
+
+private:
+	BroadPhaseRegionManagerInternal*	mImpl;
+};
+
 #if !PX_DOXYGEN
 } // namespace physx
 #endif
@@ -42,6 +42,185 @@ namespace physx
 {
 #endif
 
+/**
+\brief Scheduling strategies of the default CPU dispatcher.
+
+@see PxDefaultCpuDispatcherCreate()
+*/
+struct PxDefaultCpuDispatcherSchedulingMode
+{
+	enum Enum
+	{
+		/**
+		\brief Tasks submitted from a worker thread go to that worker's local queue, all other tasks go to a
+		shared queue. Idle workers scan the other workers' queues and wait on a single wake-up event.
+		*/
+		eSHARED_QUEUE,
+
+		/**
+		\brief Every worker owns a bounded work-stealing deque. Tasks submitted from a worker thread are pushed
+		to its deque and popped in LIFO order by the owner, idle workers steal in FIFO order from randomly
+		chosen victims. Tasks submitted from other threads go to a shared queue. Idle workers park on their own
+		wake-up event and only as many workers as needed are woken up.
+
+		\note Recommended for machines with a large number of cores.
+		*/
+		eWORK_STEALING,
+
+		/**
+		\brief Tasks are queued per scene, the scene being identified by the context id of the task. Idle workers
+		take the next task from the scene with the highest priority, then from the scene with the earliest deadline,
+		then from the scene that received the fewest tasks relative to its weight. Tasks with context id 0 go to a
+		default queue with the default scheduling parameters.
+
+		\note Meant for a single dispatcher shared by many scenes, with one worker thread per core.
+
+		@see PxDefaultCpuDispatcher::setSceneSchedulingParams() PxDefaultCpuDispatcher::setSceneDeadline() PxScene::getTaskContextId()
+		*/
+		eSCENE_PRIORITY
+	};
+};
+
+/**
+\brief Controls how idle worker threads of the default CPU dispatcher wait for new tasks.
+
+An idle worker first polls for tasks with exponential back-off, executing up to spinCount pause instructions.
+It then yields its time slice up to yieldCount times, polling after each yield, before it finally parks
+and waits for the dispatcher to wake it up. Spinning and yielding avoid the wake-up latency of parked threads
+at the cost of CPU time.
+
+The default policy parks idle workers immediately.
+
+@see PxDefaultCpuDispatcher::setWaitPolicy() PxDefaultCpuDispatcher::setFrameActive()
+*/
+struct PxDefaultCpuDispatcherWaitPolicy
+{
+	PxDefaultCpuDispatcherWaitPolicy() : spinCount(0), yieldCount(0)	{}
+
+	/**
+	\brief Number of pause instructions an idle worker executes while polling for tasks before it starts yielding.
+	*/
+	PxU32	spinCount;
+
+	/**
+	\brief Number of times an idle worker yields its time slice while polling for tasks before it parks.
+	*/
+	PxU32	yieldCount;
+};
+
+/**
+\brief Per-worker counters of the default CPU dispatcher.
+
+The counters are written by the worker threads without synchronization, values read while the workers
+are running are approximate.
+
+@see PxDefaultCpuDispatcher::getWorkerStatistics()
+*/
+struct PxDefaultCpuDispatcherWorkerStatistics
+{
+	PxU32	nbTasks;		//!< Number of tasks executed by the worker
+	PxU32	nbSteals;		//!< Number of tasks the worker took from the queue of another worker
+	PxU32	nbSpins;		//!< Number of times the worker ran out of tasks and started spinning
+	PxU32	nbSpinHits;		//!< Number of times the worker found a task while spinning or yielding, avoiding a park
+	PxU32	nbYields;		//!< Number of times the worker yielded its time slice
+	PxU32	nbParks;		//!< Number of times the worker parked until woken up by the dispatcher
+};
+
+/**
+\brief Counters of the task queue entry pools of the default CPU dispatcher, summed over the dispatcher and its workers.
+
+Queue entries are allocated in slabs. The pools only grow, so once they reached the peak number of queued tasks
+submitting a task does not allocate memory anymore.
+
+@see PxDefaultCpuDispatcher::getQueueStatistics()
+*/
+struct PxDefaultCpuDispatcherQueueStatistics
+{
+	PxU32	nbEntries;			//!< Number of queue entries allocated
+	PxU32	nbSlabs;			//!< Number of slabs the entries were allocated in
+	PxU32	maxNbEntriesUsed;	//!< Sum of the peak number of entries used at the same time in each pool
+};
+
+/**
+\brief Scheduling parameters of a scene sharing a dispatcher created with PxDefaultCpuDispatcherSchedulingMode::eSCENE_PRIORITY.
+
+@see PxDefaultCpuDispatcher::setSceneSchedulingParams()
+*/
+struct PxDefaultCpuDispatcherSceneParams
+{
+	PxDefaultCpuDispatcherSceneParams() : priority(0), weight(1)	{}
+
+	/**
+	\brief Tasks of scenes with a higher priority are always executed first.
+	*/
+	PxU32	priority;
+
+	/**
+	\brief Relative share of the workers among scenes of the same priority without deadline. A scene with weight 2 gets
+	twice as many tasks executed as a scene with weight 1 while both have tasks queued.
+
+	<b>Range:</b> [1, 65536]<br>
+	*/
+	PxU32	weight;
+};
+
+/**
+\brief Per-scene counters of a dispatcher created with PxDefaultCpuDispatcherSchedulingMode::eSCENE_PRIORITY.
+
+@see PxDefaultCpuDispatcher::getSceneStatistics()
+*/
+struct PxDefaultCpuDispatcherSceneStatistics
+{
+	PxU32	nbTasks;		//!< Number of tasks of the scene executed by the workers
+	PxU32	nbLateTasks;	//!< Number of tasks of the scene started after the deadline of the scene
+	PxU32	nbQueuedTasks;	//!< Number of tasks of the scene waiting for a worker
+};
+
+/**
+\brief Describes how worker threads are pinned to the processors of the machine.
+
+Each worker is pinned to one logical processor. Physical cores of the preferred NUMA node are used first, with cores
+sharing a last level cache next to each other, then their SMT siblings, then the other nodes. Scenes running in the
+same process can be given disjoint processor sets so that they don't share cores and caches.
+
+\note The topology is read from /sys/devices/system/cpu on Linux. On other platforms the workers are not pinned.
+\note Up to 1024 logical processors are supported. Affinity masks are 32 bit, use cpuSetWords and
+PxDefaultCpuDispatcherGetTopologyCpus() to address processors beyond the first 32.
+
+@see PxDefaultCpuDispatcherGetTopologyCpus() PxDefaultCpuDispatcherGetTopologyAffinityMasks() PxDefaultCpuDispatcherCreate()
+*/
+struct PxDefaultCpuDispatcherTopologyDesc
+{
+	PxDefaultCpuDispatcherTopologyDesc() : preferredNumaNode(PX_MAX_U32), cpuSet(0), cpuSetWords(NULL), nbCpuSetWords(0), preferPhysicalCores(true)	{}
+
+	/**
+	\brief NUMA node whose processors are used first. PX_MAX_U32 selects the node with the most usable processors.
+	*/
+	PxU32	preferredNumaNode;
+
+	/**
+	\brief Mask of the logical processors the workers may be pinned to, 0 for all processors.
+	*/
+	PxU32	cpuSet;
+
+	/**
+	\brief Wide mask of the logical processors the workers may be pinned to, used instead of cpuSet when not NULL.
+
+	Bit i of word j stands for logical processor 64*j+i. The array must hold nbCpuSetWords words.
+	*/
+	const PxU64*	cpuSetWords;
+
+	/**
+	\brief Number of words in cpuSetWords.
+	*/
+	PxU32	nbCpuSetWords;
+
+	/**
+	\brief Pin one worker per physical core before using SMT siblings.
+	*/
+	bool	preferPhysicalCores;
+};
+
 /**
 \brief A default implementation for a CPU task dispatcher.
 
@@ -74,6 +253,112 @@ public:
 	\return True if tasks should be profiled.
 	*/
 	virtual bool getRunProfiled() const = 0;
+
+	/**
+	\brief Sets the policy used by idle worker threads to wait for new tasks.
+
+	\param[in] policy The wait policy.
+
+	@see PxDefaultCpuDispatcherWaitPolicy
+	*/
+	virtual void setWaitPolicy(const PxDefaultCpuDispatcherWaitPolicy& policy) = 0;
+
+	/**
+	\brief Returns the policy used by idle worker threads to wait for new tasks.
+
+	\return The wait policy.
+	*/
+	virtual PxDefaultCpuDispatcherWaitPolicy getWaitPolicy() const = 0;
+
+	/**
+	\brief Hints that a simulation frame is in flight.
+
+	While a frame is active, idle workers keep spinning and yielding instead of parking, so that the task bursts
+	of a frame do not pay the wake-up latency of parked threads. Typically set to true before PxScene::simulate()
+	and to false after PxScene::fetchResults(). Workers park according to the wait policy once the hint is cleared.
+
+	\param[in] active True while a simulation frame is in flight.
+	*/
+	virtual void setFrameActive(bool active) = 0;
+
+	/**
+	\brief Returns the frame-active hint.
+
+	@see setFrameActive()
+	*/
+	virtual bool isFrameActive() const = 0;
+
+	/**
+	\brief Copies the per-worker statistics to a user buffer.
+
+	\param[out] userBuffer Buffer receiving one entry per worker thread.
+	\param[in] bufferSize Number of entries that fit in the buffer.
+	\return Number of entries written.
+
+	@see PxDefaultCpuDispatcherWorkerStatistics getWorkerCount()
+	*/
+	virtual PxU32 getWorkerStatistics(PxDefaultCpuDispatcherWorkerStatistics* userBuffer, PxU32 bufferSize) const = 0;
+
+	/**
+	\brief Resets the per-worker statistics.
+	*/
+	virtual void resetWorkerStatistics() = 0;
+
+	/**
+	\brief Retrieves the counters of the task queue entry pools.
+
+	\param[out] stats The pool counters.
+
+	@see PxDefaultCpuDispatcherQueueStatistics
+	*/
+	virtual void getQueueStatistics(PxDefaultCpuDispatcherQueueStatistics& stats) const = 0;
+
+	/**
+	\brief Sets the scheduling parameters of a scene sharing the dispatcher.
+
+	Scenes that submit tasks without having been registered use the default parameters.
+
+	\note Only supported by dispatchers created with PxDefaultCpuDispatcherSchedulingMode::eSCENE_PRIORITY.
+
+	\param[in] contextId Context id of the scene, see PxScene::getTaskContextId().
+	\param[in] params The scheduling parameters.
+	\return False if the mode does not support per-scene scheduling, if the context id is 0 or if too many scenes are registered.
+
+	@see PxDefaultCpuDispatcherSceneParams removeScene()
+	*/
+	virtual bool setSceneSchedulingParams(PxU64 contextId, const PxDefaultCpuDispatcherSceneParams& params) = 0;
+
+	/**
+	\brief Gives a scene a deadline for its current simulation step.
+
+	Among scenes of the same priority, the scene with the earliest deadline gets the workers first, so that late
+	running scenes catch up. Typically called right before PxScene::simulate() with the time left until the results
+	are needed, and with zero after PxScene::fetchResults().
+
+	\note Only supported by dispatchers created with PxDefaultCpuDispatcherSchedulingMode::eSCENE_PRIORITY.
+
+	\param[in] contextId Context id of the scene, see PxScene::getTaskContextId().
+	\param[in] timeToDeadline Time from now to the deadline in seconds, zero to clear the deadline.
+	*/
+	virtual void setSceneDeadline(PxU64 contextId, PxReal timeToDeadline) = 0;
+
+	/**
+	\brief Retrieves the counters of a scene sharing the dispatcher.
+
+	\param[in] contextId Context id of the scene, see PxScene::getTaskContextId().
+	\param[out] stats The scene counters.
+	\return False if the scene is unknown to the dispatcher.
+
+	@see PxDefaultCpuDispatcherSceneStatistics
+	*/
+	virtual bool getSceneStatistics(PxU64 contextId, PxDefaultCpuDispatcherSceneStatistics& stats) const = 0;
+
+	/**
+	\brief Forgets the scheduling parameters and counters of a scene, to be called once the scene is released.
+
+	\param[in] contextId Context id of the scene, see PxScene::getTaskContextId().
+	*/
+	virtual void removeScene(PxU64 contextId) = 0;
 };
 
 
@@ -82,13 +367,54 @@ public:
 
 \param[in] numThreads Number of worker threads the dispatcher should use.
 \param[in] affinityMasks Array with affinity mask for each thread. If not defined, default masks will be used.
+\param[in] mode Scheduling strategy used to distribute the tasks among the worker threads.
 
 \note numThreads may be zero in which case no worker thread are initialized and
 simulation tasks will be executed on the thread that calls PxScene::simulate()
 
-@see PxDefaultCpuDispatcher
+@see PxDefaultCpuDispatcher PxDefaultCpuDispatcherSchedulingMode
+*/
+PxDefaultCpuDispatcher* PxDefaultCpuDispatcherCreate(PxU32 numThreads, PxU32* affinityMasks = NULL, PxDefaultCpuDispatcherSchedulingMode::Enum mode = PxDefaultCpuDispatcherSchedulingMode::eSHARED_QUEUE);
+
+/**
+\brief Create default dispatcher with worker threads pinned according to the CPU topology, extensions SDK needs to be initialized first.
+
+\param[in] numThreads Number of worker threads the dispatcher should use.
+\param[in] topologyDesc Describes which processors the workers are pinned to.
+\param[in] mode Scheduling strategy used to distribute the tasks among the worker threads.
+
+@see PxDefaultCpuDispatcherTopologyDesc PxDefaultCpuDispatcherGetTopologyAffinityMasks()
+*/
+PxDefaultCpuDispatcher* PxDefaultCpuDispatcherCreate(PxU32 numThreads, const PxDefaultCpuDispatcherTopologyDesc& topologyDesc, PxDefaultCpuDispatcherSchedulingMode::Enum mode = PxDefaultCpuDispatcherSchedulingMode::eSHARED_QUEUE);
+
+/**
+\brief Computes the logical processor each worker thread is pinned to from the CPU topology.
+
+This is what PxDefaultCpuDispatcherCreate() uses when given a PxDefaultCpuDispatcherTopologyDesc.
+
+\param[in] numThreads Number of worker threads.
+\param[in] topologyDesc Describes which processors the workers are pinned to.
+\param[out] cpus Array of numThreads logical processor indices. Set to PX_MAX_U32 if the topology is not available.
+\return Number of distinct physical cores the workers are pinned to, 0 if the topology is not available.
+
+@see PxDefaultCpuDispatcherTopologyDesc
+*/
+PxU32 PxDefaultCpuDispatcherGetTopologyCpus(PxU32 numThreads, const PxDefaultCpuDispatcherTopologyDesc& topologyDesc, PxU32* cpus);
+
+/**
+\brief Computes one affinity mask per worker thread from the CPU topology.
+
+\param[in] numThreads Number of worker threads.
+\param[in] topologyDesc Describes which processors the workers are pinned to.
+\param[out] affinityMasks Array of numThreads masks, suitable for PxDefaultCpuDispatcherCreate(). Set to zero if the topology is not available.
+\return Number of distinct physical cores the workers are pinned to, 0 if the topology is not available.
+
+\note A worker placed on a processor above 31 gets a zero mask and a warning is sent to the error callback.
+PxDefaultCpuDispatcherCreate() with a PxDefaultCpuDispatcherTopologyDesc pins such workers.
+
+@see PxDefaultCpuDispatcherTopologyDesc PxDefaultCpuDispatcherGetTopologyCpus()
 */
-PxDefaultCpuDispatcher* PxDefaultCpuDispatcherCreate(PxU32 numThreads, PxU32* affinityMasks = NULL);
+PxU32 PxDefaultCpuDispatcherGetTopologyAffinityMasks(PxU32 numThreads, const PxDefaultCpuDispatcherTopologyDesc& topologyDesc, PxU32* affinityMasks);
 
 #if !PX_DOXYGEN
 } // namespace physx
@@ -53,6 +53,7 @@
 #include "extensions/PxTriangleMeshExt.h"
 #include "extensions/PxSerialization.h"
 #include "extensions/PxDefaultCpuDispatcher.h"
+#include "extensions/PxAllocationProfiler.h"
 #include "extensions/PxSmoothNormals.h"
 #include "extensions/PxSimpleFactory.h"
 #include "extensions/PxStringTableExt.h"
@@ -0,0 +1,93 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+
+#ifndef PXTASK_PXTASKGRAPHRECORD_H
+#define PXTASK_PXTASKGRAPHRECORD_H
+
+#include "task/PxTaskDefine.h"
+#include "foundation/PxSimpleTypes.h"
+
+namespace physx
+{
+PX_PUSH_PACK_DEFAULT
+
+/**
+\brief A task executed during a recorded frame.
+
+All times are in microseconds, relative to the start of the frame.
+
+@see PxTaskGraphRecord
+*/
+struct PxTaskGraphRecordEvent
+{
+	const char*	name;			//!< Name of the task
+	PxU64		contextId;		//!< Context ID of the task
+	PxReal		submitTime;		//!< Time the task became ready and was handed to the CPU dispatcher
+	PxReal		startTime;		//!< Time the task started running
+	PxReal		endTime;		//!< Time the task finished running
+	PxU32		threadIndex;	//!< Thread that ran the task, threads are numbered in order of their first task in the frame
+
+	/**
+	\brief Event that made this task ready, i.e. the predecessor that completed last or the task that spawned it.
+
+	0xffffffff if the task was submitted from outside the task graph, for example by PxScene::simulate().
+	*/
+	PxU32		dependency;
+};
+
+/**
+\brief The task graph executed during one simulation frame.
+
+A frame starts with the first PxTaskManager::startSimulation() call and ends with PxTaskManager::stopSimulation(),
+which for scenes corresponds to PxScene::simulate() and PxScene::fetchResults().
+
+The critical path is the chain of dependencies leading to the task that finished last. It is the sequence of
+tasks that bounds the frame duration, no matter how many threads are available.
+
+@see PxTaskManager::setTaskGraphRecording() PxTaskManager::getTaskGraphRecord()
+*/
+struct PxTaskGraphRecord
+{
+	const PxTaskGraphRecordEvent*	events;					//!< Recorded tasks, in order of submission
+	PxU32							nbEvents;				//!< Number of recorded tasks
+	PxU32							nbDroppedEvents;		//!< Tasks that could not be recorded, because the recording buffer was full or because they were still running at the end of the frame
+	PxReal							frameDuration;			//!< Time between the start of the frame and the end of the frame
+
+	const PxU32*					criticalPath;			//!< Indices of the events on the critical path, in execution order
+	PxU32							criticalPathLength;		//!< Number of events on the critical path
+	PxReal							criticalPathBusyTime;	//!< Total run time of the tasks on the critical path, the rest of the critical path is scheduling latency
+
+	const PxReal*					threadBusyTime;			//!< Total run time of the tasks of each thread
+	const PxReal*					threadUtilization;		//!< Busy time of each thread divided by the frame duration
+	PxU32							nbThreads;				//!< Number of threads that ran tasks during the frame
+};
+
+PX_POP_PACK
+
+} // end physx namespace
+
+#endif // PXTASK_PXTASKGRAPHRECORD_H
@@ -31,11 +31,13 @@
 #include "task/PxTaskDefine.h"
 #include "foundation/PxSimpleTypes.h"
 #include "foundation/PxErrorCallback.h"
+#include "task/PxTaskGraphRecord.h"
 
 namespace physx
 {
 PX_PUSH_PACK_DEFAULT
 
+class PxOutputStream;
 class PxBaseTask;
 class PxTask;
 class PxLightCpuTask;
@@ -164,6 +166,60 @@ public:
 	*/
 	virtual PxTask*   getTaskFromID(PxTaskID id) = 0;
 
+	/**
+	\brief Submits a task that is ready to run to the CPU dispatcher.
+
+	Tasks managing their own dependencies use this instead of calling the dispatcher directly, so that
+	they are seen by the task graph recorder.
+
+	\param[in] task The task to be run.
+	*/
+	virtual void	submitReadyTask(PxBaseTask& task) = 0;
+
+	/**
+	\brief Enables or disables recording of the executed task graph.
+
+	While recording, every task handed to the CPU dispatcher is timed and the task that made it ready is tracked.
+	At the end of each frame the record is analyzed for its critical path and per-thread utilization.
+	Recording adds a small overhead to each task and should not be enabled in production.
+
+	\note Should not be changed while a frame is being simulated, it takes effect at the next frame.
+
+	\param[in] enable True to record the task graph of the following frames.
+
+	@see getTaskGraphRecord() PxTaskGraphRecord
+	*/
+	virtual void	setTaskGraphRecording(bool enable) = 0;
+
+	/**
+	\brief Checks if the task graph is recorded.
+
+	\return True if recording is enabled.
+	*/
+	virtual bool	getTaskGraphRecording() const = 0;
+
+	/**
+	\brief Returns the task graph recorded during the last completed frame.
+
+	The record stays valid until the end of the next frame.
+
+	\return The recorded frame, NULL if no frame has been recorded.
+
+	@see setTaskGraphRecording()
+	*/
+	virtual const PxTaskGraphRecord*	getTaskGraphRecord() const = 0;
+
+	/**
+	\brief Writes the task graph recorded during the last completed frame in Chrome trace event format.
+
+	The output can be loaded in chrome://tracing or compatible viewers. Dependencies are written as flow events
+	and tasks on the critical path are tagged.
+
+	\param[in] stream Stream receiving the JSON document, e.g. a PxDefaultFileOutputStream.
+	\return False if no frame has been recorded.
+	*/
+	virtual bool	writeTaskGraphRecordAsChromeTrace(PxOutputStream& stream) const = 0;
+
 	/**
 	\brief Release the PxTaskManager object, referenced dispatchers will not be released
 	*/
@@ -0,0 +1,230 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+// ****************************************************************************
+// This snippet is a micro-benchmark for the box pruning kernels of the ABP and
+// MBP broad-phases.
+//
+// The same set of moving boxes is simulated at different densities with each
+// kernel supported by the CPU (PxSetBroadPhaseKernel), without and with worker
+// threads. All pairs are killed by the filter shader, so that the frame time is
+// mostly spent in the broad-phase. The number of new broad-phase pairs must be
+// the same for all kernels and thread counts, the snippet fails otherwise.
+//
+// ****************************************************************************
+
+#include "PxPhysicsAPI.h"
+
+#include "../snippetutils/SnippetUtils.h"
+#include "../snippetcommon/SnippetPrint.h"
+
+using namespace physx;
+
+PxDefaultAllocator		gAllocator;
+PxDefaultErrorCallback	gErrorCallback;
+
+PxFoundation*			gFoundation = NULL;
+PxPhysics*				gPhysics	= NULL;
+
+PxDefaultCpuDispatcher*	gDispatcher = NULL;
+PxMaterial*				gMaterial	= NULL;
+
+// Number of worker threads of the dispatcher for each pass, 0 runs everything on the main thread
+static const PxU32		gThreadCounts[] = { 0, 4 };
+
+static const PxU32		gNbObjects		= 8192;
+static const PxU32		gNbWarmupFrames	= 10;
+static const PxU32		gNbFrames		= 100;
+
+// Side of the cube containing the boxes. The boxes are 1 unit wide.
+struct Density
+{
+	const char*	name;
+	PxReal		worldSize;
+};
+
+static const Density gDensities[] = 
+{
+	{ "sparse",		400.0f	},
+	{ "typical",	100.0f	},
+	{ "dense",		40.0f	}
+};
+
+static const char* gKernelNames[] = { "scalar", "AVX2", "AVX-512" };
+
+// The filter shader is called once for each new broad-phase pair, possibly from worker threads
+static volatile PxI32 gNbNewPairs = 0;
+
+static PxFilterFlags killAllPairsFilterShader(	PxFilterObjectAttributes, PxFilterData, PxFilterObjectAttributes, PxFilterData,
+												PxPairFlags&, const void*, PxU32)
+{
+	SnippetUtils::atomicIncrement(&gNbNewPairs);
+	return PxFilterFlag::eKILL;
+}
+
+// Deterministic random numbers, so that all kernels see the same boxes
+static PxU32 gSeed = 0;
+static PxReal random01()
+{
+	gSeed = gSeed * 1664525u + 1013904223u;
+	return PxReal(gSeed>>8) / PxReal(1<<24);
+}
+
+static PxScene* createScene(PxBroadPhaseType::Enum bpType, PxReal worldSize)
+{
+	PxSceneDesc sceneDesc(gPhysics->getTolerancesScale());
+	sceneDesc.gravity		= PxVec3(0.0f);
+	sceneDesc.cpuDispatcher	= gDispatcher;
+	sceneDesc.filterShader	= killAllPairsFilterShader;
+	sceneDesc.broadPhaseType = bpType;
+	PxScene* scene = gPhysics->createScene(sceneDesc);
+
+	// The boxes move at most 2 units during the benchmark
+	const PxBounds3 worldBounds(PxVec3(-worldSize*0.5f - 4.0f), PxVec3(worldSize*0.5f + 4.0f));
+	if(bpType==PxBroadPhaseType::eMBP)
+	{
+		PxBounds3 regions[16];
+		const PxU32 nbRegions = PxBroadPhaseExt::createRegionsFromWorldBounds(regions, worldBounds, 4);
+		for(PxU32 i=0;i<nbRegions;i++)
+		{
+			PxBroadPhaseRegion region;
+			region.bounds	= regions[i];
+			region.userData	= NULL;
+			scene->addBroadPhaseRegion(region);
+		}
+	}
+
+	gSeed = 42;
+	PxShape* shape = gPhysics->createShape(PxBoxGeometry(0.5f, 0.5f, 0.5f), *gMaterial);
+	for(PxU32 i=0;i<gNbObjects;i++)
+	{
+		const PxVec3 pos = (PxVec3(random01(), random01(), random01()) - PxVec3(0.5f)) * worldSize;
+		const PxVec3 vel = (PxVec3(random01(), random01(), random01()) - PxVec3(0.5f)) * 2.0f;
+		PxRigidDynamic* body = gPhysics->createRigidDynamic(PxTransform(pos));
+		body->attachShape(*shape);
+		body->setLinearVelocity(vel);
+		body->setLinearDamping(0.0f);
+		scene->addActor(*body);
+	}
+	shape->release();
+	return scene;
+}
+
+// Returns the number of new broad-phase pairs
+static PxU32 runBenchmark(PxBroadPhaseType::Enum bpType, const Density& density, PxBroadPhaseKernel::Enum kernel, PxU32 nbThreads)
+{
+	PxScene* scene = createScene(bpType, density.worldSize);
+
+	gNbNewPairs = 0;
+	PxU64 time = 0;
+	for(PxU32 i=0;i<gNbWarmupFrames+gNbFrames;i++)
+	{
+		const PxU64 startTime = SnippetUtils::getCurrentTimeCounterValue();
+		scene->simulate(1.0f/60.0f);
+		scene->fetchResults(true);
+		if(i>=gNbWarmupFrames)
+			time += SnippetUtils::getCurrentTimeCounterValue() - startTime;
+	}
+
+	const PxU32 nbNewPairs = PxU32(gNbNewPairs);
+	printf("%s %-8s %-8s %u threads %8.3f ms/frame, %u new pairs\n",	bpType==PxBroadPhaseType::eABP ? "ABP" : "MBP",
+																	density.name, gKernelNames[kernel], nbThreads,
+																	SnippetUtils::getElapsedTimeInMilliseconds(time)/PxReal(gNbFrames), nbNewPairs);
+	scene->release();
+	return nbNewPairs;
+}
+
+void initPhysics()
+{
+	gFoundation = PxCreateFoundation(PX_PHYSICS_VERSION, gAllocator, gErrorCallback);
+	gPhysics = PxCreatePhysics(PX_PHYSICS_VERSION, *gFoundation, PxTolerancesScale());
+	gMaterial = gPhysics->createMaterial(0.5f, 0.5f, 0.6f);
+}
+
+void cleanupPhysics()
+{
+	// Restore the default (widest) kernels
+	PxSetBroadPhaseKernel(PxBroadPhaseKernel::eAVX512);
+
+	PX_RELEASE(gPhysics);
+	PX_RELEASE(gFoundation);
+	
+	printf("SnippetBoxPruning done.\n");
+}
+
+int snippetMain(int, const char*const*)
+{
+	initPhysics();
+
+	const PxBroadPhaseKernel::Enum widestKernel = PxSetBroadPhaseKernel(PxBroadPhaseKernel::eAVX512);
+	printf("Widest supported kernel: %s\n", gKernelNames[widestKernel]);
+
+	// Pair counts of the scalar kernel without worker threads, the reference for the other runs
+	const PxU32 nbDensities = sizeof(gDensities)/sizeof(gDensities[0]);
+	PxU32 referenceNbPairs[2][nbDensities];
+	PxU32 nbMismatches = 0;
+
+	const PxBroadPhaseType::Enum bpTypes[] = { PxBroadPhaseType::eABP, PxBroadPhaseType::eMBP };
+	for(PxU32 t=0;t<sizeof(gThreadCounts)/sizeof(gThreadCounts[0]);t++)
+	{
+		gDispatcher = PxDefaultCpuDispatcherCreate(gThreadCounts[t]);
+
+		for(PxU32 d=0;d<nbDensities;d++)
+		{
+			for(PxU32 b=0;b<2;b++)
+			{
+				for(PxU32 k=0;k<=PxU32(widestKernel);k++)
+				{
+					const PxBroadPhaseKernel::Enum kernel = PxSetBroadPhaseKernel(PxBroadPhaseKernel::Enum(k));
+					const PxU32 nbPairs = runBenchmark(bpTypes[b], gDensities[d], kernel, gThreadCounts[t]);
+
+					if(t==0 && kernel==PxBroadPhaseKernel::eSCALAR)
+						referenceNbPairs[b][d] = nbPairs;
+					else if(nbPairs!=referenceNbPairs[b][d])
+					{
+						printf("ERROR: %u new pairs, the scalar kernel without worker threads found %u\n", nbPairs, referenceNbPairs[b][d]);
+						nbMismatches++;
+					}
+				}
+			}
+		}
+
+		PX_RELEASE(gDispatcher);
+	}
+
+	cleanupPhysics();
+
+	if(nbMismatches)
+	{
+		printf("SnippetBoxPruning FAILED: %u runs found a different number of pairs.\n", nbMismatches);
+		return 1;
+	}
+
+	return 0;
+}
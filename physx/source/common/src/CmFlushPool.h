@@ -36,10 +36,16 @@
 #include "CmPhysXCommon.h"
 #include "PsMutex.h"
 #include "PsArray.h"
+#include "PsAtomic.h"
+#include "PsIntrinsics.h"
 #include "PsBitUtils.h"
 
 /*
 Pool used to allocate variable sized tasks. It's intended to be cleared after a short period (time step).
+
+Allocations bump an atomic offset in the current chunk, the mutex is only taken to move on to the next chunk.
+Chunks are kept up to the peak number of chunks used in a time step, so that a pool that has warmed up does not
+hit the global allocator anymore.
 */
 
 namespace physx
@@ -51,10 +57,21 @@ namespace Cm
 	class FlushPool
 	{
 		PX_NOCOPY(FlushPool)
+
+		// Header at the start of each chunk, keeps the data 16 bytes aligned
+		struct Chunk
+		{
+			volatile PxI32	mOffset;
+			PxU32			mPad[3];
+
+			PX_FORCE_INLINE	PxU8*	getData()	{ return reinterpret_cast<PxU8*>(this + 1);	}
+		};
+
 	public:
-		FlushPool(PxU32 chunkSize) : mChunks(PX_DEBUG_EXP("FlushPoolChunk")), mChunkIndex(0), mOffset(0), mChunkSize(chunkSize)
+		FlushPool(PxU32 chunkSize) : mChunks(PX_DEBUG_EXP("FlushPoolChunk")), mChunkIndex(0), mChunkSize(chunkSize), mMaxNbChunksUsed(1), mMaxBytesUsed(0)
 		{
-			mChunks.pushBack(static_cast<PxU8*>(PX_ALLOC(mChunkSize, "PxU8")));
+			mChunks.pushBack(allocateChunk());
+			mCurrentChunk = mChunks[0];
 		}
 
 		~FlushPool()
@@ -65,37 +82,45 @@ namespace Cm
 
 		// alignment must be a power of two
 		void* allocate(PxU32 size, PxU32 alignment=16)
-		{
-			Ps::Mutex::ScopedLock lock(mMutex);
-			return allocateNotThreadSafe(size, alignment);
-		}
-
-		// alignment must be a power of two
-		void* allocateNotThreadSafe(PxU32 size, PxU32 alignment=16)
 		{
 			PX_ASSERT(shdfnd::isPowerOfTwo(alignment));
-			PX_ASSERT(size <= mChunkSize && !mChunks.empty());
-			
-			// padding for alignment
-			size_t unalignedStart = reinterpret_cast<size_t>(mChunks[mChunkIndex]+mOffset);
-			PxU32 pad = PxU32(((unalignedStart+alignment-1)&~(size_t(alignment)-1)) - unalignedStart);
+			PX_ASSERT(size <= mChunkSize);
 
-			if (mOffset + size + pad > mChunkSize)
+			for(;;)
 			{
-				mChunkIndex++;
-				mOffset = 0;
-				if (mChunkIndex >= mChunks.size())
-					mChunks.pushBack(static_cast<PxU8*>(PX_ALLOC(mChunkSize, "PxU8")));
-
-				// update padding to ensure new alloc is aligned
-				unalignedStart = reinterpret_cast<size_t>(mChunks[mChunkIndex]);
-				pad = PxU32(((unalignedStart+alignment-1)&~(size_t(alignment)-1)) - unalignedStart);
+				Chunk* chunk = mCurrentChunk;
+				PxU8* data = chunk->getData();
+				PxI32 offset = chunk->mOffset;
+
+				for(;;)
+				{
+					// padding for alignment
+					const size_t unalignedStart = reinterpret_cast<size_t>(data + offset);
+					const PxU32 pad = PxU32(((unalignedStart+alignment-1)&~(size_t(alignment)-1)) - unalignedStart);
+
+					if (PxU32(offset) + size + pad > mChunkSize)
+						break;
+
+					const PxI32 previousOffset = Ps::atomicCompareExchange(&chunk->mOffset, PxI32(PxU32(offset) + size + pad), offset);
+					if (previousOffset == offset)
+					{
+						void* ptr = data + offset + pad;
+						PX_ASSERT((reinterpret_cast<size_t>(ptr)&(size_t(alignment)-1)) == 0);
+						return ptr;
+					}
+
+					offset = previousOffset;
+				}
+
+				nextChunk(chunk);
 			}
+		}
 
-			void* ptr = mChunks[mChunkIndex] + mOffset + pad;
-			PX_ASSERT((reinterpret_cast<size_t>(ptr)&(size_t(alignment)-1)) == 0);
-			mOffset += size + pad;
-			return ptr;
+		// alignment must be a power of two
+		// Same as allocate(), kept for the callers that batch allocations between lock() and unlock()
+		PX_FORCE_INLINE void* allocateNotThreadSafe(PxU32 size, PxU32 alignment=16)
+		{
+			return allocate(size, alignment);
 		}
 
 		void clear(PxU32 spareChunkCount = sSpareChunkCount)
@@ -109,18 +134,23 @@ namespace Cm
 		{
 			PX_UNUSED(spareChunkCount);
 
-			//release memory not used previously
-			PxU32 targetSize = mChunkIndex+sSpareChunkCount;
+			const PxU32 bytesUsed = mChunkIndex * mChunkSize + PxU32(mCurrentChunk->mOffset);
+			mMaxBytesUsed = PxMax(mMaxBytesUsed, bytesUsed);
+			mMaxNbChunksUsed = PxMax(mMaxNbChunksUsed, mChunkIndex + 1);
+
+			//release memory not used at the peak
+			PxU32 targetSize = mMaxNbChunksUsed - 1 + sSpareChunkCount;
 			while (mChunks.size() > targetSize)
 				PX_FREE(mChunks.popBack());
 
 			mChunkIndex = 0;
-			mOffset = 0;
+			mChunks[0]->mOffset = 0;
+			mCurrentChunk = mChunks[0];
 		}
 
 		void resetNotThreadSafe()
 		{
-			PxU8* firstChunk = mChunks[0];
+			Chunk* firstChunk = mChunks[0];
 
 			for (PxU32 i = 1; i < mChunks.size(); ++i)
 				PX_FREE(mChunks[i]);
@@ -128,7 +158,9 @@ namespace Cm
 			mChunks.clear();
 			mChunks.pushBack(firstChunk);
 			mChunkIndex = 0;
-			mOffset = 0;
+			firstChunk->mOffset = 0;
+			mCurrentChunk = firstChunk;
+			mMaxNbChunksUsed = 1;
 		}
 
 		void lock()
@@ -141,12 +173,58 @@ namespace Cm
 			mMutex.unlock();	
 		}
 
+		// Number of chunks currently allocated
+		PxU32 getNbChunks() const
+		{
+			return mChunks.size();
+		}
+
+		// High-water marks, updated when the pool is cleared
+		PxU32 getMaxNbChunksUsed() const
+		{
+			return mMaxNbChunksUsed;
+		}
+
+		PxU32 getMaxBytesUsed() const
+		{
+			return mMaxBytesUsed;
+		}
+
 	private:
+		Chunk* allocateChunk()
+		{
+			Chunk* chunk = reinterpret_cast<Chunk*>(PX_ALLOC(sizeof(Chunk) + mChunkSize, "PxU8"));
+			chunk->mOffset = 0;
+			return chunk;
+		}
+
+		// Moves on to the next chunk unless another thread already did
+		void nextChunk(Chunk* fullChunk)
+		{
+			Ps::Mutex::ScopedLock lock(mMutex);
+
+			if (mCurrentChunk != fullChunk)
+				return;
+
+			mChunkIndex++;
+			if (mChunkIndex >= mChunks.size())
+				mChunks.pushBack(allocateChunk());
+
+			Chunk* chunk = mChunks[mChunkIndex];
+			chunk->mOffset = 0;
+
+			// publish the chunk once its offset is reset
+			Ps::memoryBarrier();
+			mCurrentChunk = chunk;
+		}
+
 		Ps::Mutex mMutex;
-		Ps::Array<PxU8*> mChunks;
+		Ps::Array<Chunk*> mChunks;
+		Chunk* volatile mCurrentChunk;
 		PxU32 mChunkIndex;
-		PxU32 mOffset;
 		PxU32 mChunkSize;
+		PxU32 mMaxNbChunksUsed;
+		PxU32 mMaxBytesUsed;
 	};
 
 	
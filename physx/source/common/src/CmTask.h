@@ -146,7 +146,7 @@ namespace Cm
 				for (PxU32 i = 0; i < mDependents.size(); i++)
 					mReferencesToRemove.pushBack(mDependents[i]);
 				mDependents.clear();
-				mTm->getCpuDispatcher()->submitTask(*this);
+				mTm->submitReadyTask(*this);
 			}
 		}
 
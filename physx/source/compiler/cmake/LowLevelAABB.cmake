@@ -46,6 +46,10 @@ SOURCE_GROUP("includes" FILES ${LLAABB_HEADERS})
 
 SET(LLAABB_SOURCE	
 	${LLAABB_DIR}/src/BpAABBManager.cpp
+	${LLAABB_DIR}/src/BpABPTasks.cpp
+	${LLAABB_DIR}/src/BpABPTasks.h
+	${LLAABB_DIR}/src/BpBoxPruningKernels.cpp
+	${LLAABB_DIR}/src/BpBoxPruningKernels.h
 	${LLAABB_DIR}/src/BpBroadPhase.cpp
 	${LLAABB_DIR}/src/BpBroadPhaseABP.cpp
 	${LLAABB_DIR}/src/BpBroadPhaseABP.h
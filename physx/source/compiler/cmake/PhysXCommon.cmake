@@ -177,6 +177,7 @@ SET(PHYSXCOMMON_GU_SOURCE
 	${GU_SOURCE_DIR}/src/GuMeshFactory.h
 	${GU_SOURCE_DIR}/src/GuMTD.h
 	${GU_SOURCE_DIR}/src/GuOverlapTests.h
+	${GU_SOURCE_DIR}/src/GuParallelJobs.h
 	${GU_SOURCE_DIR}/src/GuSerialize.h
 	${GU_SOURCE_DIR}/src/GuSphere.h
 	${GU_SOURCE_DIR}/src/GuSweepMTD.h
@@ -185,6 +186,7 @@ SET(PHYSXCOMMON_GU_SOURCE
 	${GU_SOURCE_DIR}/src/GuAABBTreeBuild.cpp
 	${GU_SOURCE_DIR}/src/GuAABBTreeBuild.h
 	${GU_SOURCE_DIR}/src/GuAABBTreeQuery.h
+	${GU_SOURCE_DIR}/src/GuParallelJobs.cpp
 	${GU_SOURCE_DIR}/src/GuBVHStructure.cpp
 	${GU_SOURCE_DIR}/src/GuBVHStructure.h
 	${GU_SOURCE_DIR}/src/GuBVHTestsSIMD.h
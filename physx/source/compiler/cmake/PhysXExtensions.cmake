@@ -38,9 +38,11 @@ include(${PHYSX_ROOT_DIR}/${PROJECT_CMAKE_FILES_DIR}/${TARGET_BUILD_PLATFORM}/Ph
 
 
 SET(PHYSX_EXTENSIONS_SOURCE
+	${LL_SOURCE_DIR}/ExtAllocationProfiler.cpp
 	${LL_SOURCE_DIR}/ExtBroadPhase.cpp
 	${LL_SOURCE_DIR}/ExtCollection.cpp
 	${LL_SOURCE_DIR}/ExtConvexMeshExt.cpp
+	${LL_SOURCE_DIR}/ExtCpuTopology.cpp
 	${LL_SOURCE_DIR}/ExtCpuWorkerThread.cpp
 	${LL_SOURCE_DIR}/ExtD6Joint.cpp
 	${LL_SOURCE_DIR}/ExtD6JointCreate.cpp
@@ -62,12 +64,17 @@ SET(PHYSX_EXTENSIONS_SOURCE
 	${LL_SOURCE_DIR}/ExtRigidBodyExt.cpp
 	${LL_SOURCE_DIR}/ExtRigidActorExt.cpp	
 	${LL_SOURCE_DIR}/ExtSceneQueryExt.cpp
+	${LL_SOURCE_DIR}/ExtSceneSchedulingCpuDispatcher.cpp
 	${LL_SOURCE_DIR}/ExtSimpleFactory.cpp
 	${LL_SOURCE_DIR}/ExtSmoothNormals.cpp
 	${LL_SOURCE_DIR}/ExtSphericalJoint.cpp
 	${LL_SOURCE_DIR}/ExtTriangleMeshExt.cpp
+	${LL_SOURCE_DIR}/ExtWorkStealingCpuDispatcher.cpp
+	${LL_SOURCE_DIR}/ExtAllocationProfiler.h
 	${LL_SOURCE_DIR}/ExtConstraintHelper.h
+	${LL_SOURCE_DIR}/ExtCpuTopology.h
 	${LL_SOURCE_DIR}/ExtCpuWorkerThread.h
+	${LL_SOURCE_DIR}/ExtCpuWorkerWait.h
 	${LL_SOURCE_DIR}/ExtD6Joint.h
 	${LL_SOURCE_DIR}/ExtDefaultCpuDispatcher.h
 	${LL_SOURCE_DIR}/ExtDistanceJoint.h
@@ -81,10 +88,13 @@ SET(PHYSX_EXTENSIONS_SOURCE
 	${LL_SOURCE_DIR}/ExtPrismaticJoint.h
 	${LL_SOURCE_DIR}/ExtPvd.h
 	${LL_SOURCE_DIR}/ExtRevoluteJoint.h
+	${LL_SOURCE_DIR}/ExtSceneSchedulingCpuDispatcher.h
 	${LL_SOURCE_DIR}/ExtSerialization.h
 	${LL_SOURCE_DIR}/ExtSharedQueueEntryPool.h
 	${LL_SOURCE_DIR}/ExtSphericalJoint.h
 	${LL_SOURCE_DIR}/ExtTaskQueueHelper.h	
+	${LL_SOURCE_DIR}/ExtWorkStealingCpuDispatcher.h
+	${LL_SOURCE_DIR}/ExtWorkStealingDeque.h
 )
 SOURCE_GROUP(src FILES ${PHYSX_EXTENSIONS_SOURCE})
 
@@ -97,6 +107,7 @@ SET(PHYSX_EXTENSIONS_METADATA_SOURCE
 SOURCE_GROUP(src\\metadata FILES ${PHYSX_EXTENSIONS_METADATA_SOURCE})
 
 SET(PHYSX_EXTENSIONS_HEADERS
+	${PHYSX_ROOT_DIR}/include/extensions/PxAllocationProfiler.h
 	${PHYSX_ROOT_DIR}/include/extensions/PxBinaryConverter.h
 	${PHYSX_ROOT_DIR}/include/extensions/PxBroadPhaseExt.h
 	${PHYSX_ROOT_DIR}/include/extensions/PxCollectionExt.h
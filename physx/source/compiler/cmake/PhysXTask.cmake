@@ -39,11 +39,14 @@ SET(PHYSXTASK_HEADERS
 	${PHYSX_ROOT_DIR}/include/task/PxCpuDispatcher.h
 	${PHYSX_ROOT_DIR}/include/task/PxTask.h
 	${PHYSX_ROOT_DIR}/include/task/PxTaskDefine.h
+	${PHYSX_ROOT_DIR}/include/task/PxTaskGraphRecord.h
 	${PHYSX_ROOT_DIR}/include/task/PxTaskManager.h
 )
 SOURCE_GROUP(include FILES ${PHYSXTASK_HEADERS})
 
 SET(PHYSXTASK_SOURCE
+	${LL_SOURCE_DIR}/src/TaskGraphRecorder.cpp
+	${LL_SOURCE_DIR}/src/TaskGraphRecorder.h
 	${LL_SOURCE_DIR}/src/TaskManager.cpp
 )
 SOURCE_GROUP(src FILES ${PHYSXTASK_SOURCE})
@@ -41,6 +41,7 @@ SET(SCENEQUERY_HEADERS
 	${SCENEQUERY_BASE_DIR}/include/SqPruner.h
 	${SCENEQUERY_BASE_DIR}/include/SqPrunerMergeData.h
 	${SCENEQUERY_BASE_DIR}/include/SqPruningStructure.h
+	${SCENEQUERY_BASE_DIR}/include/SqQueryCache.h
 	${SCENEQUERY_BASE_DIR}/include/SqSceneQueryManager.h	
 )
 SOURCE_GROUP(include FILES ${SCENEQUERY_HEADERS})
@@ -60,6 +61,9 @@ SET(SCENEQUERY_SOURCE
 	${SCENEQUERY_BASE_DIR}/src/SqAABBTreeUpdateMap.h
 	${SCENEQUERY_BASE_DIR}/src/SqBounds.cpp
 	${SCENEQUERY_BASE_DIR}/src/SqBounds.h
+	${SCENEQUERY_BASE_DIR}/src/SqCompressedAABBTree.cpp
+	${SCENEQUERY_BASE_DIR}/src/SqCompressedAABBTree.h
+	${SCENEQUERY_BASE_DIR}/src/SqCompressedAABBTreeQuery.h
 	${SCENEQUERY_BASE_DIR}/src/SqCompoundPruner.cpp
 	${SCENEQUERY_BASE_DIR}/src/SqCompoundPruner.h	
 	${SCENEQUERY_BASE_DIR}/src/SqCompoundPruningPool.cpp
@@ -68,12 +72,18 @@ SET(SCENEQUERY_SOURCE
 	${SCENEQUERY_BASE_DIR}/src/SqBucketPruner.h
 	${SCENEQUERY_BASE_DIR}/src/SqExtendedBucketPruner.cpp
 	${SCENEQUERY_BASE_DIR}/src/SqExtendedBucketPruner.h
+	${SCENEQUERY_BASE_DIR}/src/SqGridPruner.cpp
+	${SCENEQUERY_BASE_DIR}/src/SqGridPruner.h
 	${SCENEQUERY_BASE_DIR}/src/SqMetaData.cpp
 	${SCENEQUERY_BASE_DIR}/src/SqPruningPool.cpp
 	${SCENEQUERY_BASE_DIR}/src/SqPruningPool.h
 	${SCENEQUERY_BASE_DIR}/src/SqPruningStructure.cpp
+	${SCENEQUERY_BASE_DIR}/src/SqQueryCache.cpp
 	${SCENEQUERY_BASE_DIR}/src/SqSceneQueryManager.cpp
 	${SCENEQUERY_BASE_DIR}/src/SqTypedef.h
+	${SCENEQUERY_BASE_DIR}/src/SqWideAABBTree.cpp
+	${SCENEQUERY_BASE_DIR}/src/SqWideAABBTree.h
+	${SCENEQUERY_BASE_DIR}/src/SqWideAABBTreeQuery.h
 )
 SOURCE_GROUP(src FILES ${SCENEQUERY_SOURCE})
 
@@ -69,6 +69,7 @@ class PX_FOUNDATION_API Foundation : public PxFoundation, public UserAllocated
 	// note, you MUST eventually call release if createInstance returned true!
 	static Foundation* createInstance(PxU32 version, PxErrorCallback& errc, PxAllocatorCallback& alloc);
 	static Foundation& getInstance();
+	static bool isInstanced();
 	static void setInstance(Foundation& foundation);
 	void release();
 	static void incRefCount(); // this call requires a foundation object to exist already
@@ -142,6 +143,22 @@ class PX_FOUNDATION_API Foundation : public PxFoundation, public UserAllocated
 	{
 		return mTempAllocMutex;
 	}
+	PX_INLINE uint32_t getTempAllocTlsIndex() const
+	{
+		return mTempAllocTlsIndex;
+	}
+	PX_INLINE TempAllocatorThreadCache*& getTempAllocThreadCaches()
+	{
+		return mTempAllocThreadCaches;
+	}
+	PX_INLINE volatile int32_t& getTempAllocThreadCacheBytes()
+	{
+		return mTempAllocThreadCacheBytes;
+	}
+	PX_INLINE TempAllocatorStatistics& getTempAllocRetiredStatistics()
+	{
+		return mTempAllocRetiredStatistics;
+	}
 	// End allocations
 
   private:
@@ -167,6 +184,10 @@ class PX_FOUNDATION_API Foundation : public PxFoundation, public UserAllocated
 
 	AllocFreeTable mTempAllocFreeTable;
 	Mutex mTempAllocMutex;
+	uint32_t mTempAllocTlsIndex;
+	TempAllocatorThreadCache* mTempAllocThreadCaches;      // protected by mTempAllocMutex
+	volatile int32_t mTempAllocThreadCacheBytes;           // held by all the thread caches
+	TempAllocatorStatistics mTempAllocRetiredStatistics; // counters of the caches already released
 
 	Mutex mListenerMutex;
 
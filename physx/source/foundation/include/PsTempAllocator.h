@@ -30,6 +30,7 @@
 #ifndef PSFOUNDATION_PSTEMPALLOCATOR_H
 #define PSFOUNDATION_PSTEMPALLOCATOR_H
 
+#include "PxFoundation.h"
 #include "PsAllocator.h"
 
 namespace physx
@@ -46,6 +47,29 @@ union TempAllocatorChunk
 	uint8_t mPad[16];          // 16 byte aligned allocations
 };
 
+typedef PxTempAllocatorStatistics TempAllocatorStatistics;
+
+// Small per-thread stock of free chunks in front of the mutex protected free lists of the foundation.
+// Only the owning thread touches the bins, the statistics are read under the temp allocator mutex.
+struct TempAllocatorThreadCache
+{
+	enum
+	{
+		eNB_BINS = 9,                     // one per chunk size handled by the free lists, 512B to 128kB
+		eMAX_NB_CHUNKS_PER_BIN = 4,
+		eMAX_NB_BYTES = 256 * 1024,
+		eMAX_TOTAL_NB_BYTES = 4 * 1024 * 1024 // all caches together, threads not created by Ps::Thread never release theirs
+	};
+
+	TempAllocatorChunk* mBins[eNB_BINS];
+	uint32_t mNbChunks[eNB_BINS];
+	uint32_t mNbBytes;
+	uint32_t mNbHits;
+	uint32_t mNbMisses;
+	uint32_t mNbOverflows;
+	TempAllocatorThreadCache* mNext;
+};
+
 class TempAllocator
 {
   public:
@@ -54,6 +78,10 @@ class TempAllocator
 	}
 	PX_FOUNDATION_API void* allocate(size_t size, const char* file, int line);
 	PX_FOUNDATION_API void deallocate(void* ptr);
+
+	// returns the calling thread's cached chunks to the shared free lists, called when a Ps::Thread quits
+	PX_FOUNDATION_API static void releaseThreadCache();
+	PX_FOUNDATION_API static void getStatistics(TempAllocatorStatistics& stats);
 };
 
 } // namespace shdfnd
@@ -41,6 +41,8 @@
 
 #if PX_WINDOWS_FAMILY || PX_XBOXONE || PX_XBOX_SERIES_X
 #define PxSpinLockPause() __asm pause
+#elif (PX_LINUX || PX_ANDROID || PX_PS4 || PX_APPLE_FAMILY) && (PX_X86 || PX_X64)
+#define PxSpinLockPause() asm volatile("pause")
 #elif PX_LINUX || PX_ANDROID || PX_PS4 || PX_APPLE_FAMILY || PX_SWITCH
 #define PxSpinLockPause() asm("nop")
 #else
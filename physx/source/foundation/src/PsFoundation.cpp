@@ -33,6 +33,8 @@
 #include "PsFoundation.h"
 #include "PsString.h"
 #include "PsAllocator.h"
+#include "PsThread.h"
+#include "foundation/PxMemory.h"
 
 namespace physx
 {
@@ -56,13 +58,35 @@ Foundation::Foundation(PxErrorCallback& errc, PxAllocatorCallback& alloc)
 , mErrorMutex(PX_DEBUG_EXP("Foundation::mErrorMutex"))
 , mNamedAllocMutex(PX_DEBUG_EXP("Foundation::mNamedAllocMutex"))
 , mTempAllocMutex(PX_DEBUG_EXP("Foundation::mTempAllocMutex"))
+, mTempAllocTlsIndex(TlsAlloc())
+, mTempAllocThreadCaches(NULL)
+, mTempAllocThreadCacheBytes(0)
 {
+	PxMemZero(&mTempAllocRetiredStatistics, sizeof(mTempAllocRetiredStatistics));
 }
 
 Foundation::~Foundation()
 {
 	// deallocate temp buffer allocations
 	Allocator alloc;
+	for(TempAllocatorThreadCache* cache = mTempAllocThreadCaches; cache;)
+	{
+		for(PxU32 i = 0; i < TempAllocatorThreadCache::eNB_BINS; ++i)
+		{
+			for(TempAllocatorChunk* ptr = cache->mBins[i]; ptr;)
+			{
+				TempAllocatorChunk* next = ptr->mNext;
+				alloc.deallocate(ptr);
+				ptr = next;
+			}
+		}
+		TempAllocatorThreadCache* next = cache->mNext;
+		alloc.deallocate(cache);
+		cache = next;
+	}
+	mTempAllocThreadCaches = NULL;
+	TlsFree(mTempAllocTlsIndex);
+
 	for(PxU32 i = 0; i < mTempAllocFreeTable.size(); ++i)
 	{
 		for(TempAllocatorChunk* ptr = mTempAllocFreeTable[i]; ptr;)
@@ -81,6 +105,11 @@ Foundation& Foundation::getInstance()
 	return *mInstance;
 }
 
+bool Foundation::isInstanced()
+{
+	return mInstance != NULL;
+}
+
 void Foundation::setInstance(Foundation& foundation)
 {
 	mInstance = &foundation;
@@ -272,6 +301,11 @@ physx::PxFoundation& PxGetFoundation()
 	return physx::shdfnd::Foundation::getInstance();
 }
 
+void PxGetTempAllocatorStatistics(physx::PxTempAllocatorStatistics& stats)
+{
+	physx::shdfnd::TempAllocator::getStatistics(stats);
+}
+
 physx::PxProfilerCallback* PxGetProfilerCallback()
 {
 	return physx::shdfnd::gProfilerCallback;
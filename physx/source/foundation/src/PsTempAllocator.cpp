@@ -36,6 +36,8 @@
 #include "PsAtomic.h"
 #include "PsIntrinsics.h"
 #include "PsBitUtils.h"
+#include "PsThread.h"
+#include "foundation/PxMemory.h"
 
 #if PX_VC
 #pragma warning(disable : 4706) // assignment within conditional expression
@@ -61,6 +63,54 @@ PX_INLINE Foundation::Mutex& getMutex()
 
 const PxU32 sMinIndex = 8;  // 256B min
 const PxU32 sMaxIndex = 17; // 128kB max
+
+typedef TempAllocatorThreadCache ThreadCache;
+PX_COMPILE_TIME_ASSERT(sMaxIndex - sMinIndex == ThreadCache::eNB_BINS);
+
+PX_INLINE ThreadCache* getThreadCache()
+{
+	ThreadCache* cache = reinterpret_cast<ThreadCache*>(TlsGet(getFoundation().getTempAllocTlsIndex()));
+	if(!cache)
+	{
+		cache = reinterpret_cast<ThreadCache*>(NonTrackingAllocator().allocate(sizeof(ThreadCache), __FILE__, __LINE__));
+		PxMemZero(cache, sizeof(ThreadCache));
+		TlsSet(getFoundation().getTempAllocTlsIndex(), cache);
+
+		Foundation::Mutex::ScopedLock lock(getMutex());
+		cache->mNext = getFoundation().getTempAllocThreadCaches();
+		getFoundation().getTempAllocThreadCaches() = cache;
+	}
+	return cache;
+}
+
+// same search as for the free table, updates index to the size of the returned chunk
+PX_INLINE Chunk* popFromThreadCache(ThreadCache& cache, uint32_t& index)
+{
+	const uint32_t endBin = PxMin(index - sMinIndex + 3, uint32_t(ThreadCache::eNB_BINS));
+	for(uint32_t bin = index - sMinIndex; bin < endBin; ++bin)
+	{
+		if(Chunk* chunk = cache.mBins[bin])
+		{
+			cache.mBins[bin] = chunk->mNext;
+			cache.mNbChunks[bin]--;
+			index = bin + sMinIndex;
+			cache.mNbBytes -= 2u << index;
+			atomicAdd(&getFoundation().getTempAllocThreadCacheBytes(), -int32_t(2u << index));
+			return chunk;
+		}
+	}
+	return 0;
+}
+
+// caller holds the temp allocator mutex
+PX_INLINE void pushToFreeTable(Chunk* chunk, uint32_t bin)
+{
+	if(getFreeTable().size() <= bin)
+		getFreeTable().resize(bin + 1);
+
+	chunk->mNext = getFreeTable()[bin];
+	getFreeTable()[bin] = chunk;
+}
 }
 
 void* TempAllocator::allocate(size_t size, const char* filename, int line)
@@ -73,24 +123,34 @@ void* TempAllocator::allocate(size_t size, const char* filename, int line)
 	Chunk* chunk = 0;
 	if(index < sMaxIndex)
 	{
-		Foundation::Mutex::ScopedLock lock(getMutex());
-
-		// find chunk up to 16x bigger than necessary
-		Chunk** it = getFreeTable().begin() + index - sMinIndex;
-		Chunk** end = PxMin(it + 3, getFreeTable().end());
-		while(it < end && !(*it))
-			++it;
-
-		if(it < end)
+		ThreadCache* cache = getThreadCache();
+		if((chunk = popFromThreadCache(*cache, index)))
 		{
-			// pop top off freelist
-			chunk = *it;
-			*it = chunk->mNext;
-			index = uint32_t(it - getFreeTable().begin() + sMinIndex);
+			cache->mNbHits++;
 		}
 		else
-			// create new chunk
-			chunk = reinterpret_cast<Chunk*>(NonTrackingAllocator().allocate(size_t(2 << index), filename, line));
+		{
+			cache->mNbMisses++;
+
+			Foundation::Mutex::ScopedLock lock(getMutex());
+
+			// find chunk up to 16x bigger than necessary
+			Chunk** it = getFreeTable().begin() + index - sMinIndex;
+			Chunk** end = PxMin(it + 3, getFreeTable().end());
+			while(it < end && !(*it))
+				++it;
+
+			if(it < end)
+			{
+				// pop top off freelist
+				chunk = *it;
+				*it = chunk->mNext;
+				index = uint32_t(it - getFreeTable().begin() + sMinIndex);
+			}
+			else
+				// create new chunk
+				chunk = reinterpret_cast<Chunk*>(NonTrackingAllocator().allocate(size_t(2 << index), filename, line));
+		}
 	}
 	else
 	{
@@ -115,14 +175,84 @@ void TempAllocator::deallocate(void* ptr)
 	if(index >= sMaxIndex)
 		return NonTrackingAllocator().deallocate(chunk);
 
+	ThreadCache* cache = getThreadCache();
+	const uint32_t bin = index - sMinIndex;
+	const uint32_t chunkSize = 2u << index;
+	if(cache->mNbChunks[bin] < ThreadCache::eMAX_NB_CHUNKS_PER_BIN && cache->mNbBytes + chunkSize <= ThreadCache::eMAX_NB_BYTES)
+	{
+		// the caches of threads that exit without releasing them stay allocated, bound what they can hold
+		volatile int32_t& totalNbBytes = getFoundation().getTempAllocThreadCacheBytes();
+		if(uint32_t(atomicAdd(&totalNbBytes, int32_t(chunkSize))) <= ThreadCache::eMAX_TOTAL_NB_BYTES)
+		{
+			chunk->mNext = cache->mBins[bin];
+			cache->mBins[bin] = chunk;
+			cache->mNbChunks[bin]++;
+			cache->mNbBytes += chunkSize;
+			return;
+		}
+		atomicAdd(&totalNbBytes, -int32_t(chunkSize));
+	}
+	cache->mNbOverflows++;
+
+	Foundation::Mutex::ScopedLock lock(getMutex());
+	pushToFreeTable(chunk, bin);
+}
+
+void TempAllocator::releaseThreadCache()
+{
+	if(!Foundation::isInstanced())
+		return;
+
+	Foundation& foundation = getFoundation();
+	ThreadCache* cache = reinterpret_cast<ThreadCache*>(TlsGet(foundation.getTempAllocTlsIndex()));
+	if(!cache)
+		return;
+
+	TlsSet(foundation.getTempAllocTlsIndex(), NULL);
+
+	{
+		Foundation::Mutex::ScopedLock lock(getMutex());
+
+		for(uint32_t bin = 0; bin < ThreadCache::eNB_BINS; ++bin)
+		{
+			while(Chunk* chunk = cache->mBins[bin])
+			{
+				cache->mBins[bin] = chunk->mNext;
+				pushToFreeTable(chunk, bin);
+			}
+		}
+
+		atomicAdd(&foundation.getTempAllocThreadCacheBytes(), -int32_t(cache->mNbBytes));
+
+		TempAllocatorStatistics& retired = foundation.getTempAllocRetiredStatistics();
+		retired.nbThreadCacheHits += cache->mNbHits;
+		retired.nbThreadCacheMisses += cache->mNbMisses;
+		retired.nbThreadCacheOverflows += cache->mNbOverflows;
+
+		ThreadCache** it = &foundation.getTempAllocThreadCaches();
+		while(*it != cache)
+			it = &(*it)->mNext;
+		*it = cache->mNext;
+	}
+
+	NonTrackingAllocator().deallocate(cache);
+}
+
+void TempAllocator::getStatistics(TempAllocatorStatistics& stats)
+{
 	Foundation::Mutex::ScopedLock lock(getMutex());
 
-	index -= sMinIndex;
-	if(getFreeTable().size() <= index)
-		getFreeTable().resize(index + 1);
+	stats = getFoundation().getTempAllocRetiredStatistics();
+	stats.nbThreadCaches = 0;
 
-	chunk->mNext = getFreeTable()[index];
-	getFreeTable()[index] = chunk;
+	// the owning threads update their counters without locking, the totals are approximate while they run
+	for(const ThreadCache* cache = getFoundation().getTempAllocThreadCaches(); cache; cache = cache->mNext)
+	{
+		stats.nbThreadCacheHits += cache->mNbHits;
+		stats.nbThreadCacheMisses += cache->mNbMisses;
+		stats.nbThreadCacheOverflows += cache->mNbOverflows;
+		stats.nbThreadCaches++;
+	}
 }
 
 } // namespace shdfnd
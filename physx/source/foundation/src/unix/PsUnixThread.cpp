@@ -64,8 +64,6 @@ int android_getCpuCount(void);
 }
 #endif
 
-#define PxSpinLockPause() asm("nop")
-
 namespace physx
 {
 namespace shdfnd
@@ -138,6 +136,8 @@ void* PxThreadStart(void* arg)
 		(*impl->fn)(impl->arg);
 	else if(impl->arg)
 		(reinterpret_cast<Runnable*>(impl->arg))->execute();
+
+	TempAllocator::releaseThreadCache();
 	return 0;
 }
 }
@@ -266,6 +266,7 @@ __attribute__((noreturn))
     void ThreadImpl::quit()
 {
 	getThread(this)->state = _PxThreadStopped;
+	TempAllocator::releaseThreadCache();
 	pthread_exit(0);
 }
 
@@ -35,6 +35,7 @@
 
 #include "windows/PsWindowsInclude.h"
 #include "PsThread.h"
+#include "PsTempAllocator.h"
 
 using namespace Platform;
 using namespace Windows::Foundation;
@@ -106,6 +107,8 @@ DWORD WINAPI PxThreadStart(LPVOID arg)
 		(*impl->fn)(impl->arg);
 	else if(impl->arg)
 		((Runnable*)impl->arg)->execute();
+
+	TempAllocator::releaseThreadCache();
 	return 0;
 }
 }
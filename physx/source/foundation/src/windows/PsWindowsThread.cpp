@@ -98,6 +98,8 @@ DWORD WINAPI PxThreadStart(LPVOID arg)
 		(*impl->fn)(impl->arg);
 	else if(impl->arg)
 		((Runnable*)impl->arg)->execute();
+
+	TempAllocator::releaseThreadCache();
 	return 0;
 }
 
@@ -275,6 +277,7 @@ bool ThreadImpl::quitIsSignalled()
 void ThreadImpl::quit()
 {
 	getThread(this)->state = _ThreadImpl::Stopped;
+	TempAllocator::releaseThreadCache();
 	ExitThread(0);
 }
 
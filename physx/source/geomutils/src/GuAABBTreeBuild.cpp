@@ -32,7 +32,10 @@
 
 #include "PsMathUtils.h"
 #include "PsFoundation.h"
+#include "PsTime.h"
 #include "GuInternal.h"
+#include "GuParallelJobs.h"
+#include "task/PxCpuDispatcher.h"
 
 using namespace physx;
 using namespace Gu;
@@ -76,6 +79,33 @@ void NodeAllocator::init(PxU32 nbPrimitives, PxU32 limit)
 	mTotalNbNodes = 1;
 }
 
+// Starts an allocator for the nodes below an already allocated subtree root
+void NodeAllocator::initSubtree(PxU32 nbPrimitives, PxU32 limit)
+{
+	const PxU32 maxSize = nbPrimitives * 2 - 1;
+	const PxU32 estimatedFinalSize = PxMax(maxSize <= 1024 ? maxSize : maxSize / limit, PxU32(2));
+	mPool = PX_NEW(AABBTreeBuildNode)[estimatedFinalSize];
+	PxMemZero(mPool, sizeof(AABBTreeBuildNode)*estimatedFinalSize);
+
+	mSlabs.pushBack(Slab(mPool, 0, estimatedFinalSize));
+	mCurrentSlabIndex = 0;
+	mTotalNbNodes = 0;
+}
+
+// Takes over the slabs of a subtree allocator, the nodes keep their addresses
+void NodeAllocator::append(NodeAllocator& subtreeAllocator)
+{
+	const PxU32 nbSlabs = subtreeAllocator.mSlabs.size();
+	for(PxU32 i=0;i<nbSlabs;i++)
+		mSlabs.pushBack(subtreeAllocator.mSlabs[i]);
+	mTotalNbNodes += subtreeAllocator.mTotalNbNodes;
+
+	subtreeAllocator.mSlabs.reset();
+	subtreeAllocator.mPool = NULL;
+	subtreeAllocator.mCurrentSlabIndex = 0;
+	subtreeAllocator.mTotalNbNodes = 0;
+}
+
 // PT: TODO: inline this?
 AABBTreeBuildNode* NodeAllocator::getBiNode()
 {
@@ -142,6 +172,124 @@ static PxU32 split(const PxBounds3& box, PxU32 nb, PxU32* const PX_RESTRICT prim
 	return nbPos;
 }
 
+static PX_FORCE_INLINE float getHalfSurfaceArea(const Vec4V minV, const Vec4V maxV)
+{
+	PX_ALIGN(16, PxVec4) e;
+	V4StoreA(V4Sub(maxV, minV), &e.x);
+	return e.x*e.y + e.y*e.z + e.z*e.x;
+}
+
+// Binned SAH split, see Wald, "On fast Construction of SAH-based Bounding Volume Hierarchies". Returns the number of
+// primitives moved to the positive side, 0 if the centers cannot be told apart along any axis.
+static PxU32 splitSAH(PxU32 nb, PxU32* const PX_RESTRICT prims, const AABBTreeBuildParams& params, const Vec4V centersMinV, const Vec4V centersMaxV)
+{
+	const PxU32 NB_BINS = 16;
+
+	PX_ALIGN(16, PxVec4) centersMin;
+	PX_ALIGN(16, PxVec4) extents;
+	V4StoreA(centersMinV, &centersMin.x);
+	V4StoreA(V4Sub(centersMaxV, centersMinV), &extents.x);
+
+	float scales[3];
+	for(PxU32 axis=0;axis<3;axis++)
+	{
+		const float scale = extents[axis] > 0.0f ? float(NB_BINS) * 0.9999f / extents[axis] : 0.0f;
+		scales[axis] = PxIsFinite(scale) ? scale : 0.0f;
+	}
+	if(scales[0]==0.0f && scales[1]==0.0f && scales[2]==0.0f)
+		return 0;
+
+	PxU32 binCounts[3][NB_BINS];
+	Vec4V binMin[3][NB_BINS];
+	Vec4V binMax[3][NB_BINS];
+	const Vec4V emptyMinV = V4Load(PX_MAX_F32);
+	const Vec4V emptyMaxV = V4Load(-PX_MAX_F32);
+	for(PxU32 axis=0;axis<3;axis++)
+	{
+		for(PxU32 i=0;i<NB_BINS;i++)
+		{
+			binCounts[axis][i] = 0;
+			binMin[axis][i] = emptyMinV;
+			binMax[axis][i] = emptyMaxV;
+		}
+	}
+
+	const PxBounds3* PX_RESTRICT boxes = params.mAABBArray;
+	const PxVec3* PX_RESTRICT centers = params.mCache;
+	for(PxU32 i=0;i<nb;i++)
+	{
+		const PxU32 index = prims[i];
+		const Vec4V curMinV = V4LoadU(&boxes[index].minimum.x);
+		const Vec4V curMaxV = V4LoadU(&boxes[index].maximum.x);
+		for(PxU32 axis=0;axis<3;axis++)
+		{
+			const PxU32 bin = PxMin(PxU32((centers[index][axis] - centersMin[axis]) * scales[axis]), NB_BINS-1);
+			binCounts[axis][bin]++;
+			binMin[axis][bin] = V4Min(binMin[axis][bin], curMinV);
+			binMax[axis][bin] = V4Max(binMax[axis][bin], curMaxV);
+		}
+	}
+
+	// Sweep the bins from both sides, plane i separates bins [0, i] from bins [i+1, NB_BINS-1]
+	float bestCost = PX_MAX_F32;
+	PxU32 bestAxis = 0;
+	PxU32 bestPlane = 0;
+	for(PxU32 axis=0;axis<3;axis++)
+	{
+		if(scales[axis]==0.0f)
+			continue;
+
+		float rightCosts[NB_BINS];
+		PxU32 nbRight = 0;
+		Vec4V rightMinV = emptyMinV;
+		Vec4V rightMaxV = emptyMaxV;
+		for(PxU32 i=NB_BINS-1;i>0;i--)
+		{
+			nbRight += binCounts[axis][i];
+			rightMinV = V4Min(rightMinV, binMin[axis][i]);
+			rightMaxV = V4Max(rightMaxV, binMax[axis][i]);
+			rightCosts[i] = nbRight ? float(nbRight) * getHalfSurfaceArea(rightMinV, rightMaxV) : -1.0f;
+		}
+
+		PxU32 nbLeft = 0;
+		Vec4V leftMinV = emptyMinV;
+		Vec4V leftMaxV = emptyMaxV;
+		for(PxU32 i=0;i<NB_BINS-1;i++)
+		{
+			nbLeft += binCounts[axis][i];
+			leftMinV = V4Min(leftMinV, binMin[axis][i]);
+			leftMaxV = V4Max(leftMaxV, binMax[axis][i]);
+			if(!nbLeft || rightCosts[i+1]<0.0f)
+				continue;
+
+			const float cost = float(nbLeft) * getHalfSurfaceArea(leftMinV, leftMaxV) + rightCosts[i+1];
+			if(cost<bestCost)
+			{
+				bestCost = cost;
+				bestAxis = axis;
+				bestPlane = i;
+			}
+		}
+	}
+	if(bestCost==PX_MAX_F32)
+		return 0;
+
+	// Reorganize the list of indices in this order: positive - negative, positive being the bins up to the best plane
+	PxU32 nbPos = 0;
+	for(PxU32 i=0;i<nb;i++)
+	{
+		const PxU32 index = prims[i];
+		const PxU32 bin = PxMin(PxU32((centers[index][bestAxis] - centersMin[bestAxis]) * scales[bestAxis]), NB_BINS-1);
+		if(bin<=bestPlane)
+		{
+			prims[i] = prims[nbPos];
+			prims[nbPos] = index;
+			nbPos++;
+		}
+	}
+	return nbPos;
+}
+
 void AABBTreeBuildNode::subdivide(const AABBTreeBuildParams& params, BuildStats& stats, NodeAllocator& allocator, PxU32* const indices)
 {
 	PxU32* const PX_RESTRICT primitives = indices + mNodeIndex;
@@ -149,6 +297,7 @@ void AABBTreeBuildNode::subdivide(const AABBTreeBuildParams& params, BuildStats&
 
 	// Compute global box & means for current node. The box is stored in mBV.
 	Vec4V meansV;
+	Vec4V centersMinV, centersMaxV;
 	{
 		const PxBounds3* PX_RESTRICT boxes = params.mAABBArray;
 		PX_ASSERT(boxes);
@@ -159,13 +308,17 @@ void AABBTreeBuildNode::subdivide(const AABBTreeBuildParams& params, BuildStats&
 		Vec4V maxV = V4LoadU(&boxes[primitives[0]].maximum.x);
 
 		meansV = V4LoadU(&params.mCache[primitives[0]].x);
+		centersMinV = centersMaxV = meansV;
 
 		for (PxU32 i = 1; i<nbPrims; i++)
 		{
 			const PxU32 index = primitives[i];
 			const Vec4V curMinV = V4LoadU(&boxes[index].minimum.x);
 			const Vec4V curMaxV = V4LoadU(&boxes[index].maximum.x);
-			meansV = V4Add(meansV, V4LoadU(&params.mCache[index].x));
+			const Vec4V curCenterV = V4LoadU(&params.mCache[index].x);
+			meansV = V4Add(meansV, curCenterV);
+			centersMinV = V4Min(centersMinV, curCenterV);
+			centersMaxV = V4Max(centersMaxV, curCenterV);
 			minV = V4Min(minV, curMinV);
 			maxV = V4Max(maxV, curMaxV);
 		}
@@ -182,6 +335,15 @@ void AABBTreeBuildNode::subdivide(const AABBTreeBuildParams& params, BuildStats&
 
 	bool validSplit = true;
 	PxU32 nbPos;
+	if(params.mBuildStrategy == BVHBuildStrategy::eSAH)
+	{
+		nbPos = splitSAH(nbPrims, primitives, params, centersMinV, centersMaxV);
+
+		// Check split validity
+		if (!nbPos || nbPos == nbPrims)
+			validSplit = false;
+	}
+	else
 	{
 		// Compute variances
 		Vec4V varsV = V4Zero();
@@ -293,15 +455,161 @@ bool Gu::initAABBTreeBuild(AABBTreeBuildParams& params, NodeAllocator& nodeAlloc
 	return true;
 }
 
+namespace
+{
+	// Trees smaller than this are built on the calling thread
+	const PxU32 PARALLEL_BUILD_MIN_NB_PRIMITIVES = 4096;
+	// Nodes are split on the calling thread until there are this many subtrees per worker, or they get this small
+	const PxU32 PARALLEL_BUILD_NB_SUBTREES_PER_WORKER = 4;
+	const PxU32 PARALLEL_BUILD_MIN_SUBTREE_SIZE = 512;
+
+	// A subtree built by one thread, with its own node allocator and statistics
+	struct SubtreeJob
+	{
+		AABBTreeBuildNode*	mRoot;
+		NodeAllocator		mAllocator;
+		BuildStats			mStats;
+	};
+
+	struct ParallelBuildParams
+	{
+		AABBTreeBuildParams*	mParams;
+		PxU32*					mIndices;
+		SubtreeJob*				mJobs;
+	};
+}
+
+static void buildSubtreeJob(void* userData, PxU32 jobIndex)
+{
+	const ParallelBuildParams& buildParams = *reinterpret_cast<const ParallelBuildParams*>(userData);
+	AABBTreeBuildParams& params = *buildParams.mParams;
+	SubtreeJob& job = buildParams.mJobs[jobIndex];
+	job.mAllocator.initSubtree(job.mRoot->mNbPrimitives, params.mLimit);
+	job.mRoot->_buildHierarchy(params, job.mStats, job.mAllocator, buildParams.mIndices);
+}
+
+static void buildHierarchyParallel(AABBTreeBuildParams& params, NodeAllocator& nodeAllocator, BuildStats& stats, PxU32* indices, PxCpuDispatcher& dispatcher)
+{
+	// Split the top of the tree on the calling thread, always opening the largest pending node. The order
+	// in which the subtrees are listed only depends on the input, so the tree does not depend on the scheduling.
+	const PxU32 maxNbSubtrees = dispatcher.getWorkerCount() * PARALLEL_BUILD_NB_SUBTREES_PER_WORKER;
+	Ps::Array<AABBTreeBuildNode*> subtrees;
+	subtrees.pushBack(nodeAllocator.mPool);
+	while(subtrees.size() < maxNbSubtrees)
+	{
+		PxU32 largest = 0;
+		for(PxU32 i=1;i<subtrees.size();i++)
+		{
+			if(subtrees[i]->mNbPrimitives > subtrees[largest]->mNbPrimitives)
+				largest = i;
+		}
+
+		AABBTreeBuildNode* node = subtrees[largest];
+		if(node->mNbPrimitives < PARALLEL_BUILD_MIN_SUBTREE_SIZE)
+			break;
+
+		node->subdivide(params, stats, nodeAllocator, indices);
+		stats.mTotalPrims += node->mNbPrimitives;
+
+		if(node->isLeaf())
+		{
+			subtrees.replaceWithLast(largest);
+			if(!subtrees.size())
+				return;
+		}
+		else
+		{
+			AABBTreeBuildNode* pos = const_cast<AABBTreeBuildNode*>(node->getPos());
+			subtrees[largest] = pos;
+			subtrees.insert() = pos + 1;
+		}
+	}
+
+	const PxU32 nbJobs = subtrees.size();
+	SubtreeJob* jobs = PX_NEW(SubtreeJob)[nbJobs];
+	for(PxU32 i=0;i<nbJobs;i++)
+		jobs[i].mRoot = subtrees[i];
+
+	ParallelBuildParams buildParams;
+	buildParams.mParams		= &params;
+	buildParams.mIndices	= indices;
+	buildParams.mJobs		= jobs;
+	runParallelJobs(&dispatcher, nbJobs, buildSubtreeJob, &buildParams, "AABBTreeBuild.buildSubtrees");
+
+	for(PxU32 i=0;i<nbJobs;i++)
+	{
+		SubtreeJob& job = jobs[i];
+		nodeAllocator.append(job.mAllocator);
+		stats.increaseCount(job.mStats.getCount());
+		stats.mTotalPrims += job.mStats.mTotalPrims;
+	}
+	stats.mNbTasks = nbJobs;
+
+	PX_DELETE_ARRAY(jobs);
+}
+
 bool Gu::buildAABBTree(AABBTreeBuildParams& params, NodeAllocator& nodeAllocator, BuildStats& stats, PxU32*&  indices)
 {
+	Ps::Time timer;
+
 	// initialize the build first
 	if(!initAABBTreeBuild(params, nodeAllocator, stats, indices))
 		return false;
 
 	// Build the hierarchy
-	nodeAllocator.mPool->_buildHierarchy(params, stats, nodeAllocator, indices);
+	if(params.mDispatcher && params.mDispatcher->getWorkerCount() && params.mNbPrimitives >= PARALLEL_BUILD_MIN_NB_PRIMITIVES)
+		buildHierarchyParallel(params, nodeAllocator, stats, indices, *params.mDispatcher);
+	else
+		nodeAllocator.mPool->_buildHierarchy(params, stats, nodeAllocator, indices);
+
+	stats.mBuildTime = float(timer.getElapsedSeconds());
+
+	computeAABBTreeQuality(nodeAllocator, stats);
 
 	return true;
 }
 
+void Gu::computeAABBTreeQuality(const NodeAllocator& nodeAllocator, BuildStats& stats)
+{
+	stats.mNbLeaves = 0;
+	stats.mMaxDepth = 0;
+	stats.mSAHCost = 0.0f;
+
+	const AABBTreeBuildNode* root = nodeAllocator.mPool;
+	if(!root)
+		return;
+
+	// Expected cost of a query going through the tree, with unit costs for node visits and primitive tests. The probability
+	// of visiting a node is the ratio of its surface area to the root's.
+	const float rootArea = getHalfSurfaceArea(V4LoadU(&root->mBV.minimum.x), V4LoadU(&root->mBV.maximum.x));
+	const float coeff = rootArea > 0.0f ? 1.0f / rootArea : 0.0f;
+
+	Ps::Array<const AABBTreeBuildNode*> stack;
+	Ps::Array<PxU32> depths;
+	stack.pushBack(root);
+	depths.pushBack(0);
+	float cost = 0.0f;
+	while(stack.size())
+	{
+		const AABBTreeBuildNode* node = stack.popBack();
+		const PxU32 depth = depths.popBack();
+
+		const float area = getHalfSurfaceArea(V4LoadU(&node->mBV.minimum.x), V4LoadU(&node->mBV.maximum.x)) * coeff;
+		if(node->isLeaf())
+		{
+			cost += area * float(node->getNbPrimitives());
+			stats.mNbLeaves++;
+			stats.mMaxDepth = PxMax(stats.mMaxDepth, depth);
+		}
+		else
+		{
+			cost += area;
+			stack.pushBack(node->getPos());
+			stack.pushBack(node->getNeg());
+			depths.pushBack(depth + 1);
+			depths.pushBack(depth + 1);
+		}
+	}
+	stats.mSAHCost = cost;
+}
+
@@ -41,6 +41,7 @@
 
 namespace physx
 {
+	class PxCpuDispatcher;
 
 	using namespace shdfnd::aos;
 
@@ -53,26 +54,51 @@ namespace physx
 		//! Contains AABB-tree build statistics
 		struct PX_PHYSX_COMMON_API BuildStats
 		{
-			BuildStats() : mCount(0), mTotalPrims(0) {}
+			BuildStats() : mCount(0), mTotalPrims(0), mNbLeaves(0), mMaxDepth(0), mSAHCost(0.0f), mBuildTime(0.0f), mNbTasks(0) {}
 
 			PxU32	mCount;			//!< Number of nodes created
 			PxU32	mTotalPrims;	//!< Total accumulated number of primitives. Should be much higher than the source
 									//!< number of prims, since it accumulates all prims covered by each node (i.e. internal
 									//!< nodes too, not just leaf ones)
+			// Tree quality, see computeAABBTreeQuality()
+			PxU32	mNbLeaves;		//!< Number of leaf nodes
+			PxU32	mMaxDepth;		//!< Depth of the deepest leaf, the root being at depth 0
+			float	mSAHCost;		//!< Surface area heuristic cost of the tree, relative to the root's surface area
+			float	mBuildTime;		//!< Build time in seconds
+			PxU32	mNbTasks;		//!< Number of subtrees built in parallel, 0 for a serial build
 
-			PX_FORCE_INLINE	void	reset() { mCount = mTotalPrims = 0; }
+			PX_FORCE_INLINE	void	reset() { mCount = mTotalPrims = mNbLeaves = mMaxDepth = mNbTasks = 0; mSAHCost = mBuildTime = 0.0f; }
 
 			PX_FORCE_INLINE	void	setCount(PxU32 nb) { mCount = nb; }
 			PX_FORCE_INLINE	void	increaseCount(PxU32 nb) { mCount += nb; }
 			PX_FORCE_INLINE	PxU32	getCount()				const { return mCount; }
 		};
 
+		//! Contains AABB-tree traversal statistics, accumulated over the traversals they are passed to
+		struct TraversalStats
+		{
+			TraversalStats() : mNbVisitedNodes(0), mNbLeafTests(0) {}
+
+			PxU32	mNbVisitedNodes;	//!< Number of nodes whose bounds were tested against the query
+			PxU32	mNbLeafTests;		//!< Number of primitives of the leaves reached by the query
+		};
+
+		//! Strategy used to split the nodes of an AABB-tree
+		struct BVHBuildStrategy
+		{
+			enum Enum
+			{
+				eFAST,	//!< Splits the axis of greatest variance at the middle of the node's box
+				eSAH	//!< Binned surface area heuristic, slower to build but gives faster queries
+			};
+		};
+
 		//! Contains AABB-tree build parameters
 		class PX_PHYSX_COMMON_API AABBTreeBuildParams : public Ps::UserAllocated
 		{
 		public:
-			AABBTreeBuildParams(PxU32 limit = 1, PxU32 nb_prims = 0, const PxBounds3* boxes = NULL) :
-				mLimit(limit), mNbPrimitives(nb_prims), mAABBArray(boxes), mCache(NULL) {}
+			AABBTreeBuildParams(PxU32 limit = 1, PxU32 nb_prims = 0, const PxBounds3* boxes = NULL, BVHBuildStrategy::Enum strategy = BVHBuildStrategy::eSAH) :
+				mLimit(limit), mNbPrimitives(nb_prims), mAABBArray(boxes), mCache(NULL), mBuildStrategy(strategy), mDispatcher(NULL) {}
 			~AABBTreeBuildParams()
 			{
 				reset();
@@ -89,6 +115,8 @@ namespace physx
 			PxU32			mNbPrimitives;	//!< Number of (source) primitives.
 			const	PxBounds3*		mAABBArray;		//!< Shortcut to an app-controlled array of AABBs.
 			PxVec3*			mCache;			//!< Cache for AABB centers - managed by build code.
+			BVHBuildStrategy::Enum	mBuildStrategy;	//!< Node splitting strategy
+			PxCpuDispatcher*		mDispatcher;	//!< Optional dispatcher building the subtrees of large trees in parallel (buildAABBTree() only)
 		};
 
 		class NodeAllocator;
@@ -139,6 +167,8 @@ namespace physx
 
 			void						release();
 			void						init(PxU32 nbPrimitives, PxU32 limit);
+			void						initSubtree(PxU32 nbPrimitives, PxU32 limit);
+			void						append(NodeAllocator& subtreeAllocator);
 			AABBTreeBuildNode*			getBiNode();
 
 			AABBTreeBuildNode*			mPool;
@@ -174,6 +204,13 @@ namespace physx
 		*	\param		indices				[out]	Indices buffer allocated during build
 		*/
 		bool PX_PHYSX_COMMON_API		buildAABBTree(AABBTreeBuildParams& params, NodeAllocator& nodeAllocator, BuildStats& stats, PxU32*&  indices);
+
+		/* 
+		*	\brief		Computes the quality statistics of a built AABBtree.
+		*	\param		nodeAllocator		[in]	Node allocator holding the build nodes, the root being the first node
+		*	\param		stats				[out]	Statistics, the number of leaves, max depth and SAH cost are updated
+		*/
+		void PX_PHYSX_COMMON_API		computeAABBTreeQuality(const NodeAllocator& nodeAllocator, BuildStats& stats);
 #if PX_VC 
      #pragma warning(pop) 
 #endif
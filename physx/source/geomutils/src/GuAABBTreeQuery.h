@@ -32,7 +32,9 @@
 #define GU_AABBTREEQUERY_H
 
 #include "GuBVHTestsSIMD.h"
+#include "GuAABBTreeBuild.h"
 #include "PsInlineArray.h"
+#include "PsBitUtils.h"
 
 namespace physx
 {
@@ -55,14 +57,39 @@ namespace physx
 
 		//////////////////////////////////////////////////////////////////////////
 
+		// PT: counts in locals and adds to the optional stats when the traversal returns, whatever the exit point
+		class TraversalCounter
+		{
+		public:
+			PX_FORCE_INLINE	TraversalCounter(TraversalStats* stats) : mStats(stats), mNbVisitedNodes(0), mNbLeafTests(0)	{}
+			PX_FORCE_INLINE	~TraversalCounter()
+			{
+				if(mStats)
+				{
+					mStats->mNbVisitedNodes += mNbVisitedNodes;
+					mStats->mNbLeafTests += mNbLeafTests;
+				}
+			}
+
+			TraversalStats*	mStats;
+			PxU32			mNbVisitedNodes;
+			PxU32			mNbLeafTests;
+		private:
+			TraversalCounter& operator=(const TraversalCounter&);
+		};
+
+		//////////////////////////////////////////////////////////////////////////
+
 		template<typename Test, typename Tree, typename Node, typename Payload, typename QueryCallback>
 		class AABBTreeOverlap
 		{
 		public:
-			bool operator()(const Payload* objects, const PxBounds3* boxes, const Tree& tree, const Test& test, QueryCallback& visitor)
+			bool operator()(const Payload* objects, const PxBounds3* boxes, const Tree& tree, const Test& test, QueryCallback& visitor, TraversalStats* stats = NULL)
 			{
 				using namespace Cm;
 
+				TraversalCounter counter(stats);
+
 				Ps::InlineArray<const Node*, RAW_TRAVERSAL_STACK_SIZE> stack;
 				stack.forceSize_Unsafe(RAW_TRAVERSAL_STACK_SIZE);
 				const Node* const nodeBase = tree.getNodes();
@@ -74,11 +101,13 @@ namespace physx
 					const Node* node = stack[--stackIndex];
 					Vec3V center, extents;
 					node->getAABBCenterExtentsV(&center, &extents);
+					counter.mNbVisitedNodes++;
 					while (test(center, extents))
 					{
 						if (node->isLeaf())
 						{
 							PxU32 nbPrims = node->getNbPrimitives();
+							counter.mNbLeafTests += nbPrims;
 							const bool doBoxTest = nbPrims > 1;
 							const PxU32* prims = node->getPrimitives(tree.getIndices());
 							while (nbPrims--)
@@ -116,6 +145,7 @@ namespace physx
 						if(stackIndex == stack.capacity())
 							stack.resizeUninitialized(stack.capacity() * 2);
 						node->getAABBCenterExtentsV(&center, &extents);
+						counter.mNbVisitedNodes++;
 					}
 				}
 				return true;
@@ -168,10 +198,12 @@ namespace physx
 			bool operator()(
 				const Payload* objects, const PxBounds3* boxes, const Tree& tree,
 				const PxVec3& origin, const PxVec3& unitDir, PxReal& maxDist, const PxVec3& inflation,
-				QueryCallback& pcb)
+				QueryCallback& pcb, TraversalStats* stats = NULL)
 			{
 				using namespace Cm;
 
+				TraversalCounter counter(stats);
+
 				// PT: we will pass center*2 and extents*2 to the ray-box code, to save some work per-box
 				// So we initialize the test with values multiplied by 2 as well, to get correct results
 				Gu::RayAABBTest test(origin*2.0f, unitDir*2.0f, maxDist, inflation*2.0f);
@@ -188,12 +220,14 @@ namespace physx
 					const Node* node = stack[stackIndex];
 					Vec3V center, extents;
 					node->getAABBCenterExtentsV2(&center, &extents);
+					counter.mNbVisitedNodes++;
 					if (test.check<tInflate>(center, extents))	// TODO: try timestamp ray shortening to skip this
 					{
 						PxReal md = maxDist; // has to be before the goto below to avoid compile error
 						while (!node->isLeaf())
 						{
 							const Node* children = node->getPos(nodeBase);
+							counter.mNbVisitedNodes += 2;
 
 							Vec3V c0, e0;
 							children[0].getAABBCenterExtentsV2(&c0, &e0);
@@ -221,6 +255,7 @@ namespace physx
 						}
 
 						oldMaxDist = maxDist; // we copy since maxDist can be updated in the callback and md<maxDist test below can fail
+						counter.mNbLeafTests += node->getNbPrimitives();
 
 						if (!doLeafTest<tInflate, Tree, Node>(node, test, md, oldMaxDist,
 							objects, boxes, tree,
@@ -233,6 +268,153 @@ namespace physx
 				return true;
 			}
 		};
+
+		//////////////////////////////////////////////////////////////////////////
+
+		// PT: packet version of AABBTreeRaycast<false>, for up to 4 rays. Each node is tested against all the rays of the packet at once,
+		// using SIMD slab tests with the rays in SoA layout. The traversal order is driven by the sum of the rays' directions, so it
+		// is only efficient for coherent rays. The hits are reported per ray. Inactive rays use a negative max distance, which makes
+		// them miss all the boxes.
+		template <typename Tree, typename Node, typename Payload, typename Packet, typename QueryCallback>
+		class AABBTreeRaycastPacket
+		{
+		public:
+			void operator()(const Payload* objects, const PxBounds3* boxes, const Tree& tree, Packet& packet, QueryCallback& pcb, TraversalStats* stats = NULL)
+			{
+				TraversalCounter counter(stats);
+
+				PX_ALIGN(16, PxReal originX[4]);	PX_ALIGN(16, PxReal originY[4]);	PX_ALIGN(16, PxReal originZ[4]);
+				PX_ALIGN(16, PxReal invDirX[4]);	PX_ALIGN(16, PxReal invDirY[4]);	PX_ALIGN(16, PxReal invDirZ[4]);
+				PX_ALIGN(16, PxReal maxDist[4]);
+
+				PxVec3 dirSum(0.0f);
+				for(PxU32 i=0;i<4;i++)
+				{
+					const bool active = i<packet.mNbRays && (packet.mActiveMask & (1<<i));
+					const PxU32 j = i<packet.mNbRays ? i : 0;
+					const PxVec3& origin = packet.mOrigins[j];
+					const PxVec3& dir = packet.mUnitDirs[j];
+					originX[i] = origin.x;
+					originY[i] = origin.y;
+					originZ[i] = origin.z;
+					// null direction components are clamped to a tiny value with the proper sign, to avoid NaNs in the slab tests
+					const PxReal eps = 1e-9f;
+					invDirX[i] = 1.0f / (PxAbs(dir.x)>eps ? dir.x : (dir.x<0.0f ? -eps : eps));
+					invDirY[i] = 1.0f / (PxAbs(dir.y)>eps ? dir.y : (dir.y<0.0f ? -eps : eps));
+					invDirZ[i] = 1.0f / (PxAbs(dir.z)>eps ? dir.z : (dir.z<0.0f ? -eps : eps));
+					maxDist[i] = active ? packet.mDistances[i] : -1.0f;
+					if(active)
+						dirSum += dir;
+				}
+
+				const Vec4V oX = V4LoadA(originX), oY = V4LoadA(originY), oZ = V4LoadA(originZ);
+				const Vec4V invX = V4LoadA(invDirX), invY = V4LoadA(invDirY), invZ = V4LoadA(invDirZ);
+				const Vec3V dirSumV = V3LoadU(dirSum);
+				Vec4V maxDistV = V4LoadA(maxDist);
+
+				PxU32 activeMask = 0;
+				for(PxU32 i=0;i<packet.mNbRays;i++)
+					activeMask |= packet.mActiveMask & (1<<i);
+
+				Ps::InlineArray<const Node*, RAW_TRAVERSAL_STACK_SIZE> stack;
+				stack.forceSize_Unsafe(RAW_TRAVERSAL_STACK_SIZE);
+				const Node* const nodeBase = tree.getNodes();
+				stack[0] = nodeBase;
+				PxU32 stackIndex = 1;
+
+				while(activeMask && stackIndex--)
+				{
+					const Node* node = stack[stackIndex];
+					counter.mNbVisitedNodes++;
+					if(!test(node->mBV, oX, oY, oZ, invX, invY, invZ, maxDistV))
+						continue;
+
+					while(!node->isLeaf())
+					{
+						const Node* children = node->getPos(nodeBase);
+						counter.mNbVisitedNodes += 2;
+
+						const PxU32 b0 = test(children[0].mBV, oX, oY, oZ, invX, invY, invZ, maxDistV);
+						const PxU32 b1 = test(children[1].mBV, oX, oY, oZ, invX, invY, invZ, maxDistV);
+
+						if(b0 && b1)	// if both intersect, push the one with the further center on the stack for later
+						{
+							Vec3V c0, e0, c1, e1;
+							children[0].getAABBCenterExtentsV2(&c0, &e0);
+							children[1].getAABBCenterExtentsV2(&c1, &e1);
+							// & 1 because FAllGrtr behavior differs across platforms
+							const PxU32 bit = FAllGrtr(V3Dot(V3Sub(c1, c0), dirSumV), FZero()) & 1;
+							stack[stackIndex++] = children + bit;
+							node = children + (1 - bit);
+							if(stackIndex == stack.capacity())
+								stack.resizeUninitialized(stack.capacity() * 2);
+						}
+						else if(b0)
+							node = children;
+						else if(b1)
+							node = children + 1;
+						else
+							goto skip_leaf_code;
+					}
+
+					{
+						PxU32 nbPrims = node->getNbPrimitives();
+						const PxU32* prims = node->getPrimitives(tree.getIndices());
+						while(nbPrims--)
+						{
+							const PxU32 poolIndex = *prims++;
+							counter.mNbLeafTests++;
+
+							PxU32 hitMask = test(boxes[poolIndex], oX, oY, oZ, invX, invY, invZ, maxDistV);
+							if(!hitMask)
+								continue;
+
+							do
+							{
+								const PxU32 rayIndex = Ps::lowestSetBit(hitMask);
+								hitMask &= hitMask - 1;
+
+								PxReal md = maxDist[rayIndex];
+								if(!pcb.invoke(rayIndex, md, objects[poolIndex]))
+								{
+									activeMask &= ~(1<<rayIndex);
+									maxDist[rayIndex] = -1.0f;
+								}
+								else if(md < maxDist[rayIndex])
+								{
+									maxDist[rayIndex] = md;
+									packet.mDistances[rayIndex] = md;
+								}
+							} while(hitMask);
+
+							maxDistV = V4LoadA(maxDist);
+							if(!activeMask)
+								break;
+						}
+					}
+				skip_leaf_code:;
+				}
+
+				packet.mActiveMask = activeMask;
+			}
+
+		private:
+			// returns a bit mask of the rays hitting the box
+			static PX_FORCE_INLINE PxU32 test(const PxBounds3& box, const Vec4V oX, const Vec4V oY, const Vec4V oZ,
+												const Vec4V invX, const Vec4V invY, const Vec4V invZ, const Vec4V maxDistV)
+			{
+				const Vec4V t0X = V4Mul(V4Sub(V4Load(box.minimum.x), oX), invX);
+				const Vec4V t1X = V4Mul(V4Sub(V4Load(box.maximum.x), oX), invX);
+				const Vec4V t0Y = V4Mul(V4Sub(V4Load(box.minimum.y), oY), invY);
+				const Vec4V t1Y = V4Mul(V4Sub(V4Load(box.maximum.y), oY), invY);
+				const Vec4V t0Z = V4Mul(V4Sub(V4Load(box.minimum.z), oZ), invZ);
+				const Vec4V t1Z = V4Mul(V4Sub(V4Load(box.maximum.z), oZ), invZ);
+
+				const Vec4V tNear = V4Max(V4Max(V4Min(t0X, t1X), V4Min(t0Y, t1Y)), V4Max(V4Min(t0Z, t1Z), V4Zero()));
+				const Vec4V tFar = V4Min(V4Min(V4Max(t0X, t1X), V4Max(t0Y, t1Y)), V4Min(V4Max(t0Z, t1Z), maxDistV));
+				return BGetBitMask(V4IsGrtrOrEq(tFar, tNear));
+			}
+		};
 	}
 }
 
@@ -0,0 +1,162 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "GuParallelJobs.h"
+#include "foundation/PxMath.h"
+#include "PsUserAllocated.h"
+#include "PsAtomic.h"
+#include "PsFPU.h"
+#include "PsSync.h"
+#include "task/PxTask.h"
+#include "task/PxCpuDispatcher.h"
+
+using namespace physx;
+using namespace Gu;
+
+namespace
+{
+	class ParallelJobsContext;
+
+	class ParallelJobsTask : public PxBaseTask
+	{
+	public:
+									ParallelJobsTask() : mContext(NULL)	{}
+
+		virtual void				run();
+		virtual const char*			getName() const;
+		virtual void				addReference()			{}
+		virtual void				removeReference()		{}
+		virtual int32_t				getReference() const	{ return 1;	}
+		virtual void				release();
+
+				ParallelJobsContext*	mContext;
+	};
+
+	// Shared by the calling thread and the tasks. Each of them holds a reference: a task may only start running after
+	// the calling thread is done, in which case it finds no job left and deletes the context if it is the last one.
+	class ParallelJobsContext : public Ps::UserAllocated
+	{
+	public:
+		ParallelJobsContext(PxU32 nbJobs, PxU32 nbTasks, ParallelJobFunc func, void* userData, const char* name) :
+			mFunc		(func),
+			mUserData	(userData),
+			mName		(name),
+			mNbJobs		(nbJobs),
+			mNextJob	(0),
+			mNbJobsLeft	(PxI32(nbJobs)),
+			mRefCount	(PxI32(nbTasks + 1))
+		{
+			mTasks = PX_NEW(ParallelJobsTask)[nbTasks];
+			for(PxU32 i=0;i<nbTasks;i++)
+				mTasks[i].mContext = this;
+		}
+
+		~ParallelJobsContext()
+		{
+			PX_DELETE_ARRAY(mTasks);
+		}
+
+		void runJobs()
+		{
+			PX_SIMD_GUARD;
+
+			for(;;)
+			{
+				const PxU32 jobIndex = PxU32(Ps::atomicIncrement(&mNextJob) - 1);
+				if(jobIndex >= mNbJobs)
+					break;
+
+				(mFunc)(mUserData, jobIndex);
+
+				if(Ps::atomicDecrement(&mNbJobsLeft) == 0)
+					mDone.set();
+			}
+		}
+
+		void releaseReference()
+		{
+			if(Ps::atomicDecrement(&mRefCount) == 0)
+				PX_DELETE(this);
+		}
+
+		const ParallelJobFunc	mFunc;
+		void* const				mUserData;
+		const char* const		mName;
+		ParallelJobsTask*		mTasks;
+		const PxU32				mNbJobs;
+		volatile PxI32			mNextJob;
+		volatile PxI32			mNbJobsLeft;
+		volatile PxI32			mRefCount;
+		Ps::Sync				mDone;
+	private:
+		ParallelJobsContext& operator=(const ParallelJobsContext&);
+	};
+
+	void ParallelJobsTask::run()
+	{
+		mContext->runJobs();
+	}
+
+	const char* ParallelJobsTask::getName() const
+	{
+		return mContext->mName;
+	}
+
+	void ParallelJobsTask::release()
+	{
+		mContext->releaseReference();
+	}
+}
+
+PxU32 Gu::getNbParallelThreads(const PxCpuDispatcher* dispatcher)
+{
+	return dispatcher ? dispatcher->getWorkerCount() + 1 : 1;
+}
+
+void Gu::runParallelJobs(PxCpuDispatcher* dispatcher, PxU32 nbJobs, ParallelJobFunc func, void* userData, const char* name)
+{
+	const PxU32 nbTasks = nbJobs ? PxMin(getNbParallelThreads(dispatcher) - 1, nbJobs - 1) : 0;
+	if(!nbTasks)
+	{
+		for(PxU32 i=0;i<nbJobs;i++)
+			(func)(userData, i);
+		return;
+	}
+
+	ParallelJobsContext* context = PX_NEW(ParallelJobsContext)(nbJobs, nbTasks, func, userData, name);
+
+	for(PxU32 i=0;i<nbTasks;i++)
+		dispatcher->submitTask(context->mTasks[i]);
+
+	// The calling thread runs jobs too, then only waits for the ones that other threads have started
+	context->runJobs();
+	context->mDone.wait();
+
+	context->releaseReference();
+}
@@ -0,0 +1,56 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef GU_PARALLEL_JOBS_H
+#define GU_PARALLEL_JOBS_H
+
+#include "common/PxPhysXCommonConfig.h"
+#include "CmPhysXCommon.h"
+
+namespace physx
+{
+	class PxCpuDispatcher;
+
+namespace Gu
+{
+	typedef void (*ParallelJobFunc)(void* userData, PxU32 jobIndex);
+
+	// Runs 'nbJobs' calls to 'func' on the calling thread and on the dispatcher's worker threads, and returns when all of them
+	// are done. The jobs are picked in order by whichever thread is available, so they must be independent. Without a dispatcher
+	// or worker threads, everything runs on the calling thread.
+	void PX_PHYSX_COMMON_API runParallelJobs(PxCpuDispatcher* dispatcher, PxU32 nbJobs, ParallelJobFunc func, void* userData, const char* name);
+
+	// Returns the number of threads runParallelJobs() can use, including the calling thread
+	PxU32 PX_PHYSX_COMMON_API getNbParallelThreads(const PxCpuDispatcher* dispatcher);
+
+} // namespace Gu
+
+}
+
+#endif // GU_PARALLEL_JOBS_H
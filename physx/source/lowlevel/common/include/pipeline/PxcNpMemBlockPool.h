@@ -105,6 +105,7 @@ private:
 	PxU32					mMaxUsedBlocks;
 	PxcNpMemBlock*			mScratchBlockAddr;
 	PxU32					mNbScratchBlocks;
+	PxU32					mMinNbFreeScratchBlocks;
 	PxcScratchAllocator&	mScratchAllocator;
 
 	PxU32					mPeakConstraintAllocations;
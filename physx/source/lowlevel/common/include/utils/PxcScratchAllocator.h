@@ -32,6 +32,7 @@
 #define PXC_SCRATCHALLOCATOR_H
 
 #include "foundation/PxAssert.h"
+#include "foundation/PxMath.h"
 #include "PxvConfig.h"
 #include "PsMutex.h"
 #include "PsArray.h"
@@ -43,7 +44,8 @@ class PxcScratchAllocator
 {
 	PX_NOCOPY(PxcScratchAllocator)
 public:
-	PxcScratchAllocator() : mStack(PX_DEBUG_EXP("PxcScratchAllocator")), mStart(NULL), mSize(0)
+	PxcScratchAllocator() : mStack(PX_DEBUG_EXP("PxcScratchAllocator")), mStart(NULL), mSize(0), mLowestAddr(NULL),
+		mPeakUsage(0), mNbHeapFallbacks(0), mHeapFallbackBytes(0)
 	{
 		mStack.reserve(64);
 		mStack.pushBack(0);
@@ -58,9 +60,15 @@ public:
 		PX_ASSERT(mStack.size()==1);
 		mStack.popBack();
 
+		mPeakUsage = PxMax(mPeakUsage, getUsage());
+
 		mStart = reinterpret_cast<PxU8*>(addr);
 		mSize = size;
 		mStack.pushBack(mStart + size);
+
+		mLowestAddr = mStart + size;
+		mNbHeapFallbacks = 0;
+		mHeapFallbackBytes = 0;
 	}
 
 	void* allocAll(PxU32& size)
@@ -72,10 +80,22 @@ public:
 		if(size==0)
 			return NULL;
 
+		// the caller reports how much of it it really used, see recordAllocAllUsage()
 		mStack.pushBack(mStart);
 		return mStart;
 	}
 
+	// Records the lowest address really used in the block returned by allocAll()
+	void recordAllocAllUsage(void* lowestUsedAddr)
+	{
+		PX_ASSERT(isScratchAddr(lowestUsedAddr));
+		PxU8* addr = reinterpret_cast<PxU8*>(lowestUsedAddr);
+
+		Ps::Mutex::ScopedLock lock(mLock);
+		if(addr < mLowestAddr)
+			mLowestAddr = addr;
+	}
+
 
 	void* alloc(PxU32 requestedSize, bool fallBackToHeap = false)
 	{
@@ -90,12 +110,16 @@ public:
 		{
 			PxU8* addr = top - requestedSize;
 			mStack.pushBack(addr);
+			if(addr < mLowestAddr)
+				mLowestAddr = addr;
 			return addr;
 		}
 
 		if(!fallBackToHeap)
 			return NULL;
 
+		mNbHeapFallbacks++;
+		mHeapFallbackBytes += requestedSize;
 		return PX_ALLOC(requestedSize, "Scratch Block Fallback");
 	}
 
@@ -126,11 +150,27 @@ public:
 		return a>= mStart && a<mStart+mSize;
 	}
 
+	PxU32 getSize()				const	{ return mSize;								}
+
+	// Peak number of bytes used from the current block
+	PxU32 getUsage()			const	{ return mStart ? PxU32(mStart + mSize - mLowestAddr) : 0;	}
+
+	// Peak number of bytes used from all blocks so far
+	PxU32 getPeakUsage()		const	{ return PxMax(mPeakUsage, getUsage());		}
+
+	PxU32 getNbHeapFallbacks()	const	{ return mNbHeapFallbacks;					}
+	PxU32 getHeapFallbackBytes()	const	{ return mHeapFallbackBytes;				}
+
 private:
 	Ps::Mutex			mLock;
 	Ps::Array<PxU8*>	mStack;
 	PxU8*				mStart;
 	PxU32				mSize;
+
+	PxU8*				mLowestAddr;		// lowest address allocated from the current block
+	PxU32				mPeakUsage;
+	PxU32				mNbHeapFallbacks;
+	PxU32				mHeapFallbackBytes;
 };
 
 }
@@ -49,6 +49,7 @@ PxcNpMemBlockPool::PxcNpMemBlockPool(PxcScratchAllocator& allocator):
   mMaxUsedBlocks(0),
   mScratchBlockAddr(0),
   mNbScratchBlocks(0),
+  mMinNbFreeScratchBlocks(0),
   mScratchAllocator(allocator),
   mPeakConstraintAllocations(0),
   mConstraintAllocations(0)  
@@ -139,6 +140,7 @@ void PxcNpMemBlockPool::acquireConstraintMemory()
 	PX_ASSERT(mScratchBlocks.size()==0);
 	mScratchBlockAddr = reinterpret_cast<PxcNpMemBlock*>(addr);
 	mNbScratchBlocks =  size/PxcNpMemBlock::SIZE;
+	mMinNbFreeScratchBlocks = mNbScratchBlocks;
 
 	mScratchBlocks.resize(mNbScratchBlocks);
 	for(PxU32 i=0;i<mNbScratchBlocks;i++)
@@ -173,6 +175,10 @@ void PxcNpMemBlockPool::releaseConstraintMemory()
 
 	if(mScratchBlockAddr)
 	{
+		// blocks are handed out from the end of the scratch memory
+		if(mMinNbFreeScratchBlocks < mNbScratchBlocks)
+			mScratchAllocator.recordAllocAllUsage(mScratchBlockAddr + mMinNbFreeScratchBlocks);
+
 		mScratchAllocator.free(mScratchBlockAddr);
 		mScratchBlockAddr = 0;
 		mNbScratchBlocks = 0;
@@ -196,6 +202,7 @@ PxcNpMemBlock* PxcNpMemBlockPool::acquire(PxcNpMemBlockArray& trackingArray, PxU
 	if(isScratchAllocation && mScratchBlocks.size()>0)
 	{
 		PxcNpMemBlock* block = mScratchBlocks.popBack();
+		mMinNbFreeScratchBlocks = PxMin(mMinNbFreeScratchBlocks, mScratchBlocks.size());
 		trackingArray.pushBack(block);
 		return block;
 	}
@@ -444,8 +444,6 @@
 			void putBpCacheData(BpCacheData*);
 			void resetBpCacheData();
 
-			Ps::Mutex					mMapLock;
-
 		private:
 			void reserveShapeSpace(PxU32 nbShapes);
 
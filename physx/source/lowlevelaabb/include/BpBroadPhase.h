@@ -68,6 +68,18 @@ class BroadPhaseBase
 		return true;
 	}
 
+	/**
+	\brief Gets the state of the hash table storing the broad-phase pairs.
+
+	\param[out]	stats	Pair statistics
+	\return True if success, false if the broad-phase does not track its pairs in a hash table
+	*/
+	virtual	bool					getPairStatistics(PxBroadPhasePairStatistics& stats)	const
+	{
+		PX_UNUSED(stats);
+		return false;
+	}
+
 	/**
 	\brief Returns number of regions currently registered in the broad-phase.
 
@@ -210,6 +222,7 @@ public:
 	\param[in] maxNbStaticShapes is the expected maximum number of static shapes.
 	\param[in] maxNbDynamicShapes is the expected maximum number of dynamic shapes.
 	\param[in] contextID is the context ID parameter sent to the profiler
+	\param[in] persistentPairs keeps the pair storage at its peak size, see PxSceneFlag::eENABLE_PERSISTENT_BROADPHASE_PAIRS.
 	\return The instantiated BroadPhase.
 	\note maxNbRegions is only used if mbp is the chosen broadphase (PxBroadPhaseType::eMBP)
 	\note maxNbRegions, maxNbBroadPhaseOverlaps, maxNbStaticShapes and maxNbDynamicShapes are typically specified in PxSceneLimits
@@ -220,7 +233,20 @@ public:
 		const PxU32 maxNbBroadPhaseOverlaps,
 		const PxU32 maxNbStaticShapes,
 		const PxU32 maxNbDynamicShapes,
-		PxU64 contextID);
+		PxU64 contextID,
+		bool persistentPairs);
+
+	/**
+	\brief Selects the box pruning kernels used by MBP and ABP, see PxSetBroadPhaseKernel.
+	\param[in] kernel - the desired kernel.
+	\return The selected kernel.
+	*/
+	static	PxBroadPhaseKernel::Enum	setKernel(PxBroadPhaseKernel::Enum kernel);
+
+	/**
+	\brief Returns the box pruning kernels used by MBP and ABP.
+	*/
+	static	PxBroadPhaseKernel::Enum	getKernel();
 
 
 	/**
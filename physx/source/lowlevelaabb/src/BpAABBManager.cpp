@@ -212,6 +212,9 @@ class PersistentPairs : public Ps::UserAllocated
 #endif
 												Ps::Array<VolumeData>& volumeData, Ps::Array<AABBOverlap>* createdOverlaps, Ps::Array<AABBOverlap>* destroyedOverlaps);
 					void			outputDeletedOverlaps(Ps::Array<AABBOverlap>* overlaps, const Ps::Array<VolumeData>& volumeData);
+
+	// PT: pairs created by the broadphase are only inserted in the pair maps, their overlaps are found by their first update()
+	PX_FORCE_INLINE	bool			isNew()	const	{ return mTimestamp==PX_INVALID_U32;	}
 	private:
 	virtual			void			findOverlaps(PairArray& pairs, const PxBounds3* PX_RESTRICT bounds, const float* PX_RESTRICT contactDistances, const Bp::FilterGroup::Enum* PX_RESTRICT groups
 #ifdef BP_FILTERING_USES_TYPE_IN_GROUP
@@ -778,7 +781,7 @@ bool PersistentActorAggregatePair::update(AABBManager& manager, BpCacheData* dat
 	if(!mAggregate->getNbAggregated())	// PT: needed with lazy empty actors
 		return true;
 
-	if(mAggregate->isDirty() || manager.mChangedHandleMap.boundedTest(mActorHandle))
+	if(isNew() || mAggregate->isDirty() || manager.mChangedHandleMap.boundedTest(mActorHandle))
 		manager.updatePairs(*this, data);
 
 	return false;
@@ -832,7 +835,7 @@ bool PersistentAggregateAggregatePair::update(AABBManager& manager, BpCacheData*
 	if(!mAggregate0->getNbAggregated() || !mAggregate1->getNbAggregated())	// PT: needed with lazy empty actors
 		return true;
 
-	if(mAggregate0->isDirty() || mAggregate1->isDirty())
+	if(isNew() || mAggregate0->isDirty() || mAggregate1->isDirty())
 		manager.updatePairs(*this, data);
 
 	return false;
@@ -1882,7 +1885,6 @@ void AABBManager::processBPCreatedPair(const BroadPhasePair& pair)
 	bool status = pairMap->insert(AggPair(volA, volB), newPair);
 	PX_UNUSED(status);
 	PX_ASSERT(status);
-	updatePairs(*newPair);
 }
 
 void AABBManager::processBPDeletedPair(const BroadPhasePair& pair)
@@ -1998,8 +2000,27 @@ public:
 	PairData mCreatedPairs[2];
 	PairData mDestroyedPairs[2];
 
-	ProcessAggPairsBase(PxU64 contextID) : Cm::Task(contextID)
+	// PT: entries to remove from mMap. The map is compacting, i.e. erasing an entry changes the iteration order of the
+	// remaining ones, so the tasks don't erase them directly. They are erased afterwards in task order, which keeps the
+	// order of the pairs deterministic from one frame to the next.
+	AggPairMap* mMap;
+	AggPair mRemovedEntries[MaxPairs];
+	PxU32 mNbRemovedEntries;
+
+	ProcessAggPairsBase(PxU64 contextID, AggPairMap* map = NULL) : Cm::Task(contextID),
+		mMap(map), mNbRemovedEntries(0)
+	{
+	}
+
+	void eraseRemovedEntries()
 	{
+		for (PxU32 i = 0; i < mNbRemovedEntries; i++)
+		{
+			bool status = mMap->erase(mRemovedEntries[i]);
+			PX_ASSERT(status);
+			PX_UNUSED(status);
+		}
+		mNbRemovedEntries = 0;
 	}
 
 	void setCache(BpCacheData& data)
@@ -2031,12 +2052,10 @@ public:
 	Bp::AggPair mAggPairs[MaxPairs];
 	PxU32 mNbPairs;
 	AABBManager* mManager;
-	AggPairMap* mMap;
-	Ps::Mutex* mMutex;
 	const char* mName;
 
-	ProcessAggPairsParallelTask(PxU64 contextID, Ps::Mutex* mutex, AABBManager* manager, AggPairMap* map, const char* name) : ProcessAggPairsBase(contextID),
-		mNbPairs(0), mManager(manager), mMap(map), mMutex(mutex), mName(name)
+	ProcessAggPairsParallelTask(PxU64 contextID, AABBManager* manager, AggPairMap* map, const char* name) : ProcessAggPairsBase(contextID, map),
+		mNbPairs(0), mManager(manager), mName(name)
 	{
 	}
 
@@ -2047,13 +2066,11 @@ public:
 
 		setCache(*data);
 
-
-		Ps::InlineArray<AggPair, MaxPairs> removedEntries;
 		for (PxU32 i = 0; i < mNbPairs; ++i)
 		{
 			if (mPersistentPairs[i]->update(*mManager, data))
 			{
-				removedEntries.pushBack(mAggPairs[i]);
+				mRemovedEntries[mNbRemovedEntries++] = mAggPairs[i];
 				PX_DELETE(mPersistentPairs[i]);
 			}
 		}
@@ -2061,20 +2078,6 @@ public:
 		updateCounters();
 
 		mManager->putBpCacheData(data);
-
-
-		if (removedEntries.size())
-		{
-			Ps::Mutex::ScopedLock lock(*mMutex);
-			for (PxU32 i = 0; i < removedEntries.size(); i++)
-			{
-				bool status = mMap->erase(removedEntries[i]);
-				PX_ASSERT(status);
-				PX_UNUSED(status);
-			}
-		}
-
-
 	}
 
 	virtual const char* getName() const { return mName; }
@@ -2153,9 +2156,9 @@ static void processAggregatePairsParallel(AggPairMap& map, AABBManager& manager,
 
 	// PT: TODO: replace with decent hash map - or remove the hashmap entirely and use a linear array
 
-	manager.mMapLock.lock();
+	const PxU64 contextID = manager.getContextId();
 
-	ProcessAggPairsParallelTask* task = PX_PLACEMENT_NEW(flushPool.allocate(sizeof(ProcessAggPairsParallelTask)), ProcessAggPairsParallelTask)(0, &manager.mMapLock, &manager, &map, taskName);
+	ProcessAggPairsParallelTask* task = PX_PLACEMENT_NEW(flushPool.allocate(sizeof(ProcessAggPairsParallelTask)), ProcessAggPairsParallelTask)(contextID, &manager, &map, taskName);
 
 	PxU32 startIdx = pairTasks.size();
 
@@ -2167,12 +2170,10 @@ static void processAggregatePairsParallel(AggPairMap& map, AABBManager& manager,
 		{
 			pairTasks.pushBack(task);
 			task->setContinuation(continuation);
-			task = PX_PLACEMENT_NEW(flushPool.allocate(sizeof(ProcessAggPairsParallelTask)), ProcessAggPairsParallelTask)(0, &manager.mMapLock, &manager, &map, taskName);
+			task = PX_PLACEMENT_NEW(flushPool.allocate(sizeof(ProcessAggPairsParallelTask)), ProcessAggPairsParallelTask)(contextID, &manager, &map, taskName);
 		}
 	}
 
-	manager.mMapLock.unlock();
-
 	for (PxU32 i = startIdx; i < pairTasks.size(); ++i)
 	{
 		pairTasks[i]->removeReference();
@@ -2262,6 +2263,13 @@ void PostBroadPhaseStage2Task::runInternal()
 
 void AABBManager::postBpStage2(PxBaseTask* continuation, Cm::FlushPool& flushPool)
 {
+	// PT: the new aggregate pairs are only inserted in the maps here. Their overlaps are found by the tasks below, along
+	// with the existing pairs, instead of serially in stage 3.
+	{
+		PX_PROFILE_ZONE("AABBManager::postBroadPhase - process created pairs", getContextId());
+		processBPPairs<CreatedPairHandler>(mBroadPhase.getNbCreatedPairs(), mBroadPhase.getCreatedPairs(), *this);
+	}
+
 	{
 		const PxU32 size = mDirtyAggregates.size();
 		for (PxU32 i = 0; i < size; i += ProcessSelfCollisionPairsParallel::MaxPairs)
@@ -2322,6 +2330,7 @@ void AABBManager::postBpStage3(PxBaseTask*)
 			for (PxU32 a = 0; a < mAggPairTasks.size(); ++a)
 			{
 				ProcessAggPairsBase* task = mAggPairTasks[a];
+				task->eraseRemovedEntries();
 				for (PxU32 t = 0; t < 2; t++)
 				{
 					for (PxU32 i = 0, startIdx = task->mCreatedPairs[t].mStartIdx; i < task->mCreatedPairs[t].mCount; ++i)
@@ -2356,12 +2365,6 @@ void AABBManager::postBpStage3(PxBaseTask*)
 		}
 	}
 
-	{
-		PX_PROFILE_ZONE("AABBManager::postBroadPhase - process created pairs", getContextId());
-		processBPPairs<CreatedPairHandler>(mBroadPhase.getNbCreatedPairs(), mBroadPhase.getCreatedPairs(), *this);
-//		processBPPairs<DeletedPairHandler>(mBroadPhase.getNbDeletedPairs(), mBroadPhase.getDeletedPairs(), *this);
-	}
-
 	// PT: TODO: revisit this
 	// Filter out pairs in mDestroyedOverlaps that already exist in mCreatedOverlaps. This should be done better using bitmaps
 	// and some imposed ordering on previous operations. Later.
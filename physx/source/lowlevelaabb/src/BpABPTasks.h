@@ -0,0 +1,122 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef BP_ABP_TASKS_H
+#define BP_ABP_TASKS_H
+
+#include "PsUserAllocated.h"
+#include "CmTask.h"
+
+namespace physx
+{
+namespace Bp
+{
+	class BroadPhaseABP;
+
+#define ABP_MAX_NB_TASKS	16
+
+	class ABPTask : public Cm::Task, public shdfnd::UserAllocated
+	{
+		public:
+												ABPTask(PxU64 contextId) : Cm::Task(contextId), mABP(NULL), mIndex(0)	{}
+
+		PX_FORCE_INLINE	void					set(BroadPhaseABP* abp, PxU32 index)
+												{
+													mABP = abp;
+													mIndex = index;
+												}
+		protected:
+						BroadPhaseABP*			mABP;
+						PxU32					mIndex;
+		private:
+		ABPTask& operator=(const ABPTask&);
+	};
+
+	// PT: sorts the new and updated boxes of one box manager (static, kinematic or dynamic). The three managers are prepared in parallel.
+	class ABPPrepareTask : public ABPTask
+	{
+	public:
+								ABPPrepareTask(PxU64 contextId = 0) : ABPTask(contextId)	{}
+		// PxBaseTask
+		virtual const char*		getName() const { return "BpABP.prepare"; }
+		//~PxBaseTask
+
+		// Cm::Task
+		virtual void			runInternal();
+		//~Cm::Task
+	};
+
+	// PT: runs after the prepare tasks. Gathers the box pruning passes of the frame and spawns the pruning tasks.
+	class ABPUpdateWorkTask : public ABPTask
+	{
+	public:
+								ABPUpdateWorkTask(PxU64 contextId = 0) : ABPTask(contextId)	{}
+		// PxBaseTask
+		virtual const char*		getName() const { return "BpABP.updateWork"; }
+		//~PxBaseTask
+
+		// Cm::Task
+		virtual void			runInternal();
+		//~Cm::Task
+	};
+
+	// PT: runs a slice of each box pruning pass, and records the overlaps in a buffer of its own.
+	class ABPPruningTask : public ABPTask
+	{
+	public:
+								ABPPruningTask(PxU64 contextId = 0) : ABPTask(contextId)	{}
+		// PxBaseTask
+		virtual const char*		getName() const { return "BpABP.pruning"; }
+		//~PxBaseTask
+
+		// Cm::Task
+		virtual void			runInternal();
+		//~Cm::Task
+	};
+
+	// PT: runs after the pruning tasks. Adds their overlaps to the pair manager in a fixed order, then computes the
+	// created/deleted pairs. This is single-threaded.
+	class ABPPostUpdateWorkTask : public ABPTask
+	{
+	public:
+								ABPPostUpdateWorkTask(PxU64 contextId = 0) : ABPTask(contextId)	{}
+		// PxBaseTask
+		virtual const char*		getName() const { return "BpABP.postUpdateWork"; }
+		//~PxBaseTask
+
+		// Cm::Task
+		virtual void			runInternal();
+		//~Cm::Task
+	};
+
+} //namespace Bp
+
+} //namespace physx
+
+#endif // BP_ABP_TASKS_H
@@ -0,0 +1,477 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+
+#include "BpBoxPruningKernels.h"
+#include "PsBitUtils.h"
+
+#ifdef BP_WIDE_BOX_PRUNING
+	#include <immintrin.h>
+	#if PX_VC
+		#include <intrin.h>
+		// PT: MSVC doesn't need target attributes to use the intrinsics, but AVX-512 ones need VS2017
+		#define BP_TARGET_AVX2
+		#define BP_TARGET_AVX512
+		#if _MSC_VER >= 1910
+			#define BP_AVX512_KERNELS
+		#endif
+	#else
+		#include <cpuid.h>
+		#define BP_TARGET_AVX2		__attribute__((target("avx2")))
+		#define BP_TARGET_AVX512	__attribute__((target("avx512f")))
+		#define BP_AVX512_KERNELS
+	#endif
+#endif
+
+using namespace physx;
+using namespace Bp;
+
+#ifdef BP_WIDE_BOX_PRUNING
+
+///////////////////////////////////////////////////////////////////////////////
+
+// PT: CPU & OS support. The OS must save the AVX (and AVX-512) registers on context switches, which is checked with xgetbv.
+static PxBroadPhaseKernel::Enum detectKernel()
+{
+	PxU32 ecx1 = 0;
+	PxU32 ebx7 = 0;
+	PxU64 xcr0 = 0;
+#if PX_VC
+	int info[4];
+	__cpuid(info, 0);
+	const int maxLeaf = info[0];
+	if(maxLeaf<1)
+		return PxBroadPhaseKernel::eSCALAR;
+	__cpuid(info, 1);
+	ecx1 = PxU32(info[2]);
+	if(maxLeaf>=7)
+	{
+		__cpuidex(info, 7, 0);
+		ebx7 = PxU32(info[1]);
+	}
+	if(ecx1 & (1<<27))
+		xcr0 = _xgetbv(0);
+#else
+	unsigned int eax, ebx, ecx, edx;
+	if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return PxBroadPhaseKernel::eSCALAR;
+	ecx1 = ecx;
+	if(__get_cpuid_max(0, NULL)>=7)
+	{
+		__cpuid_count(7, 0, eax, ebx, ecx, edx);
+		ebx7 = ebx;
+	}
+	if(ecx1 & (1<<27))
+	{
+		__asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		xcr0 = (PxU64(edx)<<32)|eax;
+	}
+#endif
+	const bool osxsave	= (ecx1 & (1<<27))!=0;
+	const bool avx		= (ecx1 & (1<<28))!=0;
+	const bool avx2		= (ebx7 & (1<<5))!=0;
+	const bool avx512f	= (ebx7 & (1<<16))!=0;
+	if(!osxsave || !avx || !avx2 || (xcr0 & 0x6)!=0x6)	// XMM & YMM states
+		return PxBroadPhaseKernel::eSCALAR;
+#ifdef BP_AVX512_KERNELS
+	if(avx512f && (xcr0 & 0xe6)==0xe6)	// Opmask, ZMM_Hi256 & Hi16_ZMM states
+		return PxBroadPhaseKernel::eAVX512;
+#else
+	PX_UNUSED(avx512f);
+#endif
+	return PxBroadPhaseKernel::eAVX2;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// PT: same test as SIMD_OVERLAP_TEST_14a in the ABP kernels, used for the last candidates
+static PX_FORCE_INLINE bool ABPOverlapTest(const __m128 b, const AABB_YZn& box1)
+{
+	return _mm_movemask_ps(_mm_cmpngt_ps(b, _mm_loadu_ps(&box1.mMinY)))==15;
+}
+
+// PT: tests the candidates one by one, from 'i' until the sentinels
+static PX_FORCE_INLINE bool ABPKernelTail(	const AABB_YZn& box0_YZ, PxU32 maxLimit, PxU32& index1, PxU32 i,
+											const AABB_Xi* PX_RESTRICT boxes1_X, const AABB_YZn* PX_RESTRICT boxes1_YZ,
+											PxU32* PX_RESTRICT overlaps, PxU32& nbOverlaps, PxU32 nb)
+{
+	const __m128 b = _mm_setr_ps(-box0_YZ.mMaxY, -box0_YZ.mMaxZ, -box0_YZ.mMinY, -box0_YZ.mMinZ);
+	while(boxes1_X[i].mMinX<=maxLimit)
+	{
+		if(ABPOverlapTest(b, boxes1_YZ[i]))
+		{
+			if(nb==BP_WIDE_MAX_NB_OVERLAPS)
+			{
+				index1 = i;
+				nbOverlaps = nb;
+				return false;
+			}
+			overlaps[nb++] = i;
+		}
+		i++;
+	}
+	nbOverlaps = nb;
+	return true;
+}
+
+// PT: ABP, 8 candidates per iteration. The YZ bounds of the candidates are transposed so that each register contains the
+// same component of the 8 boxes: the first lane gets boxes 0-3, the second lane boxes 4-7, which keeps the mask bits in order.
+BP_TARGET_AVX2 static bool ABPKernel_AVX2(	const AABB_YZn& box0_YZ, PxU32 maxLimit, PxU32& index1, PxU32 nb1,
+											const AABB_Xi* PX_RESTRICT boxes1_X, const AABB_YZn* PX_RESTRICT boxes1_YZ,
+											PxU32* PX_RESTRICT overlaps, PxU32& nbOverlaps)
+{
+	const __m256 b0 = _mm256_set1_ps(-box0_YZ.mMaxY);
+	const __m256 b1 = _mm256_set1_ps(-box0_YZ.mMaxZ);
+	const __m256 b2 = _mm256_set1_ps(-box0_YZ.mMinY);
+	const __m256 b3 = _mm256_set1_ps(-box0_YZ.mMinZ);
+	const __m256i limit = _mm256_set1_epi32(int(maxLimit));
+
+	PxU32 nb = 0;
+	PxU32 i = index1;
+	while(i+8<=nb1)
+	{
+		if(nb>BP_WIDE_MAX_NB_OVERLAPS-8)
+		{
+			index1 = i;
+			nbOverlaps = nb;
+			return false;
+		}
+
+		// PT: min X of the 8 candidates, compared as unsigned integers
+		const __m256 x0 = _mm256_loadu_ps(reinterpret_cast<const float*>(boxes1_X + i));
+		const __m256 x1 = _mm256_loadu_ps(reinterpret_cast<const float*>(boxes1_X + i + 4));
+		const __m256i minX = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(2,0,2,0))), _MM_SHUFFLE(3,1,2,0));
+		const PxU32 maskX = PxU32(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_max_epu32(minX, limit), limit))));
+		if(!maskX)
+			break;
+
+		const float* yz = &boxes1_YZ[i].mMinY;
+		const __m256 r0 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(yz)), _mm_loadu_ps(yz + 16), 1);
+		const __m256 r1 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(yz + 4)), _mm_loadu_ps(yz + 20), 1);
+		const __m256 r2 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(yz + 8)), _mm_loadu_ps(yz + 24), 1);
+		const __m256 r3 = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(yz + 12)), _mm_loadu_ps(yz + 28), 1);
+		const __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+		const __m256 t1 = _mm256_unpacklo_ps(r2, r3);
+		const __m256 t2 = _mm256_unpackhi_ps(r0, r1);
+		const __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+		const __m256 c0 = _mm256_cmp_ps(b0, _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1,0,1,0)), _CMP_NGT_UQ);
+		const __m256 c1 = _mm256_cmp_ps(b1, _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3,2,3,2)), _CMP_NGT_UQ);
+		const __m256 c2 = _mm256_cmp_ps(b2, _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1,0,1,0)), _CMP_NGT_UQ);
+		const __m256 c3 = _mm256_cmp_ps(b3, _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3,2,3,2)), _CMP_NGT_UQ);
+		PxU32 hits = maskX & PxU32(_mm256_movemask_ps(_mm256_and_ps(_mm256_and_ps(c0, c1), _mm256_and_ps(c2, c3))));
+		while(hits)
+		{
+			overlaps[nb++] = i + Ps::lowestSetBitUnsafe(hits);
+			hits &= hits - 1;
+		}
+
+		if(maskX!=0xff)
+		{
+			nbOverlaps = nb;
+			return true;
+		}
+		i += 8;
+	}
+
+	// PT: less than 8 boxes left before the sentinels
+	if(i+8>nb1)
+		return ABPKernelTail(box0_YZ, maxLimit, index1, i, boxes1_X, boxes1_YZ, overlaps, nbOverlaps, nb);
+	nbOverlaps = nb;
+	return true;
+}
+
+#ifdef BP_AVX512_KERNELS
+// PT: ABP, 16 candidates per iteration. Each permute gathers two components of 8 boxes, so that a single comparison tests
+// two components of these 8 boxes.
+BP_TARGET_AVX512 static bool ABPKernel_AVX512(	const AABB_YZn& box0_YZ, PxU32 maxLimit, PxU32& index1, PxU32 nb1,
+												const AABB_Xi* PX_RESTRICT boxes1_X, const AABB_YZn* PX_RESTRICT boxes1_YZ,
+												PxU32* PX_RESTRICT overlaps, PxU32& nbOverlaps)
+{
+	const __m512 b01 = _mm512_mask_blend_ps(0xff00, _mm512_set1_ps(-box0_YZ.mMaxY), _mm512_set1_ps(-box0_YZ.mMaxZ));
+	const __m512 b23 = _mm512_mask_blend_ps(0xff00, _mm512_set1_ps(-box0_YZ.mMinY), _mm512_set1_ps(-box0_YZ.mMinZ));
+	const __m512i idx01 = _mm512_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28, 1, 5, 9, 13, 17, 21, 25, 29);
+	const __m512i idx23 = _mm512_setr_epi32(2, 6, 10, 14, 18, 22, 26, 30, 3, 7, 11, 15, 19, 23, 27, 31);
+	const __m512i idxX = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+	const __m512i limit = _mm512_set1_epi32(int(maxLimit));
+
+	PxU32 nb = 0;
+	PxU32 i = index1;
+	while(i+16<=nb1)
+	{
+		if(nb>BP_WIDE_MAX_NB_OVERLAPS-16)
+		{
+			index1 = i;
+			nbOverlaps = nb;
+			return false;
+		}
+
+		const __m512i x0 = _mm512_loadu_si512(boxes1_X + i);
+		const __m512i x1 = _mm512_loadu_si512(boxes1_X + i + 8);
+		const PxU32 maskX = PxU32(_mm512_cmple_epu32_mask(_mm512_permutex2var_epi32(x0, idxX, x1), limit));
+		if(!maskX)
+			break;
+
+		const float* yz = &boxes1_YZ[i].mMinY;
+		const __m512 z0 = _mm512_loadu_ps(yz);
+		const __m512 z1 = _mm512_loadu_ps(yz + 16);
+		const __m512 z2 = _mm512_loadu_ps(yz + 32);
+		const __m512 z3 = _mm512_loadu_ps(yz + 48);
+		const PxU32 mA =	PxU32(_mm512_cmp_ps_mask(b01, _mm512_permutex2var_ps(z0, idx01, z1), _CMP_NGT_UQ))
+						&	PxU32(_mm512_cmp_ps_mask(b23, _mm512_permutex2var_ps(z0, idx23, z1), _CMP_NGT_UQ));
+		const PxU32 mB =	PxU32(_mm512_cmp_ps_mask(b01, _mm512_permutex2var_ps(z2, idx01, z3), _CMP_NGT_UQ))
+						&	PxU32(_mm512_cmp_ps_mask(b23, _mm512_permutex2var_ps(z2, idx23, z3), _CMP_NGT_UQ));
+		PxU32 hits = maskX & ((mA & (mA>>8) & 0xff) | ((mB & (mB>>8) & 0xff)<<8));
+		while(hits)
+		{
+			overlaps[nb++] = i + Ps::lowestSetBitUnsafe(hits);
+			hits &= hits - 1;
+		}
+
+		if(maskX!=0xffff)
+		{
+			nbOverlaps = nb;
+			return true;
+		}
+		i += 16;
+	}
+
+	// PT: less than 16 boxes left before the sentinels
+	if(i+16>nb1)
+		return ABPKernelTail(box0_YZ, maxLimit, index1, i, boxes1_X, boxes1_YZ, overlaps, nbOverlaps, nb);
+	nbOverlaps = nb;
+	return true;
+}
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+// PT: same test as SIMD_OVERLAP_TEST in the MBP kernels, used for the last candidates
+static PX_FORCE_INLINE bool MBPOverlapTest(const SIMD_AABB& box0, const SIMD_AABB& box1)
+{
+	return	!(PxI32(box1.mMinY) > PxI32(box0.mMaxY)) && !(PxI32(box1.mMinZ) > PxI32(box0.mMaxZ))
+		&&	(PxI32(box1.mMaxY) > PxI32(box0.mMinY)) && (PxI32(box1.mMaxZ) > PxI32(box0.mMinZ));
+}
+
+// PT: tests the candidates one by one, from 'i' until the sentinels
+static PX_FORCE_INLINE bool MBPKernelTail(	const SIMD_AABB& box0, PxU32& index1, PxU32 i, const SIMD_AABB* PX_RESTRICT boxes1,
+											PxU32* PX_RESTRICT overlaps, PxU32& nbOverlaps, PxU32 nb)
+{
+	const PxU32 maxLimit = box0.mMaxX;
+	while(boxes1[i].mMinX<=maxLimit)
+	{
+		if(MBPOverlapTest(box0, boxes1[i]))
+		{
+			if(nb==BP_WIDE_MAX_NB_OVERLAPS)
+			{
+				index1 = i;
+				nbOverlaps = nb;
+				return false;
+			}
+			overlaps[nb++] = i;
+		}
+		i++;
+	}
+	nbOverlaps = nb;
+	return true;
+}
+
+// PT: MBP boxes are 24 bytes, the components of 8 candidates are gathered. The min X are gathered first since most
+// iterations end there.
+BP_TARGET_AVX2 static bool MBPKernel_AVX2(	const SIMD_AABB& box0, PxU32& index1, PxU32 nb1, const SIMD_AABB* PX_RESTRICT boxes1,
+											PxU32* PX_RESTRICT overlaps, PxU32& nbOverlaps)
+{
+	PX_COMPILE_TIME_ASSERT(sizeof(SIMD_AABB)==24);
+	const __m256i offsets = _mm256_setr_epi32(0, 6, 12, 18, 24, 30, 36, 42);
+	const __m256i limit = _mm256_set1_epi32(int(box0.mMaxX));
+	const __m256i minY0 = _mm256_set1_epi32(int(box0.mMinY));
+	const __m256i minZ0 = _mm256_set1_epi32(int(box0.mMinZ));
+	const __m256i maxY0 = _mm256_set1_epi32(int(box0.mMaxY));
+	const __m256i maxZ0 = _mm256_set1_epi32(int(box0.mMaxZ));
+
+	PxU32 nb = 0;
+	PxU32 i = index1;
+	while(i+8<=nb1)
+	{
+		if(nb>BP_WIDE_MAX_NB_OVERLAPS-8)
+		{
+			index1 = i;
+			nbOverlaps = nb;
+			return false;
+		}
+
+		const int* base = reinterpret_cast<const int*>(boxes1 + i);
+		const __m256i minX = _mm256_i32gather_epi32(base, offsets, 4);
+		const PxU32 maskX = PxU32(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_max_epu32(minX, limit), limit))));
+		if(!maskX)
+			break;
+
+		const __m256i minY1 = _mm256_i32gather_epi32(base + 2, offsets, 4);
+		const __m256i minZ1 = _mm256_i32gather_epi32(base + 3, offsets, 4);
+		const __m256i maxY1 = _mm256_i32gather_epi32(base + 4, offsets, 4);
+		const __m256i maxZ1 = _mm256_i32gather_epi32(base + 5, offsets, 4);
+		const __m256i separated = _mm256_or_si256(_mm256_cmpgt_epi32(minY1, maxY0), _mm256_cmpgt_epi32(minZ1, maxZ0));
+		const __m256i overlapping = _mm256_and_si256(_mm256_cmpgt_epi32(maxY1, minY0), _mm256_cmpgt_epi32(maxZ1, minZ0));
+		PxU32 hits = maskX & PxU32(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_andnot_si256(separated, overlapping))));
+		while(hits)
+		{
+			overlaps[nb++] = i + Ps::lowestSetBitUnsafe(hits);
+			hits &= hits - 1;
+		}
+
+		if(maskX!=0xff)
+		{
+			nbOverlaps = nb;
+			return true;
+		}
+		i += 8;
+	}
+
+	if(i+8>nb1)
+		return MBPKernelTail(box0, index1, i, boxes1, overlaps, nbOverlaps, nb);
+	nbOverlaps = nb;
+	return true;
+}
+
+#ifdef BP_AVX512_KERNELS
+BP_TARGET_AVX512 static bool MBPKernel_AVX512(	const SIMD_AABB& box0, PxU32& index1, PxU32 nb1, const SIMD_AABB* PX_RESTRICT boxes1,
+												PxU32* PX_RESTRICT overlaps, PxU32& nbOverlaps)
+{
+	const __m512i offsets = _mm512_setr_epi32(0, 6, 12, 18, 24, 30, 36, 42, 48, 54, 60, 66, 72, 78, 84, 90);
+	const __m512i limit = _mm512_set1_epi32(int(box0.mMaxX));
+	const __m512i minY0 = _mm512_set1_epi32(int(box0.mMinY));
+	const __m512i minZ0 = _mm512_set1_epi32(int(box0.mMinZ));
+	const __m512i maxY0 = _mm512_set1_epi32(int(box0.mMaxY));
+	const __m512i maxZ0 = _mm512_set1_epi32(int(box0.mMaxZ));
+
+	PxU32 nb = 0;
+	PxU32 i = index1;
+	while(i+16<=nb1)
+	{
+		if(nb>BP_WIDE_MAX_NB_OVERLAPS-16)
+		{
+			index1 = i;
+			nbOverlaps = nb;
+			return false;
+		}
+
+		const int* base = reinterpret_cast<const int*>(boxes1 + i);
+		const PxU32 maskX = PxU32(_mm512_cmple_epu32_mask(_mm512_i32gather_epi32(offsets, base, 4), limit));
+		if(!maskX)
+			break;
+
+		const __mmask16 separated =	_mm512_cmpgt_epi32_mask(_mm512_i32gather_epi32(offsets, base + 2, 4), maxY0)
+								|	_mm512_cmpgt_epi32_mask(_mm512_i32gather_epi32(offsets, base + 3, 4), maxZ0);
+		const __mmask16 overlapping =	_mm512_cmpgt_epi32_mask(_mm512_i32gather_epi32(offsets, base + 4, 4), minY0)
+									&	_mm512_cmpgt_epi32_mask(_mm512_i32gather_epi32(offsets, base + 5, 4), minZ0);
+		PxU32 hits = maskX & PxU32(overlapping & ~separated);
+		while(hits)
+		{
+			overlaps[nb++] = i + Ps::lowestSetBitUnsafe(hits);
+			hits &= hits - 1;
+		}
+
+		if(maskX!=0xffff)
+		{
+			nbOverlaps = nb;
+			return true;
+		}
+		i += 16;
+	}
+
+	if(i+16>nb1)
+		return MBPKernelTail(box0, index1, i, boxes1, overlaps, nbOverlaps, nb);
+	nbOverlaps = nb;
+	return true;
+}
+#endif
+
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+
+// PT: detected on first use. Detection always gives the same result so racing threads are not an issue.
+static PxI32 gSupportedKernel	= -1;
+static PxI32 gSelectedKernel	= -1;
+
+static PxBroadPhaseKernel::Enum getSupportedKernel()
+{
+	if(gSupportedKernel<0)
+	{
+#ifdef BP_WIDE_BOX_PRUNING
+		gSupportedKernel = PxI32(detectKernel());
+#else
+		gSupportedKernel = PxI32(PxBroadPhaseKernel::eSCALAR);
+#endif
+	}
+	return PxBroadPhaseKernel::Enum(gSupportedKernel);
+}
+
+PxBroadPhaseKernel::Enum Bp::setBoxPruningKernel(PxBroadPhaseKernel::Enum kernel)
+{
+	const PxBroadPhaseKernel::Enum supported = getSupportedKernel();
+	gSelectedKernel = PxI32(kernel>supported ? supported : kernel);
+	return PxBroadPhaseKernel::Enum(gSelectedKernel);
+}
+
+PxBroadPhaseKernel::Enum Bp::getBoxPruningKernel()
+{
+	if(gSelectedKernel<0)
+		gSelectedKernel = PxI32(getSupportedKernel());
+	return PxBroadPhaseKernel::Enum(gSelectedKernel);
+}
+
+ABPWideKernel Bp::getABPWideKernel()
+{
+#ifdef BP_WIDE_BOX_PRUNING
+	switch(getBoxPruningKernel())
+	{
+		case PxBroadPhaseKernel::eAVX2:		return ABPKernel_AVX2;
+	#ifdef BP_AVX512_KERNELS
+		case PxBroadPhaseKernel::eAVX512:	return ABPKernel_AVX512;
+	#endif
+		default:							break;
+	}
+#endif
+	return NULL;
+}
+
+MBPWideKernel Bp::getMBPWideKernel()
+{
+#ifdef BP_WIDE_BOX_PRUNING
+	switch(getBoxPruningKernel())
+	{
+		case PxBroadPhaseKernel::eAVX2:		return MBPKernel_AVX2;
+	#ifdef BP_AVX512_KERNELS
+		case PxBroadPhaseKernel::eAVX512:	return MBPKernel_AVX512;
+	#endif
+		default:							break;
+	}
+#endif
+	return NULL;
+}
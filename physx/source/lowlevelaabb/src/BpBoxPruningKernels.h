@@ -0,0 +1,80 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+
+#ifndef BP_BOX_PRUNING_KERNELS_H
+#define BP_BOX_PRUNING_KERNELS_H
+
+#include "PxBroadPhase.h"
+#include "BpBroadPhaseShared.h"
+#include "BpBroadPhaseMBPCommon.h"
+
+// PT: wide kernels are only available on x86/x64, where they are selected at runtime depending on the CPU
+#if PX_INTEL_FAMILY && !defined(PX_SIMD_DISABLED) && !PX_EMSCRIPTEN
+	#define BP_WIDE_BOX_PRUNING
+#endif
+
+namespace physx
+{
+namespace Bp
+{
+	// PT: size of the overlap buffer passed to the wide kernels
+	#define BP_WIDE_MAX_NB_OVERLAPS	64
+
+	// PT: the wide kernels replace the inner loop of the box pruning functions. They test a box against the next candidates of
+	// a sorted array, starting at 'index1', until the candidates' min X goes beyond the box's max X. The indices of overlapping
+	// candidates are written to 'overlaps' in increasing order, i.e. in the same order as the scalar loops would output them.
+	//
+	// They return true when all candidates have been processed, and false when the overlap buffer is full. In that case 'index1'
+	// is the next candidate to process and the function must be called again. Only the first 'nb1' boxes of the array are loaded
+	// 8 or 16 at a time, the remaining candidates are tested one by one until the sentinels stop the loop.
+
+	// PT: for ABP, box0 is given by its max X and its YZ bounds. YZ bounds use the ABP_SIMD_OVERLAP layout (negated mins).
+	typedef bool (*ABPWideKernel)(	const AABB_YZn& box0_YZ, PxU32 maxLimit, PxU32& index1, PxU32 nb1,
+									const AABB_Xi* PX_RESTRICT boxes1_X, const AABB_YZn* PX_RESTRICT boxes1_YZ,
+									PxU32* PX_RESTRICT overlaps, PxU32& nbOverlaps);
+
+	// PT: for MBP, boxes use the MBP_SIMD_OVERLAP layout (integer bounds shifted right by one bit)
+	typedef bool (*MBPWideKernel)(	const SIMD_AABB& box0, PxU32& index1, PxU32 nb1, const SIMD_AABB* PX_RESTRICT boxes1,
+									PxU32* PX_RESTRICT overlaps, PxU32& nbOverlaps);
+
+	// PT: selects the kernels used by ABP & MBP. Unsupported instruction sets fall back to the widest supported one, which is
+	// also the default. Returns the selected kernel.
+	PxBroadPhaseKernel::Enum	setBoxPruningKernel(PxBroadPhaseKernel::Enum kernel);
+	PxBroadPhaseKernel::Enum	getBoxPruningKernel();
+
+	// PT: return NULL when the scalar kernels are selected
+	ABPWideKernel				getABPWideKernel();
+	MBPWideKernel				getMBPWideKernel();
+
+} //namespace Bp
+
+} //namespace physx
+
+#endif // BP_BOX_PRUNING_KERNELS_H
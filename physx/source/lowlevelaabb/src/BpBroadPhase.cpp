@@ -30,6 +30,7 @@
 #include "BpBroadPhase.h"
 #include "BpBroadPhaseSap.h"
 #include "BpBroadPhaseMBP.h"
+#include "BpBoxPruningKernels.h"
 #include "PxSceneDesc.h"
 #include "CmBitMap.h"
 
@@ -41,7 +42,8 @@ BroadPhase* createABP(
 	const PxU32 maxNbBroadPhaseOverlaps,
 	const PxU32 maxNbStaticShapes,
 	const PxU32 maxNbDynamicShapes,
-	PxU64 contextID);
+	PxU64 contextID,
+	bool persistentPairs);
 
 BroadPhase* createMBP4(
 	const PxU32 maxNbBroadPhaseOverlaps,
@@ -55,20 +57,31 @@ BroadPhase* BroadPhase::create(
 	const PxU32 maxNbBroadPhaseOverlaps,
 	const PxU32 maxNbStaticShapes,
 	const PxU32 maxNbDynamicShapes,
-	PxU64 contextID)
+	PxU64 contextID,
+	bool persistentPairs)
 {
 	PX_ASSERT(bpType==PxBroadPhaseType::eMBP || bpType == PxBroadPhaseType::eSAP || bpType == PxBroadPhaseType::eABP);
 
 	if(bpType==PxBroadPhaseType::eABP)
-		return createABP(maxNbBroadPhaseOverlaps, maxNbStaticShapes, maxNbDynamicShapes, contextID);
+		return createABP(maxNbBroadPhaseOverlaps, maxNbStaticShapes, maxNbDynamicShapes, contextID, persistentPairs);
 //		return createMBP4(maxNbBroadPhaseOverlaps, maxNbStaticShapes, maxNbDynamicShapes, contextID);
 	else if(bpType==PxBroadPhaseType::eMBP)
-		return PX_NEW(BroadPhaseMBP)(maxNbRegions, maxNbBroadPhaseOverlaps, maxNbStaticShapes, maxNbDynamicShapes, contextID);
+		return PX_NEW(BroadPhaseMBP)(maxNbRegions, maxNbBroadPhaseOverlaps, maxNbStaticShapes, maxNbDynamicShapes, contextID, persistentPairs);
 	else
-		return PX_NEW(BroadPhaseSap)(maxNbBroadPhaseOverlaps, maxNbStaticShapes, maxNbDynamicShapes, contextID);
+		return PX_NEW(BroadPhaseSap)(maxNbBroadPhaseOverlaps, maxNbStaticShapes, maxNbDynamicShapes, contextID, persistentPairs);
 //		return createABP(maxNbBroadPhaseOverlaps, maxNbStaticShapes, maxNbDynamicShapes, contextID);
 }
 
+PxBroadPhaseKernel::Enum BroadPhase::setKernel(PxBroadPhaseKernel::Enum kernel)
+{
+	return setBoxPruningKernel(kernel);
+}
+
+PxBroadPhaseKernel::Enum BroadPhase::getKernel()
+{
+	return getBoxPruningKernel();
+}
+
 
 #if PX_CHECKED
 bool BroadPhaseUpdateData::isValid(const BroadPhaseUpdateData& updateData, const BroadPhase& bp)
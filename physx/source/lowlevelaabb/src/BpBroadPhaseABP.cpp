@@ -30,6 +30,7 @@
 #include "foundation/PxProfiler.h"
 #include "BpBroadPhaseABP.h"
 #include "BpBroadPhaseShared.h"
+#include "BpBoxPruningKernels.h"
 #include "CmRadixSortBuffered.h"
 #include "PsFoundation.h"
 #include "PsVecMath.h"
@@ -65,6 +66,11 @@ using namespace Cm;
 
 //#define RECURSE_LIMIT	20000
 
+#if defined(BP_WIDE_BOX_PRUNING) && defined(ABP_SIMD_OVERLAP) && defined(ABP_USE_INTEGER_XS2)
+	#define ABP_WIDE_BOX_PRUNING
+	#define ABP_MIN_NB_WIDE_CANDIDATES	8	// PT: the wide kernels are only used for boxes overlapping at least that number of candidates along X
+#endif
+
 	typedef	PxU32	ABP_Index;
 
 	static const bool gPrepareOverlapsFlag = true;
@@ -914,6 +920,88 @@ static ABP_Index* resizeMapping(PxU32 oldNbBoxes, PxU32 newNbBoxes, ABP_Index* m
 #endif
 	};
 
+	// PT: overlaps found by a pruning task. They are filtered like in ABP_PairManager::addPair, but only recorded here. The
+	// buffers of all tasks are then added to the pair manager in a fixed order, see ABP::mergePairBuffers().
+	class ABP_PairBuffer : public Ps::UserAllocated
+	{
+		public:
+														ABP_PairBuffer();
+
+		PX_FORCE_INLINE	void							addPair(PxU32 index0, PxU32 index1)
+														{
+															const PxU32 id0 = mInToOut0[index0];
+															const PxU32 id1 = mInToOut1[index1];
+															PX_ASSERT(id0!=id1);
+															PX_ASSERT(id0!=INVALID_ID);
+															PX_ASSERT(id1!=INVALID_ID);
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+															if(groupFiltering(mGroups[id0], mGroups[id1], mLUT))
+#else
+															if(groupFiltering(mGroups[id0], mGroups[id1]))
+#endif
+																mPairs.pushBack(BroadPhasePair(id0, id1));
+														}
+
+						Ps::Array<BroadPhasePair>		mPairs;
+						Ps::Array<PxU32>				mPassEnds;	// End of each pruning pass' overlaps in mPairs
+
+						const Bp::FilterGroup::Enum*	mGroups;
+						const ABP_Index*				mInToOut0;
+						const ABP_Index*				mInToOut1;
+						const ABPEntry*					mObjects;
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+						const bool*						mLUT;
+#endif
+	};
+
+	// PT: one call to the box pruning kernels. The passes of a frame are gathered first and then run in order, either all
+	// at once, or with their outer loop split between the pruning tasks. In both cases the overlaps come out in the same order.
+	struct ABP_PruningPass
+	{
+		enum Type
+		{
+			eCOMPLETE,		// Boxes0 against themselves
+			eBIPARTITE_0,	// Boxes0 against boxes1, first half of doBipartiteBoxPruning_Leaf()
+			eBIPARTITE_1	// Boxes0 against boxes1, second half of doBipartiteBoxPruning_Leaf()
+		};
+
+		const SIMD_AABB_X4*		mBoxes0_X;
+		const SIMD_AABB_X4*		mBoxes1_X;
+		const SIMD_AABB_YZ4*	mBoxes0_YZ;
+		const SIMD_AABB_YZ4*	mBoxes1_YZ;
+		const ABP_Index*		mRemap0;
+		const ABP_Index*		mRemap1;
+		PxU32					mNb0;		// Number of boxes in the outer loop
+		PxU32					mNb1;
+		Type					mType;
+	};
+
+	struct ABP_PruningPasses
+	{
+						Ps::Array<ABP_PruningPass>	mPasses;
+						Ps::Array<void*>			mMemory;	// Temporary buffers referenced by the passes, from ABP_MM::frameAlloc()
+
+						void						release(ABP_MM& memoryManager)
+													{
+														PxU32 nb = mMemory.size();
+														while(nb--)
+															memoryManager.frameFree(mMemory[nb]);
+														mMemory.clear();
+														mPasses.clear();
+													}
+	};
+
+ABP_PairBuffer::ABP_PairBuffer() :
+	mGroups		(NULL),
+	mInToOut0	(NULL),
+	mInToOut1	(NULL),
+	mObjects	(NULL)
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+	,mLUT		(NULL)
+#endif
+{
+}
+
 	///////////////////////////////////////////////////////////////////////////
 
 	struct ABP_SharedData
@@ -1780,7 +1868,13 @@ void BoxManager::finalize()
 						void					setTransientData(const PxBounds3* bounds, const PxReal* contactDistance/*, const Bp::FilterGroup::Enum* groups*/);
 
 						void					Region_prepareOverlaps();
+						void					Region_prepareBoxes(FilterType::Enum type);
 						void					Region_findOverlaps(ABP_PairManager& pairManager);
+						void					Region_gatherPruningPasses();
+						void					Region_runPruningPasses(ABP_PairManager& pairManager);
+						void					Region_runPruningTask(PxU32 taskIndex, PxU32 nbTasks);
+						void					Region_mergePairBuffers(PxU32 nbTasks);
+						void					Region_finalize();
 
 						ABP_MM					mMM;
 						BoxManager				mSBM;
@@ -1789,6 +1883,8 @@ void BoxManager::finalize()
 						DynamicManager			mKBM;
 						ABP_SharedData			mShared;
 						ABP_PairManager			mPairManager;
+						ABP_PruningPasses		mPruningPasses;
+						ABP_PairBuffer			mPairBuffers[ABP_MAX_NB_TASKS];	// One per pruning task
 
 //				const	PxBounds3*				mTransientBounds;
 //				const	PxReal*					mTransientContactDistance;
@@ -1898,26 +1994,79 @@ static PX_FORCE_INLINE int intersect2D(const SIMD_AABB_YZ4& a, const SIMD_AABB_Y
 }
 #endif
 
-static PX_FORCE_INLINE void outputPair(ABP_PairManager& pairManager, PxU32 index0, PxU32 index1)
+// PT: the kernels below output their overlaps to either the ABP_PairManager directly, or to the ABP_PairBuffer of a pruning task
+template<class PairManagerT>
+static PX_FORCE_INLINE void outputPair(PairManagerT& pairManager, PxU32 index0, PxU32 index1)
 {
 	pairManager.addPair(index0, index1);
 }
 
-template<int codepath>
-static void boxPruningKernel(	PxU32 nb0, PxU32 nb1,
+#ifdef ABP_WIDE_BOX_PRUNING
+// PT: returns true if the wide kernels should be used for the candidates starting at index1, i.e. if there are enough of them
+static PX_FORCE_INLINE bool useWideKernel(ABPWideKernel wideKernel, PxU32 index1, PxU32 nb1, const SIMD_AABB_X4* PX_RESTRICT boxes1_X, PosXType2 maxLimit)
+{
+	return wideKernel && index1+ABP_MIN_NB_WIDE_CANDIDATES<=nb1 && boxes1_X[index1+ABP_MIN_NB_WIDE_CANDIDATES-1].mMinX<=maxLimit;
+}
+
+template<class PairManagerT>
+static PX_NOINLINE void outputWideOverlaps(	PairManagerT& pairManager, ABPWideKernel wideKernel, PxU32 index0, PxU32 index1, PxU32 nb1,
+											PosXType2 maxLimit, const SIMD_AABB_YZ4& box0,
+											const SIMD_AABB_X4* PX_RESTRICT boxes1_X, const SIMD_AABB_YZ4* PX_RESTRICT boxes1_YZ)
+{
+	PxU32 overlaps[BP_WIDE_MAX_NB_OVERLAPS];
+	bool done;
+	do
+	{
+		PxU32 nbOverlaps;
+		done = wideKernel(box0, maxLimit, index1, nb1, boxes1_X, boxes1_YZ, overlaps, nbOverlaps);
+		for(PxU32 i=0;i<nbOverlaps;i++)
+			outputPair(pairManager, index0, overlaps[i]);
+	}
+	while(!done);
+}
+#endif
+
+// PT: returns the first box whose min is not smaller than the limit. This is where the kernels' running index would be
+// when they reach a box of that min, which lets them start from any box of their outer loop.
+static PX_FORCE_INLINE PxU32 findRunningIndex(const SIMD_AABB_X4* PX_RESTRICT boxes_X, PxU32 nb, PosXType2 limit)
+{
+	PxU32 first = 0;
+	while(nb)
+	{
+		const PxU32 half = nb>>1;
+		if(boxes_X[first + half].mMinX<limit)
+		{
+			first += half + 1;
+			nb -= half + 1;
+		}
+		else
+			nb = half;
+	}
+	return first;
+}
+
+// PT: processes boxes [start0;end0[ of the first set against the second set
+template<int codepath, class PairManagerT>
+static void boxPruningKernel(	PxU32 start0, PxU32 end0, PxU32 nb1,
 								const SIMD_AABB_X4* PX_RESTRICT boxes0_X, const SIMD_AABB_X4* PX_RESTRICT boxes1_X,
 								const SIMD_AABB_YZ4* PX_RESTRICT boxes0_YZ, const SIMD_AABB_YZ4* PX_RESTRICT boxes1_YZ,
 								const ABP_Index* PX_RESTRICT inToOut0, const ABP_Index* PX_RESTRICT inToOut1,
-								ABP_PairManager* PX_RESTRICT pairManager, const ABPEntry* PX_RESTRICT objects)
+								PairManagerT* PX_RESTRICT pairManager, const ABPEntry* PX_RESTRICT objects)
 {
+	if(start0>=end0)
+		return;
+
 	pairManager->mInToOut0 = inToOut0;
 	pairManager->mInToOut1 = inToOut1;
 	pairManager->mObjects = objects;
 
-	PxU32 index0 = 0;
-	PxU32 runningIndex1 = 0;
+#ifdef ABP_WIDE_BOX_PRUNING
+	const ABPWideKernel wideKernel = getABPWideKernel();
+#endif
+	PxU32 index0 = start0;
+	PxU32 runningIndex1 = start0 ? findRunningIndex(boxes1_X, nb1, boxes0_X[start0].mMinX) : 0;
 
-	while(runningIndex1<nb1 && index0<nb0)
+	while(runningIndex1<nb1 && index0<end0)
 	{
 		const SIMD_AABB_X4& box0_X = boxes0_X[index0];
 		const PosXType2 maxLimit = box0_X.mMaxX;
@@ -1937,6 +2086,11 @@ static void boxPruningKernel(	PxU32 nb0, PxU32 nb1,
 		const SIMD_AABB_YZ4& box0 = boxes0_YZ[index0];
 		SIMD_OVERLAP_PRELOAD_BOX0
 
+#ifdef ABP_WIDE_BOX_PRUNING
+		if(useWideKernel(wideKernel, runningIndex1, nb1, boxes1_X, maxLimit))
+			outputWideOverlaps(*pairManager, wideKernel, index0, runningIndex1, nb1, maxLimit, box0, boxes1_X, boxes1_YZ);
+		else
+#endif
 		if(gUseRegularBPKernel)
 		{
 			PxU32 index1 = runningIndex1;
@@ -2057,8 +2211,9 @@ LoopStart:
 	}
 }
 
+template<class PairManagerT>
 static /*PX_FORCE_INLINE*/ void doBipartiteBoxPruning_Leaf(
-		ABP_PairManager* PX_RESTRICT pairManager,
+		PairManagerT* PX_RESTRICT pairManager,
 		const ABPEntry* PX_RESTRICT objects,
 		PxU32 nb0,
 		PxU32 nb1,
@@ -2072,29 +2227,29 @@ static /*PX_FORCE_INLINE*/ void doBipartiteBoxPruning_Leaf(
 {
 	PX_ASSERT(boxes0_X[nb0].isSentinel());
 	PX_ASSERT(boxes1_X[nb1].isSentinel());
-	boxPruningKernel<0>(nb0, nb1, boxes0_X, boxes1_X, boxes0_YZ, boxes1_YZ, remap0, remap1, pairManager, objects);
-	boxPruningKernel<1>(nb1, nb0, boxes1_X, boxes0_X, boxes1_YZ, boxes0_YZ, remap1, remap0, pairManager, objects);
-}
-
-static PX_FORCE_INLINE void doBipartiteBoxPruning_Leaf(ABP_PairManager* PX_RESTRICT pairManager, const ABPEntry* PX_RESTRICT objects,
-		PxU32 nb0, PxU32 nb1, const SplitBoxes& boxes0, const SplitBoxes& boxes1, const ABP_Index* PX_RESTRICT remap0, const ABP_Index* PX_RESTRICT remap1)
-{
-	doBipartiteBoxPruning_Leaf(pairManager, objects, nb0, nb1, boxes0.getBoxes_X(), boxes1.getBoxes_X(), boxes0.getBoxes_YZ(), boxes1.getBoxes_YZ(), remap0, remap1);
+	boxPruningKernel<0>(0, nb0, nb1, boxes0_X, boxes1_X, boxes0_YZ, boxes1_YZ, remap0, remap1, pairManager, objects);
+	boxPruningKernel<1>(0, nb1, nb0, boxes1_X, boxes0_X, boxes1_YZ, boxes0_YZ, remap1, remap0, pairManager, objects);
 }
 
-static void doCompleteBoxPruning_Leaf(	ABP_PairManager* PX_RESTRICT pairManager, PxU32 nb,
+// PT: processes boxes [start;end[ against the following ones
+template<class PairManagerT>
+static void completeBoxPruningKernel(	PxU32 start, PxU32 end, PxU32 nb,
 										const SIMD_AABB_X4* PX_RESTRICT boxes_X,
 										const SIMD_AABB_YZ4* PX_RESTRICT boxes_YZ,
 										const ABP_Index* PX_RESTRICT remap,
-										const ABPEntry* PX_RESTRICT objects)
+										PairManagerT* PX_RESTRICT pairManager, const ABPEntry* PX_RESTRICT objects)
 {
 	pairManager->mInToOut0 = remap;
 	pairManager->mInToOut1 = remap;
 	pairManager->mObjects = objects;
 
-	PxU32 index0 = 0;
-	PxU32 runningIndex = 0;
-	while(runningIndex<nb && index0<nb)
+#ifdef ABP_WIDE_BOX_PRUNING
+	const ABPWideKernel wideKernel = getABPWideKernel();
+#endif
+	// PT: the running index is always one past the current box, see below
+	PxU32 index0 = start;
+	PxU32 runningIndex = start;
+	while(runningIndex<nb && index0<end)
 	{
 		const SIMD_AABB_X4& box0_X = boxes_X[index0];
 		const PosXType2 maxLimit = box0_X.mMaxX;
@@ -2105,6 +2260,11 @@ static void doCompleteBoxPruning_Leaf(	ABP_PairManager* PX_RESTRICT pairManager,
 		const SIMD_AABB_YZ4& box0 = boxes_YZ[index0];
 		SIMD_OVERLAP_PRELOAD_BOX0
 
+#ifdef ABP_WIDE_BOX_PRUNING
+		if(useWideKernel(wideKernel, runningIndex, nb, boxes_X, maxLimit))
+			outputWideOverlaps(*pairManager, wideKernel, index0, runningIndex, nb, maxLimit, box0, boxes_X, boxes_YZ);
+		else
+#endif
 		if(gUseRegularBPKernel)
 		{
 			PxU32 index1 = runningIndex;
@@ -2230,6 +2390,68 @@ StartLoop:
 	}
 }
 
+template<class PairManagerT>
+static PX_FORCE_INLINE void doCompleteBoxPruning_Leaf(	PairManagerT* PX_RESTRICT pairManager, PxU32 nb,
+														const SIMD_AABB_X4* PX_RESTRICT boxes_X,
+														const SIMD_AABB_YZ4* PX_RESTRICT boxes_YZ,
+														const ABP_Index* PX_RESTRICT remap,
+														const ABPEntry* PX_RESTRICT objects)
+{
+	completeBoxPruningKernel(0, nb, nb, boxes_X, boxes_YZ, remap, pairManager, objects);
+}
+
+static PX_FORCE_INLINE void addCompletePass(ABP_PruningPasses& passes, PxU32 nb,
+											const SIMD_AABB_X4* PX_RESTRICT boxes_X, const SIMD_AABB_YZ4* PX_RESTRICT boxes_YZ, const ABP_Index* PX_RESTRICT remap)
+{
+	ABP_PruningPass& pass = passes.mPasses.insert();
+	pass.mBoxes0_X = pass.mBoxes1_X = boxes_X;
+	pass.mBoxes0_YZ = pass.mBoxes1_YZ = boxes_YZ;
+	pass.mRemap0 = pass.mRemap1 = remap;
+	pass.mNb0 = pass.mNb1 = nb;
+	pass.mType = ABP_PruningPass::eCOMPLETE;
+}
+
+static void addBipartitePasses(	ABP_PruningPasses& passes, PxU32 nb0, PxU32 nb1,
+								const SIMD_AABB_X4* PX_RESTRICT boxes0_X, const SIMD_AABB_X4* PX_RESTRICT boxes1_X,
+								const SIMD_AABB_YZ4* PX_RESTRICT boxes0_YZ, const SIMD_AABB_YZ4* PX_RESTRICT boxes1_YZ,
+								const ABP_Index* PX_RESTRICT remap0, const ABP_Index* PX_RESTRICT remap1)
+{
+	PX_ASSERT(boxes0_X[nb0].isSentinel());
+	PX_ASSERT(boxes1_X[nb1].isSentinel());
+
+	ABP_PruningPass& pass0 = passes.mPasses.insert();
+	pass0.mBoxes0_X = boxes0_X;		pass0.mBoxes1_X = boxes1_X;
+	pass0.mBoxes0_YZ = boxes0_YZ;	pass0.mBoxes1_YZ = boxes1_YZ;
+	pass0.mRemap0 = remap0;			pass0.mRemap1 = remap1;
+	pass0.mNb0 = nb0;				pass0.mNb1 = nb1;
+	pass0.mType = ABP_PruningPass::eBIPARTITE_0;
+
+	ABP_PruningPass& pass1 = passes.mPasses.insert();
+	pass1.mBoxes0_X = boxes1_X;		pass1.mBoxes1_X = boxes0_X;
+	pass1.mBoxes0_YZ = boxes1_YZ;	pass1.mBoxes1_YZ = boxes0_YZ;
+	pass1.mRemap0 = remap1;			pass1.mRemap1 = remap0;
+	pass1.mNb0 = nb1;				pass1.mNb1 = nb0;
+	pass1.mType = ABP_PruningPass::eBIPARTITE_1;
+}
+
+static PX_FORCE_INLINE void addBipartitePasses(ABP_PruningPasses& passes, PxU32 nb0, PxU32 nb1, const SplitBoxes& boxes0, const SplitBoxes& boxes1,
+												const ABP_Index* PX_RESTRICT remap0, const ABP_Index* PX_RESTRICT remap1)
+{
+	addBipartitePasses(passes, nb0, nb1, boxes0.getBoxes_X(), boxes1.getBoxes_X(), boxes0.getBoxes_YZ(), boxes1.getBoxes_YZ(), remap0, remap1);
+}
+
+// PT: runs boxes [start;end[ of the pass' outer loop
+template<class PairManagerT>
+static void runPruningPass(const ABP_PruningPass& pass, PxU32 start, PxU32 end, PairManagerT* PX_RESTRICT pairManager, const ABPEntry* PX_RESTRICT objects)
+{
+	if(pass.mType==ABP_PruningPass::eCOMPLETE)
+		completeBoxPruningKernel(start, end, pass.mNb0, pass.mBoxes0_X, pass.mBoxes0_YZ, pass.mRemap0, pairManager, objects);
+	else if(pass.mType==ABP_PruningPass::eBIPARTITE_0)
+		boxPruningKernel<0>(start, end, pass.mNb1, pass.mBoxes0_X, pass.mBoxes1_X, pass.mBoxes0_YZ, pass.mBoxes1_YZ, pass.mRemap0, pass.mRemap1, pairManager, objects);
+	else
+		boxPruningKernel<1>(start, end, pass.mNb1, pass.mBoxes0_X, pass.mBoxes1_X, pass.mBoxes0_YZ, pass.mBoxes1_YZ, pass.mRemap0, pass.mRemap1, pairManager, objects);
+}
+
 #ifdef USE_ABP_BUCKETS
 static const PxU8 gCodes[] = {	4, 4, 4, 255, 4, 3, 2, 255,
 								4, 1, 0, 255, 255, 255, 255, 255 };
@@ -2395,15 +2617,15 @@ static void CompleteBoxPruning_Recursive(
 #endif
 
 #ifndef USE_ALTERNATIVE_VERSION
+// PT: the buckets are kept alive in the passes' memory until the passes have been run
 static void CompleteBoxPruning_Version16(
 	ABP_MM& memoryManager,
 	const PxBounds3& updatedBounds,
-	ABP_PairManager* PX_RESTRICT pairManager,
+	ABP_PruningPasses& passes,
 	PxU32 nb,
 	const SIMD_AABB_X4* PX_RESTRICT listX,
 	const SIMD_AABB_YZ4* PX_RESTRICT listYZ,
-	const ABP_Index* PX_RESTRICT remap,
-	const ABPEntry* PX_RESTRICT objects)
+	const ABP_Index* PX_RESTRICT remap)
 {
 	if(!nb)
 		return;
@@ -2482,31 +2704,13 @@ static void CompleteBoxPruning_Version16(
 
 	{
 		for(PxU32 i=0;i<NB_BUCKETS;i++)
-		{
-#ifdef RECURSE_LIMIT
-			if(Counters[i]<RECURSE_LIMIT || Counters[i]==nb)
-#endif
-				doCompleteBoxPruning_Leaf(	pairManager,
-										Counters[i],
-										BoxListX[i], BoxListYZ[i],
-										RemapBase[i],
-										objects);
-#ifdef RECURSE_LIMIT
-			else
-				CompleteBoxPruning_Recursive(memoryManager, pairManager,
-										Counters[i],
-										BoxListX[i], BoxListYZ[i],
-										RemapBase[i],
-										objects);
-#endif
-
-		}
+			addCompletePass(passes, Counters[i], BoxListX[i], BoxListYZ[i], RemapBase[i]);
 	}
 
 	{
 		for(PxU32 i=0;i<NB_BUCKETS-1;i++)
 		{
-			doBipartiteBoxPruning_Leaf(pairManager, objects,
+			addBipartitePasses(passes,
 				Counters[i], Counters[NB_BUCKETS-1],
 				BoxListX[i], BoxListX[NB_BUCKETS-1], BoxListYZ[i], BoxListYZ[NB_BUCKETS-1],
 				RemapBase[i], RemapBase[NB_BUCKETS-1]
@@ -2514,9 +2718,9 @@ static void CompleteBoxPruning_Version16(
 		}
 	}
 
-	memoryManager.frameFree(Remap);
-	memoryManager.frameFree(BoxListYZBuffer);
-	memoryManager.frameFree(BoxListXBuffer);
+	passes.mMemory.pushBack(BoxListXBuffer);
+	passes.mMemory.pushBack(BoxListYZBuffer);
+	passes.mMemory.pushBack(Remap);
 }
 #endif
 #endif
@@ -2660,7 +2864,7 @@ static void CompleteBoxPruning_Version16(
 }
 #endif
 
-static void doCompleteBoxPruning_(ABP_MM& memoryManager, ABP_PairManager* PX_RESTRICT pairManager, const ABPEntry* PX_RESTRICT objects, const DynamicManager& mDBM)
+static void doCompleteBoxPruning_(ABP_MM& memoryManager, ABP_PruningPasses& passes, const DynamicManager& mDBM)
 {
 	const PxU32 nbUpdated = mDBM.getNbUpdatedBoxes();
 	if(!nbUpdated)
@@ -2674,10 +2878,10 @@ static void doCompleteBoxPruning_(ABP_MM& memoryManager, ABP_PairManager* PX_RES
 	// PT: find sleeping-dynamics-vs-active-dynamics overlaps
 	if(nbNonUpdated)
 	{
-		doBipartiteBoxPruning_Leaf(	pairManager, objects,
-								nbUpdated, nbNonUpdated,
-								updatedBoxes, mDBM.getSleepingBoxes(),
-								mDBM.getRemap_Updated(), mDBM.getRemap_Sleeping());
+		addBipartitePasses(	passes,
+							nbUpdated, nbNonUpdated,
+							updatedBoxes, mDBM.getSleepingBoxes(),
+							mDBM.getRemap_Updated(), mDBM.getRemap_Sleeping());
 	}
 
 	///////
@@ -2688,16 +2892,16 @@ static void doCompleteBoxPruning_(ABP_MM& memoryManager, ABP_PairManager* PX_RES
 		PX_UNUSED(memoryManager);
 #ifdef USE_ABP_BUCKETS
 		if(nbUpdated>USE_ABP_BUCKETS)
-			CompleteBoxPruning_Version16(memoryManager, mDBM.getUpdatedBounds(), pairManager, nbUpdated,
+			CompleteBoxPruning_Version16(memoryManager, mDBM.getUpdatedBounds(), passes, nbUpdated,
 								updatedDynamicBoxes_X,
 								updatedDynamicBoxes_YZ,
-								mDBM.getRemap_Updated(), objects);
+								mDBM.getRemap_Updated());
 		else
 #endif
-			doCompleteBoxPruning_Leaf(pairManager, nbUpdated,
+			addCompletePass(passes, nbUpdated,
 								updatedDynamicBoxes_X,
 								updatedDynamicBoxes_YZ,
-								mDBM.getRemap_Updated(), objects);
+								mDBM.getRemap_Updated());
 	}
 }
 
@@ -2722,14 +2926,23 @@ void ABP::Region_prepareOverlaps()
 	mRS.reset();
 }
 
+// PT: multithreaded version of Region_prepareOverlaps(), called for each box manager from a different task. The managers
+// sort and write the boxes they own, and the entries of mABP_Objects for these boxes, so they can run concurrently.
+void ABP::Region_prepareBoxes(FilterType::Enum type)
+{
+	BoxManager& bm = type==FilterType::STATIC ? mSBM : type==FilterType::KINEMATIC ? mKBM : mDBM;
+	if(bm.isThereWorkToDo())
+		bm.prepareData(mRS, mShared.mABP_Objects, mShared.mABP_Objects_Capacity, mMM);
+}
+
 // Finds static-vs-dynamic and dynamic-vs-dynamic overlaps
-static void findAllOverlaps(ABP_MM& memoryManager, ABP_PairManager& pairManager, const ABP_SharedData& mShared, const StaticManager& mSBM, const DynamicManager& mDBM, bool doComplete, bool doBipartite)
+static void findAllOverlaps(ABP_MM& memoryManager, ABP_PruningPasses& passes, const StaticManager& mSBM, const DynamicManager& mDBM, bool doComplete, bool doBipartite)
 {
 	const PxU32 nbUpdatedBoxes = mDBM.getNbUpdatedBoxes();
 
 	// PT: find dynamics-vs-dynamics overlaps
 	if(doComplete)
-		doCompleteBoxPruning_(memoryManager, &pairManager, mShared.mABP_Objects, mDBM);
+		doCompleteBoxPruning_(memoryManager, passes, mDBM);
 
 	// PT: find dynamics-vs-statics overlaps
 	if(doBipartite)
@@ -2739,39 +2952,40 @@ static void findAllOverlaps(ABP_MM& memoryManager, ABP_PairManager& pairManager,
 		{
 			if(mSBM.getNbUpdatedBoxes())
 			{
-				doBipartiteBoxPruning_Leaf(	&pairManager, mShared.mABP_Objects,
-										nbUpdatedBoxes, mSBM.getNbUpdatedBoxes(),
-										mDBM.getUpdatedBoxes(), mSBM.getUpdatedBoxes(),
-										mDBM.getRemap_Updated(), mSBM.getRemap_Updated()
-									);
+				addBipartitePasses(	passes,
+								nbUpdatedBoxes, mSBM.getNbUpdatedBoxes(),
+								mDBM.getUpdatedBoxes(), mSBM.getUpdatedBoxes(),
+								mDBM.getRemap_Updated(), mSBM.getRemap_Updated()
+							);
 			}
 			if(mSBM.getNbNonUpdatedBoxes())
 			{
-				doBipartiteBoxPruning_Leaf(	&pairManager, mShared.mABP_Objects,
-										nbUpdatedBoxes, mSBM.getNbNonUpdatedBoxes(),
-										mDBM.getUpdatedBoxes(), mSBM.getSleepingBoxes(),
-										mDBM.getRemap_Updated(), mSBM.getRemap_Sleeping()
-									);
+				addBipartitePasses(	passes,
+								nbUpdatedBoxes, mSBM.getNbNonUpdatedBoxes(),
+								mDBM.getUpdatedBoxes(), mSBM.getSleepingBoxes(),
+								mDBM.getRemap_Updated(), mSBM.getRemap_Sleeping()
+							);
 			}
 		}
 
 		// PT: TODO: refactor this with kinematic stuff, etc.... bit tedious
 		if(mSBM.getNbUpdatedBoxes() && mDBM.getNbNonUpdatedBoxes())
 		{
-			doBipartiteBoxPruning_Leaf(	&pairManager, mShared.mABP_Objects,
-									mDBM.getNbNonUpdatedBoxes(), mSBM.getNbUpdatedBoxes(),
-									mDBM.getSleepingBoxes(), mSBM.getUpdatedBoxes(),
-									mDBM.getRemap_Sleeping(), mSBM.getRemap_Updated()
-								);
+			addBipartitePasses(	passes,
+							mDBM.getNbNonUpdatedBoxes(), mSBM.getNbUpdatedBoxes(),
+							mDBM.getSleepingBoxes(), mSBM.getUpdatedBoxes(),
+							mDBM.getRemap_Sleeping(), mSBM.getRemap_Updated()
+						);
 		}
 
 	}
 }
 
-void ABP::Region_findOverlaps(ABP_PairManager& pairManager)
+void ABP::Region_gatherPruningPasses()
 {
-	if(!gPrepareOverlapsFlag)
-		Region_prepareOverlaps();
+	PX_ASSERT(!mPruningPasses.mPasses.size());
+
+	ABP_PruningPasses& passes = mPruningPasses;
 
 	bool doKineKine = true;
 	bool doStaticKine = true;
@@ -2783,8 +2997,8 @@ void ABP::Region_findOverlaps(ABP_PairManager& pairManager)
 	}
 	#endif
 
-	findAllOverlaps(mMM, pairManager, mShared, mSBM, mDBM, true, true);
-	findAllOverlaps(mMM, pairManager, mShared, mSBM, mKBM, doKineKine, doStaticKine);
+	findAllOverlaps(mMM, passes, mSBM, mDBM, true, true);
+	findAllOverlaps(mMM, passes, mSBM, mKBM, doKineKine, doStaticKine);
 
 	const PxU32 nbUpdatedDynamics = mDBM.getNbUpdatedBoxes();
 	const PxU32 nbNonUpdatedDynamics = mDBM.getNbNonUpdatedBoxes();
@@ -2796,32 +3010,98 @@ void ABP::Region_findOverlaps(ABP_PairManager& pairManager)
 		// Active dynamics vs active kinematics
 		if(nbUpdatedKinematics)
 		{
-			doBipartiteBoxPruning_Leaf(	&pairManager, mShared.mABP_Objects,
-									nbUpdatedDynamics, nbUpdatedKinematics,
-									mDBM.getUpdatedBoxes(), mKBM.getUpdatedBoxes(),
-									mDBM.getRemap_Updated(), mKBM.getRemap_Updated()
-								);
+			addBipartitePasses(	passes,
+							nbUpdatedDynamics, nbUpdatedKinematics,
+							mDBM.getUpdatedBoxes(), mKBM.getUpdatedBoxes(),
+							mDBM.getRemap_Updated(), mKBM.getRemap_Updated()
+						);
 		}
 		// Active dynamics vs inactive kinematics
 		if(nbNonUpdatedKinematics)
 		{
-			doBipartiteBoxPruning_Leaf(	&pairManager, mShared.mABP_Objects,
-									nbUpdatedDynamics, nbNonUpdatedKinematics,
-									mDBM.getUpdatedBoxes(), mKBM.getSleepingBoxes(),
-									mDBM.getRemap_Updated(), mKBM.getRemap_Sleeping()
-								);
+			addBipartitePasses(	passes,
+							nbUpdatedDynamics, nbNonUpdatedKinematics,
+							mDBM.getUpdatedBoxes(), mKBM.getSleepingBoxes(),
+							mDBM.getRemap_Updated(), mKBM.getRemap_Sleeping()
+						);
 		}
 	}
 
 	if(nbUpdatedKinematics && nbNonUpdatedDynamics)
 	{
 		// Inactive dynamics vs active kinematics
-		doBipartiteBoxPruning_Leaf(	&pairManager, mShared.mABP_Objects,
-								nbNonUpdatedDynamics, nbUpdatedKinematics,
-								mDBM.getSleepingBoxes(), mKBM.getUpdatedBoxes(),
-								mDBM.getRemap_Sleeping(), mKBM.getRemap_Updated()
-							);
+		addBipartitePasses(	passes,
+						nbNonUpdatedDynamics, nbUpdatedKinematics,
+						mDBM.getSleepingBoxes(), mKBM.getUpdatedBoxes(),
+						mDBM.getRemap_Sleeping(), mKBM.getRemap_Updated()
+					);
 	}
+}
+
+void ABP::Region_runPruningPasses(ABP_PairManager& pairManager)
+{
+	const ABP_PruningPass* PX_RESTRICT passes = mPruningPasses.mPasses.begin();
+	const PxU32 nbPasses = mPruningPasses.mPasses.size();
+	for(PxU32 i=0;i<nbPasses;i++)
+		runPruningPass(passes[i], 0, passes[i].mNb0, &pairManager, mShared.mABP_Objects);
+}
+
+void ABP::Region_findOverlaps(ABP_PairManager& pairManager)
+{
+	if(!gPrepareOverlapsFlag)
+		Region_prepareOverlaps();
+
+	Region_gatherPruningPasses();
+	Region_runPruningPasses(pairManager);
+	Region_finalize();
+}
+
+// PT: task taskIndex runs the same slice of the outer loop of each pass. The slices only depend on the number of tasks.
+void ABP::Region_runPruningTask(PxU32 taskIndex, PxU32 nbTasks)
+{
+	ABP_PairBuffer& buffer = mPairBuffers[taskIndex];
+	buffer.mPairs.clear();
+	buffer.mPassEnds.clear();
+	buffer.mGroups = mPairManager.mGroups;
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+	buffer.mLUT = mPairManager.mLUT;
+#endif
+
+	const ABP_PruningPass* PX_RESTRICT passes = mPruningPasses.mPasses.begin();
+	const PxU32 nbPasses = mPruningPasses.mPasses.size();
+	buffer.mPassEnds.reserve(nbPasses);
+	for(PxU32 i=0;i<nbPasses;i++)
+	{
+		const ABP_PruningPass& pass = passes[i];
+		const PxU32 start = PxU32((PxU64(pass.mNb0)*taskIndex)/nbTasks);
+		const PxU32 end = PxU32((PxU64(pass.mNb0)*(taskIndex+1))/nbTasks);
+		runPruningPass(pass, start, end, &buffer, mShared.mABP_Objects);
+		buffer.mPassEnds.pushBack(buffer.mPairs.size());
+	}
+}
+
+// PT: adds the overlaps of the pruning tasks to the pair manager pass by pass, and for each pass slice by slice. This is the
+// order in which Region_runPruningPasses() finds them, so the created pairs are the same and in the same order whatever
+// the number of tasks.
+void ABP::Region_mergePairBuffers(PxU32 nbTasks)
+{
+	const PxU32 nbPasses = mPruningPasses.mPasses.size();
+	for(PxU32 i=0;i<nbPasses;i++)
+	{
+		for(PxU32 j=0;j<nbTasks;j++)
+		{
+			const ABP_PairBuffer& buffer = mPairBuffers[j];
+			const BroadPhasePair* PX_RESTRICT pairs = buffer.mPairs.begin();
+			const PxU32 end = buffer.mPassEnds[i];
+			for(PxU32 k=i ? buffer.mPassEnds[i-1] : 0;k<end;k++)
+				mPairManager.addPairInternal(pairs[k].mVolA, pairs[k].mVolB);
+		}
+	}
+}
+
+void ABP::Region_finalize()
+{
+	mPruningPasses.release(mMM);
 
 	mSBM.finalize();
 	mDBM.finalize();
@@ -3058,6 +3338,11 @@ void ABP::reset()
 	PX_DELETE_ARRAY(mShared.mABP_Objects);
 	mShared.mABP_Objects_Capacity = 0;
 	mPairManager.purge();
+	for(PxU32 i=0;i<ABP_MAX_NB_TASKS;i++)
+	{
+		mPairBuffers[i].mPairs.reset();
+		mPairBuffers[i].mPassEnds.reset();
+	}
 	mShared.mUpdatedObjects.empty();
 	mShared.mRemovedObjects.empty();
 }
@@ -3089,23 +3374,38 @@ void ABP::setTransientData(const PxBounds3* bounds, const PxReal* contactDistanc
 using namespace internalABP;
 
 #define DEFAULT_CREATED_DELETED_PAIRS_CAPACITY 1024
+#define ABP_MIN_NB_BOXES_PER_TASK	256	// PT: don't spawn pruning tasks for less than that number of boxes each
 
 BroadPhaseABP::BroadPhaseABP(	PxU32 maxNbBroadPhaseOverlaps,
 								PxU32 maxNbStaticShapes,
 								PxU32 maxNbDynamicShapes,
-								PxU64 /*contextID*/) :
-	mGroups		(NULL)
+								PxU64 contextID,
+								bool persistentPairs) :
+	mPersistentPairs	(persistentPairs),
+	mGroups				(NULL),
 #ifdef BP_FILTERING_USES_TYPE_IN_GROUP
-	,mLUT		(NULL)
+	mLUT				(NULL),
 #endif
+	mUpdateWorkTask		(contextID),
+	mPostUpdateWorkTask	(contextID),
+	mNbCpuTasks			(0),
+	mNbPruningTasks		(0)
 {
+	for(PxU32 i=0;i<FilterType::AGGREGATE;i++)
+		mPrepareTasks[i].setContextId(contextID);
+	for(PxU32 i=0;i<ABP_MAX_NB_TASKS;i++)
+		mPruningTasks[i].setContextId(contextID);
+
 	mABP = PX_NEW(ABP)();
 
 	const PxU32 nbObjects = maxNbStaticShapes + maxNbDynamicShapes;
 	mABP->preallocate(nbObjects, maxNbBroadPhaseOverlaps);
+	mABP->mPairManager.mPersistent = persistentPairs;
 
-	mCreated.reserve(DEFAULT_CREATED_DELETED_PAIRS_CAPACITY);
-	mDeleted.reserve(DEFAULT_CREATED_DELETED_PAIRS_CAPACITY);
+	// PT: in persistent mode the created/deleted arrays are sized for the expected number of overlaps, and never shrink
+	const PxU32 pairsCapacity = persistentPairs ? PxMax(maxNbBroadPhaseOverlaps, PxU32(DEFAULT_CREATED_DELETED_PAIRS_CAPACITY)) : DEFAULT_CREATED_DELETED_PAIRS_CAPACITY;
+	mCreated.reserve(pairsCapacity);
+	mDeleted.reserve(pairsCapacity);
 }
 
 BroadPhaseABP::~BroadPhaseABP()
@@ -3113,7 +3413,7 @@ BroadPhaseABP::~BroadPhaseABP()
 	DELETESINGLE(mABP);
 }
 
-void BroadPhaseABP::update(const PxU32 /*numCpuTasks*/, PxcScratchAllocator* scratchAllocator, const BroadPhaseUpdateData& updateData, physx::PxBaseTask* /*continuation*/, physx::PxBaseTask* narrowPhaseUnblockTask)
+void BroadPhaseABP::update(const PxU32 numCpuTasks, PxcScratchAllocator* scratchAllocator, const BroadPhaseUpdateData& updateData, physx::PxBaseTask* continuation, physx::PxBaseTask* narrowPhaseUnblockTask)
 {
 #if PX_CHECKED
 	PX_CHECK_AND_RETURN(scratchAllocator, "BroadPhaseABP::update - scratchAllocator must be non-NULL \n");
@@ -3124,10 +3424,78 @@ void BroadPhaseABP::update(const PxU32 /*numCpuTasks*/, PxcScratchAllocator* scr
 	if(narrowPhaseUnblockTask)
 		narrowPhaseUnblockTask->removeReference();
 
-	setUpdateData(updateData);
+	if(numCpuTasks<2 || !continuation)
+	{
+		setUpdateData(updateData);
 
-	update();
-	postUpdate();
+		update();
+		postUpdate();
+		return;
+	}
+
+	// PT: the boxes are prepared by the prepare tasks, in parallel
+	setUpdateData(updateData, false);
+
+	mNbCpuTasks = PxMin(numCpuTasks, PxU32(ABP_MAX_NB_TASKS));
+
+	mPostUpdateWorkTask.set(this, 0);
+	mUpdateWorkTask.set(this, 0);
+
+	mPostUpdateWorkTask.setContinuation(continuation);
+	mUpdateWorkTask.setContinuation(&mPostUpdateWorkTask);
+	for(PxU32 i=0;i<FilterType::AGGREGATE;i++)
+	{
+		mPrepareTasks[i].set(this, i);
+		mPrepareTasks[i].setContinuation(&mUpdateWorkTask);
+	}
+
+	mPostUpdateWorkTask.removeReference();
+	mUpdateWorkTask.removeReference();
+	for(PxU32 i=0;i<FilterType::AGGREGATE;i++)
+		mPrepareTasks[i].removeReference();
+}
+
+void BroadPhaseABP::prepareBoxes(PxU32 filterType)
+{
+	mABP->Region_prepareBoxes(FilterType::Enum(filterType));
+}
+
+void BroadPhaseABP::startPruningTasks(PxBaseTask* continuation)
+{
+	mABP->mRS.reset();
+
+	mABP->mPairManager.mGroups = mGroups;
+#ifdef BP_FILTERING_USES_TYPE_IN_GROUP
+	mABP->mPairManager.mLUT = mLUT;
+#endif
+	mABP->Region_gatherPruningPasses();
+
+	PxU32 nbBoxes = 0;
+	const PxU32 nbPasses = mABP->mPruningPasses.mPasses.size();
+	for(PxU32 i=0;i<nbPasses;i++)
+		nbBoxes += mABP->mPruningPasses.mPasses[i].mNb0;
+
+	const PxU32 nbTasks = PxMin(mNbCpuTasks, nbBoxes/ABP_MIN_NB_BOXES_PER_TASK);
+	if(nbTasks<2)
+	{
+		mABP->Region_runPruningPasses(mABP->mPairManager);
+		mABP->Region_finalize();
+		return;
+	}
+
+	// PT: the pair buffers are merged and the passes released in postUpdate()
+	mNbPruningTasks = nbTasks;
+	for(PxU32 i=0;i<nbTasks;i++)
+	{
+		mPruningTasks[i].set(this, i);
+		mPruningTasks[i].setContinuation(continuation);
+		mPruningTasks[i].removeReference();
+	}
+}
+
+void BroadPhaseABP::runPruningTask(PxU32 taskIndex)
+{
+	mABP->Region_runPruningTask(taskIndex, mNbPruningTasks);
 }
 
 void BroadPhaseABP::singleThreadedUpdate(PxcScratchAllocator* scratchAllocator, const BroadPhaseUpdateData& updateData)
@@ -3240,7 +3608,7 @@ void BroadPhaseABP::addObjects(const BroadPhaseUpdateData& updateData)
 		mABP->addDynamicObjects(dynamics.mIndices, dynamics.mNb, dynamics.mMaxIndex);
 }
 
-void BroadPhaseABP::setUpdateData(const BroadPhaseUpdateData& updateData)
+void BroadPhaseABP::setUpdateData(const BroadPhaseUpdateData& updateData, bool prepareOverlaps)
 {
 	mABP->setTransientData(updateData.getAABBs(), updateData.getContactDistance()/*, updateData.getGroups()*/);
 
@@ -3268,7 +3636,7 @@ void BroadPhaseABP::setUpdateData(const BroadPhaseUpdateData& updateData)
 	PX_ASSERT(!mCreated.size());
 	PX_ASSERT(!mDeleted.size());
 
-	if(gPrepareOverlapsFlag)
+	if(gPrepareOverlapsFlag && prepareOverlaps)
 		mABP->Region_prepareOverlaps();
 }
 
@@ -3283,6 +3651,13 @@ void BroadPhaseABP::update()
 
 void BroadPhaseABP::postUpdate()
 {
+	if(mNbPruningTasks)
+	{
+		mABP->Region_mergePairBuffers(mNbPruningTasks);
+		mABP->Region_finalize();
+		mNbPruningTasks = 0;
+	}
+
 	mABP->finalize(this);
 }
 
@@ -3306,10 +3681,10 @@ BroadPhasePair* BroadPhaseABP::getDeletedPairs()
 	return mDeleted.begin();
 }
 
-static void freeBuffer(Ps::Array<BroadPhasePair>& buffer)
+static void freeBuffer(Ps::Array<BroadPhasePair>& buffer, bool persistent)
 {
 	const PxU32 size = buffer.size();
-	if(size>DEFAULT_CREATED_DELETED_PAIRS_CAPACITY)
+	if(!persistent && size>DEFAULT_CREATED_DELETED_PAIRS_CAPACITY)
 	{
 		buffer.reset();
 		buffer.reserve(DEFAULT_CREATED_DELETED_PAIRS_CAPACITY);
@@ -3323,8 +3698,14 @@ static void freeBuffer(Ps::Array<BroadPhasePair>& buffer)
 void BroadPhaseABP::freeBuffers()
 {
 	mABP->freeBuffers();
-	freeBuffer(mCreated);
-	freeBuffer(mDeleted);
+	freeBuffer(mCreated, mPersistentPairs);
+	freeBuffer(mDeleted, mPersistentPairs);
+}
+
+bool BroadPhaseABP::getPairStatistics(PxBroadPhasePairStatistics& stats) const
+{
+	mABP->mPairManager.getStatistics(stats);
+	return true;
 }
 
 #if PX_CHECKED
@@ -3396,8 +3777,9 @@ BroadPhase* createABP(
 	const PxU32 maxNbBroadPhaseOverlaps,
 	const PxU32 maxNbStaticShapes,
 	const PxU32 maxNbDynamicShapes,
-	PxU64 contextID)
+	PxU64 contextID,
+	bool persistentPairs)
 {
-	return PX_NEW(BroadPhaseABP)(maxNbBroadPhaseOverlaps, maxNbStaticShapes, maxNbDynamicShapes, contextID);
+	return PX_NEW(BroadPhaseABP)(maxNbBroadPhaseOverlaps, maxNbStaticShapes, maxNbDynamicShapes, contextID, persistentPairs);
 }
 
@@ -35,6 +35,7 @@
 #include "PxPhysXConfig.h"
 #include "BpBroadPhaseUpdate.h"
 #include "PsUserAllocated.h"
+#include "BpABPTasks.h"
 
 namespace internalABP{
 	class ABP;
@@ -51,9 +52,14 @@ namespace Bp
 											BroadPhaseABP(	PxU32 maxNbBroadPhaseOverlaps,
 															PxU32 maxNbStaticShapes,
 															PxU32 maxNbDynamicShapes,
-															PxU64 contextID);
+															PxU64 contextID,
+															bool persistentPairs);
 		virtual								~BroadPhaseABP();
 
+	// BroadPhaseBase
+		virtual	bool						getPairStatistics(PxBroadPhasePairStatistics& stats)	const;
+	//~BroadPhaseBase
+
 	// BroadPhase
 		virtual	PxBroadPhaseType::Enum		getType()					const	{ return PxBroadPhaseType::eABP;	}
 		virtual	void						destroy()							{ delete this;						}
@@ -77,12 +83,13 @@ namespace Bp
 
 				Ps::Array<BroadPhasePair>	mCreated;
 				Ps::Array<BroadPhasePair>	mDeleted;
+				const bool					mPersistentPairs;	// See PxSceneFlag::eENABLE_PERSISTENT_BROADPHASE_PAIRS
 
 				const Bp::FilterGroup::Enum*mGroups;
 #ifdef BP_FILTERING_USES_TYPE_IN_GROUP
 				const bool*					mLUT;
 #endif
-				void						setUpdateData(const BroadPhaseUpdateData& updateData);
+				void						setUpdateData(const BroadPhaseUpdateData& updateData, bool prepareOverlaps = true);
 				void						addObjects(const BroadPhaseUpdateData& updateData);
 				void						removeObjects(const BroadPhaseUpdateData& updateData);
 				void						updateObjects(const BroadPhaseUpdateData& updateData);
@@ -90,6 +97,18 @@ namespace Bp
 				void						update();
 				void						postUpdate();
 
+				// PT: multithreaded update, see BpABPTasks.h
+				void						prepareBoxes(PxU32 filterType);
+				void						startPruningTasks(physx::PxBaseTask* continuation);
+				void						runPruningTask(PxU32 taskIndex);
+
+				ABPPrepareTask				mPrepareTasks[FilterType::AGGREGATE];	// Indexed by FilterType, aggregates are dynamic objects here
+				ABPUpdateWorkTask			mUpdateWorkTask;
+				ABPPruningTask				mPruningTasks[ABP_MAX_NB_TASKS];
+				ABPPostUpdateWorkTask		mPostUpdateWorkTask;
+				PxU32						mNbCpuTasks;
+				PxU32						mNbPruningTasks;	// Number of pruning tasks of the current update, 0 if the pruning ran single-threaded
+
 				PxU32						getCurrentNbPairs()	const;
 				void						setScratchAllocator(PxcScratchAllocator* scratchAllocator);
 	};
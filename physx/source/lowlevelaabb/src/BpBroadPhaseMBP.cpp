@@ -29,6 +29,7 @@
 
 #include "BpBroadPhaseMBP.h"
 #include "BpBroadPhaseShared.h"
+#include "BpBoxPruningKernels.h"
 #include "CmRadixSortBuffered.h"
 #include "PsUtilities.h"
 #include "PsFoundation.h"
@@ -40,6 +41,11 @@ using namespace physx::shdfnd::aos;
 #define USE_FULLY_INSIDE_FLAG
 //#define MBP_USE_NO_CMP_OVERLAP_3D	// Seems slower
 
+#if defined(BP_WIDE_BOX_PRUNING) && defined(MBP_SIMD_OVERLAP)
+	#define MBP_WIDE_BOX_PRUNING
+	#define MBP_MIN_NB_WIDE_CANDIDATES	8	// PT: the wide kernels are only used for boxes overlapping at least that number of candidates along X
+#endif
+
 //HWSCAN: reverse bits in fully-inside-flag bitmaps because the code gives us indices for which bits are set (and we want the opposite)
 #define HWSCAN
 
@@ -1223,6 +1229,40 @@ static PX_FORCE_INLINE void outputPair(	MBP_PairManager& pairManager,
 	pairManager.addPair(id0, id1);
 }
 
+#ifdef MBP_WIDE_BOX_PRUNING
+// PT: returns true if the wide kernels should be used for the candidates starting at index1, i.e. if there are enough of them
+static PX_FORCE_INLINE bool useWideKernel(MBPWideKernel wideKernel, PxU32 index1, PxU32 nb1, const MBP_AABB* PX_RESTRICT boxes1, PxU32 limit)
+{
+	return wideKernel && index1+MBP_MIN_NB_WIDE_CANDIDATES<=nb1 && boxes1[index1+MBP_MIN_NB_WIDE_CANDIDATES-1].mMinX<=limit;
+}
+
+// PT: 'swapped' is true when the candidates are the first objects of the pairs
+static PX_NOINLINE void outputWideOverlaps(	MBP_PairManager& pairManager, MBPWideKernel wideKernel, PxU32 index0, PxU32 index1, PxU32 nb1,
+											const MBP_AABB& box0, const MBP_AABB* PX_RESTRICT boxes1,
+											const MBP_Index* PX_RESTRICT inToOut0, const MBP_Index* PX_RESTRICT inToOut1,
+											const MBPEntry* PX_RESTRICT objects, bool swapped)
+{
+	PxU32 overlaps[BP_WIDE_MAX_NB_OVERLAPS];
+	bool done;
+	do
+	{
+		PxU32 nbOverlaps;
+		done = wideKernel(box0, index1, nb1, boxes1, overlaps, nbOverlaps);
+		if(swapped)
+		{
+			for(PxU32 i=0;i<nbOverlaps;i++)
+				outputPair(pairManager, overlaps[i], index0, inToOut0, inToOut1, objects);
+		}
+		else
+		{
+			for(PxU32 i=0;i<nbOverlaps;i++)
+				outputPair(pairManager, index0, overlaps[i], inToOut0, inToOut1, objects);
+		}
+	}
+	while(!done);
+}
+#endif
+
 MBPOS_TmpBuffers::MBPOS_TmpBuffers() :
 	mNbSleeping					(0),
 	mNbUpdated					(0),
@@ -1471,6 +1511,9 @@ static void doCompleteBoxPruning(MBP_PairManager* PX_RESTRICT pairManager, const
 	const MBP_Index* PX_RESTRICT inToOut_Dynamic_Sleeping	= input.mInToOut_Dynamic_Sleeping;
 	const PxU32 nbUpdated 									= input.mNbUpdated;
 	const PxU32 nbNonUpdated								= input.mNbNonUpdated;
+#ifdef MBP_WIDE_BOX_PRUNING
+	const MBPWideKernel wideKernel							= getMBPWideKernel();
+#endif
 
 	//
 
@@ -1494,15 +1537,22 @@ static void doCompleteBoxPruning(MBP_PairManager* PX_RESTRICT pairManager, const
 			while(sleepingDynamicBoxes[runningIndex1].mMinX<l)
 				runningIndex1++;
 
-			PxU32 index1 = runningIndex1;
-
-			while(sleepingDynamicBoxes[index1].mMinX<=limit)
+#ifdef MBP_WIDE_BOX_PRUNING
+			if(useWideKernel(wideKernel, runningIndex1, nb1, sleepingDynamicBoxes, limit))
+				outputWideOverlaps(*pairManager, wideKernel, index0, runningIndex1, nb1, box0, sleepingDynamicBoxes, inToOut_Dynamic, inToOut_Dynamic_Sleeping, objects, false);
+			else
+#endif
 			{
-				MBP_OVERLAP_TEST(sleepingDynamicBoxes[index1])
+				PxU32 index1 = runningIndex1;
+
+				while(sleepingDynamicBoxes[index1].mMinX<=limit)
 				{
-					outputPair(*pairManager, index0, index1, inToOut_Dynamic, inToOut_Dynamic_Sleeping, objects);
+					MBP_OVERLAP_TEST(sleepingDynamicBoxes[index1])
+					{
+						outputPair(*pairManager, index0, index1, inToOut_Dynamic, inToOut_Dynamic_Sleeping, objects);
+					}
+					index1++;
 				}
-				index1++;
 			}
 			index0++;
 		}
@@ -1521,15 +1571,22 @@ static void doCompleteBoxPruning(MBP_PairManager* PX_RESTRICT pairManager, const
 			while(updatedDynamicBoxes[runningIndex0].mMinX<=l)
 				runningIndex0++;
 
-			PxU32 index1 = runningIndex0;
-
-			while(updatedDynamicBoxes[index1].mMinX<=limit)
+#ifdef MBP_WIDE_BOX_PRUNING
+			if(useWideKernel(wideKernel, runningIndex0, nb0, updatedDynamicBoxes, limit))
+				outputWideOverlaps(*pairManager, wideKernel, index0, runningIndex0, nb0, box0, updatedDynamicBoxes, inToOut_Dynamic, inToOut_Dynamic_Sleeping, objects, true);
+			else
+#endif
 			{
-				MBP_OVERLAP_TEST(updatedDynamicBoxes[index1])
+				PxU32 index1 = runningIndex0;
+
+				while(updatedDynamicBoxes[index1].mMinX<=limit)
 				{
-					outputPair(*pairManager, index1, index0, inToOut_Dynamic, inToOut_Dynamic_Sleeping, objects);
+					MBP_OVERLAP_TEST(updatedDynamicBoxes[index1])
+					{
+						outputPair(*pairManager, index1, index0, inToOut_Dynamic, inToOut_Dynamic_Sleeping, objects);
+					}
+					index1++;
 				}
-				index1++;
 			}
 			index0++;
 		}
@@ -1553,14 +1610,21 @@ static void doCompleteBoxPruning(MBP_PairManager* PX_RESTRICT pairManager, const
 
 		if(runningIndex<nbUpdated)
 		{
-			PxU32 index1 = runningIndex;
-			while(updatedDynamicBoxes[index1].mMinX<=limit)
+#ifdef MBP_WIDE_BOX_PRUNING
+			if(useWideKernel(wideKernel, runningIndex, nbUpdated, updatedDynamicBoxes, limit))
+				outputWideOverlaps(*pairManager, wideKernel, index0, runningIndex, nbUpdated, box0, updatedDynamicBoxes, inToOut_Dynamic, inToOut_Dynamic, objects, false);
+			else
+#endif
 			{
-				MBP_OVERLAP_TEST(updatedDynamicBoxes[index1])
+				PxU32 index1 = runningIndex;
+				while(updatedDynamicBoxes[index1].mMinX<=limit)
 				{
-					outputPair(*pairManager, index0, index1, inToOut_Dynamic, inToOut_Dynamic, objects);
+					MBP_OVERLAP_TEST(updatedDynamicBoxes[index1])
+					{
+						outputPair(*pairManager, index0, index1, inToOut_Dynamic, inToOut_Dynamic, objects);
+					}
+					index1++;
 				}
-				index1++;
 			}
 		}
 		index0++;
@@ -1581,6 +1645,9 @@ static void doBipartiteBoxPruning(MBP_PairManager* PX_RESTRICT pairManager, cons
 	const MBP_AABB* PX_RESTRICT staticBoxes			= input.mStaticBoxes;
 	const MBP_Index* PX_RESTRICT inToOut_Static		= input.mInToOut_Static;
 	const MBP_Index* PX_RESTRICT inToOut_Dynamic	= input.mInToOut_Dynamic;
+#ifdef MBP_WIDE_BOX_PRUNING
+	const MBPWideKernel wideKernel					= getMBPWideKernel();
+#endif
 
 	PX_ASSERT(isSentinel(staticBoxes[nb1]));
 	PX_ASSERT(isSentinel(staticBoxes[nb1+1]));
@@ -1603,15 +1670,22 @@ static void doBipartiteBoxPruning(MBP_PairManager* PX_RESTRICT pairManager, cons
 		while(staticBoxes[runningIndex1].mMinX<l)
 			runningIndex1++;
 
-		PxU32 index1 = runningIndex1;
-
-		while(staticBoxes[index1].mMinX<=limit)
+#ifdef MBP_WIDE_BOX_PRUNING
+		if(useWideKernel(wideKernel, runningIndex1, nb1, staticBoxes, limit))
+			outputWideOverlaps(*pairManager, wideKernel, index0, runningIndex1, nb1, box0, staticBoxes, inToOut_Dynamic, inToOut_Static, mObjects, false);
+		else
+#endif
 		{
-			MBP_OVERLAP_TEST(staticBoxes[index1])
+			PxU32 index1 = runningIndex1;
+
+			while(staticBoxes[index1].mMinX<=limit)
 			{
-				outputPair(*pairManager, index0, index1, inToOut_Dynamic, inToOut_Static, mObjects);
+				MBP_OVERLAP_TEST(staticBoxes[index1])
+				{
+					outputPair(*pairManager, index0, index1, inToOut_Dynamic, inToOut_Static, mObjects);
+				}
+				index1++;
 			}
-			index1++;
 		}
 		index0++;
 	}
@@ -1630,15 +1704,22 @@ static void doBipartiteBoxPruning(MBP_PairManager* PX_RESTRICT pairManager, cons
 		while(dynamicBoxes[runningIndex0].mMinX<=l)
 			runningIndex0++;
 
-		PxU32 index1 = runningIndex0;
-
-		while(dynamicBoxes[index1].mMinX<=limit)
+#ifdef MBP_WIDE_BOX_PRUNING
+		if(useWideKernel(wideKernel, runningIndex0, nb0, dynamicBoxes, limit))
+			outputWideOverlaps(*pairManager, wideKernel, index0, runningIndex0, nb0, box0, dynamicBoxes, inToOut_Dynamic, inToOut_Static, mObjects, true);
+		else
+#endif
 		{
-			MBP_OVERLAP_TEST(dynamicBoxes[index1])
+			PxU32 index1 = runningIndex0;
+
+			while(dynamicBoxes[index1].mMinX<=limit)
 			{
-				outputPair(*pairManager, index1, index0, inToOut_Dynamic, inToOut_Static, mObjects);
+				MBP_OVERLAP_TEST(dynamicBoxes[index1])
+				{
+					outputPair(*pairManager, index1, index0, inToOut_Dynamic, inToOut_Static, mObjects);
+				}
+				index1++;
 			}
-			index1++;
 		}
 		index0++;
 	}
@@ -2601,7 +2682,6 @@ bool MBP::updateObjectAfterRegionRemoval(MBP_Handle handle, Region* removedRegio
 	const MBP_ObjectIndex objectIndex = decodeHandle_Index(handle);
 
 	const PxU32 nbRegions = mNbRegions;
-	PX_UNUSED(nbRegions);
 	const RegionData* PX_RESTRICT regions = mRegions.begin();
 	MBP_Object* PX_RESTRICT objects = mMBP_Objects.begin();
 	MBP_Object& currentObject = objects[objectIndex];
@@ -2639,6 +2719,52 @@ bool MBP::updateObjectAfterRegionRemoval(MBP_Handle handle, Region* removedRegio
 #endif
 
 	PX_ASSERT(nbNewHandles==nbHandles-1);
+
+	// PT: populateNewRegion() skips objects that are fully inside their regions, so an object can overlap a remaining
+	// region without being in it. This happens when a region is replaced by smaller regions covering it, or the other way
+	// around. Instead of reporting the object as out-of-bounds, we add it to the remaining regions it overlaps.
+	if(!nbNewHandles)
+	{
+		MBP_AABB box;
+		for(PxU32 i=0;i<nbHandles;i++)
+		{
+			if(regions[handles[i].mInternalBPHandle].mBP==removedRegion)
+				removedRegion->retrieveBounds(box, handles[i].mHandle);
+		}
+
+		const PxU32 isStatic = decodeHandle_IsStatic(handle);
+#ifdef USE_FULLY_INSIDE_FLAG
+		bool objectIsFullyInsideRegions = true;
+#endif
+		// PT: the removed region's box has already been set to empty, so it is not found here
+		for(PxU32 i=0;i<nbRegions;i++)
+		{
+			if(regions[i].mBox.intersects(box))
+			{
+				PX_ASSERT(regions[i].mBP);
+#ifdef USE_FULLY_INSIDE_FLAG
+				if(!box.isInside(regions[i].mBox))
+					objectIsFullyInsideRegions = false;
+#endif
+				const MBP_Index BPHandle = regions[i].mBP->addObject(box, handle, isStatic!=0);
+				newHandles[nbNewHandles].mHandle = Ps::to16(BPHandle);
+				newHandles[nbNewHandles].mInternalBPHandle = Ps::to16(i);
+				nbNewHandles++;
+			}
+		}
+
+		if(nbNewHandles)
+		{
+			mUpdatedObjects.setBitChecked(objectIndex);
+#ifdef USE_FULLY_INSIDE_FLAG
+			if(objectIsFullyInsideRegions)
+				setBit(mFullyInsideBitmap, objectIndex);
+			else
+				clearBit(mFullyInsideBitmap, objectIndex);
+#endif
+		}
+	}
+
 	purgeHandles(&currentObject, nbHandles);
 	storeHandles(&currentObject, nbNewHandles, newHandles);
 
@@ -2950,11 +3076,13 @@ BroadPhaseMBP::BroadPhaseMBP(	PxU32 maxNbRegions,
 								PxU32 maxNbBroadPhaseOverlaps,
 								PxU32 maxNbStaticShapes,
 								PxU32 maxNbDynamicShapes,
-								PxU64 contextID) :
+								PxU64 contextID,
+								bool persistentPairs) :
 	mMBPUpdateWorkTask		(contextID),
 	mMBPPostUpdateWorkTask	(contextID),
 	mMapping				(NULL),
 	mCapacity				(0),
+	mPersistentPairs		(persistentPairs),
 	mGroups					(NULL)
 #ifdef BP_FILTERING_USES_TYPE_IN_GROUP
 	,mLUT					(NULL)
@@ -2965,11 +3093,15 @@ BroadPhaseMBP::BroadPhaseMBP(	PxU32 maxNbRegions,
 	const PxU32 nbObjects = maxNbStaticShapes + maxNbDynamicShapes;
 	mMBP->preallocate(maxNbRegions, nbObjects, maxNbBroadPhaseOverlaps);
 
+	mMBP->mPairManager.mPersistent = persistentPairs;
+
 	if(nbObjects)
 		allocateMappingArray(nbObjects);
 
-	mCreated.reserve(DEFAULT_CREATED_DELETED_PAIRS_CAPACITY);
-	mDeleted.reserve(DEFAULT_CREATED_DELETED_PAIRS_CAPACITY);
+	// PT: in persistent mode the created/deleted arrays are sized for the expected number of overlaps, and never shrink
+	const PxU32 pairsCapacity = persistentPairs ? PxMax(maxNbBroadPhaseOverlaps, PxU32(DEFAULT_CREATED_DELETED_PAIRS_CAPACITY)) : DEFAULT_CREATED_DELETED_PAIRS_CAPACITY;
+	mCreated.reserve(pairsCapacity);
+	mDeleted.reserve(pairsCapacity);
 }
 
 BroadPhaseMBP::~BroadPhaseMBP()
@@ -3329,10 +3461,16 @@ const PxU32* BroadPhaseMBP::getOutOfBoundsObjects() const
 	return mMBP->mOutOfBoundsObjects.begin();
 }
 
-static void freeBuffer(Ps::Array<BroadPhasePair>& buffer)
+bool BroadPhaseMBP::getPairStatistics(PxBroadPhasePairStatistics& stats) const
+{
+	mMBP->mPairManager.getStatistics(stats);
+	return true;
+}
+
+static void freeBuffer(Ps::Array<BroadPhasePair>& buffer, bool persistent)
 {
 	const PxU32 size = buffer.size();
-	if(size>DEFAULT_CREATED_DELETED_PAIRS_CAPACITY)
+	if(!persistent && size>DEFAULT_CREATED_DELETED_PAIRS_CAPACITY)
 	{
 		buffer.reset();
 		buffer.reserve(DEFAULT_CREATED_DELETED_PAIRS_CAPACITY);
@@ -3346,8 +3484,8 @@ static void freeBuffer(Ps::Array<BroadPhasePair>& buffer)
 void BroadPhaseMBP::freeBuffers()
 {
 	mMBP->freeBuffers();
-	freeBuffer(mCreated);
-	freeBuffer(mDeleted);
+	freeBuffer(mCreated, mPersistentPairs);
+	freeBuffer(mDeleted, mPersistentPairs);
 }
 
 #if PX_CHECKED
@@ -52,7 +52,8 @@ namespace Bp
 															PxU32 maxNbBroadPhaseOverlaps,
 															PxU32 maxNbStaticShapes,
 															PxU32 maxNbDynamicShapes,
-															PxU64 contextID);
+															PxU64 contextID,
+															bool persistentPairs);
 		virtual								~BroadPhaseMBP();
 
 	// BroadPhaseBase
@@ -63,6 +64,7 @@ namespace Bp
 		virtual	bool						removeRegion(PxU32 handle);
 		virtual	PxU32						getNbOutOfBoundsObjects()	const;
 		virtual	const PxU32*				getOutOfBoundsObjects()		const;
+		virtual	bool						getPairStatistics(PxBroadPhasePairStatistics& stats)	const;
 	//~BroadPhaseBase
 
 	// BroadPhase
@@ -93,6 +95,7 @@ namespace Bp
 				PxU32						mCapacity;
 				Ps::Array<BroadPhasePair>	mCreated;
 				Ps::Array<BroadPhasePair>	mDeleted;
+				const bool					mPersistentPairs;	// See PxSceneFlag::eENABLE_PERSISTENT_BROADPHASE_PAIRS
 
 				const Bp::FilterGroup::Enum*mGroups;
 #ifdef BP_FILTERING_USES_TYPE_IN_GROUP
@@ -52,7 +52,8 @@ BroadPhaseSap::BroadPhaseSap(
 	const PxU32 maxNbBroadPhaseOverlaps,
 	const PxU32 maxNbStaticShapes,
 	const PxU32 maxNbDynamicShapes,
-	PxU64 contextID) :
+	PxU64 contextID,
+	bool persistentPairs) :
 	mScratchAllocator		(NULL),
 	mSapUpdateWorkTask		(contextID),
 	mSapPostUpdateWorkTask	(contextID),
@@ -114,6 +115,7 @@ BroadPhaseSap::BroadPhaseSap(
 
 	mDefaultPairsCapacity = PxMax(maxNbBroadPhaseOverlaps, PxU32(DEFAULT_CREATEDDELETED_PAIR_ARRAY_CAPACITY));
 
+	mPairs.mPersistent = persistentPairs;
 	mPairs.init(mDefaultPairsCapacity);
 
 	mBatchUpdateTasks[2].set(this,2);
@@ -181,6 +183,12 @@ void BroadPhaseSap::destroy()
 	PX_FREE(this);
 }
 
+bool BroadPhaseSap::getPairStatistics(PxBroadPhasePairStatistics& stats) const
+{
+	mPairs.getStatistics(stats);
+	return true;
+}
+
 void BroadPhaseSap::resizeBuffers()
 {
 	const PxU32 defaultPairsCapacity = mDefaultPairsCapacity;
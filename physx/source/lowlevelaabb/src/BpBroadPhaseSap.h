@@ -111,9 +111,13 @@ public:
 	friend class SapUpdateWorkTask;
 	friend class SapPostUpdateWorkTask;
 
-										BroadPhaseSap(const PxU32 maxNbBroadPhaseOverlaps, const PxU32 maxNbStaticShapes, const PxU32 maxNbDynamicShapes, PxU64 contextID);
+										BroadPhaseSap(const PxU32 maxNbBroadPhaseOverlaps, const PxU32 maxNbStaticShapes, const PxU32 maxNbDynamicShapes, PxU64 contextID, bool persistentPairs);
 	virtual								~BroadPhaseSap();
 
+	// BroadPhaseBase
+	virtual	bool						getPairStatistics(PxBroadPhasePairStatistics& stats)	const;
+	//~BroadPhaseBase
+
 	// BroadPhase
 	virtual	PxBroadPhaseType::Enum		getType()					const	{ return PxBroadPhaseType::eSAP;	}
 	virtual	void						destroy();
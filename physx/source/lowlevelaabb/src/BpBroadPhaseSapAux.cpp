@@ -29,6 +29,7 @@
 
 #include "CmPhysXCommon.h"
 #include "BpBroadPhaseSapAux.h"
+#include "BpBroadPhaseShared.h"
 #include "PsFoundation.h"
 
 namespace physx
@@ -81,7 +82,11 @@ SapPairManager::SapPairManager() :
 	mActivePairStates		(NULL),
 	mNbActivePairs			(0),
 	mActivePairsCapacity	(0),
-	mMask					(0)
+	mMask					(0),
+	mPeakNbActivePairs		(0),
+	mNbGrowths				(0),
+	mNbShrinks				(0),
+	mPersistent				(false)
 {
 }
 
@@ -107,6 +112,14 @@ void SapPairManager::init(const PxU32 size)
 	mHashCapacity=size;
 	mMinAllowedHashCapacity = size;
 	mActivePairsCapacity=size;
+
+	//In persistent mode the hash table directly uses the largest power-of-two size that fits the allocated capacity.
+	if(mPersistent)
+	{
+		mHashSize = Ps::isPowerOfTwo(size) ? size : Ps::nextPowerOfTwo(size)>>1;
+		mMask = mHashSize-1;
+		reallocPairs(false);
+	}
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -212,6 +225,7 @@ const BroadPhasePair* SapPairManager::AddPair(BpHandle id0, BpHandle id1, const
 		// Get more entries
 		mHashSize = Ps::nextPowerOfTwo(mNbActivePairs+1);
 		mMask = mHashSize-1;
+		mNbGrowths++;
 
 		reallocPairs(mHashSize>mHashCapacity);
 
@@ -230,6 +244,8 @@ const BroadPhasePair* SapPairManager::AddPair(BpHandle id0, BpHandle id1, const
 	PX_ASSERT(HashValue<mHashCapacity);
 	mNext[mNbActivePairs] = mHashTable[HashValue];
 	mHashTable[HashValue] = BpHandle(mNbActivePairs++);
+	if(mNbActivePairs > mPeakNbActivePairs)
+		mPeakNbActivePairs = mNbActivePairs;
 	return p;
 }
 
@@ -396,12 +412,27 @@ void SapPairManager::shrinkMemory()
 	{
 		newHashSize = mMinAllowedHashCapacity;
 	}
+
+	//In persistent mode the hash size never falls below its peak value.
+	if(mPersistent && newHashSize < mHashSize)
+		return;
+
+	if(newHashSize < mHashSize)
+		mNbShrinks++;
 	mHashSize = newHashSize;
 	mMask = newHashSize-1;
 
 	reallocPairs( (newHashSize > mMinAllowedHashCapacity) || (mHashSize <= (mHashCapacity >> 2)) || (mHashSize <= (mActivePairsCapacity >> 2)));
 }
 
+void SapPairManager::getStatistics(PxBroadPhasePairStatistics& stats) const
+{
+	stats.peakNbPairs	= mPeakNbActivePairs;
+	stats.nbGrowths		= mNbGrowths;
+	stats.nbShrinks		= mNbShrinks;
+	computeHashStatistics(stats, mHashTable, mNext, mHashSize, mNbActivePairs, BP_INVALID_BP_HANDLE);
+}
+
 void SapPairManager::reallocPairs(const bool allocRequired)
 {
 	if(allocRequired)
@@ -111,6 +111,7 @@ public:
 	void					release();
 
 	void					shrinkMemory();
+	void					getStatistics(PxBroadPhasePairStatistics& stats)	const;
 
 	const BroadPhasePair*	AddPair		(BpHandle id0, BpHandle id1, const PxU8 state);
 	bool					RemovePair	(BpHandle id0, BpHandle id1);
@@ -132,6 +133,10 @@ public:
 	PxU32				mNbActivePairs;
 	PxU32				mActivePairsCapacity;
 	PxU32				mMask;
+	PxU32				mPeakNbActivePairs;
+	PxU32				mNbGrowths;
+	PxU32				mNbShrinks;
+	bool				mPersistent;	// Never shrink, see PxSceneFlag::eENABLE_PERSISTENT_BROADPHASE_PAIRS
 
 	BroadPhasePair*		FindPair	(BpHandle id0, BpHandle id1, PxU32 hash_value) const;
 	void				RemovePair	(BpHandle id0, BpHandle id1, PxU32 hash_value, PxU32 pair_index);
@@ -52,7 +52,11 @@ PairManagerData::PairManagerData() :
 	mHashTable		(NULL),
 	mNext			(NULL),
 	mActivePairs	(NULL),
-	mReservedMemory (0)
+	mReservedMemory (0),
+	mPeakNbActivePairs	(0),
+	mNbGrowths		(0),
+	mNbShrinks		(0),
+	mPersistent		(false)
 {
 }
 
@@ -121,6 +125,13 @@ void PairManagerData::shrinkMemory()
 	if(mReservedMemory && correctHashSize < mReservedMemory)
 		return;
 
+	// PT: in persistent mode the table stays at its peak size, so that oscillating pair counts don't rehash every frame
+	if(mPersistent && correctHashSize < mHashSize)
+		return;
+
+	if(correctHashSize < mHashSize)
+		mNbShrinks++;
+
 	// Reduce memory used
 	mHashSize = correctHashSize;
 	mMask = mHashSize-1;
@@ -153,6 +164,7 @@ PX_NOINLINE PxU32 PairManagerData::growPairs(PxU32 fullHashValue)
 	// Get more entries
 	mHashSize = Ps::nextPowerOfTwo(mNbActivePairs+1);
 	mMask = mHashSize-1;
+	mNbGrowths++;
 
 	reallocPairs();
 
@@ -244,3 +256,40 @@ void PairManagerData::removePair(PxU32 /*id0*/, PxU32 /*id1*/, PxU32 hashValue,
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+void PairManagerData::getStatistics(PxBroadPhasePairStatistics& stats) const
+{
+	stats.peakNbPairs	= mPeakNbActivePairs;
+	stats.nbGrowths		= mNbGrowths;
+	stats.nbShrinks		= mNbShrinks;
+	computeHashStatistics(stats, mHashTable, mNext, mHashSize, mNbActivePairs, INVALID_ID);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Bp::computeHashStatistics(PxBroadPhasePairStatistics& stats, const PxU32* hashTable, const PxU32* next, PxU32 hashSize, PxU32 nbPairs, PxU32 invalidIndex)
+{
+	stats.nbPairs			= nbPairs;
+	stats.hashSize			= hashSize;
+	stats.loadFactor		= hashSize ? PxReal(nbPairs)/PxReal(hashSize) : 0.0f;
+	stats.nbCollisions		= 0;
+	stats.maxChainLength	= 0;
+
+	if(!hashTable)
+		return;
+
+	for(PxU32 i=0;i<hashSize;i++)
+	{
+		PxU32 chainLength = 0;
+		PxU32 offset = hashTable[i];
+		while(offset!=invalidIndex)
+		{
+			chainLength++;
+			offset = next[offset];
+		}
+		if(chainLength>1)
+			stats.nbCollisions += chainLength-1;
+		stats.maxChainLength = PxMax(stats.maxChainLength, chainLength);
+	}
+}
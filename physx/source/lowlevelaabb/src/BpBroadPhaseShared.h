@@ -31,6 +31,7 @@
 #define BP_BROADPHASE_SHARED_H
 
 #include "BpBroadPhaseUpdate.h"
+#include "PxBroadPhase.h"
 #include "PsUserAllocated.h"
 #include "PsHash.h"
 #include "PsVecMath.h"
@@ -70,6 +71,9 @@ namespace Bp
 	PX_FORCE_INLINE PxU32	hash(PxU32 id0, PxU32 id1)									{ return PxU32(Ps::hash( (id0&0xffff)|(id1<<16)) );	}
 	PX_FORCE_INLINE void	sort(PxU32& id0, PxU32& id1)								{ if(id0>id1)	Ps::swap(id0, id1);					}
 
+	// PT: fills the load factor, collision and chain length fields of 'stats' by walking the buckets of a pair hash table
+	void	computeHashStatistics(PxBroadPhasePairStatistics& stats, const PxU32* hashTable, const PxU32* next, PxU32 hashSize, PxU32 nbPairs, PxU32 invalidIndex);
+
 	class PairManagerData
 	{
 		public:
@@ -127,6 +131,8 @@ namespace Bp
 												hashValue = growPairs(fullHashValue);
 
 											const PxU32 pairIndex = mNbActivePairs++;
+											if(mNbActivePairs > mPeakNbActivePairs)
+												mPeakNbActivePairs = mNbActivePairs;
 
 											InternalPair* PX_RESTRICT p = &mActivePairs[pairIndex];
 											p->setNewPair(id0, id1);
@@ -142,6 +148,10 @@ namespace Bp
 						PxU32*			mNext;
 						InternalPair*	mActivePairs;
 						PxU32			mReservedMemory;
+						PxU32			mPeakNbActivePairs;
+						PxU32			mNbGrowths;
+						PxU32			mNbShrinks;
+						bool			mPersistent;	// PT: never shrink, see PxSceneFlag::eENABLE_PERSISTENT_BROADPHASE_PAIRS
 
 						void			purge();
 						void			reallocPairs();
@@ -149,6 +159,7 @@ namespace Bp
 						void			reserveMemory(PxU32 memSize);
 		PX_NOINLINE		PxU32			growPairs(PxU32 fullHashValue);
 						void			removePair(PxU32 id0, PxU32 id1, PxU32 hashValue, PxU32 pairIndex);
+						void			getStatistics(PxBroadPhasePairStatistics& stats)	const;
 	};
 
 	struct AABB_Xi
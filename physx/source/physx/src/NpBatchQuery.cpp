@@ -57,13 +57,18 @@ PX_COMPILE_TIME_ASSERT(0==(sizeof(PxOverlapHit)& 0x0f));
 	}
 
 NpBatchQuery::NpBatchQuery(NpScene& owner, const PxBatchQueryDesc& d)
-	: mNpScene(&owner), mNbRaycasts(0), mNbOverlaps(0), mNbSweeps(0), mBatchQueryIsRunning(0), mDesc(d), mPrevOffset(PxU32(eTERMINAL))
+	: mNpScene(&owner), mNbRaycasts(0), mNbOverlaps(0), mNbSweeps(0), mBatchQueryIsRunning(0), mDesc(d), mPrevOffset(PxU32(eTERMINAL)),
+	mJobs(PX_DEBUG_EXP("BatchQueryJobs")), mGroups(PX_DEBUG_EXP("BatchQueryGroups")), mRun(NULL)
 {
 	mHasMtdSweep = false;
 }
 
 NpBatchQuery::~NpBatchQuery()
 {
+	for(PxU32 i = 0; i < mGroups.size(); i++)
+		PX_DELETE(mGroups[i]);
+	if(mRun)
+		PX_DELETE(mRun);
 }
 
 void NpBatchQuery::setUserMemory(const PxBatchQueryMemory& userMem)
@@ -280,7 +285,286 @@ struct PxOverflowBuffer : PxHitBuffer<HitType>
 	}
 };
 
+// runs a query with a touch buffer of the given size, following the rules of the serial execution
+template<typename ResultType, typename HitType>
+static PX_FORCE_INLINE PxU32 runQuery(
+	NpScene& scene, const BatchStreamHeader& h, const MultiQueryInput& input, BatchQueryFilterData& bfd,
+	HitType* touches, PxU32 hitsSpaceLeft, ResultType& result)
+{
+	PxOverflowBuffer<HitType> hits(touches, PxMin<PxU32>(h.maxTouchHits, hitsSpaceLeft));
+	scene.NpScene::multiQuery<HitType>(input, hits, h.hitFlags, h.cache, h.fd, NULL, &bfd);
+	hits.overflow |= (hitsSpaceLeft == 0 && h.maxTouchHits > 0); // report overflow if 0 space left and maxTouchHits>0
+	writeStatus<ResultType, HitType>(&result, hits, h.userData, hits.overflow);
+	return hits.nbTouches;
+}
+
+// The queries only write the members of the touches flagged as valid, the others get their default values so that the
+// scratch buffers never hand uninitialized memory to the user.
+static PX_FORCE_INLINE void initUnsetMembers(PxLocationHit& hit)
+{
+	if(!(hit.flags & PxHitFlag::ePOSITION))
+		hit.position = PxVec3(0.0f);
+	if(!(hit.flags & PxHitFlag::eNORMAL))
+		hit.normal = PxVec3(0.0f);
+	if(!(hit.flags & PxHitFlag::eFACE_INDEX))
+		hit.faceIndex = 0xffffffff;
+}
+
+static PX_FORCE_INLINE void initUnsetMembers(PxRaycastHit& hit)
+{
+	initUnsetMembers(static_cast<PxLocationHit&>(hit));
+	if(!(hit.flags & PxHitFlag::eUV))
+	{
+		hit.u = 0.0f;
+		hit.v = 0.0f;
+	}
+}
+
+static PX_FORCE_INLINE void initUnsetMembers(PxOverlapHit& hit)
+{
+	// overlaps only report the actor and the shape
+	hit.faceIndex = 0xffffffff;
+}
+
+// runs a query of a group into the group's scratch buffer, as if all the user touch buffer was still available
+template<typename ResultType, typename HitType>
+static PX_FORCE_INLINE void runQueryIntoScratch(
+	NpScene& scene, const BatchStreamHeader& h, const MultiQueryInput& input, BatchQueryFilterData& bfd,
+	Ps::Array<HitType>& touches, PxU32 touchBufferSize, ResultType& result, BatchQueryJob& job)
+{
+	job.firstTouch = touches.size();
+	job.maxNbTouches = PxMin<PxU32>(h.maxTouchHits, touchBufferSize);
+
+	// the space has been reserved for the whole group by runGroup()
+	PX_ASSERT(touches.capacity() >= job.firstTouch + job.maxNbTouches);
+	touches.resizeUninitialized(job.firstTouch + job.maxNbTouches);
+	HitType* jobTouches = touches.begin() + job.firstTouch;
+	job.nbTouches = runQuery<ResultType, HitType>(scene, h, input, bfd, jobTouches, touchBufferSize, result);
+	touches.resizeUninitialized(job.firstTouch + job.nbTouches);
+
+	for(PxU32 i = 0; i < job.nbTouches; i++)
+		initUnsetMembers(jobTouches[i]);
+}
+
+// packs the touches of a query executed in parallel into the user touch buffer
+template<typename ResultType, typename HitType>
+static PX_FORCE_INLINE PxU32 packQuery(
+	const BatchStreamHeader& h, const BatchQueryJob& job, const Ps::Array<HitType>& scratchTouches, HitType* touches, PxU32 hitsSpaceLeft,
+	ResultType& result)
+{
+	// With less room left than the query ran with, the serial execution would have stopped collecting touches earlier.
+	// Keep the touches that fit and report the overflow the way it does, rather than running the query again.
+	PxU32 nbTouches = job.nbTouches;
+	if(PxMin<PxU32>(h.maxTouchHits, hitsSpaceLeft) < job.maxNbTouches)
+	{
+		const PxU32 maxNbTouches = PxMin<PxU32>(h.maxTouchHits, hitsSpaceLeft);
+		if(nbTouches > maxNbTouches || (hitsSpaceLeft == 0 && h.maxTouchHits > 0))
+		{
+			nbTouches = PxMin(nbTouches, maxNbTouches);
+			result.nbTouches = nbTouches;
+			result.queryStatus = PxU8(PxBatchQueryStatus::eOVERFLOW);
+		}
+	}
+
+	for(PxU32 i = 0; i < nbTouches; i++)
+		touches[i] = scratchTouches[job.firstTouch + i];
+	result.touches = (result.queryStatus == PxBatchQueryStatus::eOVERFLOW && nbTouches == 0) ? NULL : touches;
+	return nbTouches;
+}
+
+void BatchQueryTask::run()
+{
+	mRun->runGroups();
+}
+
+void BatchQueryTask::release()
+{
+	// the last user of the run releases it, this task included
+	BatchQueryRun* run = mRun;
+	if(Ps::atomicDecrement(&run->refCount) == 0)
+		PX_DELETE(run);
+}
+
+void BatchQueryRun::runGroups()
+{
+	// groups are picked dynamically to balance the load, the results do not depend on which thread runs them
+	for(;;)
+	{
+		const PxU32 groupIndex = PxU32(Ps::atomicIncrement(&nextGroup) - 1);
+		if(groupIndex >= nbGroups)
+			break;
+
+		owner->runGroup(*owner->mGroups[groupIndex]);
+
+		if(PxU32(Ps::atomicIncrement(&nbGroupsDone)) == nbGroups)
+			groupsDone.set();
+	}
+}
+
+void NpBatchQuery::runGroup(BatchQueryGroup& group)
+{
+	PX_SIMD_GUARD;
+
+	BatchQueryFilterData bfd(mDesc.filterShaderData, mDesc.filterShaderDataSize, mDesc.preFilterShader, mDesc.postFilterShader);
+
+	const PxBatchQueryMemory& mem = mDesc.queryMemory;
+
+	// reserve the worst case once, so that the queries never wait for the scratch buffers to grow
+	PxU32 maxNbRaycastTouches = 0, maxNbOverlapTouches = 0, maxNbSweepTouches = 0;
+	for(PxU32 i = 0; i < group.nbJobs; i++)
+	{
+		BatchQueryStreamReader reader(mStream.begin() + mJobs[group.firstJob + i].headerOffset);
+		const BatchStreamHeader& h = *reader.read<BatchStreamHeader>();
+		switch (h.hitTypeId)
+		{
+			case QTypeROS::eRAYCAST:	maxNbRaycastTouches += PxMin<PxU32>(h.maxTouchHits, mem.raycastTouchBufferSize);	break;
+			case QTypeROS::eOVERLAP:	maxNbOverlapTouches += PxMin<PxU32>(h.maxTouchHits, mem.overlapTouchBufferSize);	break;
+			case QTypeROS::eSWEEP:		maxNbSweepTouches += PxMin<PxU32>(h.maxTouchHits, mem.sweepTouchBufferSize);		break;
+			default:					break;
+		}
+	}
+
+	group.raycastTouches.clear();
+	group.overlapTouches.clear();
+	group.sweepTouches.clear();
+	group.raycastTouches.reserve(maxNbRaycastTouches);
+	group.overlapTouches.reserve(maxNbOverlapTouches);
+	group.sweepTouches.reserve(maxNbSweepTouches);
+
+	for(PxU32 i = 0; i < group.nbJobs; i++)
+	{
+		BatchQueryJob& job = mJobs[group.firstJob + i];
+		BatchQueryStreamReader reader(mStream.begin() + job.headerOffset);
+		const BatchStreamHeader& h = *reader.read<BatchStreamHeader>();
+		const MultiQueryInput& input = *readQueryInput(reader);
+
+		switch (h.hitTypeId)
+		{
+			case QTypeROS::eRAYCAST:
+				runQueryIntoScratch<PxRaycastQueryResult, PxRaycastHit>(*mNpScene, h, input, bfd, group.raycastTouches,
+					mem.raycastTouchBufferSize, mem.userRaycastResultBuffer[job.resultIndex], job);
+				break;
+			case QTypeROS::eOVERLAP:
+				runQueryIntoScratch<PxOverlapQueryResult, PxOverlapHit>(*mNpScene, h, input, bfd, group.overlapTouches,
+					mem.overlapTouchBufferSize, mem.userOverlapResultBuffer[job.resultIndex], job);
+				break;
+			case QTypeROS::eSWEEP:
+				runQueryIntoScratch<PxSweepQueryResult, PxSweepHit>(*mNpScene, h, input, bfd, group.sweepTouches,
+					mem.sweepTouchBufferSize, mem.userSweepResultBuffer[job.resultIndex], job);
+				break;
+			default:
+				PX_ALWAYS_ASSERT_MESSAGE("Unexpected batch query type (raycast/overlap/sweep).");
+		}
+	}
+}
+
+void NpBatchQuery::executeParallel(PxCpuDispatcher& dispatcher, PxU32 nbQueriesPerTask)
+{
+	PX_PROFILE_ZONE("BatchedSceneQuery.executeParallel", mNpScene->getContextId());
+
+	// list the queries in submission order
+	const PxU32 nbQueries = mNbRaycasts + mNbOverlaps + mNbSweeps;
+	mJobs.resizeUninitialized(nbQueries);
+	{
+		PxU32 nbRaycasts = 0, nbOverlaps = 0, nbSweeps = 0;
+		PxU32 curQueryOffset = 0;
+		for(PxU32 i = 0; i < nbQueries; i++)
+		{
+			const BatchStreamHeader& h = *reinterpret_cast<const BatchStreamHeader*>(mStream.begin() + curQueryOffset);
+			mJobs[i].headerOffset = curQueryOffset;
+			mJobs[i].resultIndex = h.hitTypeId == QTypeROS::eRAYCAST ? nbRaycasts++ : h.hitTypeId == QTypeROS::eOVERLAP ? nbOverlaps++ : nbSweeps++;
+			curQueryOffset = h.nextQueryOffset;
+		}
+		PX_ASSERT(curQueryOffset == eTERMINAL);
+	}
+
+	const PxU32 nbGroups = (nbQueries + nbQueriesPerTask - 1) / nbQueriesPerTask;
+	while(mGroups.size() < nbGroups)
+		mGroups.pushBack(PX_NEW(BatchQueryGroup));
+	for(PxU32 i = 0; i < nbGroups; i++)
+	{
+		mGroups[i]->firstJob = i * nbQueriesPerTask;
+		mGroups[i]->nbJobs = PxMin(nbQueriesPerTask, nbQueries - mGroups[i]->firstJob);
+	}
+
+	// the calling thread takes part, one task per worker is enough as tasks keep picking groups until none is left
+	const PxU32 nbTasks = PxMin(dispatcher.getWorkerCount(), nbGroups - 1);
+
+	// reuse the run of the previous execution if all its tasks are done
+	BatchQueryRun* run = mRun ? mRun : PX_NEW(BatchQueryRun);
+	mRun = NULL;
+	run->owner = this;
+	run->nbGroups = nbGroups;
+	run->nextGroup = 0;
+	run->nbGroupsDone = 0;
+	run->refCount = PxI32(nbTasks + 1);
+	run->groupsDone.reset();
+	if(run->tasks.size() < nbTasks)
+		run->tasks.resize(nbTasks);
+	for(PxU32 i = 0; i < nbTasks; i++)
+	{
+		run->tasks[i].mRun = run;
+		run->tasks[i].setContextId(mNpScene->getContextId());
+		dispatcher.submitTask(run->tasks[i]);
+	}
+
+	run->runGroups();
+	run->groupsDone.wait();
+
+	if(Ps::atomicDecrement(&run->refCount) == 0)
+		mRun = run;
+
+	// pack the touches the way the serial execution does
+	PxRaycastHit* raycastHits = mDesc.queryMemory.userRaycastTouchBuffer;
+	PxOverlapHit* overlapHits = mDesc.queryMemory.userOverlapTouchBuffer;
+	PxSweepHit* sweepHits = mDesc.queryMemory.userSweepTouchBuffer;
+	for(PxU32 g = 0; g < nbGroups; g++)
+	{
+		const BatchQueryGroup& group = *mGroups[g];
+		for(PxU32 i = 0; i < group.nbJobs; i++)
+		{
+			const BatchQueryJob& job = mJobs[group.firstJob + i];
+			BatchQueryStreamReader reader(mStream.begin() + job.headerOffset);
+			const BatchStreamHeader& h = *reader.read<BatchStreamHeader>();
+
+			switch (h.hitTypeId)
+			{
+				case QTypeROS::eRAYCAST:
+				{
+					const PxU32 nbRaycastHits = PxU32(raycastHits - mDesc.queryMemory.userRaycastTouchBuffer);
+					raycastHits += packQuery<PxRaycastQueryResult, PxRaycastHit>(h, job, group.raycastTouches, raycastHits,
+						mDesc.queryMemory.raycastTouchBufferSize - nbRaycastHits, mDesc.queryMemory.userRaycastResultBuffer[job.resultIndex]);
+				} break;
+				case QTypeROS::eOVERLAP:
+				{
+					const PxU32 nbOverlapHits = PxU32(overlapHits - mDesc.queryMemory.userOverlapTouchBuffer);
+					overlapHits += packQuery<PxOverlapQueryResult, PxOverlapHit>(h, job, group.overlapTouches, overlapHits,
+						mDesc.queryMemory.overlapTouchBufferSize - nbOverlapHits, mDesc.queryMemory.userOverlapResultBuffer[job.resultIndex]);
+				} break;
+				case QTypeROS::eSWEEP:
+				{
+					const PxU32 nbSweepHits = PxU32(sweepHits - mDesc.queryMemory.userSweepTouchBuffer);
+					sweepHits += packQuery<PxSweepQueryResult, PxSweepHit>(h, job, group.sweepTouches, sweepHits,
+						mDesc.queryMemory.sweepTouchBufferSize - nbSweepHits, mDesc.queryMemory.userSweepResultBuffer[job.resultIndex]);
+				} break;
+				default:
+					PX_ALWAYS_ASSERT_MESSAGE("Unexpected batch query type (raycast/overlap/sweep).");
+			}
+		}
+	}
+}
+
 void NpBatchQuery::execute()
+{
+	executeInternal(NULL, 0);
+}
+
+void NpBatchQuery::execute(PxCpuDispatcher& dispatcher, PxU32 nbQueriesPerTask)
+{
+	executeInternal(&dispatcher, PxMax(nbQueriesPerTask, PxU32(1)));
+}
+
+void NpBatchQuery::executeInternal(PxCpuDispatcher* dispatcher, PxU32 nbQueriesPerTask)
 {
 	NP_READ_CHECK(mNpScene);
 
@@ -366,75 +650,63 @@ void NpBatchQuery::execute()
 		return;
 	}
 
-	PxU32 hitsSpaceLeft; PX_UNUSED(hitsSpaceLeft);
-
-	// ====================== parse and execute the batch query memory stream ====================== 
-	PxU32 queryCount = 0;
-	do {
-		// parse a query from the input stream, create a stream reader at current double buffer
-		BatchQueryStreamReader reader(mStream.begin()+curQueryOffset);
-		BatchStreamHeader& h = *reader.read<BatchStreamHeader>();
-
-		curQueryOffset = h.nextQueryOffset;
-		Ps::prefetchLine(mStream.begin() + curQueryOffset);
-		
-		MultiQueryInput& input = *readQueryInput(reader);
-
-		// ====================== switch over query type - QTypeROS::eRAYCAST, eOVERLAP, eSWEEP =====================
-		switch (h.hitTypeId)
-		{
-			// =============== Current query is a raycast =====================
-			case QTypeROS::eRAYCAST:
-			{
-				PxU32 nbRaycastHits = PxU32(raycastHits - mDesc.queryMemory.userRaycastTouchBuffer);
-				PX_ASSERT(nbRaycastHits <= raycastHitsSize);
-				hitsSpaceLeft = raycastHitsSize - nbRaycastHits;
-				PxOverflowBuffer<PxRaycastHit> hits(raycastHits, PxMin<PxU32>(h.maxTouchHits, hitsSpaceLeft));
-				mNpScene->NpScene::multiQuery<PxRaycastHit>(input, hits, h.hitFlags, h.cache, h.fd, NULL, &bfd);
-				hits.overflow |= (hitsSpaceLeft == 0 && h.maxTouchHits > 0); // report overflow if 0 space left and maxTouchHits>0
-				writeStatus<PxRaycastQueryResult, PxRaycastHit>(raycastResults++, hits, h.userData, hits.overflow);
-				raycastHits += hits.nbTouches;
-			} break;
-
-			// ================ Current query is an overlap ====================
-			case QTypeROS::eOVERLAP:
-			{
-				PxU32 nbOverlapHits = PxU32(overlapHits - mDesc.queryMemory.userOverlapTouchBuffer);
-				PX_ASSERT(nbOverlapHits <= overlapHitsSize);
-				hitsSpaceLeft = overlapHitsSize - nbOverlapHits;
-				PxOverflowBuffer<PxOverlapHit> hits(overlapHits, PxMin<PxU32>(h.maxTouchHits, hitsSpaceLeft));
-				mNpScene->NpScene::multiQuery<PxOverlapHit>(input, hits, h.hitFlags, h.cache, h.fd, NULL, &bfd);
-				hits.overflow |= (hitsSpaceLeft == 0 && h.maxTouchHits > 0); // report overflow if 0 space left and maxTouchHits>0
-				writeStatus<PxOverlapQueryResult, PxOverlapHit>(overlapResults++, hits, h.userData, hits.overflow);
-				overlapHits += hits.nbTouches;
-			} break;
-
-			// ================== Current query is a sweep =========================
-			case QTypeROS::eSWEEP:
+	if(dispatcher && mNbRaycasts + mNbOverlaps + mNbSweeps > nbQueriesPerTask)
+	{
+		executeParallel(*dispatcher, nbQueriesPerTask);
+	}
+	else
+	{
+		// ====================== parse and execute the batch query memory stream ====================== 
+		PxU32 queryCount = 0;
+		do {
+			// parse a query from the input stream, create a stream reader at current double buffer
+			BatchQueryStreamReader reader(mStream.begin()+curQueryOffset);
+			BatchStreamHeader& h = *reader.read<BatchStreamHeader>();
+
+			curQueryOffset = h.nextQueryOffset;
+			Ps::prefetchLine(mStream.begin() + curQueryOffset);
+			
+			MultiQueryInput& input = *readQueryInput(reader);
+
+			// ====================== switch over query type - QTypeROS::eRAYCAST, eOVERLAP, eSWEEP =====================
+			switch (h.hitTypeId)
 			{
-
-				PxU32 nbSweepHits = PxU32(sweepHits - mDesc.queryMemory.userSweepTouchBuffer);
-				PX_ASSERT(nbSweepHits <= sweepHitsSize);
-				hitsSpaceLeft = sweepHitsSize - nbSweepHits;
-				PxOverflowBuffer<PxSweepHit> hits(sweepHits, PxMin<PxU32>(h.maxTouchHits, hitsSpaceLeft));
-				mNpScene->NpScene::multiQuery<PxSweepHit>(input, hits, h.hitFlags, h.cache, h.fd, NULL, &bfd);
-				hits.overflow |= (hitsSpaceLeft == 0 && h.maxTouchHits > 0); // report overflow if 0 space left and maxTouchHits>0
-				writeStatus<PxSweepQueryResult, PxSweepHit>(sweepResults++, hits, h.userData, hits.overflow);
-				sweepHits += hits.nbTouches;
-			} break;
-			default:
-				PX_ALWAYS_ASSERT_MESSAGE("Unexpected batch query type (raycast/overlap/sweep).");
-		}
-
-		if (h.nextQueryOffset == eTERMINAL) // end of stream
-			// AP: previously also had a break on hitCount==-1 which is aborted due to out of space
-			// abort stream parsing if we ran into an aborted query (hitCount==-1).. but it was easier to just continue
-			// the perf implications for aborted queries are not a significant consideration and this allows to avoid
-			// writing special case code for filling the query buffers after aborted query
-			break;
-		#undef MULTIQ
-		queryCount++;
-	} while (queryCount < 1000000);
+				// =============== Current query is a raycast =====================
+				case QTypeROS::eRAYCAST:
+				{
+					PxU32 nbRaycastHits = PxU32(raycastHits - mDesc.queryMemory.userRaycastTouchBuffer);
+					PX_ASSERT(nbRaycastHits <= raycastHitsSize);
+					raycastHits += runQuery<PxRaycastQueryResult, PxRaycastHit>(*mNpScene, h, input, bfd, raycastHits, raycastHitsSize - nbRaycastHits, *raycastResults++);
+				} break;
+
+				// ================ Current query is an overlap ====================
+				case QTypeROS::eOVERLAP:
+				{
+					PxU32 nbOverlapHits = PxU32(overlapHits - mDesc.queryMemory.userOverlapTouchBuffer);
+					PX_ASSERT(nbOverlapHits <= overlapHitsSize);
+					overlapHits += runQuery<PxOverlapQueryResult, PxOverlapHit>(*mNpScene, h, input, bfd, overlapHits, overlapHitsSize - nbOverlapHits, *overlapResults++);
+				} break;
+
+				// ================== Current query is a sweep =========================
+				case QTypeROS::eSWEEP:
+				{
+					PxU32 nbSweepHits = PxU32(sweepHits - mDesc.queryMemory.userSweepTouchBuffer);
+					PX_ASSERT(nbSweepHits <= sweepHitsSize);
+					sweepHits += runQuery<PxSweepQueryResult, PxSweepHit>(*mNpScene, h, input, bfd, sweepHits, sweepHitsSize - nbSweepHits, *sweepResults++);
+				} break;
+				default:
+					PX_ALWAYS_ASSERT_MESSAGE("Unexpected batch query type (raycast/overlap/sweep).");
+			}
+
+			if (h.nextQueryOffset == eTERMINAL) // end of stream
+				// AP: previously also had a break on hitCount==-1 which is aborted due to out of space
+				// abort stream parsing if we ran into an aborted query (hitCount==-1).. but it was easier to just continue
+				// the perf implications for aborted queries are not a significant consideration and this allows to avoid
+				// writing special case code for filling the query buffers after aborted query
+				break;
+			queryCount++;
+		} while (queryCount < 1000000);
+	}
 
 #if PX_SUPPORT_PVD
 	if( isSqCollectorLocked && needUpdatePvd)	
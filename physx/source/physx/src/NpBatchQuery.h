@@ -38,12 +38,14 @@
 #include "PsUserAllocated.h"
 #include "CmPhysXCommon.h"
 #include "PsSync.h"
+#include "task/PxTask.h"
 
 namespace physx
 {
 
 class NpSceneQueryManager;
 struct BatchStreamHeader;
+struct BatchQueryFilterData;
 class NpScene;
 
 namespace Sq
@@ -107,6 +109,66 @@ struct BatchQueryStreamReader
 	PxU32 mReadPos;
 };
 
+class NpBatchQuery;
+
+// A query of a batch executed in parallel
+struct BatchQueryJob
+{
+	PxU32	headerOffset;	// offset of the query's BatchStreamHeader in the stream
+	PxU32	resultIndex;	// index in the user result buffer of the query type
+	PxU32	firstTouch;		// index of the first touch in the scratch buffer of the group
+	PxU32	nbTouches;
+	PxU32	maxNbTouches;	// touch limit the query ran with
+};
+
+// Consecutive queries run by one task. Touches go to scratch buffers until they are packed in submission order.
+struct BatchQueryGroup : public Ps::UserAllocated
+{
+	BatchQueryGroup() : raycastTouches(PX_DEBUG_EXP("BatchQueryRaycastTouches")), overlapTouches(PX_DEBUG_EXP("BatchQueryOverlapTouches")), sweepTouches(PX_DEBUG_EXP("BatchQuerySweepTouches"))	{}
+
+	PxU32						firstJob;
+	PxU32						nbJobs;
+	Ps::Array<PxRaycastHit>		raycastTouches;
+	Ps::Array<PxOverlapHit>		overlapTouches;
+	Ps::Array<PxSweepHit>		sweepTouches;
+};
+
+struct BatchQueryRun;
+
+class BatchQueryTask : public PxBaseTask
+{
+public:
+								BatchQueryTask() : mRun(NULL)	{}
+
+	virtual void				run();
+	virtual const char*			getName() const		{ return "BatchedSceneQuery.executeTask";	}
+	virtual void				addReference()		{}
+	virtual void				removeReference()	{}
+	virtual int32_t				getReference() const	{ return 1;	}
+	virtual void				release();
+
+			BatchQueryRun*		mRun;
+};
+
+// State of a parallel execution, shared by the calling thread and the tasks. The caller only waits for the groups to
+// be done, not for the tasks: a task may still be queued when the batch completes, for instance when execute() is called
+// from a worker thread of the dispatcher. Late tasks find no group left and only touch this object, which is released
+// by its last user.
+struct BatchQueryRun : public Ps::UserAllocated
+{
+	BatchQueryRun() : tasks(PX_DEBUG_EXP("BatchQueryTasks")), owner(NULL), nbGroups(0), nextGroup(0), nbGroupsDone(0), refCount(0)	{}
+
+			void						runGroups();
+
+			Ps::Array<BatchQueryTask>	tasks;
+			Ps::Sync					groupsDone;
+			NpBatchQuery*				owner;
+			PxU32						nbGroups;
+	volatile	PxI32					nextGroup;
+	volatile	PxI32					nbGroupsDone;
+	volatile	PxI32					refCount;	// the caller and each submitted task
+};
+
 class NpBatchQuery : public PxBatchQuery, public Ps::UserAllocated
 {
 public:
@@ -115,6 +177,7 @@ public:
 
 	// PxBatchQuery interface
 	virtual	void							execute();
+	virtual	void							execute(PxCpuDispatcher& dispatcher, PxU32 nbQueriesPerTask);
 	virtual void							release();
 	virtual	PxBatchQueryPreFilterShader		getPreFilterShader() const;
 	virtual	PxBatchQueryPostFilterShader	getPostFilterShader() const;
@@ -144,6 +207,9 @@ public:
 	// sync object for batch query completion wait
 	shdfnd::Sync							mSync;
 private:
+			void							executeInternal(PxCpuDispatcher* dispatcher, PxU32 nbQueriesPerTask);
+			void							executeParallel(PxCpuDispatcher& dispatcher, PxU32 nbQueriesPerTask);
+			void							runGroup(BatchQueryGroup& group);
 			void							resetResultBuffers();
 			void							finalizeExecute();
 			void							writeBatchHeader(const BatchStreamHeader& h);
@@ -157,7 +223,13 @@ private:
 						PxU32				mPrevOffset;
 						bool				mHasMtdSweep;
 
+	// parallel execution, kept across executions to reuse the memory
+						Ps::Array<BatchQueryJob>	mJobs;
+						Ps::Array<BatchQueryGroup*>	mGroups;
+						BatchQueryRun*		mRun;	// NULL while tasks of the last execution are still queued
+
 	friend class physx::Sq::SceneQueryManager;
+	friend struct BatchQueryRun;
 };
 
 }
@@ -56,6 +56,7 @@
 #include "PsString.h"
 #include "PvdPhysicsClient.h"
 #include "SqPruningStructure.h"
+#include "BpBroadPhase.h"
 
 //~PX_SERIALIZATION
 
@@ -560,7 +561,7 @@ PxU32 NpPhysics::getBVHStructures(PxBVHStructure** userBuffer, PxU32 bufferSize,
 }
 ///////////////////////////////////////////////////////////////////////////////
 
-PxPruningStructure* NpPhysics::createPruningStructure(PxRigidActor*const* actors, PxU32 nbActors)
+PxPruningStructure* NpPhysics::createPruningStructure(PxRigidActor*const* actors, PxU32 nbActors, PxCpuDispatcher* dispatcher)
 {
 	PX_SIMD_GUARD;
 
@@ -568,7 +569,7 @@ PxPruningStructure* NpPhysics::createPruningStructure(PxRigidActor*const* actors
 	PX_ASSERT(nbActors > 0);
 
 	Sq::PruningStructure* ps = PX_NEW(Sq::PruningStructure)();	
-	if(!ps->build(actors, nbActors))
+	if(!ps->build(actors, nbActors, dispatcher))
 	{
 		PX_DELETE_AND_RESET(ps);		
 	}
@@ -729,6 +730,16 @@ PxPhysics* PxCreateBasePhysics(PxU32 version, PxFoundation& foundation, const Px
 	return NpPhysics::createInstance(version, foundation, scale, trackOutstandingAllocations, static_cast<pvdsdk::PsPvd*>(pvd));
 }
 
+PxBroadPhaseKernel::Enum PxSetBroadPhaseKernel(PxBroadPhaseKernel::Enum kernel)
+{
+	return Bp::BroadPhase::setKernel(kernel);
+}
+
+PxBroadPhaseKernel::Enum PxGetBroadPhaseKernel()
+{
+	return Bp::BroadPhase::getKernel();
+}
+
 void PxRegisterArticulations(PxPhysics& physics)
 {
 	PX_UNUSED(&physics);	// for the moment
@@ -158,7 +158,7 @@ public:
 	PX_FORCE_INLINE void			unregisterPhysXIndicatorGpuClient() {}
 #endif
 
-	virtual		PxPruningStructure*	createPruningStructure(PxRigidActor*const* actors, PxU32 nbActors);
+	virtual		PxPruningStructure*	createPruningStructure(PxRigidActor*const* actors, PxU32 nbActors, PxCpuDispatcher* dispatcher);
 
 	virtual		const PxTolerancesScale&		getTolerancesScale() const;
 
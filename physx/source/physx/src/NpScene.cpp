@@ -42,6 +42,7 @@
 #include "SqPruningStructure.h"
 #include "SqSceneQueryManager.h"
 #include "GuBVHStructure.h"
+#include "GuAABBTreeBuild.h"
 
 #include "ScbNpDeps.h"
 #include "ScArticulationSim.h"
@@ -86,7 +87,7 @@ static PX_FORCE_INLINE bool removeFromSceneCheck(NpScene* npScene, PxScene* scen
 
 NpSceneQueries::NpSceneQueries(const PxSceneDesc& desc) : 
 	mScene					(desc, getContextId()),
-	mSQManager				(mScene, desc.staticStructure, desc.dynamicStructure, desc.dynamicTreeRebuildRateHint, desc.limits),
+	mSQManager				(mScene, desc.staticStructure, desc.dynamicStructure, desc.dynamicTreeRebuildRateHint, desc.limits, desc.cpuDispatcher, desc.gridPrunerCellSize, desc.dynamicTreeRebuildTimeBudget),
 	mCachedRaycastFuncs		(Gu::getRaycastFuncTable()),
 	mCachedSweepFuncs		(Gu::getSweepFuncTable()),
 	mCachedOverlapFuncs		(Gu::getOverlapFuncTable()),
@@ -100,6 +101,8 @@ NpSceneQueries::NpSceneQueries(const PxSceneDesc& desc) :
 {
 	mSceneQueriesStaticPrunerUpdate.setObject(this);
 	mSceneQueriesDynamicPrunerUpdate.setObject(this);
+
+	mQueryCache.setParams(1024, 0.25f * desc.getTolerancesScale().length);
 }
 
 NpScene::NpScene(const PxSceneDesc& desc) :
@@ -126,7 +129,9 @@ NpScene::NpScene(const PxSceneDesc& desc) :
 	mSceneQueriesUpdateRunning	(false),
 	mHasSimulatedOnce		(false),
 	mBetweenFetchResults	(false),
-	mBuildFrozenActors		(false)
+	mBuildFrozenActors		(false),
+	mFrameArena				(NULL),
+	mFrameArenaSize			(desc.frameArenaSize)
 {
 	mSceneExecution.setObject(this);
 	mSceneCollide.setObject(this);
@@ -137,6 +142,9 @@ NpScene::NpScene(const PxSceneDesc& desc) :
 
 	mThreadReadWriteDepth = Ps::TlsAlloc();
 
+	if(mFrameArenaSize)
+		mFrameArena = PX_ALLOC(mFrameArenaSize, "NpScene::mFrameArena");
+
 	updatePhysXIndicator();
 
 }
@@ -184,6 +192,9 @@ NpScene::~NpScene()
 		unlockWrite();
 
 	TlsFree(mThreadReadWriteDepth);
+
+	if(mFrameArena)
+		PX_FREE(mFrameArena);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1663,6 +1674,19 @@ bool NpScene::getBroadPhaseCaps(PxBroadPhaseCaps& caps) const
 	return mScene.getBroadPhaseCaps(caps);
 }
 
+bool NpScene::getBroadPhasePairStatistics(PxBroadPhasePairStatistics& stats) const
+{
+	NP_READ_CHECK(this);
+
+	if(getSimulationStage() != Sc::SimulationStage::eCOMPLETE)
+	{
+		//the pair manager is updated during the sim, hence, avoid call while simulation is running.
+		Ps::getFoundation().error(PxErrorCode::eDEBUG_WARNING, __FILE__, __LINE__, "PxScene::getBroadPhasePairStatistics() not allowed while simulation is running. Call will be ignored.");
+		return false;
+	}
+	return mScene.getBroadPhasePairStatistics(stats);
+}
+
 PxU32 NpScene::getNbBroadPhaseRegions() const
 {
 	NP_READ_CHECK(this);
@@ -1867,6 +1891,12 @@ void NpScene::simulateOrCollide(PxReal elapsedTime, physx::PxBaseTask* completio
 
 		PX_CHECK_AND_RETURN(elapsedTime > 0, "PxScene::collide/simulate: The elapsed time must be positive!");
 
+		if(!scratchBlock)
+		{
+			scratchBlock = mFrameArena;
+			scratchBlockSize = mFrameArena ? mFrameArenaSize : 0;
+		}
+
 		PX_CHECK_AND_RETURN((reinterpret_cast<size_t>(scratchBlock)&15) == 0, "PxScene::simulate: scratch block must be 16-byte aligned!");
 	
 		PX_CHECK_AND_RETURN((scratchBlockSize&16383) == 0, "PxScene::simulate: scratch block size must be a multiple of 16K");
@@ -2114,6 +2144,7 @@ void NpScene::fetchResultsPostContactCallbacks()
 
 	mSQManager.updateCompoundActors(mScene.getScScene().getActiveCompoundBodiesArray(), mScene.getScScene().getNumActiveCompoundBodies());
 	mSQManager.afterSync(getSceneQueryUpdateModeFast());
+	mSQManager.endQueryStatsFrame();
 
 #if PX_SUPPORT_PVD
 	mScene.getScenePvdClient().updateSceneQueries();
@@ -2436,6 +2467,25 @@ PxU32 NpScene::getDynamicTreeRebuildRateHint() const
 	return mSQManager.getDynamicTreeRebuildRateHint();
 }
 
+void NpScene::setDynamicTreeRebuildTimeBudget(PxU32 microseconds)
+{
+	NP_WRITE_CHECK(this);
+	mSQManager.setDynamicTreeRebuildTimeBudget(microseconds);
+}
+
+PxU32 NpScene::getDynamicTreeRebuildTimeBudget() const
+{
+	NP_READ_CHECK(this);
+	return mSQManager.getDynamicTreeRebuildTimeBudget();
+}
+
+void NpScene::getSceneQueryRebuildStatistics(PxSceneQueryRebuildStatistics& staticStats, PxSceneQueryRebuildStatistics& dynamicStats) const
+{
+	NP_READ_CHECK(this);
+	mSQManager.getRebuildStatistics(Sq::PruningIndex::eSTATIC, staticStats);
+	mSQManager.getRebuildStatistics(Sq::PruningIndex::eDYNAMIC, dynamicStats);
+}
+
 void NpScene::forceDynamicTreeRebuild(bool rebuildStaticStructure, bool rebuildDynamicStructure)
 {
 	PX_PROFILE_ZONE("API.forceDynamicTreeRebuild", getContextId());
@@ -2444,6 +2494,30 @@ void NpScene::forceDynamicTreeRebuild(bool rebuildStaticStructure, bool rebuildD
 	mSQManager.forceDynamicTreeRebuild(rebuildStaticStructure, rebuildDynamicStructure);
 }
 
+static void getBuildStatistics(const Sq::Pruner* pruner, PxSceneQueryBuildStatistics& stats)
+{
+	const Gu::BuildStats* buildStats = pruner ? pruner->getBuildStats() : NULL;
+	if(!buildStats)
+	{
+		PxMemZero(&stats, sizeof(PxSceneQueryBuildStatistics));
+		return;
+	}
+
+	stats.buildTime		= buildStats->mBuildTime;
+	stats.nbSubtrees	= buildStats->mNbTasks;
+	stats.nbNodes		= buildStats->getCount();
+	stats.nbLeaves		= buildStats->mNbLeaves;
+	stats.maxDepth		= buildStats->mMaxDepth;
+	stats.sahCost		= buildStats->mSAHCost;
+}
+
+void NpScene::getSceneQueryBuildStatistics(PxSceneQueryBuildStatistics& staticStats, PxSceneQueryBuildStatistics& dynamicStats) const
+{
+	NP_READ_CHECK(this);
+	getBuildStatistics(mSQManager.get(Sq::PruningIndex::eSTATIC).pruner(), staticStats);
+	getBuildStatistics(mSQManager.get(Sq::PruningIndex::eDYNAMIC).pruner(), dynamicStats);
+}
+
 void NpScene::setSolverBatchSize(PxU32 solverBatchSize)
 {
 	NP_WRITE_CHECK(this);
@@ -2543,16 +2617,79 @@ PxU32 NpScene::getMaxNbContactDataBlocksUsed() const
 	return mScene.getScScene().getMaxNbContactDataBlocksUsed();
 }
 
+void NpScene::getFrameArenaStatistics(PxFrameArenaStatistics& stats) const
+{
+	PxMemZero(&stats, sizeof(PxFrameArenaStatistics));
+
+	PX_CHECK_AND_RETURN((getSimulationStage() == Sc::SimulationStage::eCOMPLETE), 
+		"PxScene::getFrameArenaStatistics: This call is not allowed while the simulation is running. Statistics will be zero.");
+
+	mScene.getScScene().getFrameArenaStatistics(stats);
+}
+
 PxU32 NpScene::getTimestamp() const
 {
 	return mScene.getScScene().getTimeStamp();
 }
 
+PxU64 NpScene::getTaskContextId() const
+{
+	return getContextId();
+}
+
 PxU32 NpScene::getSceneQueryStaticTimestamp() const
 {
 	return mSQManager.get(PruningIndex::eSTATIC).timestamp();
 }
 
+void NpScene::setSceneQueryCacheParams(PxU32 maxNbEntries, PxReal tolerance)
+{
+	NP_WRITE_CHECK(this);
+	PX_CHECK_AND_RETURN(tolerance > 0.0f && PxIsFinite(tolerance), "PxScene::setSceneQueryCacheParams: tolerance must be positive.");
+
+	mQueryCache.setParams(maxNbEntries, tolerance);
+}
+
+void NpScene::getSceneQueryCacheStatistics(PxSceneQueryCacheStatistics& stats) const
+{
+	NP_READ_CHECK(this);
+
+	Sq::QueryCacheStats cacheStats;
+	mQueryCache.getStats(cacheStats);
+	stats.nbHits		= cacheStats.mNbHits;
+	stats.nbMisses		= cacheStats.mNbMisses;
+	stats.nbStaleMisses	= cacheStats.mNbStale;
+	stats.nbOverflows	= cacheStats.mNbOverflows;
+}
+
+void NpScene::resetSceneQueryCacheStatistics()
+{
+	NP_WRITE_CHECK(this);
+
+	mQueryCache.resetStats();
+}
+
+void NpScene::setSceneQueryStatisticsEnabled(bool enabled)
+{
+	NP_WRITE_CHECK(this);
+
+	mSQManager.setQueryStatsEnabled(enabled);
+}
+
+bool NpScene::isSceneQueryStatisticsEnabled() const
+{
+	NP_READ_CHECK(this);
+
+	return mSQManager.getQueryStatsEnabled();
+}
+
+void NpScene::getSceneQueryStatistics(PxSceneQueryStatistics& stats) const
+{
+	NP_READ_CHECK(this);
+
+	stats = mSQManager.getQueryStats();
+}
+
 PxCpuDispatcher* NpScene::getCpuDispatcher() const
 {
 	return getTaskManager()->getCpuDispatcher();
@@ -3038,8 +3175,8 @@ bool NpScene::fetchQueries(bool block)
 		// PT: TODO: why do we want to show it in the cross thread view?
 		PX_PROFILE_START_CROSSTHREAD("Basic.fetchQueries", getContextId());
 
-		// flush updates and commit if work is done
-		mSQManager.flushUpdates();
+		// flush updates and switch to the new trees if the build tasks finished them
+		mSQManager.commitNewTrees();
 	
 		PX_PROFILE_STOP_CROSSTHREAD("Basic.fetchQueries", getContextId());
 		PX_PROFILE_STOP_CROSSTHREAD("Basic.sceneQueriesUpdate", getContextId());
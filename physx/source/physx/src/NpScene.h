@@ -205,7 +205,11 @@ class NpScene : public NpSceneQueries, public Ps::UserAllocated
 					void							releaseBatchQuery(PxBatchQuery* bq);
 	virtual			void							setDynamicTreeRebuildRateHint(PxU32 dynamicTreeRebuildRateHint);
 	virtual			PxU32							getDynamicTreeRebuildRateHint() const;
+	virtual			void							setDynamicTreeRebuildTimeBudget(PxU32 microseconds);
+	virtual			PxU32							getDynamicTreeRebuildTimeBudget() const;
+	virtual			void							getSceneQueryRebuildStatistics(PxSceneQueryRebuildStatistics& staticStats, PxSceneQueryRebuildStatistics& dynamicStats) const;
 	virtual			void							forceDynamicTreeRebuild(bool rebuildStaticStructure, bool rebuildDynamicStructure);
+	virtual			void							getSceneQueryBuildStatistics(PxSceneQueryBuildStatistics& staticStats, PxSceneQueryBuildStatistics& dynamicStats) const;
 	virtual			void							sceneQueriesUpdate(physx::PxBaseTask* completionTask, bool controlSimulation);
 	virtual			bool							checkQueries(bool block);
 	virtual			bool							fetchQueries(bool block);
@@ -232,11 +236,19 @@ class NpScene : public NpSceneQueries, public Ps::UserAllocated
 	virtual			void							setNbContactDataBlocks(PxU32 numBlocks);
 	virtual			PxU32							getNbContactDataBlocksUsed() const;
 	virtual			PxU32							getMaxNbContactDataBlocksUsed() const;
+	virtual			void							getFrameArenaStatistics(PxFrameArenaStatistics& stats) const;
 
 	virtual			PxU32							getContactReportStreamBufferSize() const;
 
 	virtual			PxU32							getTimestamp()	const;
+	virtual			PxU64							getTaskContextId()	const;
 	virtual			PxU32							getSceneQueryStaticTimestamp()	const;
+	virtual			void							setSceneQueryCacheParams(PxU32 maxNbEntries, PxReal tolerance);
+	virtual			void							getSceneQueryCacheStatistics(PxSceneQueryCacheStatistics& stats)	const;
+	virtual			void							resetSceneQueryCacheStatistics();
+	virtual			void							setSceneQueryStatisticsEnabled(bool enabled);
+	virtual			bool							isSceneQueryStatisticsEnabled()	const;
+	virtual			void							getSceneQueryStatistics(PxSceneQueryStatistics& stats)	const;
 
 	virtual			PxCpuDispatcher*				getCpuDispatcher() const;
 	virtual			PxCudaContextManager*			getCudaContextManager() const;
@@ -246,6 +258,7 @@ class NpScene : public NpSceneQueries, public Ps::UserAllocated
 	
 	virtual			PxBroadPhaseType::Enum			getBroadPhaseType()									const;
 	virtual			bool							getBroadPhaseCaps(PxBroadPhaseCaps& caps)			const;
+	virtual			bool							getBroadPhasePairStatistics(PxBroadPhasePairStatistics& stats)	const;
 	virtual			PxU32							getNbBroadPhaseRegions()							const;
 	virtual			PxU32							getBroadPhaseRegions(PxBroadPhaseRegionInfo* userBuffer, PxU32 bufferSize, PxU32 startIndex=0) const;
 	virtual			PxU32							addBroadPhaseRegion(const PxBroadPhaseRegion& region, bool populateRegion);
@@ -449,6 +462,9 @@ private:
 					bool							mHasSimulatedOnce;
 					bool							mBetweenFetchResults;
 					bool							mBuildFrozenActors;
+
+					void*							mFrameArena;		// scratch memory of the steps simulated without user scratch block
+					PxU32							mFrameArenaSize;
 };
 
 PX_FORCE_INLINE	void NpScene::addToConstraintList(PxConstraint& constraint)
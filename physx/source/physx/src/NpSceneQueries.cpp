@@ -36,6 +36,8 @@
 #include "GuIntersectionRayBox.h"
 #include "GuBounds.h"
 #include "GuIntersectionRay.h"
+#include "PsTime.h"
+#include "PsBitUtils.h"
 
 // Synchronous scene queries
 
@@ -184,6 +186,20 @@ static PX_FORCE_INLINE bool applyAllPreFiltersSQ(
 	return true;
 }
 
+//========================================================================================================================
+// Runs the overlap or sweep of a pruner through the query cache for queries with PxQueryFlag::eCOHERENT.
+// Returns false if the query didn't use the cache, the caller then queries the pruner directly.
+static PX_FORCE_INLINE bool cachedPrunerQuery(
+	QueryCache* queryCache, const SceneQueryManager& sqManager, PruningIndex::Enum index, PxU32 queryType, const PxBounds3& queryBounds,
+	PrunerCallback& pcb, PxAgain& again)
+{
+	if(!queryCache)
+		return false;
+
+	const PrunerExt& prunerExt = sqManager.get(index);
+	return queryCache->query(*prunerExt.pruner(), index, prunerExt.timestamp(), queryType, queryBounds, pcb, again);
+}
+
 //========================================================================================================================
 // performs a single geometry query for any HitType (PxSweepHit, PxOverlapHit, PxRaycastHit)
 template<typename HitType>
@@ -356,6 +372,7 @@ struct MultiQueryCallback : public PrunerCallback
 	PxBounds3					mQueryShapeBounds;
 	bool						mQueryShapeBoundsValid;
 	const ShapeData*			mShapeData;
+	PrunerQueryStats*			mStats; // counters of the pruner being searched, NULL if the statistics are disabled
 
 	MultiQueryCallback(
 		const NpSceneQueries& scene, const MultiQueryInput& input, bool anyHit, PxHitCallback<HitType>& hitCall, PxHitFlags hitFlags,
@@ -375,7 +392,8 @@ struct MultiQueryCallback : public PrunerCallback
 			mAnyHit					(anyHit),
 			mIsCached				(false),
 			mQueryShapeBoundsValid	(false),
-			mShapeData				(NULL)
+			mShapeData				(NULL),
+			mStats					(NULL)
 	{
 	}
 	
@@ -443,6 +461,12 @@ struct MultiQueryCallback : public PrunerCallback
 			filteredHitFlags | mMeshAnyHitFlags,
 			maxSubHits1, subHits1, mShrunkDistance, mQueryShapeBoundsValid ? &mQueryShapeBounds : NULL);
 
+		if(mStats)
+		{
+			mStats->mNbNarrowTests++;
+			mStats->mNbHits += nbSubHits;
+		}
+
 		// ------------------------- iterate over geometry subhits -----------------------------------
 		for (PxU32 iSubHit = 0; iSubHit < nbSubHits; iSubHit++)
 		{
@@ -675,6 +699,64 @@ private:
 
 #undef HITDIST
 
+//========================================================================================================================
+// Gathers the costs of a query in each pruner when the scene query statistics are enabled, and adds them to the scene
+// query manager when the query ends.
+struct QueryStatsRecorder
+{
+	PX_FORCE_INLINE QueryStatsRecorder(const SceneQueryManager& sqManager, PxSceneQueryStatistics::QueryType type) :
+		mSQManager(sqManager), mType(type), mEnabled(sqManager.getQueryStatsEnabled())
+	{
+	}
+
+	PX_FORCE_INLINE ~QueryStatsRecorder()
+	{
+		if(mEnabled)
+			mSQManager.addQueryStats(mType, mStats);
+	}
+
+	PX_FORCE_INLINE PrunerQueryStats* get(PxU32 prunerIndex)
+	{
+		return mEnabled ? mStats + prunerIndex : NULL;
+	}
+
+	const SceneQueryManager&				mSQManager;
+	const PxSceneQueryStatistics::QueryType	mType;
+	const bool								mEnabled;
+	PrunerQueryStats						mStats[PxSceneQueryStatistics::ePRUNER_COUNT];
+
+private:
+	QueryStatsRecorder& operator=(const QueryStatsRecorder&);
+};
+
+// Counts and times the search of a pruner by a query, and points the query callback to the pruner's counters
+template<typename HitType>
+struct PrunerQueryScope
+{
+	PX_FORCE_INLINE PrunerQueryScope(QueryStatsRecorder& recorder, PxU32 prunerIndex, MultiQueryCallback<HitType>& pcb) :
+		mStats(recorder.get(prunerIndex))
+	{
+		pcb.mStats = mStats;
+		pcb.mTraversalStats = mStats ? &mStats->mTraversal : NULL;
+		if(mStats)
+		{
+			mStats->mNbQueries++;
+			mStartTicks = Ps::Time::getCurrentCounterValue();
+		}
+	}
+
+	PX_FORCE_INLINE ~PrunerQueryScope()
+	{
+		if(mStats)
+			mStats->mTicks += Ps::Time::getCurrentCounterValue() - mStartTicks;
+	}
+
+	PrunerQueryStats*	mStats;
+	PxU64				mStartTicks;
+};
+
+static const PxU32 COMPOUND_PRUNER_INDEX = PxSceneQueryStatistics::eCOMPOUND;
+
 //========================================================================================================================
 template<typename HitType>
 bool NpSceneQueries::multiQuery(
@@ -770,17 +852,32 @@ bool NpSceneQueries::multiQuery(
 	const PxU32 doStatics = filterData.flags & PxQueryFlag::eSTATIC;
 	const PxU32 doDynamics = filterData.flags & PxQueryFlag::eDYNAMIC;
 
+	QueryCache* queryCache = ((filterData.flags & PxQueryFlag::eCOHERENT) && mQueryCache.isEnabled()) ? &mQueryCache : NULL;
+
 	if(HitTypeSupport<HitType>::IsRaycast)
 	{
-		bool again = doStatics ? staticPruner->raycast(input.getOrigin(), input.getDir(), pcb.mShrunkDistance, pcb) : true;
+		QueryStatsRecorder stats(mSQManager, PxSceneQueryStatistics::eRAYCAST);
+
+		bool again = true;
+		if(doStatics)
+		{
+			PrunerQueryScope<HitType> scope(stats, PruningIndex::eSTATIC, pcb);
+			again = staticPruner->raycast(input.getOrigin(), input.getDir(), pcb.mShrunkDistance, pcb);
+		}
 		if(!again)
 			return hits.hasAnyHits();
 		
 		if(doDynamics)
+		{
+			PrunerQueryScope<HitType> scope(stats, PruningIndex::eDYNAMIC, pcb);
 			again = dynamicPruner->raycast(input.getOrigin(), input.getDir(), pcb.mShrunkDistance, pcb);
+		}
 
 		if(again)
+		{
+			PrunerQueryScope<HitType> scope(stats, COMPOUND_PRUNER_INDEX, pcb);
 			again = compoundPruner->raycast(input.getOrigin(), input.getDir(), pcb.mShrunkDistance, pcb, filterData.flags);
+		}
 
 		cbr.again = again; // update the status to avoid duplicate processTouches()
 		return hits.hasAnyHits();
@@ -791,15 +888,33 @@ bool NpSceneQueries::multiQuery(
 
 		const ShapeData sd(*input.geometry, *input.pose, input.inflation);
 		pcb.mShapeData = &sd;
-		PxAgain again = doStatics ? staticPruner->overlap(sd, pcb) : true;
+		const PxU32 queryType = PxU32(input.geometry->getType());
+		const PxBounds3& queryBounds = sd.getPrunerInflatedWorldAABB();
+
+		QueryStatsRecorder stats(mSQManager, PxSceneQueryStatistics::eOVERLAP);
+
+		PxAgain again = true;
+		if(doStatics)
+		{
+			PrunerQueryScope<HitType> scope(stats, PruningIndex::eSTATIC, pcb);
+			if(!cachedPrunerQuery(queryCache, mSQManager, PruningIndex::eSTATIC, queryType, queryBounds, pcb, again))
+				again = staticPruner->overlap(sd, pcb);
+		}
 		if(!again) // && (filterData.flags & PxQueryFlag::eANY_HIT))
 			return hits.hasAnyHits();
 		
 		if(doDynamics)
-			again = dynamicPruner->overlap(sd, pcb);
+		{
+			PrunerQueryScope<HitType> scope(stats, PruningIndex::eDYNAMIC, pcb);
+			if(!cachedPrunerQuery(queryCache, mSQManager, PruningIndex::eDYNAMIC, queryType, queryBounds, pcb, again))
+				again = dynamicPruner->overlap(sd, pcb);
+		}
 
 		if(again)
+		{
+			PrunerQueryScope<HitType> scope(stats, COMPOUND_PRUNER_INDEX, pcb);
 			again = compoundPruner->overlap(sd, pcb, filterData.flags);
+		}
 
 		cbr.again = again; // update the status to avoid duplicate processTouches()
 		return hits.hasAnyHits();
@@ -813,21 +928,209 @@ bool NpSceneQueries::multiQuery(
 		pcb.mQueryShapeBounds = sd.getPrunerInflatedWorldAABB();
 		pcb.mQueryShapeBoundsValid = true;
 		pcb.mShapeData = &sd;
-		PxAgain again = doStatics ? staticPruner->sweep(sd, input.getDir(), pcb.mShrunkDistance, pcb) : true;
+
+		// PT: the cache entries of sweeps cover the whole swept volume
+		const PxU32 queryType = PxU32(PxGeometryType::eGEOMETRY_COUNT + input.geometry->getType());
+		PxBounds3 queryBounds = pcb.mQueryShapeBounds;
+		if(queryCache)
+			queryBounds.include(PxBounds3(queryBounds.minimum + input.getDir() * pcb.mShrunkDistance, queryBounds.maximum + input.getDir() * pcb.mShrunkDistance));
+
+		QueryStatsRecorder stats(mSQManager, PxSceneQueryStatistics::eSWEEP);
+
+		PxAgain again = true;
+		if(doStatics)
+		{
+			PrunerQueryScope<HitType> scope(stats, PruningIndex::eSTATIC, pcb);
+			if(!cachedPrunerQuery(queryCache, mSQManager, PruningIndex::eSTATIC, queryType, queryBounds, pcb, again))
+				again = staticPruner->sweep(sd, input.getDir(), pcb.mShrunkDistance, pcb);
+		}
 		if(!again)
 			return hits.hasAnyHits();
 		
 		if(doDynamics)
-			again = dynamicPruner->sweep(sd, input.getDir(), pcb.mShrunkDistance, pcb);
+		{
+			PrunerQueryScope<HitType> scope(stats, PruningIndex::eDYNAMIC, pcb);
+			if(!cachedPrunerQuery(queryCache, mSQManager, PruningIndex::eDYNAMIC, queryType, queryBounds, pcb, again))
+				again = dynamicPruner->sweep(sd, input.getDir(), pcb.mShrunkDistance, pcb);
+		}
 
 		if(again)
+		{
+			PrunerQueryScope<HitType> scope(stats, COMPOUND_PRUNER_INDEX, pcb);
 			again = compoundPruner->sweep(sd, input.getDir(), pcb.mShrunkDistance, pcb, filterData.flags);
+		}
 		
 		cbr.again = again; // update the status to avoid duplicate processTouches()
 		return hits.hasAnyHits();
 	}
 }
 
+//========================================================================================================================
+namespace
+{
+	// Per-ray state of a packet raycast, each ray of the packet runs the same filtering and narrow phase as a single raycast
+	struct RaycastPacketLane
+	{
+		RaycastPacketLane(const NpSceneQueries& scene, const PxVec3& origin, const PxVec3& unitDir, PxReal distance, bool anyHit, PxHitFlags hitFlags,
+			const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) :
+			mInput		(origin, unitDir, distance),
+			mCallback	(scene, mInput, anyHit, mBuffer, hitFlags, filterData, filterCall, distance, NULL)
+		{
+		}
+
+		MultiQueryInput						mInput;
+		PxRaycastBuffer						mBuffer;
+		MultiQueryCallback<PxRaycastHit>	mCallback;
+	private:
+		RaycastPacketLane& operator=(const RaycastPacketLane&);
+	};
+
+	struct RaycastPacketCallback : PrunerPacketCallback
+	{
+		RaycastPacketCallback(RaycastPacketLane* lanes) : mLanes(lanes)	{}
+
+		virtual PxAgain invoke(PxU32 rayIndex, PxReal& distance, const PrunerPayload& payload)
+		{
+			return mLanes[rayIndex].mCallback.invoke(distance, payload);
+		}
+
+		RaycastPacketLane*	mLanes;
+	};
+
+	// Counts and times the search of a pruner by the active rays of a packet, see PrunerQueryScope
+	struct PacketQueryScope
+	{
+		PacketQueryScope(QueryStatsRecorder& recorder, PxU32 prunerIndex, const PrunerRayPacket& packet, RaycastPacketCallback& pcb) :
+			mStats(recorder.get(prunerIndex))
+		{
+			pcb.mTraversalStats = mStats ? &mStats->mTraversal : NULL;
+			for(PxU32 i=0;i<packet.mNbRays;i++)
+				pcb.mLanes[i].mCallback.mStats = mStats;
+			if(mStats)
+			{
+				mStats->mNbQueries += Ps::bitCount(packet.mActiveMask);
+				mStartTicks = Ps::Time::getCurrentCounterValue();
+			}
+		}
+
+		~PacketQueryScope()
+		{
+			if(mStats)
+				mStats->mTicks += Ps::Time::getCurrentCounterValue() - mStartTicks;
+		}
+
+		PrunerQueryStats*	mStats;
+		PxU64				mStartTicks;
+	};
+
+	// Rays going into the same octant share their traversal order, anything else is better served by single rays
+	static PX_FORCE_INLINE bool isCoherent(const PrunerRayPacket& packet)
+	{
+		PxU32 signs[3] = { 0, 0, 0 };
+		for(PxU32 i=0;i<packet.mNbRays;i++)
+		{
+			if(!(packet.mActiveMask & (1<<i)))
+				continue;
+			for(PxU32 j=0;j<3;j++)
+				signs[j] |= packet.mUnitDirs[i][j] < 0.0f ? 2 : 1;
+		}
+		return signs[0]!=3 && signs[1]!=3 && signs[2]!=3;
+	}
+}
+
+PxU32 NpSceneQueries::raycastPacket(
+	const PxVec3* origins, const PxVec3* unitDirs, PxU32 nbRays, const PxReal distance,
+	PxRaycastHit* hits, PxHitFlags hitFlags, const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) const
+{
+	PX_PROFILE_ZONE("SceneQuery.raycastPacket", getContextId());
+	NP_READ_CHECK(this);
+	PX_SIMD_GUARD;
+
+	PX_CHECK_AND_RETURN_VAL(!nbRays || (origins && unitDirs && hits), "PxScene::raycastPacket(): NULL ray or hit buffer.", 0);
+	PX_CHECK_AND_RETURN_VAL(distance > 0.0f, "PxScene::raycastPacket(): distance cannot be negative or zero", 0);
+
+	// see multiQuery() for the const_cast
+	const_cast<NpSceneQueries*>(this)->mSQManager.flushUpdates();
+
+	const bool anyHit = (filterData.flags & PxQueryFlag::eANY_HIT) == PxQueryFlag::eANY_HIT;
+
+	const Pruner* staticPruner = mSQManager.get(PruningIndex::eSTATIC).pruner();
+	const Pruner* dynamicPruner = mSQManager.get(PruningIndex::eDYNAMIC).pruner();
+	const CompoundPruner* compoundPruner = mSQManager.getCompoundPruner().pruner();
+
+	const PxU32 doStatics = filterData.flags & PxQueryFlag::eSTATIC;
+	const PxU32 doDynamics = filterData.flags & PxQueryFlag::eDYNAMIC;
+
+	PX_ALIGN(16, PxU8 laneBuffer[sizeof(RaycastPacketLane)*SQ_PRUNER_PACKET_SIZE]);
+	RaycastPacketLane* lanes = reinterpret_cast<RaycastPacketLane*>(laneBuffer);
+	RaycastPacketCallback pcb(lanes);
+
+	// each ray of a packet counts as one raycast
+	QueryStatsRecorder stats(mSQManager, PxSceneQueryStatistics::eRAYCAST);
+
+	PxU32 nbHits = 0;
+	for(PxU32 first=0; first<nbRays; first+=SQ_PRUNER_PACKET_SIZE)
+	{
+		PrunerRayPacket packet;
+		packet.mNbRays = PxMin(nbRays - first, PxU32(SQ_PRUNER_PACKET_SIZE));
+		packet.mActiveMask = 0;
+		for(PxU32 i=0;i<packet.mNbRays;i++)
+		{
+			const PxVec3& origin = origins[first+i];
+			const PxVec3& unitDir = unitDirs[first+i];
+			PX_PLACEMENT_NEW(lanes+i, RaycastPacketLane)(*this, origin, unitDir, distance, anyHit, hitFlags, filterData, filterCall);
+
+			packet.mOrigins[i] = origin;
+			packet.mUnitDirs[i] = unitDir;
+			packet.mDistances[i] = distance;
+
+			// invalid rays are reported as misses
+			PX_CHECK_MSG(origin.isFinite() && unitDir.isFinite() && unitDir.isNormalized(), "PxScene::raycastPacket(): invalid ray, origin must be finite and direction normalized.");
+			if(origin.isFinite() && unitDir.isFinite() && unitDir.isNormalized())
+				packet.mActiveMask |= 1<<i;
+		}
+
+		const bool coherent = isCoherent(packet);
+		if(doStatics)
+		{
+			PacketQueryScope scope(stats, PruningIndex::eSTATIC, packet, pcb);
+			if(coherent)
+				staticPruner->raycastPacket(packet, pcb);
+			else
+				staticPruner->Pruner::raycastPacket(packet, pcb);	// per-ray traversal, bypassing the packet implementations of the pruners
+		}
+		if(doDynamics && packet.mActiveMask)
+		{
+			PacketQueryScope scope(stats, PruningIndex::eDYNAMIC, packet, pcb);
+			if(coherent)
+				dynamicPruner->raycastPacket(packet, pcb);
+			else
+				dynamicPruner->Pruner::raycastPacket(packet, pcb);
+		}
+
+		for(PxU32 i=0;i<packet.mNbRays;i++)
+		{
+			RaycastPacketLane& lane = lanes[i];
+			if(packet.mActiveMask & (1<<i))
+			{
+				PrunerQueryScope<PxRaycastHit> scope(stats, COMPOUND_PRUNER_INDEX, lane.mCallback);
+				compoundPruner->raycast(packet.mOrigins[i], packet.mUnitDirs[i], packet.mDistances[i], lane.mCallback, filterData.flags);
+			}
+
+			if(lane.mBuffer.hasBlock)
+			{
+				hits[first+i] = lane.mBuffer.block;
+				nbHits++;
+			}
+			else
+				hits[first+i] = PxRaycastHit();
+
+			lane.~RaycastPacketLane();
+		}
+	}
+	return nbHits;
+}
+
 void NpSceneQueries::sceneQueriesStaticPrunerUpdate(PxBaseTask* )
 {
 	PX_PROFILE_ZONE("SceneQuery.sceneQueriesStaticPrunerUpdate", getContextId());
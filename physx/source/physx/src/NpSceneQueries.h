@@ -34,6 +34,7 @@
 #include "PsIntrinsics.h"
 #include "CmPhysXCommon.h"
 #include "SqSceneQueryManager.h"
+#include "SqQueryCache.h"
 #include "GuTriangleMesh.h"
 #include "GuRaycastTests.h"
 #include "GuSweepTests.h"
@@ -159,6 +160,11 @@ public:
 														const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall,
 														const PxQueryCache* cache) const;
 
+	virtual			PxU32							raycastPacket(
+														const PxVec3* origins, const PxVec3* unitDirs, PxU32 nbRays, const PxReal distance,	// Ray data
+														PxRaycastHit* hits, PxHitFlags hitFlags,
+														const PxQueryFilterData& filterData, PxQueryFilterCallback* filterCall) const;
+
 	virtual			bool							sweep(
 														const PxGeometry& geometry, const PxTransform& pose,	// GeomObject data
 														const PxVec3& unitDir, const PxReal distance,	// Ray data
@@ -196,6 +202,9 @@ public:
 
 					PxSceneQueryUpdateMode::Enum    mSceneQueryUpdateMode;
 
+					// PT: filled by queries, which are const for the SDK user
+	mutable			Sq::QueryCache					mQueryCache;
+
 #if PX_SUPPORT_PVD
 public:
 					//Scene query and hits for pvd, collected in current frame
@@ -53,6 +53,7 @@ PX_DUMMY_SYMBOL
 
 #include "PvdTypeNames.h"
 #include "PvdMetaDataPvdBinding.h"
+#include "PsString.h"
 
 using namespace physx;
 using namespace Sc;
@@ -232,6 +233,61 @@ static PX_FORCE_INLINE void registerPvdSqHit(PvdDataStream& inStream)
 	inStream.createProperty<PvdSqHit, PxF32>("V");
 }
 
+// The scene query statistics are sent as "SceneQueryStatistics.<Pruner>.<Query>.<Counter>" scalar properties of the scene
+struct PvdSceneQueryStatisticsNames
+{
+	enum { eNB_COUNTERS = 6 };
+
+	PX_FORCE_INLINE const char* get(PxU32 prunerIndex, PxU32 queryIndex, PxU32 counterIndex)
+	{
+		static const char* prunerNames[PxSceneQueryStatistics::ePRUNER_COUNT] = { "Static", "Dynamic", "Compound" };
+		static const char* queryNames[PxSceneQueryStatistics::eQUERY_TYPE_COUNT] = { "Raycast", "Sweep", "Overlap" };
+		static const char* counterNames[eNB_COUNTERS] = { "NbQueries", "NbVisitedNodes", "NbLeafTests", "NbNarrowTests", "NbHits", "Time" };
+		Ps::snprintf(mName, sizeof(mName), "SceneQueryStatistics.%s.%s.%s", prunerNames[prunerIndex], queryNames[queryIndex], counterNames[counterIndex]);
+		return mName;
+	}
+
+	char	mName[128];
+};
+
+static void registerPvdSceneQueryStatistics(PvdDataStream& inStream)
+{
+	PvdSceneQueryStatisticsNames names;
+	for(PxU32 i=0;i<PxSceneQueryStatistics::ePRUNER_COUNT;i++)
+	{
+		for(PxU32 j=0;j<PxSceneQueryStatistics::eQUERY_TYPE_COUNT;j++)
+		{
+			for(PxU32 k=0;k<PvdSceneQueryStatisticsNames::eNB_COUNTERS-1;k++)
+				inStream.createProperty<PxScene, PxU32>(names.get(i, j, k));
+			inStream.createProperty<PxScene, PxReal>(names.get(i, j, PvdSceneQueryStatisticsNames::eNB_COUNTERS-1));
+		}
+	}
+}
+
+static void sendPvdSceneQueryStatistics(PvdDataStream& inStream, const PxScene* inScene)
+{
+	if(!inScene->isSceneQueryStatisticsEnabled())
+		return;
+
+	PxSceneQueryStatistics stats;
+	inScene->getSceneQueryStatistics(stats);
+
+	PvdSceneQueryStatisticsNames names;
+	for(PxU32 i=0;i<PxSceneQueryStatistics::ePRUNER_COUNT;i++)
+	{
+		for(PxU32 j=0;j<PxSceneQueryStatistics::eQUERY_TYPE_COUNT;j++)
+		{
+			const PxSceneQueryStatistics::Counters& counters = stats.counters[i][j];
+			inStream.setPropertyValue(inScene, names.get(i, j, 0), counters.nbQueries);
+			inStream.setPropertyValue(inScene, names.get(i, j, 1), counters.nbVisitedNodes);
+			inStream.setPropertyValue(inScene, names.get(i, j, 2), counters.nbLeafTests);
+			inStream.setPropertyValue(inScene, names.get(i, j, 3), counters.nbNarrowTests);
+			inStream.setPropertyValue(inScene, names.get(i, j, 4), counters.nbHits);
+			inStream.setPropertyValue(inScene, names.get(i, j, 5), counters.time);
+		}
+	}
+}
+
 void PvdMetaDataBinding::registerSDKProperties(PvdDataStream& inStream)
 {
 	if (inStream.isClassExist<PxPhysics>())
@@ -319,6 +375,7 @@ void PvdMetaDataBinding::registerSDKProperties(PvdDataStream& inStream)
 		inStream.createProperty<PxScene, ObjectRef>("Physics", "parents", PropertyType::Scalar);
 		inStream.createProperty<PxScene, PxU32>("Timestamp");
 		inStream.createProperty<PxScene, PxReal>("SimulateElapsedTime");
+		registerPvdSceneQueryStatistics(inStream);
 		definePropertyStruct<PxSceneDesc, PxSceneDescGeneratedValues, PxScene>(inStream);
 		definePropertyStruct<PxSimulationStatistics, PxSimulationStatisticsGeneratedValues, PxScene>(inStream, "SimulationStatistics");
 		inStream.createProperty<PxScene, PvdContact>("Contacts", "", PropertyType::Array);
@@ -682,6 +739,8 @@ void PvdMetaDataBinding::sendStats(PvdDataStream& inStream, const PxScene* inSce
 
 	PxSimulationStatisticsGeneratedValues values(&theStats);
 	inStream.setPropertyMessage(inScene, values);
+
+	sendPvdSceneQueryStatistics(inStream, inScene);
 }
 
 struct PvdContactConverter
@@ -1166,6 +1166,11 @@ bool Scb::Scene::getBroadPhaseCaps(PxBroadPhaseCaps& caps) const
 	return mScene.getBroadPhaseCaps(caps);
 }
 
+bool Scb::Scene::getBroadPhasePairStatistics(PxBroadPhasePairStatistics& stats) const
+{
+	return mScene.getBroadPhasePairStatistics(stats);
+}
+
 PxU32 Scb::Scene::getNbBroadPhaseRegions() const
 {
 	return mScene.getNbBroadPhaseRegions();
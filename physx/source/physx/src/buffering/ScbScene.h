@@ -226,6 +226,7 @@ namespace Scb
 		PX_INLINE	PxBroadPhaseCallback*	getBroadPhaseCallback()		const;
 					PxBroadPhaseType::Enum	getBroadPhaseType()																				const;
 					bool					getBroadPhaseCaps(PxBroadPhaseCaps& caps)														const;
+					bool					getBroadPhasePairStatistics(PxBroadPhasePairStatistics& stats)									const;
 					PxU32					getNbBroadPhaseRegions()																		const;
 					PxU32					getBroadPhaseRegions(PxBroadPhaseRegionInfo* userBuffer, PxU32 bufferSize, PxU32 startIndex)	const;
 					PxU32					addBroadPhaseRegion(const PxBroadPhaseRegion& region, bool populateRegion);
@@ -142,6 +142,7 @@ bool BVHStructureBuilder::loadFromDesc(const PxBVHStructureDesc& desc)
 	params.mNbPrimitives = desc.bounds.count;
 	params.mAABBArray = mBounds;
 	params.mLimit = NB_OBJECTS_PER_NODE;
+	params.mDispatcher = desc.buildDispatcher;
 	BuildStats stats;
 	NodeAllocator nodeAllocator;
 
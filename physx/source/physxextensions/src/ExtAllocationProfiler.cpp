@@ -0,0 +1,266 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "ExtAllocationProfiler.h"
+#include "foundation/PxIO.h"
+#include "foundation/PxMath.h"
+#include "PsFoundation.h"
+#include "PsSort.h"
+#include "PsString.h"
+#include "PsThread.h"
+
+using namespace physx;
+
+PxAllocationProfiler* physx::PxAllocationProfilerCreate()
+{
+	Ext::AllocationProfiler* profiler = PX_NEW(Ext::AllocationProfiler)();
+	profiler->install();
+	return profiler;
+}
+
+namespace
+{
+	// Steady-state offenders first, then the busiest sites
+	struct AllocationSiteGreater
+	{
+		bool operator()(const PxAllocationSite& a, const PxAllocationSite& b) const
+		{
+			if(a.nbSteadyStateAllocations != b.nbSteadyStateAllocations)
+				return a.nbSteadyStateAllocations > b.nbSteadyStateAllocations;
+			return a.nbAllocations > b.nbAllocations;
+		}
+	};
+
+	PX_FORCE_INLINE const char* nameOrNone(const char* name)
+	{
+		return name ? name : "<none>";
+	}
+}
+
+Ext::AllocationProfiler::AllocationProfiler() :
+	mThreadStates		(NULL),
+	mChainedCallback	(NULL),
+	mSteadyState		(false)
+{
+	mTlsIndex = Ps::TlsAlloc();
+}
+
+Ext::AllocationProfiler::~AllocationProfiler()
+{
+	AllocationProfilerThreadState* state = mThreadStates;
+	while(state)
+	{
+		AllocationProfilerThreadState* next = state->next;
+		Ps::RawAllocator().deallocate(state);
+		state = next;
+	}
+
+	Ps::TlsFree(mTlsIndex);
+}
+
+void Ext::AllocationProfiler::install()
+{
+	mChainedCallback = PxGetProfilerCallback();
+	PxSetProfilerCallback(this);
+	Ps::getFoundation().registerAllocationListener(*this);
+}
+
+void Ext::AllocationProfiler::release()
+{
+	Ps::getFoundation().deregisterAllocationListener(*this);
+	if(PxGetProfilerCallback() == this)
+		PxSetProfilerCallback(mChainedCallback);
+
+	PX_DELETE(this);
+}
+
+Ext::AllocationProfilerThreadState* Ext::AllocationProfiler::getThreadState(bool create)
+{
+	AllocationProfilerThreadState* state = reinterpret_cast<AllocationProfilerThreadState*>(Ps::TlsGet(mTlsIndex));
+	if(!state && create)
+	{
+		state = reinterpret_cast<AllocationProfilerThreadState*>(Ps::RawAllocator().allocate(sizeof(AllocationProfilerThreadState), __FILE__, __LINE__));
+		state->depth = 0;
+
+		Ps::Mutex::ScopedLock lock(mMutex);
+		state->next = mThreadStates;
+		mThreadStates = state;
+		Ps::TlsSet(mTlsIndex, state);
+	}
+	return state;
+}
+
+void* Ext::AllocationProfiler::zoneStart(const char* eventName, bool detached, uint64_t contextId)
+{
+	// Detached zones start and end on different threads, they cannot be tracked with a per-thread stack
+	if(!detached)
+	{
+		AllocationProfilerThreadState* state = getThreadState(true);
+		if(state->depth < EXT_ALLOCATION_PROFILER_MAX_ZONE_DEPTH)
+			state->zones[state->depth] = eventName;
+		state->depth++;
+	}
+
+	return mChainedCallback ? mChainedCallback->zoneStart(eventName, detached, contextId) : NULL;
+}
+
+void Ext::AllocationProfiler::zoneEnd(void* profilerData, const char* eventName, bool detached, uint64_t contextId)
+{
+	if(!detached)
+	{
+		// The profiler may have been installed while this zone was already open
+		AllocationProfilerThreadState* state = getThreadState(false);
+		if(state && state->depth)
+			state->depth--;
+	}
+
+	if(mChainedCallback)
+		mChainedCallback->zoneEnd(profilerData, eventName, detached, contextId);
+}
+
+void Ext::AllocationProfiler::onAllocation(size_t size, const char* typeName, const char* filename, int line, void* /*allocatedMemory*/)
+{
+	AllocationSiteKey key;
+	key.zoneName = NULL;
+	key.fileName = filename;
+	key.line = PxU32(line);
+
+	const AllocationProfilerThreadState* state = getThreadState(false);
+	if(state && state->depth)
+		key.zoneName = state->zones[PxMin(state->depth, PxU32(EXT_ALLOCATION_PROFILER_MAX_ZONE_DEPTH)) - 1];
+
+	Ps::Mutex::ScopedLock lock(mMutex);
+
+	const SiteMap::Entry* entry = mSiteMap.find(key);
+	PxU32 index;
+	if(entry)
+	{
+		index = entry->second;
+	}
+	else
+	{
+		index = mSites.size();
+		mSiteMap.insert(key, index);
+
+		PxAllocationSite& site = mSites.insert();
+		site.zoneName = key.zoneName;
+		site.typeName = typeName;
+		site.fileName = filename;
+		site.line = key.line;
+		site.nbAllocations = 0;
+		site.nbSteadyStateAllocations = 0;
+		site.nbBytes = 0;
+		site.nbSteadyStateBytes = 0;
+	}
+
+	PxAllocationSite& site = mSites[index];
+	site.nbAllocations++;
+	site.nbBytes += size;
+	if(mSteadyState)
+	{
+		site.nbSteadyStateAllocations++;
+		site.nbSteadyStateBytes += size;
+	}
+}
+
+PxU32 Ext::AllocationProfiler::getNbSites() const
+{
+	Ps::Mutex::ScopedLock lock(mMutex);
+	return mSites.size();
+}
+
+PxU32 Ext::AllocationProfiler::getSites(PxAllocationSite* userBuffer, PxU32 bufferSize, PxU32 startIndex) const
+{
+	Ps::Mutex::ScopedLock lock(mMutex);
+
+	const PxU32 nbSites = mSites.size();
+	if(startIndex >= nbSites)
+		return 0;
+
+	const PxU32 nb = PxMin(bufferSize, nbSites - startIndex);
+	for(PxU32 i = 0; i < nb; i++)
+		userBuffer[i] = mSites[startIndex + i];
+	return nb;
+}
+
+void Ext::AllocationProfiler::reset()
+{
+	Ps::Mutex::ScopedLock lock(mMutex);
+	mSiteMap.clear();
+	mSites.clear();
+}
+
+void Ext::AllocationProfiler::writeReport(PxOutputStream& stream, bool steadyStateOnly) const
+{
+	// Work on a raw copy: the stream may allocate, which calls back into onAllocation()
+	PxAllocationSite* sites;
+	PxU32 nbSites;
+	{
+		Ps::Mutex::ScopedLock lock(mMutex);
+		nbSites = mSites.size();
+		sites = reinterpret_cast<PxAllocationSite*>(Ps::RawAllocator().allocate(sizeof(PxAllocationSite) * (nbSites + 1), __FILE__, __LINE__));
+		for(PxU32 i = 0; i < nbSites; i++)
+			sites[i] = mSites[i];
+	}
+
+	Ps::sort(sites, nbSites, AllocationSiteGreater(), Ps::RawAllocator());
+
+	PxU32 totalAllocations = 0, totalSteadyStateAllocations = 0;
+	PxU64 totalBytes = 0, totalSteadyStateBytes = 0;
+	for(PxU32 i = 0; i < nbSites; i++)
+	{
+		totalAllocations += sites[i].nbAllocations;
+		totalSteadyStateAllocations += sites[i].nbSteadyStateAllocations;
+		totalBytes += sites[i].nbBytes;
+		totalSteadyStateBytes += sites[i].nbSteadyStateBytes;
+	}
+
+	char line[1024];
+	Ps::snprintf(line, sizeof(line), "%u allocations (%llu bytes), %u in steady state (%llu bytes), %u sites\n",
+		totalAllocations, static_cast<unsigned long long>(totalBytes), totalSteadyStateAllocations, static_cast<unsigned long long>(totalSteadyStateBytes), nbSites);
+	stream.write(line, PxU32(strlen(line)));
+
+	Ps::snprintf(line, sizeof(line), "steady allocs\tsteady bytes\tallocs\tbytes\tzone\ttype\tlocation\n");
+	stream.write(line, PxU32(strlen(line)));
+
+	for(PxU32 i = 0; i < nbSites; i++)
+	{
+		const PxAllocationSite& site = sites[i];
+		if(steadyStateOnly && !site.nbSteadyStateAllocations)
+			break;	// Sorted, no steady-state allocations past this one
+
+		Ps::snprintf(line, sizeof(line), "%u\t%llu\t%u\t%llu\t%s\t%s\t%s(%u)\n",
+			site.nbSteadyStateAllocations, static_cast<unsigned long long>(site.nbSteadyStateBytes),
+			site.nbAllocations, static_cast<unsigned long long>(site.nbBytes),
+			nameOrNone(site.zoneName), nameOrNone(site.typeName), nameOrNone(site.fileName), site.line);
+		stream.write(line, PxU32(strlen(line)));
+	}
+
+	Ps::RawAllocator().deallocate(sites);
+}
@@ -0,0 +1,123 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+
+#ifndef PX_PHYSICS_EXTENSIONS_ALLOCATION_PROFILER_H_INTERNAL
+#define PX_PHYSICS_EXTENSIONS_ALLOCATION_PROFILER_H_INTERNAL
+
+#include "extensions/PxAllocationProfiler.h"
+#include "CmPhysXCommon.h"
+#include "PsBroadcast.h"
+#include "PsHashMap.h"
+#include "PsMutex.h"
+#include "PsUserAllocated.h"
+
+// Nesting deeper than this still works, the allocations are then charged to the deepest recorded zone
+#define EXT_ALLOCATION_PROFILER_MAX_ZONE_DEPTH	32
+
+namespace physx
+{
+namespace Ext
+{
+	struct AllocationSiteKey
+	{
+		const char*	zoneName;
+		const char*	fileName;
+		PxU32		line;
+	};
+
+	struct AllocationSiteKeyHash
+	{
+		PX_FORCE_INLINE uint32_t operator()(const AllocationSiteKey& k) const
+		{
+			return Ps::hash(k.zoneName) ^ (Ps::hash(k.fileName) * 1000007) ^ Ps::hash(k.line);
+		}
+		PX_FORCE_INLINE bool equal(const AllocationSiteKey& k0, const AllocationSiteKey& k1) const
+		{
+			return k0.zoneName == k1.zoneName && k0.fileName == k1.fileName && k0.line == k1.line;
+		}
+	};
+
+	// Per-thread stack of open profile zones
+	struct AllocationProfilerThreadState
+	{
+		const char*						zones[EXT_ALLOCATION_PROFILER_MAX_ZONE_DEPTH];
+		PxU32							depth;
+		AllocationProfilerThreadState*	next;
+	};
+
+	// Everything below is allocated with the raw allocator, so that recording an allocation never
+	// goes through the broadcasting allocator again.
+	class AllocationProfiler : public PxAllocationProfiler, public Ps::AllocationListener, public Ps::UserAllocated
+	{
+	public:
+											AllocationProfiler();
+		virtual								~AllocationProfiler();
+
+		// PxProfilerCallback
+		virtual void*						zoneStart(const char* eventName, bool detached, uint64_t contextId);
+		virtual void						zoneEnd(void* profilerData, const char* eventName, bool detached, uint64_t contextId);
+		//~PxProfilerCallback
+
+		// Ps::AllocationListener
+		virtual void						onAllocation(size_t size, const char* typeName, const char* filename, int line, void* allocatedMemory);
+		virtual void						onDeallocation(void*)	{}
+		//~Ps::AllocationListener
+
+		// PxAllocationProfiler
+		virtual void						release();
+		virtual void						setSteadyState(bool steadyState)	{ mSteadyState = steadyState;	}
+		virtual bool						isSteadyState()				const	{ return mSteadyState;			}
+		virtual PxU32						getNbSites()				const;
+		virtual PxU32						getSites(PxAllocationSite* userBuffer, PxU32 bufferSize, PxU32 startIndex) const;
+		virtual void						reset();
+		virtual void						writeReport(PxOutputStream& stream, bool steadyStateOnly) const;
+		//~PxAllocationProfiler
+
+				void						install();
+
+	private:
+				AllocationProfilerThreadState*	getThreadState(bool create);
+
+		typedef Ps::HashMap<AllocationSiteKey, PxU32, AllocationSiteKeyHash, Ps::RawAllocator>	SiteMap;
+
+				SiteMap									mSiteMap;		// Key to index in mSites
+				Ps::Array<PxAllocationSite, Ps::RawAllocator>	mSites;
+		mutable	Ps::Mutex								mMutex;
+				AllocationProfilerThreadState*			mThreadStates;	// All per-thread states, released with the profiler
+				PxProfilerCallback*						mChainedCallback;
+				PxU32									mTlsIndex;
+		volatile bool									mSteadyState;
+	};
+
+} // namespace Ext
+
+}
+
+#endif
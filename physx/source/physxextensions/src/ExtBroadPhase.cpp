@@ -30,7 +30,10 @@
 
 #include "foundation/PxBounds3.h"
 #include "extensions/PxBroadPhaseExt.h"
+#include "PxScene.h"
 #include "PsFoundation.h"
+#include "PsArray.h"
+#include "PsUserAllocated.h"
 #include "CmPhysXCommon.h"
 
 using namespace physx;
@@ -72,3 +75,335 @@ PxU32 PxBroadPhaseExt::createRegionsFromWorldBounds(PxBounds3* regions, const Px
 	}
 	return nbRegions;
 }
+
+namespace physx
+{
+class BroadPhaseRegionManagerInternal : public Ps::UserAllocated
+{
+	PX_NOCOPY(BroadPhaseRegionManagerInternal)
+	public:
+				BroadPhaseRegionManagerInternal(PxScene* scene, const PxBroadPhaseRegionManagerDesc& desc, void* userData);
+				~BroadPhaseRegionManagerInternal()	{}
+
+		void	update();
+
+		PX_FORCE_INLINE	PxU32	getNbRegions()	const	{ return mNbRegions;	}
+
+		// PT: node of the kd-tree partitioning the world bounds. Leaves own a broad-phase region. The two children
+		// of an internal node are stored next to each other in the node array.
+		struct Node
+		{
+			PxBounds3	mBounds;
+			PxU32		mParent;		// INVALID_ID for the root, FREE_ID for unused nodes
+			PxU32		mChildren;		// Index of the first child, INVALID_ID for leaves
+			PxU32		mRegionHandle;	// INVALID_ID for internal nodes
+			PxReal		mNbObjects;		// Average number of objects in the leaf's region
+			PxU32		mSplitDelay;	// Number of updates before the next split attempt
+
+			PX_FORCE_INLINE	bool	isLeaf()	const	{ return mChildren==INVALID_ID;	}
+			PX_FORCE_INLINE	bool	isFree()	const	{ return mParent==FREE_ID;		}
+		};
+
+		static const PxU32 INVALID_ID = 0xffffffff;
+		static const PxU32 FREE_ID = 0xfffffffe;
+
+	private:
+		PxScene*								mScene;
+		PxBroadPhaseRegionManagerDesc			mDesc;
+		void*									mUserData;
+		Ps::Array<Node>							mNodes;
+		Ps::Array<PxU32>						mFreeNodes;		// Index of the first node of each unused pair of nodes
+		Ps::Array<PxBroadPhaseRegionInfo>		mRegionInfos;
+		PxU32									mNbRegions;
+		PxU32									mMaxNbRegions;	// From PxBroadPhaseCaps, 0 if the manager is disabled
+
+				PxU32	addRegion(const PxBounds3& bounds);
+				PxU32	getNbObjects(PxU32 regionHandle)	const;
+				PxU32	allocateChildren(PxU32 parent);
+				void	releaseChildren(PxU32 parent);
+				PxU32	getSplitAxis(const Node& node)		const;
+				bool	split(PxU32 nodeIndex);
+				void	merge(PxU32 nodeIndex);
+};
+}
+
+// PT: number of updates before regions created by a split that did not separate any object can be split again
+static const PxU32 gSplitDelay = 64;
+
+BroadPhaseRegionManagerInternal::BroadPhaseRegionManagerInternal(PxScene* scene, const PxBroadPhaseRegionManagerDesc& desc, void* userData) :
+	mScene			(scene),
+	mDesc			(desc),
+	mUserData		(userData),
+	mNbRegions		(0),
+	mMaxNbRegions	(0)
+{
+	if(!desc.isValid())
+	{
+		Ps::getFoundation().error(PxErrorCode::eINVALID_PARAMETER, __FILE__, __LINE__, "PxBroadPhaseRegionManager: invalid descriptor. The manager will be disabled.");
+		return;
+	}
+
+	PxBroadPhaseCaps caps;
+	if(!scene->getBroadPhaseCaps(caps) || !caps.needsPredefinedBounds)
+	{
+		Ps::getFoundation().error(PxErrorCode::eDEBUG_WARNING, __FILE__, __LINE__, "PxBroadPhaseRegionManager: the scene's broad-phase does not use regions. The manager will be disabled.");
+		return;
+	}
+
+	const PxU32 rootHandle = addRegion(desc.worldBounds);
+	if(rootHandle==INVALID_ID)
+		return;
+
+	Node root;
+	root.mBounds		= desc.worldBounds;
+	root.mParent		= INVALID_ID;
+	root.mChildren		= INVALID_ID;
+	root.mRegionHandle	= rootHandle;
+	root.mNbObjects		= PxReal(getNbObjects(rootHandle));
+	root.mSplitDelay	= 0;
+	mNodes.pushBack(root);
+
+	mMaxNbRegions = caps.maxNbRegions;
+}
+
+PxU32 BroadPhaseRegionManagerInternal::addRegion(const PxBounds3& bounds)
+{
+	PxBroadPhaseRegion region;
+	region.bounds	= bounds;
+	region.userData	= mUserData;
+	// PT: populating the region adds the existing objects straddling it. The objects fully inside the replaced regions
+	// are moved to it when those regions are removed.
+	const PxU32 handle = mScene->addBroadPhaseRegion(region, true);
+	if(handle!=INVALID_ID)
+		mNbRegions++;
+	return handle;
+}
+
+PxU32 BroadPhaseRegionManagerInternal::getNbObjects(PxU32 regionHandle) const
+{
+	PxBroadPhaseRegionInfo info;
+	if(!mScene->getBroadPhaseRegions(&info, 1, regionHandle))
+		return 0;
+	return info.nbStaticObjects + info.nbDynamicObjects;
+}
+
+PxU32 BroadPhaseRegionManagerInternal::allocateChildren(PxU32 parent)
+{
+	PxU32 index;
+	if(mFreeNodes.size())
+	{
+		index = mFreeNodes.popBack();
+	}
+	else
+	{
+		index = mNodes.size();
+		mNodes.resizeUninitialized(index + 2);
+	}
+	mNodes[index].mParent = parent;
+	mNodes[index+1].mParent = parent;
+	return index;
+}
+
+void BroadPhaseRegionManagerInternal::releaseChildren(PxU32 parent)
+{
+	const PxU32 index = mNodes[parent].mChildren;
+	mNodes[index].mParent = FREE_ID;
+	mNodes[index+1].mParent = FREE_ID;
+	mNodes[parent].mChildren = INVALID_ID;
+	mFreeNodes.pushBack(index);
+}
+
+PxU32 BroadPhaseRegionManagerInternal::getSplitAxis(const Node& node) const
+{
+	const PxVec3 extents = node.mBounds.getDimensions();
+	PxU32 axis = INVALID_ID;
+	PxReal largest = 2.0f * mDesc.minRegionSize;
+	for(PxU32 i=0;i<3;i++)
+	{
+		if(i!=mDesc.upAxis && extents[i]>largest)
+		{
+			largest = extents[i];
+			axis = i;
+		}
+	}
+	return axis;
+}
+
+// PT: the children regions are added before the parent region is removed. Objects which are not populated into the
+// children (because they are fully inside the parent) are moved to them when the parent is removed, so they never
+// become out-of-bounds.
+bool BroadPhaseRegionManagerInternal::split(PxU32 nodeIndex)
+{
+	const PxU32 axis = getSplitAxis(mNodes[nodeIndex]);
+	PX_ASSERT(axis!=INVALID_ID);
+
+	const PxBounds3 bounds = mNodes[nodeIndex].mBounds;
+	const PxReal middle = (bounds.minimum[axis] + bounds.maximum[axis]) * 0.5f;
+	PxBounds3 childBounds[2] = { bounds, bounds };
+	childBounds[0].maximum[axis] = middle;
+	childBounds[1].minimum[axis] = middle;
+
+	PxU32 handles[2];
+	handles[0] = addRegion(childBounds[0]);
+	if(handles[0]==INVALID_ID)
+		return false;
+	handles[1] = addRegion(childBounds[1]);
+	if(handles[1]==INVALID_ID)
+	{
+		mScene->removeBroadPhaseRegion(handles[0]);
+		mNbRegions--;
+		return false;
+	}
+
+	const PxU32 nbObjects = getNbObjects(mNodes[nodeIndex].mRegionHandle);
+	mScene->removeBroadPhaseRegion(mNodes[nodeIndex].mRegionHandle);
+	mNbRegions--;
+
+	PxU32 childNbObjects[2];
+	childNbObjects[0] = getNbObjects(handles[0]);
+	childNbObjects[1] = getNbObjects(handles[1]);
+	// PT: if the split did not separate any object (e.g. all objects straddle the splitting plane), splitting the
+	// children would not either. Wait for the objects to move.
+	const PxU32 splitDelay = childNbObjects[0]>=nbObjects && childNbObjects[1]>=nbObjects ? gSplitDelay : 0;
+
+	const PxU32 children = allocateChildren(nodeIndex);
+	for(PxU32 i=0;i<2;i++)
+	{
+		Node& child = mNodes[children+i];
+		child.mBounds		= childBounds[i];
+		child.mChildren		= INVALID_ID;
+		child.mRegionHandle	= handles[i];
+		child.mNbObjects	= PxReal(childNbObjects[i]);
+		child.mSplitDelay	= splitDelay;
+	}
+
+	Node& node = mNodes[nodeIndex];
+	node.mChildren		= children;
+	node.mRegionHandle	= INVALID_ID;
+	return true;
+}
+
+void BroadPhaseRegionManagerInternal::merge(PxU32 nodeIndex)
+{
+	const PxU32 handle = addRegion(mNodes[nodeIndex].mBounds);
+	if(handle==INVALID_ID)
+		return;
+
+	const PxU32 children = mNodes[nodeIndex].mChildren;
+	for(PxU32 i=0;i<2;i++)
+	{
+		PX_ASSERT(mNodes[children+i].isLeaf());
+		mScene->removeBroadPhaseRegion(mNodes[children+i].mRegionHandle);
+		mNbRegions--;
+	}
+	releaseChildren(nodeIndex);
+
+	Node& node = mNodes[nodeIndex];
+	node.mRegionHandle	= handle;
+	node.mNbObjects		= PxReal(getNbObjects(handle));
+	node.mSplitDelay	= 0;
+}
+
+void BroadPhaseRegionManagerInternal::update()
+{
+	if(!mMaxNbRegions)
+		return;
+
+	// PT: sample the number of objects in all regions at once
+	const PxU32 nbSceneRegions = mScene->getNbBroadPhaseRegions();
+	mRegionInfos.resizeUninitialized(nbSceneRegions);
+	mScene->getBroadPhaseRegions(mRegionInfos.begin(), nbSceneRegions);
+
+	PxU32 nbActiveRegions = 0;
+	for(PxU32 i=0;i<nbSceneRegions;i++)
+		nbActiveRegions += mRegionInfos[i].active ? 1 : 0;
+
+	const PxReal smoothing = mDesc.smoothing;
+	const PxU32 nbNodes = mNodes.size();
+	for(PxU32 i=0;i<nbNodes;i++)
+	{
+		Node& node = mNodes[i];
+		if(node.isFree() || !node.isLeaf())
+			continue;
+
+		const PxBroadPhaseRegionInfo& info = mRegionInfos[node.mRegionHandle];
+		const PxReal nbObjects = PxReal(info.nbStaticObjects + info.nbDynamicObjects);
+		node.mNbObjects += (nbObjects - node.mNbObjects) * smoothing;
+		if(node.mSplitDelay)
+			node.mSplitDelay--;
+	}
+
+	// PT: merges first, since they free regions for the splits. Each split or merge temporarily needs extra regions.
+	for(PxU32 nbChanges=0; nbChanges<mDesc.maxNbChangesPerUpdate; nbChanges++)
+	{
+		PxU32 bestMerge = INVALID_ID;
+		PxReal bestMergeNbObjects = PxReal(mDesc.minNbObjectsPerRegion);
+		PxU32 bestSplit = INVALID_ID;
+		PxReal bestSplitNbObjects = PxReal(mDesc.maxNbObjectsPerRegion);
+
+		for(PxU32 i=0;i<mNodes.size();i++)
+		{
+			const Node& node = mNodes[i];
+			if(node.isFree())
+				continue;
+
+			if(node.isLeaf())
+			{
+				if(!node.mSplitDelay && node.mNbObjects>bestSplitNbObjects && getSplitAxis(node)!=INVALID_ID)
+				{
+					bestSplitNbObjects = node.mNbObjects;
+					bestSplit = i;
+				}
+			}
+			else
+			{
+				const Node& child0 = mNodes[node.mChildren];
+				const Node& child1 = mNodes[node.mChildren+1];
+				if(child0.isLeaf() && child1.isLeaf())
+				{
+					const PxReal nbObjects = child0.mNbObjects + child1.mNbObjects;
+					if(nbObjects<bestMergeNbObjects)
+					{
+						bestMergeNbObjects = nbObjects;
+						bestMerge = i;
+					}
+				}
+			}
+		}
+
+		if(bestMerge!=INVALID_ID && nbActiveRegions<mMaxNbRegions)
+		{
+			merge(bestMerge);
+			nbActiveRegions--;
+		}
+		else if(bestSplit!=INVALID_ID && nbActiveRegions+2<=mMaxNbRegions && mNbRegions<mDesc.maxNbRegions)
+		{
+			if(split(bestSplit))
+				nbActiveRegions++;
+			else
+				break;
+		}
+		else
+			break;
+	}
+}
+
+PxBroadPhaseRegionManager::PxBroadPhaseRegionManager(PxScene* scene, const PxBroadPhaseRegionManagerDesc& desc)
+{
+	mImpl = PX_NEW(BroadPhaseRegionManagerInternal)(scene, desc, this);
+}
+
+PxBroadPhaseRegionManager::~PxBroadPhaseRegionManager()
+{
+	PX_DELETE(mImpl);
+}
+
+void PxBroadPhaseRegionManager::update()
+{
+	mImpl->update();
+}
+
+PxU32 PxBroadPhaseRegionManager::getNbRegions() const
+{
+	return mImpl->getNbRegions();
+}
@@ -0,0 +1,371 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "ExtCpuTopology.h"
+#include "extensions/PxDefaultCpuDispatcher.h"
+#include "PsBitUtils.h"
+#include "PsString.h"
+#include "PsFoundation.h"
+#include "foundation/PxMath.h"
+
+#if PX_LINUX
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace physx;
+
+PxU32 Ext::CpuSet::lowest() const
+{
+	for(PxU32 i = 0; i < eNB_WORDS; i++)
+	{
+		if(words[i])
+		{
+			const PxU32 low = PxU32(words[i]);
+			return i * 64 + (low ? Ps::lowestSetBit(low) : 32 + Ps::lowestSetBit(PxU32(words[i] >> 32)));
+		}
+	}
+	return EXT_MAX_TOPOLOGY_CPUS;
+}
+
+PxU32 Ext::CpuSet::countBelow(PxU32 limit) const
+{
+	limit = PxMin(limit, PxU32(EXT_MAX_TOPOLOGY_CPUS));
+
+	PxU32 count = 0;
+	for(PxU32 i = 0; i < (limit >> 6); i++)
+		count += Ps::bitCount(PxU32(words[i])) + Ps::bitCount(PxU32(words[i] >> 32));
+
+	if(limit & 63)
+	{
+		const PxU64 partial = words[limit >> 6] & ((PxU64(1) << (limit & 63)) - 1);
+		count += Ps::bitCount(PxU32(partial)) + Ps::bitCount(PxU32(partial >> 32));
+	}
+	return count;
+}
+
+#if PX_LINUX
+
+// Reads the first line of a sysfs file
+static bool readSysFile(const char* path, char* buffer, PxU32 bufferSize)
+{
+	FILE* file = fopen(path, "r");
+	if(!file)
+		return false;
+
+	const bool success = fgets(buffer, int(bufferSize), file) != NULL;
+	fclose(file);
+	return success;
+}
+
+static bool readSysValue(const char* path, PxU32& value)
+{
+	char buffer[64];
+	if(!readSysFile(path, buffer, sizeof(buffer)))
+		return false;
+
+	value = PxU32(strtoul(buffer, NULL, 10));
+	return true;
+}
+
+// Parses a list such as "0-3,8-11" into a set
+static void parseCpuList(const char* list, Ext::CpuSet& set)
+{
+	set.clear();
+
+	const char* current = list;
+	while(*current >= '0' && *current <= '9')
+	{
+		char* end;
+		const PxU32 first = PxU32(strtoul(current, &end, 10));
+		PxU32 last = first;
+		current = end;
+		if(*current == '-')
+		{
+			last = PxU32(strtoul(current + 1, &end, 10));
+			current = end;
+		}
+
+		for(PxU32 i = first; i <= last && i < EXT_MAX_TOPOLOGY_CPUS; i++)
+			set.set(i);
+
+		if(*current == ',')
+			current++;
+	}
+}
+
+// Lists of many processors can be long, "0,2,4,...,254" already takes 600 characters
+static void readCpuListFile(const char* path, Ext::CpuSet& set)
+{
+	char buffer[8192];
+	if(readSysFile(path, buffer, sizeof(buffer)))
+		parseCpuList(buffer, set);
+	else
+		set.clear();
+}
+
+void Ext::readCpuTopology(Ps::Array<CpuTopologyEntry>& entries)
+{
+	char path[128];
+
+	entries.clear();
+
+	CpuSet onlineCpus;
+	readCpuListFile("/sys/devices/system/cpu/online", onlineCpus);
+	if(onlineCpus.isEmpty())
+		return;
+
+	// Kernels without NUMA support have no node directory, everything is node 0 then
+	Ps::Array<PxU32> nodeOfCpu;
+	nodeOfCpu.resize(EXT_MAX_TOPOLOGY_CPUS, 0);
+
+	CpuSet onlineNodes;
+	readCpuListFile("/sys/devices/system/node/online", onlineNodes);
+	for(PxU32 node = 0; node < EXT_MAX_TOPOLOGY_CPUS; node++)
+	{
+		if(!onlineNodes.test(node))
+			continue;
+
+		Ps::snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+		CpuSet nodeCpus;
+		readCpuListFile(path, nodeCpus);
+		for(PxU32 cpu = 0; cpu < EXT_MAX_TOPOLOGY_CPUS; cpu++)
+		{
+			if(nodeCpus.test(cpu))
+				nodeOfCpu[cpu] = node;
+		}
+	}
+
+	for(PxU32 cpu = 0; cpu < EXT_MAX_TOPOLOGY_CPUS; cpu++)
+	{
+		if(!onlineCpus.test(cpu))
+			continue;
+
+		PxU32 packageId = 0;
+		PxU32 coreId = cpu;
+		Ps::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/physical_package_id", cpu);
+		readSysValue(path, packageId);
+		Ps::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/core_id", cpu);
+		readSysValue(path, coreId);
+
+		Ps::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", cpu);
+		CpuSet siblings;
+		readCpuListFile(path, siblings);
+
+		// Last level cache, i.e. the cache index with the highest level. Fall back to the package.
+		PxU32 cacheGroup = 0x10000 + packageId;
+		PxU32 highestLevel = 0;
+		for(PxU32 index = 0; index < 8; index++)
+		{
+			PxU32 level;
+			Ps::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/level", cpu, index);
+			if(!readSysValue(path, level))
+				break;
+
+			if(level > highestLevel)
+			{
+				Ps::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", cpu, index);
+				CpuSet sharing;
+				readCpuListFile(path, sharing);
+				if(!sharing.isEmpty())
+				{
+					highestLevel = level;
+					cacheGroup = sharing.lowest();
+				}
+			}
+		}
+
+		CpuTopologyEntry entry;
+		entry.cpu			= cpu;
+		entry.numaNode		= nodeOfCpu[cpu];
+		entry.cacheGroup	= cacheGroup;
+		entry.core			= (packageId << 16) | (coreId & 0xffff);
+		entry.smtRank		= siblings.countBelow(cpu);
+		entries.pushBack(entry);
+	}
+}
+
+static bool setCurrentThreadCpu(PxU32 cpu)
+{
+	if(cpu >= CPU_SETSIZE)
+		return false;
+
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+#else
+
+void Ext::readCpuTopology(Ps::Array<CpuTopologyEntry>& entries)
+{
+	entries.clear();
+}
+
+static bool setCurrentThreadCpu(PxU32)
+{
+	return false;
+}
+
+#endif
+
+void Ext::pinCurrentThread(PxU32 cpu)
+{
+	if(cpu != PX_MAX_U32 && !setCurrentThreadCpu(cpu))
+		Ps::getFoundation().error(PxErrorCode::eDEBUG_WARNING, __FILE__, __LINE__, "PxDefaultCpuDispatcher: a worker thread could not be pinned to its processor.");
+}
+
+namespace
+{
+	struct TopologyOrder
+	{
+		PxU32	preferredNode;
+		bool	preferPhysicalCores;
+
+		// Cores of the preferred node first, then cores sharing a cache next to each other
+		bool lessThan(const Ext::CpuTopologyEntry& a, const Ext::CpuTopologyEntry& b) const
+		{
+			const PxU32 nodeRankA = a.numaNode == preferredNode ? 0 : 1;
+			const PxU32 nodeRankB = b.numaNode == preferredNode ? 0 : 1;
+			if(nodeRankA != nodeRankB)	return nodeRankA < nodeRankB;
+			if(a.numaNode != b.numaNode)	return a.numaNode < b.numaNode;
+
+			if(preferPhysicalCores)
+			{
+				const PxU32 siblingA = a.smtRank ? 1 : 0;
+				const PxU32 siblingB = b.smtRank ? 1 : 0;
+				if(siblingA != siblingB)	return siblingA < siblingB;
+			}
+
+			if(a.cacheGroup != b.cacheGroup)	return a.cacheGroup < b.cacheGroup;
+			if(a.core != b.core)				return a.core < b.core;
+			return a.smtRank < b.smtRank;
+		}
+	};
+
+	bool isCpuAllowed(const PxDefaultCpuDispatcherTopologyDesc& desc, PxU32 cpu)
+	{
+		if(desc.cpuSetWords)
+			return (cpu >> 6) < desc.nbCpuSetWords && (desc.cpuSetWords[cpu >> 6] & (PxU64(1) << (cpu & 63)));
+
+		return !desc.cpuSet || (cpu < 32 && (desc.cpuSet & (1u << cpu)));
+	}
+}
+
+PxU32 physx::PxDefaultCpuDispatcherGetTopologyCpus(PxU32 numThreads, const PxDefaultCpuDispatcherTopologyDesc& desc, PxU32* cpus)
+{
+	Ps::Array<Ext::CpuTopologyEntry> entries;
+	Ext::readCpuTopology(entries);
+
+	PxU32 nbEntries = 0;
+	for(PxU32 i = 0; i < entries.size(); i++)
+	{
+		if(isCpuAllowed(desc, entries[i].cpu))
+			entries[nbEntries++] = entries[i];
+	}
+	entries.forceSize_Unsafe(nbEntries);
+
+	if(!nbEntries)
+	{
+		// Topology not available, let the OS schedule the threads
+		for(PxU32 i = 0; i < numThreads; i++)
+			cpus[i] = PX_MAX_U32;
+		return 0;
+	}
+
+	// Default to the node with the most usable processors
+	TopologyOrder order;
+	order.preferredNode = desc.preferredNumaNode;
+	order.preferPhysicalCores = desc.preferPhysicalCores;
+	if(order.preferredNode == PX_MAX_U32)
+	{
+		Ps::Array<PxU32> nodeCounts;
+		for(PxU32 i = 0; i < nbEntries; i++)
+		{
+			if(entries[i].numaNode >= nodeCounts.size())
+				nodeCounts.resize(entries[i].numaNode + 1, 0);
+			nodeCounts[entries[i].numaNode]++;
+		}
+
+		PxU32 bestCount = 0;
+		for(PxU32 node = 0; node < nodeCounts.size(); node++)
+		{
+			if(nodeCounts[node] > bestCount)
+			{
+				bestCount = nodeCounts[node];
+				order.preferredNode = node;
+			}
+		}
+	}
+
+	// Insertion sort, the entries are almost sorted already
+	for(PxU32 i = 1; i < nbEntries; i++)
+	{
+		const Ext::CpuTopologyEntry entry = entries[i];
+		PxU32 j = i;
+		for(; j > 0 && order.lessThan(entry, entries[j - 1]); j--)
+			entries[j] = entries[j - 1];
+		entries[j] = entry;
+	}
+
+	// One processor per worker, wrapping around when there are more workers than processors
+	Ps::Array<PxU32> usedCores;
+	for(PxU32 i = 0; i < numThreads; i++)
+	{
+		const Ext::CpuTopologyEntry& entry = entries[i % nbEntries];
+		cpus[i] = entry.cpu;
+
+		if(usedCores.find(entry.core) == usedCores.end())
+			usedCores.pushBack(entry.core);
+	}
+
+	return usedCores.size();
+}
+
+PxU32 physx::PxDefaultCpuDispatcherGetTopologyAffinityMasks(PxU32 numThreads, const PxDefaultCpuDispatcherTopologyDesc& desc, PxU32* affinityMasks)
+{
+	const PxU32 nbCores = PxDefaultCpuDispatcherGetTopologyCpus(numThreads, desc, affinityMasks);
+
+	bool truncated = false;
+	for(PxU32 i = 0; i < numThreads; i++)
+	{
+		const PxU32 cpu = affinityMasks[i];
+		truncated |= cpu != PX_MAX_U32 && cpu >= 32;
+		affinityMasks[i] = cpu < 32 ? 1u << cpu : 0;
+	}
+
+	if(truncated)
+		Ps::getFoundation().error(PxErrorCode::eDEBUG_WARNING, __FILE__, __LINE__,
+			"PxDefaultCpuDispatcherGetTopologyAffinityMasks: processors above 31 don't fit in an affinity mask, the workers placed on them are not pinned. Use PxDefaultCpuDispatcherGetTopologyCpus() instead.");
+
+	return nbCores;
+}
@@ -0,0 +1,80 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+
+#ifndef PX_PHYSICS_EXTENSIONS_NP_CPU_TOPOLOGY_H
+#define PX_PHYSICS_EXTENSIONS_NP_CPU_TOPOLOGY_H
+
+#include "CmPhysXCommon.h"
+#include "PsArray.h"
+
+namespace physx
+{
+
+#define EXT_MAX_TOPOLOGY_CPUS 1024	// Same as the default CPU_SETSIZE of glibc
+
+namespace Ext
+{
+	// One logical processor as seen by the OS
+	struct CpuTopologyEntry
+	{
+		PxU32	cpu;			// Logical processor index
+		PxU32	numaNode;
+		PxU32	cacheGroup;		// First logical processor sharing the last level cache with this one
+		PxU32	core;			// Unique id of the physical core (package and core id)
+		PxU32	smtRank;		// 0 for the first hardware thread of a core, 1 for its first sibling, ...
+	};
+
+	// Set of logical processors or NUMA nodes, wider than the 32 bit affinity masks
+	struct CpuSet
+	{
+		enum { eNB_WORDS = EXT_MAX_TOPOLOGY_CPUS / 64 };
+
+		PxU64	words[eNB_WORDS];
+
+		CpuSet()									{ clear();	}
+		void	clear()								{ for(PxU32 i = 0; i < eNB_WORDS; i++) words[i] = 0;	}
+		void	set(PxU32 i)						{ if(i < EXT_MAX_TOPOLOGY_CPUS) words[i >> 6] |= PxU64(1) << (i & 63);	}
+		bool	test(PxU32 i) const					{ return i < EXT_MAX_TOPOLOGY_CPUS && (words[i >> 6] & (PxU64(1) << (i & 63))) != 0;	}
+		bool	isEmpty() const						{ for(PxU32 i = 0; i < eNB_WORDS; i++) if(words[i]) return false; return true;	}
+		PxU32	lowest() const;						// EXT_MAX_TOPOLOGY_CPUS if empty
+		PxU32	countBelow(PxU32 limit) const;		// Number of members lower than limit
+	};
+
+	// Fills entries with the online logical processors, leaves it empty if the topology can't be read on this platform.
+	void readCpuTopology(Ps::Array<CpuTopologyEntry>& entries);
+
+	// Pins the calling worker thread to one logical processor, PX_MAX_U32 leaves it to the OS. Warns if the OS refuses.
+	void pinCurrentThread(PxU32 cpu);
+
+} // namespace Ext
+
+}
+
+#endif
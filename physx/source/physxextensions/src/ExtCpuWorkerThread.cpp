@@ -32,14 +32,18 @@
 #include "ExtCpuWorkerThread.h"
 #include "ExtDefaultCpuDispatcher.h"
 #include "ExtTaskQueueHelper.h"
+#include "ExtCpuWorkerWait.h"
+#include "ExtCpuTopology.h"
 #include "PsFPU.h"
 
 using namespace physx;
 
 Ext::CpuWorkerThread::CpuWorkerThread()
 :	mQueueEntryPool(EXT_TASK_QUEUE_ENTRY_POOL_SIZE),
-	mThreadId(0)
+	mThreadId(0),
+	mCpu(PX_MAX_U32)
 {
+	resetStatistics();
 }
 
 
@@ -78,26 +82,47 @@ PxBaseTask* Ext::CpuWorkerThread::giveUpJob()
 }
 
 
+PxBaseTask* Ext::CpuWorkerThread::pollTask()
+{
+	PxBaseTask* task = TaskQueueHelper::fetchTask(mLocalJobList, mQueueEntryPool);
+
+	if(!task)
+		task = mOwner->getJob();
+
+	if(!task)
+	{
+		task = mOwner->stealJob();
+		if(task)
+			mStatistics.nbSteals++;
+	}
+
+	return task;
+}
+
+
 void Ext::CpuWorkerThread::execute()
 {
 	mThreadId = getId();
+	pinCurrentThread(mCpu);
 
 	while (!quitIsSignalled())
     {
         mOwner->resetWakeSignal();
 
-		PxBaseTask* task = TaskQueueHelper::fetchTask(mLocalJobList, mQueueEntryPool);
+		PxBaseTask* task = pollTask();
 
 		if(!task)
-			task = mOwner->fetchNextTask();
+			task = waitForTaskActively(*this, *mOwner, mStatistics);
 		
 		if (task)
 		{
 			mOwner->runTask(*task);
 			task->release();
+			mStatistics.nbTasks++;
 		}
-		else
+		else if (!quitIsSignalled())
 		{
+			mStatistics.nbParks++;
 			mOwner->waitForWork();
 		}
 	}
@@ -32,6 +32,7 @@
 #define PX_PHYSICS_EXTENSIONS_NP_CPU_WORKER_THREAD_H
 
 #include "CmPhysXCommon.h"
+#include "foundation/PxMemory.h"
 #include "PsThread.h"
 #include "ExtDefaultCpuDispatcher.h"
 #include "ExtSharedQueueEntryPool.h"
@@ -59,13 +60,21 @@ class DefaultCpuDispatcher;
 		void					execute();
 		bool					tryAcceptJobToLocalQueue(PxBaseTask& task, Ps::Thread::Id taskSubmitionThread);
 		PxBaseTask*				giveUpJob();
+		PxBaseTask*				pollTask();
 		Ps::Thread::Id			getWorkerThreadId() const { return mThreadId; }
+		void					setCpu(PxU32 cpu) { mCpu = cpu; }
+
+		const PxDefaultCpuDispatcherWorkerStatistics&	getStatistics() const { return mStatistics; }
+		void					resetStatistics() { PxMemZero(&mStatistics, sizeof(mStatistics)); }
+		const SharedQueueEntryPool<>&	getQueueEntryPool() const { return mQueueEntryPool; }
 
 	protected:
 		SharedQueueEntryPool<>			mQueueEntryPool;
 		DefaultCpuDispatcher*			mOwner;
 		Ps::SList      				    mLocalJobList;
 		Ps::Thread::Id					mThreadId;
+		PxU32							mCpu;	// Logical processor the worker pins itself to, PX_MAX_U32 for none
+		PxDefaultCpuDispatcherWorkerStatistics	mStatistics;
 	};
 
 #if PX_VC
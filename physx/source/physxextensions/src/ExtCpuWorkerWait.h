@@ -0,0 +1,100 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+
+#ifndef PX_PHYSICS_EXTENSIONS_NP_CPU_WORKER_WAIT_H
+#define PX_PHYSICS_EXTENSIONS_NP_CPU_WORKER_WAIT_H
+
+#include "task/PxTask.h"
+#include "extensions/PxDefaultCpuDispatcher.h"
+#include "CmPhysXCommon.h"
+#include "PsThread.h"
+#include "foundation/PxMath.h"
+
+namespace physx
+{
+
+#define EXT_WORKER_MAX_SPIN_BACKOFF 64	// Max number of pause instructions between two polls
+
+namespace Ext
+{
+	/*
+	Active wait of an idle worker before it parks, according to the dispatcher's wait policy: polls with
+	exponential back-off until the spin budget is used up, then yields and polls until the yield budget is
+	used up. Yielding goes on for as long as the dispatcher's frame-active hint is set.
+
+	Worker needs PxBaseTask* pollTask() and quitIsSignalled(), Dispatcher needs getWaitPolicy() and isFrameActive().
+	Returns NULL if the worker should park.
+	*/
+	template<class Worker, class Dispatcher>
+	PxBaseTask* waitForTaskActively(Worker& worker, const Dispatcher& dispatcher, PxDefaultCpuDispatcherWorkerStatistics& stats)
+	{
+		const PxDefaultCpuDispatcherWaitPolicy policy = dispatcher.getWaitPolicy();
+		if(!policy.spinCount && !policy.yieldCount && !dispatcher.isFrameActive())
+			return NULL;
+
+		stats.nbSpins++;
+
+		PxU32 backOff = 1;
+		for(PxU32 nbPauses = 0; nbPauses < policy.spinCount; nbPauses += backOff)
+		{
+			for(PxU32 i = 0; i < backOff; i++)
+				PxSpinLockPause();
+
+			PxBaseTask* task = worker.pollTask();
+			if(task)
+			{
+				stats.nbSpinHits++;
+				return task;
+			}
+
+			backOff = PxMin(backOff * 2, PxU32(EXT_WORKER_MAX_SPIN_BACKOFF));
+		}
+
+		for(PxU32 nbYields = 0; (nbYields < policy.yieldCount || dispatcher.isFrameActive()) && !worker.quitIsSignalled(); nbYields++)
+		{
+			Ps::Thread::yield();
+			stats.nbYields++;
+
+			PxBaseTask* task = worker.pollTask();
+			if(task)
+			{
+				stats.nbSpinHits++;
+				return task;
+			}
+		}
+
+		return NULL;
+	}
+
+} // namespace Ext
+
+}
+
+#endif
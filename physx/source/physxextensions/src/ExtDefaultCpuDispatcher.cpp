@@ -30,13 +30,43 @@
 #include "ExtDefaultCpuDispatcher.h"
 #include "ExtCpuWorkerThread.h"
 #include "ExtTaskQueueHelper.h"
+#include "ExtWorkStealingCpuDispatcher.h"
+#include "ExtSceneSchedulingCpuDispatcher.h"
 #include "PsString.h"
+#include "foundation/PxMath.h"
 
 using namespace physx;
 
-PxDefaultCpuDispatcher* physx::PxDefaultCpuDispatcherCreate(PxU32 numThreads, PxU32* affinityMasks)
+// cpus, if defined, gives the logical processor each worker pins itself to and overrides the affinity masks
+static PxDefaultCpuDispatcher* createDispatcher(PxU32 numThreads, PxU32* affinityMasks, const PxU32* cpus, PxDefaultCpuDispatcherSchedulingMode::Enum mode)
 {
-	return PX_NEW(Ext::DefaultCpuDispatcher)(numThreads, affinityMasks);
+	if(mode == PxDefaultCpuDispatcherSchedulingMode::eWORK_STEALING)
+		return PX_NEW(Ext::WorkStealingCpuDispatcher)(numThreads, affinityMasks, cpus);
+
+	if(mode == PxDefaultCpuDispatcherSchedulingMode::eSCENE_PRIORITY)
+		return PX_NEW(Ext::SceneSchedulingCpuDispatcher)(numThreads, affinityMasks, cpus);
+
+	return PX_NEW(Ext::DefaultCpuDispatcher)(numThreads, affinityMasks, cpus);
+}
+
+PxDefaultCpuDispatcher* physx::PxDefaultCpuDispatcherCreate(PxU32 numThreads, PxU32* affinityMasks, PxDefaultCpuDispatcherSchedulingMode::Enum mode)
+{
+	return createDispatcher(numThreads, affinityMasks, NULL, mode);
+}
+
+PxDefaultCpuDispatcher* physx::PxDefaultCpuDispatcherCreate(PxU32 numThreads, const PxDefaultCpuDispatcherTopologyDesc& topologyDesc, PxDefaultCpuDispatcherSchedulingMode::Enum mode)
+{
+	// Processor indices rather than masks, so that workers can be pinned beyond the first 32 processors
+	PxU32* cpus = numThreads ? reinterpret_cast<PxU32*>(PX_ALLOC(numThreads * sizeof(PxU32), "ThreadCpus")) : NULL;
+	if(cpus)
+		PxDefaultCpuDispatcherGetTopologyCpus(numThreads, topologyDesc, cpus);
+
+	PxDefaultCpuDispatcher* dispatcher = createDispatcher(numThreads, NULL, cpus, mode);
+
+	if(cpus)
+		PX_FREE(cpus);
+
+	return dispatcher;
 }
 
 #if !PX_PS4 && !PX_XBOXONE && !PX_SWITCH && !PX_XBOX_SERIES_X
@@ -49,13 +79,14 @@ void Ext::DefaultCpuDispatcher::getAffinityMasks(PxU32* affinityMasks, PxU32 thr
 }
 #endif
 
-Ext::DefaultCpuDispatcher::DefaultCpuDispatcher(PxU32 numThreads, PxU32* affinityMasks)
+Ext::DefaultCpuDispatcher::DefaultCpuDispatcher(PxU32 numThreads, PxU32* affinityMasks, const PxU32* cpus)
 	: mQueueEntryPool(EXT_TASK_QUEUE_ENTRY_POOL_SIZE, "QueueEntryPool"), mNumThreads(numThreads), mShuttingDown(false)
 #if PX_PROFILE
 	,mRunProfiled(true)
 #else
 	,mRunProfiled(false)
 #endif
+	,mFrameActive(false)
 {
 	PxU32* defaultAffinityMasks = NULL;
 
@@ -89,7 +120,10 @@ Ext::DefaultCpuDispatcher::DefaultCpuDispatcher(PxU32 numThreads, PxU32* affinit
 				mWorkerThreads[i].setName(threadName);
 			}
 
-			mWorkerThreads[i].setAffinityMask(affinityMasks[i]);
+			if(cpus)
+				mWorkerThreads[i].setCpu(cpus[i]);
+			else
+				mWorkerThreads[i].setAffinityMask(affinityMasks[i]);
 			mWorkerThreads[i].start(Ps::Thread::getDefaultStackSize());
 		}
 
@@ -147,16 +181,6 @@ void Ext::DefaultCpuDispatcher::submitTask(PxBaseTask& task)
 	}
 }
 
-PxBaseTask* Ext::DefaultCpuDispatcher::fetchNextTask()
-{
-	PxBaseTask* task = getJob();
-
-	if(!task)
-		task = stealJob();
-
-	return task;
-}
-
 void Ext::DefaultCpuDispatcher::release()
 {
 	PX_DELETE(this);
@@ -182,6 +206,36 @@ PxBaseTask* Ext::DefaultCpuDispatcher::stealJob()
 	return ret;
 }
 
+PxU32 Ext::DefaultCpuDispatcher::getWorkerStatistics(PxDefaultCpuDispatcherWorkerStatistics* userBuffer, PxU32 bufferSize) const
+{
+	const PxU32 nb = PxMin(bufferSize, mNumThreads);
+	for(PxU32 i = 0; i < nb; ++i)
+		userBuffer[i] = mWorkerThreads[i].getStatistics();
+	return nb;
+}
+
+void Ext::DefaultCpuDispatcher::resetWorkerStatistics()
+{
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].resetStatistics();
+}
+
+void Ext::DefaultCpuDispatcher::getQueueStatistics(PxDefaultCpuDispatcherQueueStatistics& stats) const
+{
+	stats.nbEntries = mQueueEntryPool.getNbEntries();
+	stats.nbSlabs = mQueueEntryPool.getNbSlabs();
+	stats.maxNbEntriesUsed = mQueueEntryPool.getMaxNbEntriesUsed();
+
+	// Tasks submitted by the workers themselves go through their own pools
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+	{
+		const SharedQueueEntryPool<>& pool = mWorkerThreads[i].getQueueEntryPool();
+		stats.nbEntries += pool.getNbEntries();
+		stats.nbSlabs += pool.getNbSlabs();
+		stats.maxNbEntriesUsed += pool.getMaxNbEntriesUsed();
+	}
+}
+
 void Ext::DefaultCpuDispatcher::resetWakeSignal()
 {
 	mWorkReady.reset();
@@ -60,7 +60,7 @@ namespace Ext
 												DefaultCpuDispatcher() : mQueueEntryPool(0) {}
 												~DefaultCpuDispatcher();
 	public:
-												DefaultCpuDispatcher(PxU32 numThreads, PxU32* affinityMasks);
+												DefaultCpuDispatcher(PxU32 numThreads, PxU32* affinityMasks, const PxU32* cpus);
 
 		//---------------------------------------------------------------------------------
 		// PxCpuDispatcher implementation
@@ -77,12 +77,33 @@ namespace Ext
 
 		virtual			bool					getRunProfiled() const { return mRunProfiled; }
 
+		virtual			void					setWaitPolicy(const PxDefaultCpuDispatcherWaitPolicy& policy) { mWaitPolicy = policy; }
+
+		virtual			PxDefaultCpuDispatcherWaitPolicy	getWaitPolicy() const { return mWaitPolicy; }
+
+		virtual			void					setFrameActive(bool active) { mFrameActive = active; }
+
+		virtual			bool					isFrameActive() const { return mFrameActive; }
+
+		virtual			PxU32					getWorkerStatistics(PxDefaultCpuDispatcherWorkerStatistics* userBuffer, PxU32 bufferSize) const;
+
+		virtual			void					resetWorkerStatistics();
+
+		virtual			void					getQueueStatistics(PxDefaultCpuDispatcherQueueStatistics& stats) const;
+
+		virtual			bool					setSceneSchedulingParams(PxU64, const PxDefaultCpuDispatcherSceneParams&) { return false; }
+
+		virtual			void					setSceneDeadline(PxU64, PxReal) {}
+
+		virtual			bool					getSceneStatistics(PxU64, PxDefaultCpuDispatcherSceneStatistics&) const { return false; }
+
+		virtual			void					removeScene(PxU64) {}
+
 		//---------------------------------------------------------------------------------
 		// DefaultCpuDispatcher
 		//---------------------------------------------------------------------------------
 						PxBaseTask*				getJob();
 						PxBaseTask*				stealJob();
-						PxBaseTask*				fetchNextTask();
 
 		PX_FORCE_INLINE	void					runTask(PxBaseTask& task)
 												{
@@ -109,8 +130,10 @@ namespace Ext
 						Ps::Sync				mWorkReady;
 						PxU8*					mThreadNames;
 						PxU32					mNumThreads;
+						PxDefaultCpuDispatcherWaitPolicy	mWaitPolicy;
 						bool					mShuttingDown;
 						bool					mRunProfiled;
+						volatile bool			mFrameActive;
 	};
 
 #if PX_VC
@@ -0,0 +1,508 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "ExtSceneSchedulingCpuDispatcher.h"
+#include "ExtDefaultCpuDispatcher.h"
+#include "ExtTaskQueueHelper.h"
+#include "ExtCpuWorkerWait.h"
+#include "ExtCpuTopology.h"
+#include "PsAtomic.h"
+#include "PsIntrinsics.h"
+#include "PsString.h"
+#include "PsTime.h"
+#include "foundation/PxMath.h"
+
+using namespace physx;
+
+namespace
+{
+	PX_FORCE_INLINE PxU64 getCurrentTime()
+	{
+		return Ps::Time::getBootCounterFrequency().toTensOfNanos(Ps::Time::getCurrentCounterValue());
+	}
+
+	// Pass values wrap around, only their difference is meaningful
+	PX_FORCE_INLINE PxI32 passDifference(PxI32 a, PxI32 b)
+	{
+		return PxI32(PxU32(a) - PxU32(b));
+	}
+
+	PX_FORCE_INLINE void setSceneParams(Ext::SceneTaskQueue& scene, const PxDefaultCpuDispatcherSceneParams& params)
+	{
+		scene.mPriority = params.priority;
+		scene.mStride = PxI32(EXT_SCENE_PASS_STRIDE / PxClamp(params.weight, PxU32(1), PxU32(EXT_SCENE_PASS_STRIDE)));
+	}
+
+	// Writers are serialized by mSceneMutex. Ps atomics are full barriers, so readers see the odd sequence before the new value.
+	void writeDeadline(Ext::SceneTaskQueue& scene, PxU64 deadline)
+	{
+		Ps::atomicIncrement(&scene.mDeadlineSequence);
+		scene.mDeadline = deadline;
+		Ps::atomicIncrement(&scene.mDeadlineSequence);
+	}
+
+	// Lock-free read, retried if a write was in progress
+	PxU64 readDeadline(const Ext::SceneTaskQueue& scene)
+	{
+		for(;;)
+		{
+			const PxI32 sequence = scene.mDeadlineSequence;
+			Ps::memoryBarrier();
+			const PxU64 deadline = scene.mDeadline;
+			Ps::memoryBarrier();
+			if(!(sequence & 1) && sequence == scene.mDeadlineSequence)
+				return deadline;
+		}
+	}
+
+	void resetScene(Ext::SceneTaskQueue& scene, PxU64 contextId, PxI32 pass)
+	{
+		scene.mContextId = contextId;
+		writeDeadline(scene, 0);
+		setSceneParams(scene, PxDefaultCpuDispatcherSceneParams());
+		scene.mPass = pass;
+		scene.mNbQueued = 0;
+		scene.mNbTasks = 0;
+		scene.mNbLateTasks = 0;
+		scene.mNbSubmitting = 0;
+	}
+
+	// True if the tasks of scene a should run before the tasks of scene b
+	bool isMoreUrgent(const Ext::SceneTaskQueue& a, const Ext::SceneTaskQueue& b)
+	{
+		if(a.mPriority != b.mPriority)
+			return a.mPriority > b.mPriority;
+
+		// Scenes without deadline come last
+		PxU64 deadlineA = readDeadline(a);
+		PxU64 deadlineB = readDeadline(b);
+		deadlineA = deadlineA ? deadlineA : ~PxU64(0);
+		deadlineB = deadlineB ? deadlineB : ~PxU64(0);
+		if(deadlineA != deadlineB)
+			return deadlineA < deadlineB;
+
+		return passDifference(a.mPass, b.mPass) < 0;
+	}
+}
+
+Ext::SceneSchedulingWorkerThread::SceneSchedulingWorkerThread()
+:	mOwner(NULL),
+	mParked(0)
+{
+	resetStatistics();
+}
+
+Ext::SceneSchedulingWorkerThread::~SceneSchedulingWorkerThread()
+{
+}
+
+void Ext::SceneSchedulingWorkerThread::initialize(SceneSchedulingCpuDispatcher* ownerDispatcher)
+{
+	mOwner = ownerDispatcher;
+}
+
+bool Ext::SceneSchedulingWorkerThread::unpark()
+{
+	if(mParked && Ps::atomicCompareExchange(&mParked, 0, 1) == 1)
+	{
+		Ps::atomicDecrement(&mOwner->mNumParked);
+		mWakeUp.set();
+		return true;
+	}
+	return false;
+}
+
+// Same protocol as WorkStealingWorkerThread::park()
+void Ext::SceneSchedulingWorkerThread::park()
+{
+	mWakeUp.reset();
+
+	// Announce that we are going to sleep before checking for work one last time. Submitters publish
+	// their task before they look for parked workers, so either they see us parked or we see their task.
+	if(Ps::atomicExchange(&mParked, 1) == 0)
+		Ps::atomicIncrement(&mOwner->mNumParked);
+
+	PxBaseTask* task = mOwner->fetchNextTask();
+	if(!task && !quitIsSignalled())
+	{
+		// Whoever wakes us up also clears the parked flag
+		mStatistics.nbParks++;
+		mWakeUp.wait();
+		return;
+	}
+
+	if(Ps::atomicCompareExchange(&mParked, 0, 1) == 1)
+		Ps::atomicDecrement(&mOwner->mNumParked);
+	else
+		mOwner->wakeOneWorker();	// We consumed a wake-up meant for the task we just took, pass it on
+
+	if(task)
+	{
+		mOwner->runTask(*task);
+		task->release();
+		mStatistics.nbTasks++;
+	}
+}
+
+PxBaseTask* Ext::SceneSchedulingWorkerThread::pollTask()
+{
+	return mOwner->fetchNextTask();
+}
+
+void Ext::SceneSchedulingWorkerThread::execute()
+{
+	pinCurrentThread(mCpu);
+
+	while(!quitIsSignalled())
+	{
+		PxBaseTask* task = pollTask();
+
+		if(!task)
+			task = waitForTaskActively(*this, *mOwner, mStatistics);
+
+		if(task)
+		{
+			mOwner->runTask(*task);
+			task->release();
+			mStatistics.nbTasks++;
+		}
+		else
+		{
+			park();
+		}
+	}
+
+	quit();
+}
+
+Ext::SceneSchedulingCpuDispatcher::SceneSchedulingCpuDispatcher(PxU32 numThreads, PxU32* affinityMasks, const PxU32* cpus)
+	: mQueueEntryPool(EXT_TASK_QUEUE_ENTRY_POOL_SIZE, "QueueEntryPool"), mNbScenes(1), mGlobalPass(0), mNumParked(0), mNextWakeUp(0), mNumThreads(numThreads)
+#if PX_PROFILE
+	,mRunProfiled(true)
+#else
+	,mRunProfiled(false)
+#endif
+	,mFrameActive(false)
+{
+	for(PxU32 i = 0; i <= EXT_MAX_SCHEDULED_SCENES; ++i)
+	{
+		mScenes[i].mDeadlineSequence = 0;
+		resetScene(mScenes[i], 0, 0);
+		mScenes[i].mInUse = false;
+	}
+	mScenes[0].mInUse = true;
+
+	PxU32* defaultAffinityMasks = NULL;
+
+	if(!affinityMasks)
+	{
+		defaultAffinityMasks = reinterpret_cast<PxU32*>(PX_ALLOC(numThreads * sizeof(PxU32), "ThreadAffinityMasks"));
+		DefaultCpuDispatcher::getAffinityMasks(defaultAffinityMasks, numThreads);
+		affinityMasks = defaultAffinityMasks;
+	}
+
+	// initialize threads first, then start
+
+	mWorkerThreads = reinterpret_cast<SceneSchedulingWorkerThread*>(PX_ALLOC(numThreads * sizeof(SceneSchedulingWorkerThread), "SceneSchedulingWorkerThread"));
+	const PxU32 nameLength = 32;
+	mThreadNames = reinterpret_cast<PxU8*>(PX_ALLOC(nameLength * numThreads, "CpuWorkerThreadName"));
+
+	if (mWorkerThreads)
+	{
+		for(PxU32 i = 0; i < numThreads; ++i)
+		{
+			PX_PLACEMENT_NEW(mWorkerThreads+i, SceneSchedulingWorkerThread)();
+			mWorkerThreads[i].initialize(this);
+		}
+
+		for(PxU32 i = 0; i < numThreads; ++i)
+		{
+			if (mThreadNames)
+			{
+				char* threadName = reinterpret_cast<char*>(mThreadNames + (i*nameLength));
+				Ps::snprintf(threadName, nameLength, "PxWorker%02d", i);
+				mWorkerThreads[i].setName(threadName);
+			}
+
+			if(cpus)
+				mWorkerThreads[i].setCpu(cpus[i]);
+			else
+				mWorkerThreads[i].setAffinityMask(affinityMasks[i]);
+			mWorkerThreads[i].start(Ps::Thread::getDefaultStackSize());
+		}
+	}
+	else
+	{
+		mNumThreads = 0;
+	}
+
+	if (defaultAffinityMasks)
+		PX_FREE(defaultAffinityMasks);
+}
+
+Ext::SceneSchedulingCpuDispatcher::~SceneSchedulingCpuDispatcher()
+{
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].signalQuit();
+
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].forceWakeUp();
+
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].waitForQuit();
+
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].~SceneSchedulingWorkerThread();
+
+	PX_FREE(mWorkerThreads);
+
+	if (mThreadNames)
+		PX_FREE(mThreadNames);
+}
+
+void Ext::SceneSchedulingCpuDispatcher::submitTask(PxBaseTask& task)
+{
+	if(!mNumThreads)
+	{
+		// no worker threads, run directly
+		runTask(task);
+		task.release();
+		return;
+	}
+
+	SharedQueueEntry* entry = mQueueEntryPool.getEntry(&task);
+	if (!entry)
+		return;
+
+	const PxU64 contextId = task.getContextId();
+	for(;;)
+	{
+		SceneTaskQueue& scene = acquireScene(contextId);
+
+		// The slot may have been removed, or even reused by another scene, since we looked it up. Announce the push
+		// first, then check: removeScene() clears mInUse before it waits for the pushes in flight and drains the queue.
+		Ps::atomicIncrement(&scene.mNbSubmitting);
+		if(!scene.mInUse || (&scene != mScenes && scene.mContextId != contextId))
+		{
+			Ps::atomicDecrement(&scene.mNbSubmitting);
+			continue;
+		}
+
+		scene.mJobList.push(*entry);
+
+		if(Ps::atomicIncrement(&scene.mNbQueued) == 1)
+		{
+			// The scene was idle, it doesn't get to catch up on the time it did not use the workers
+			const PxI32 globalPass = mGlobalPass;
+			if(passDifference(scene.mPass, globalPass) < 0)
+				scene.mPass = globalPass;
+		}
+
+		Ps::atomicDecrement(&scene.mNbSubmitting);
+		break;
+	}
+
+	wakeOneWorker();
+}
+
+void Ext::SceneSchedulingCpuDispatcher::wakeOneWorker()
+{
+	if(mNumParked <= 0)
+		return;
+
+	const PxU32 start = PxU32(Ps::atomicIncrement(&mNextWakeUp));
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+	{
+		if(mWorkerThreads[(start + i) % mNumThreads].unpark())
+			return;
+	}
+}
+
+PxBaseTask* Ext::SceneSchedulingCpuDispatcher::fetchNextTask()
+{
+	for(;;)
+	{
+		SceneTaskQueue* best = NULL;
+
+		const PxU32 nbScenes = mNbScenes;
+		for(PxU32 i = 0; i < nbScenes; ++i)
+		{
+			SceneTaskQueue& scene = mScenes[i];
+			if(scene.mInUse && scene.mNbQueued > 0 && (!best || isMoreUrgent(scene, *best)))
+				best = &scene;
+		}
+
+		if(!best)
+			return NULL;
+
+		PxBaseTask* task = TaskQueueHelper::fetchTask(best->mJobList, mQueueEntryPool);
+		if(task)
+		{
+			Ps::atomicDecrement(&best->mNbQueued);
+			mGlobalPass = Ps::atomicAdd(&best->mPass, best->mStride);
+			Ps::atomicIncrement(&best->mNbTasks);
+
+			const PxU64 deadline = readDeadline(*best);
+			if(deadline && getCurrentTime() > deadline)
+				Ps::atomicIncrement(&best->mNbLateTasks);
+
+			return task;
+		}
+
+		// Another worker took the last task of the scene between the check and the pop, look again
+	}
+}
+
+Ext::SceneTaskQueue* Ext::SceneSchedulingCpuDispatcher::findScene(PxU64 contextId) const
+{
+	if(!contextId)
+		return const_cast<SceneTaskQueue*>(mScenes);
+
+	const PxU32 nbScenes = mNbScenes;
+	for(PxU32 i = 1; i < nbScenes; ++i)
+	{
+		if(mScenes[i].mInUse && mScenes[i].mContextId == contextId)
+			return const_cast<SceneTaskQueue*>(mScenes + i);
+	}
+	return NULL;
+}
+
+Ext::SceneTaskQueue& Ext::SceneSchedulingCpuDispatcher::acquireScene(PxU64 contextId)
+{
+	SceneTaskQueue* scene = findScene(contextId);
+	if(scene)
+		return *scene;
+
+	Ps::Mutex::ScopedLock lock(mSceneMutex);
+
+	scene = findScene(contextId);
+	if(scene)
+		return *scene;
+
+	PxU32 index = 1;
+	while(index < mNbScenes && mScenes[index].mInUse)
+		index++;
+
+	if(index > EXT_MAX_SCHEDULED_SCENES)
+		return mScenes[0];
+
+	// Publish the slot only once it is fully initialized, lookups run without the lock
+	resetScene(mScenes[index], contextId, mGlobalPass);
+	Ps::memoryBarrier();
+	mScenes[index].mInUse = true;
+	if(index == mNbScenes)
+		mNbScenes = index + 1;
+
+	return mScenes[index];
+}
+
+bool Ext::SceneSchedulingCpuDispatcher::setSceneSchedulingParams(PxU64 contextId, const PxDefaultCpuDispatcherSceneParams& params)
+{
+	SceneTaskQueue& scene = acquireScene(contextId);
+	if(&scene == mScenes)
+		return false;
+
+	setSceneParams(scene, params);
+	return true;
+}
+
+void Ext::SceneSchedulingCpuDispatcher::setSceneDeadline(PxU64 contextId, PxReal timeToDeadline)
+{
+	SceneTaskQueue& scene = acquireScene(contextId);
+	if(&scene == mScenes)
+		return;
+
+	// At least one tick so that a deadline very close to now is not mistaken for no deadline
+	const PxU64 deadline = timeToDeadline > 0.0f ? getCurrentTime() + PxMax(PxU64(timeToDeadline * 1.0e8f), PxU64(1)) : 0;
+
+	Ps::Mutex::ScopedLock lock(mSceneMutex);
+	writeDeadline(scene, deadline);
+}
+
+bool Ext::SceneSchedulingCpuDispatcher::getSceneStatistics(PxU64 contextId, PxDefaultCpuDispatcherSceneStatistics& stats) const
+{
+	const SceneTaskQueue* scene = findScene(contextId);
+	if(!scene)
+		return false;
+
+	stats.nbTasks = PxU32(scene->mNbTasks);
+	stats.nbLateTasks = PxU32(scene->mNbLateTasks);
+	stats.nbQueuedTasks = PxU32(PxMax(scene->mNbQueued, 0));
+	return true;
+}
+
+void Ext::SceneSchedulingCpuDispatcher::removeScene(PxU64 contextId)
+{
+	Ps::Mutex::ScopedLock lock(mSceneMutex);
+
+	SceneTaskQueue* scene = findScene(contextId);
+	if(!scene || scene == mScenes)
+		return;
+
+	// New submitters see the slot as removed and go through acquireScene() again. The slot cannot be reused
+	// before we release the lock, so waiting for the pushes in flight is enough for the drain to see all tasks.
+	scene->mInUse = false;
+	Ps::memoryBarrier();
+	while(scene->mNbSubmitting)
+		Ps::Thread::yield();
+
+	// Tasks still queued, if any, go to the default queue
+	while(Ps::SListEntry* entry = scene->mJobList.pop())
+	{
+		mScenes[0].mJobList.push(*entry);
+		Ps::atomicDecrement(&scene->mNbQueued);
+		Ps::atomicIncrement(&mScenes[0].mNbQueued);
+	}
+}
+
+PxU32 Ext::SceneSchedulingCpuDispatcher::getWorkerStatistics(PxDefaultCpuDispatcherWorkerStatistics* userBuffer, PxU32 bufferSize) const
+{
+	const PxU32 nb = PxMin(bufferSize, mNumThreads);
+	for(PxU32 i = 0; i < nb; ++i)
+		userBuffer[i] = mWorkerThreads[i].getStatistics();
+	return nb;
+}
+
+void Ext::SceneSchedulingCpuDispatcher::resetWorkerStatistics()
+{
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].resetStatistics();
+}
+
+void Ext::SceneSchedulingCpuDispatcher::getQueueStatistics(PxDefaultCpuDispatcherQueueStatistics& stats) const
+{
+	stats.nbEntries = mQueueEntryPool.getNbEntries();
+	stats.nbSlabs = mQueueEntryPool.getNbSlabs();
+	stats.maxNbEntriesUsed = mQueueEntryPool.getMaxNbEntriesUsed();
+}
+
+void Ext::SceneSchedulingCpuDispatcher::release()
+{
+	PX_DELETE(this);
+}
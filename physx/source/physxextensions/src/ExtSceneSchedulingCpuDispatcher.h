@@ -0,0 +1,202 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef PX_PHYSICS_EXTENSIONS_NP_SCENE_SCHEDULING_CPU_DISPATCHER_H
+#define PX_PHYSICS_EXTENSIONS_NP_SCENE_SCHEDULING_CPU_DISPATCHER_H
+
+#include "common/PxProfileZone.h"
+#include "task/PxTask.h"
+#include "extensions/PxDefaultCpuDispatcher.h"
+
+#include "CmPhysXCommon.h"
+#include "PsUserAllocated.h"
+#include "PsSync.h"
+#include "PsSList.h"
+#include "PsMutex.h"
+#include "PsThread.h"
+#include "foundation/PxMemory.h"
+#include "ExtSharedQueueEntryPool.h"
+
+namespace physx
+{
+
+#define EXT_MAX_SCHEDULED_SCENES	64			// Scenes beyond this share the queue of unregistered scenes
+#define EXT_SCENE_PASS_STRIDE		(1 << 16)	// Pass increment of a weight 1 scene per executed task
+
+namespace Ext
+{
+	class SceneSchedulingCpuDispatcher;
+
+#if PX_VC
+#pragma warning(push)
+#pragma warning(disable:4324)	// Padding was added at the end of a structure because of a __declspec(align) value.
+#endif							// Because of the SList member I assume
+
+	class SceneSchedulingWorkerThread : public Ps::Thread
+	{
+	public:
+										SceneSchedulingWorkerThread();
+										~SceneSchedulingWorkerThread();
+
+						void			initialize(SceneSchedulingCpuDispatcher* ownerDispatcher);
+						void			execute();
+						PxBaseTask*		pollTask();
+
+						// Wakes the worker up if it is parked. Returns false if it was not parked.
+						bool			unpark();
+		PX_FORCE_INLINE	void			forceWakeUp()				{ mWakeUp.set();			}
+		PX_FORCE_INLINE	void			setCpu(PxU32 cpu)			{ mCpu = cpu;				}
+
+		PX_FORCE_INLINE	const PxDefaultCpuDispatcherWorkerStatistics&	getStatistics() const	{ return mStatistics;	}
+		PX_FORCE_INLINE	void			resetStatistics()			{ PxMemZero(&mStatistics, sizeof(mStatistics));	}
+
+	protected:
+						void			park();
+
+						Ps::Sync						mWakeUp;
+						SceneSchedulingCpuDispatcher*	mOwner;
+						PxU32							mCpu;	// Logical processor the worker pins itself to, PX_MAX_U32 for none
+						volatile PxI32					mParked;
+						PxDefaultCpuDispatcherWorkerStatistics	mStatistics;
+	};
+
+	// Task queue and scheduling state of one scene. Tasks are ordered by priority, then deadline, then pass.
+	// The pass grows by a stride inversely proportional to the weight for each executed task (stride scheduling).
+	struct SceneTaskQueue
+	{
+						Ps::SList		mJobList;
+						PxU64			mContextId;
+						volatile PxU64	mDeadline;		// In tens of nanoseconds, 0 if none. Read and written with readDeadline()/writeDeadline().
+						volatile PxI32	mDeadlineSequence;	// Odd while mDeadline is being written, 64-bit stores may tear on 32-bit platforms
+						PxU32			mPriority;
+						PxI32			mStride;
+						volatile PxI32	mPass;
+						volatile PxI32	mNbQueued;
+						volatile PxI32	mNbTasks;
+						volatile PxI32	mNbLateTasks;
+						volatile PxI32	mNbSubmitting;	// Number of submitters pushing to the queue, removeScene() waits for them
+						volatile bool	mInUse;
+	};
+
+	class SceneSchedulingCpuDispatcher : public PxDefaultCpuDispatcher, public Ps::UserAllocated
+	{
+		friend class SceneSchedulingWorkerThread;
+	private:
+												~SceneSchedulingCpuDispatcher();
+	public:
+												SceneSchedulingCpuDispatcher(PxU32 numThreads, PxU32* affinityMasks, const PxU32* cpus);
+
+		//---------------------------------------------------------------------------------
+		// PxCpuDispatcher implementation
+		//---------------------------------------------------------------------------------
+		virtual			void					submitTask(PxBaseTask& task);
+		virtual			PxU32					getWorkerCount()	const	{ return mNumThreads;	}
+
+		//---------------------------------------------------------------------------------
+		// PxDefaultCpuDispatcher implementation
+		//---------------------------------------------------------------------------------
+		virtual			void					release();
+
+		virtual			void					setRunProfiled(bool runProfiled) { mRunProfiled = runProfiled; }
+
+		virtual			bool					getRunProfiled() const { return mRunProfiled; }
+
+		virtual			void					setWaitPolicy(const PxDefaultCpuDispatcherWaitPolicy& policy) { mWaitPolicy = policy; }
+
+		virtual			PxDefaultCpuDispatcherWaitPolicy	getWaitPolicy() const { return mWaitPolicy; }
+
+		virtual			void					setFrameActive(bool active) { mFrameActive = active; }
+
+		virtual			bool					isFrameActive() const { return mFrameActive; }
+
+		virtual			PxU32					getWorkerStatistics(PxDefaultCpuDispatcherWorkerStatistics* userBuffer, PxU32 bufferSize) const;
+
+		virtual			void					resetWorkerStatistics();
+
+		virtual			void					getQueueStatistics(PxDefaultCpuDispatcherQueueStatistics& stats) const;
+
+		virtual			bool					setSceneSchedulingParams(PxU64 contextId, const PxDefaultCpuDispatcherSceneParams& params);
+
+		virtual			void					setSceneDeadline(PxU64 contextId, PxReal timeToDeadline);
+
+		virtual			bool					getSceneStatistics(PxU64 contextId, PxDefaultCpuDispatcherSceneStatistics& stats) const;
+
+		virtual			void					removeScene(PxU64 contextId);
+
+		//---------------------------------------------------------------------------------
+		// SceneSchedulingCpuDispatcher
+		//---------------------------------------------------------------------------------
+						// Takes a task from the queue of the most urgent scene
+						PxBaseTask*				fetchNextTask();
+
+		PX_FORCE_INLINE	void					runTask(PxBaseTask& task)
+												{
+#if PX_SUPPORT_PXTASK_PROFILING
+													if(mRunProfiled)
+													{
+														PX_PROFILE_ZONE(task.getName(), task.getContextId());
+														task.run();
+													}
+													else
+#endif
+														task.run();
+												}
+
+						// Unparks one worker if any of them is parked
+						void					wakeOneWorker();
+
+	protected:
+						// Returns NULL if the scene is not registered. Context id 0 is the default queue.
+						SceneTaskQueue*			findScene(PxU64 contextId) const;
+						// Registers the scene if needed. Context id 0 and scenes that do not fit in the table use the default queue.
+						SceneTaskQueue&			acquireScene(PxU64 contextId);
+
+						SceneSchedulingWorkerThread*	mWorkerThreads;
+						SharedQueueEntryPool<>			mQueueEntryPool;
+						SceneTaskQueue					mScenes[EXT_MAX_SCHEDULED_SCENES + 1];	// Slot 0 is the default queue
+						volatile PxU32					mNbScenes;
+						volatile PxI32					mGlobalPass;	// Pass of the last scheduled scene, newly active scenes start from it
+						Ps::Mutex						mSceneMutex;
+						volatile PxI32					mNumParked;
+						volatile PxI32					mNextWakeUp;
+						PxU8*							mThreadNames;
+						PxU32							mNumThreads;
+						PxDefaultCpuDispatcherWaitPolicy	mWaitPolicy;
+						bool							mRunProfiled;
+						volatile bool					mFrameActive;
+	};
+
+#if PX_VC
+#pragma warning(pop)
+#endif
+
+} // namespace Ext
+}
+
+#endif
@@ -27,13 +27,14 @@
 // Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
 // Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
 
-
 #ifndef PX_PHYSICS_EXTENSIONS_NP_SHARED_QUEUE_ENTRY_POOL_H
 #define PX_PHYSICS_EXTENSIONS_NP_SHARED_QUEUE_ENTRY_POOL_H
 
 #include "CmPhysXCommon.h"
 #include "PsAllocator.h"
 #include "PsArray.h"
+#include "PsAtomic.h"
+#include "PsMutex.h"
 #include "PsSList.h"
 
 namespace physx
@@ -43,12 +44,10 @@ namespace Ext
 	class SharedQueueEntry : public Ps::SListEntry
 	{
 	public:
-		SharedQueueEntry(void* objectRef) : mObjectRef(objectRef), mPooledEntry(false) {}
-		SharedQueueEntry() : mObjectRef(NULL), mPooledEntry(true) {}
+		SharedQueueEntry() : mObjectRef(NULL) {}
 
 	public:
 		void* mObjectRef;
-		bool mPooledEntry; // True if the entry was preallocated in a pool
 	};
 
 #if PX_VC
@@ -56,6 +55,11 @@ namespace Ext
 #pragma warning(disable:4324)	// Padding was added at the end of a structure because of a __declspec(align) value.
 #endif							// Because of the SList member I assume*/
 
+	/*
+	Pool of queue entries, allocated in slabs of poolSize entries. The pool grows by one slab whenever it runs dry
+	and never gives memory back before it is destroyed, so the global allocator is not hit anymore once the pool
+	has grown to the peak number of queued tasks.
+	*/
 	template<class Alloc = typename Ps::AllocatorTraits<SharedQueueEntry>::Type >
 	class SharedQueueEntryPool : private Alloc
 	{
@@ -66,9 +70,20 @@ namespace Ext
 		SharedQueueEntry* getEntry(void* objectRef);
 		void putEntry(SharedQueueEntry& entry);
 
+		PxU32 getNbEntries() const { return mSlabSize * mSlabs.size(); }
+		PxU32 getNbSlabs() const { return mSlabs.size(); }
+		PxU32 getMaxNbEntriesUsed() const { return PxU32(mMaxNbEntriesUsed); }
+
 	private:
-		SharedQueueEntry*					mTaskEntryPool;
+		// Allocates a new slab, keeps one entry for the caller and puts the others in the pool
+		SharedQueueEntry* allocateSlab();
+
 		Ps::SList							mTaskEntryPtrPool;
+		Ps::Mutex							mSlabMutex;
+		Ps::Array<SharedQueueEntry*>		mSlabs;
+		PxU32								mSlabSize;
+		volatile PxI32						mNbEntriesUsed;
+		volatile PxI32						mMaxNbEntriesUsed;	// High-water mark of mNbEntriesUsed
 	};
 
 #if PX_VC
@@ -80,22 +95,13 @@ namespace Ext
 
 template <class Alloc>
 Ext::SharedQueueEntryPool<Alloc>::SharedQueueEntryPool(PxU32 poolSize, const Alloc& alloc)
-	: Alloc(alloc)
+	: Alloc(alloc), mSlabs(PX_DEBUG_EXP("SharedQueueEntryPoolSlabs")), mSlabSize(poolSize ? poolSize : 1), mNbEntriesUsed(0), mMaxNbEntriesUsed(0)
 {
-	Ps::AlignedAllocator<PX_SLIST_ALIGNMENT, Alloc> alignedAlloc("SharedQueueEntryPool");
-
-	mTaskEntryPool = poolSize ? reinterpret_cast<SharedQueueEntry*>(alignedAlloc.allocate(sizeof(SharedQueueEntry) * poolSize, __FILE__, __LINE__)) : NULL;
-
-	if (mTaskEntryPool)
+	if (poolSize)
 	{
-		for(PxU32 i=0; i < poolSize; i++)
-		{
-			PX_ASSERT((size_t(&mTaskEntryPool[i]) & (PX_SLIST_ALIGNMENT-1)) == 0);  // The SList entry must be aligned according to PX_SLIST_ALIGNMENT
-
-			PX_PLACEMENT_NEW(&mTaskEntryPool[i], SharedQueueEntry)();
-			PX_ASSERT(mTaskEntryPool[i].mPooledEntry == true);
-			mTaskEntryPtrPool.push(mTaskEntryPool[i]);
-		}
+		SharedQueueEntry* entry = allocateSlab();
+		if (entry)
+			mTaskEntryPtrPool.push(*entry);
 	}
 }
 
@@ -103,11 +109,34 @@ Ext::SharedQueueEntryPool<Alloc>::SharedQueueEntryPool(PxU32 poolSize, const All
 template <class Alloc>
 Ext::SharedQueueEntryPool<Alloc>::~SharedQueueEntryPool()
 {
-	if (mTaskEntryPool)
+	Ps::AlignedAllocator<PX_SLIST_ALIGNMENT, Alloc> alignedAlloc("SharedQueueEntryPool");
+	for (PxU32 i = 0; i < mSlabs.size(); i++)
+		alignedAlloc.deallocate(mSlabs[i]);
+}
+
+
+template <class Alloc>
+Ext::SharedQueueEntry* Ext::SharedQueueEntryPool<Alloc>::allocateSlab()
+{
+	Ps::AlignedAllocator<PX_SLIST_ALIGNMENT, Alloc> alignedAlloc("SharedQueueEntryPool");
+
+	SharedQueueEntry* slab = reinterpret_cast<SharedQueueEntry*>(alignedAlloc.allocate(sizeof(SharedQueueEntry) * mSlabSize, __FILE__, __LINE__));
+	if (!slab)
+		return NULL;
+
+	for(PxU32 i=0; i < mSlabSize; i++)
 	{
-		Ps::AlignedAllocator<PX_SLIST_ALIGNMENT, Alloc> alignedAlloc("SharedQueueEntryPool");
-		alignedAlloc.deallocate(mTaskEntryPool);
+		PX_ASSERT((size_t(&slab[i]) & (PX_SLIST_ALIGNMENT-1)) == 0);  // The SList entry must be aligned according to PX_SLIST_ALIGNMENT
+
+		PX_PLACEMENT_NEW(&slab[i], SharedQueueEntry)();
+		if (i)
+			mTaskEntryPtrPool.push(slab[i]);
 	}
+
+	Ps::Mutex::ScopedLock lock(mSlabMutex);
+	mSlabs.pushBack(slab);
+
+	return slab;
 }
 
 
@@ -115,40 +144,30 @@ template <class Alloc>
 Ext::SharedQueueEntry* Ext::SharedQueueEntryPool<Alloc>::getEntry(void* objectRef)
 {
 	SharedQueueEntry* e = static_cast<SharedQueueEntry*>(mTaskEntryPtrPool.pop());
-	if (e)
+	if (!e)
 	{
-		PX_ASSERT(e->mPooledEntry == true);
-		e->mObjectRef = objectRef;
-		return e;
-	}
-	else
-	{
-		Ps::AlignedAllocator<PX_SLIST_ALIGNMENT, Alloc> alignedAlloc;
-		e = reinterpret_cast<SharedQueueEntry*>(alignedAlloc.allocate(sizeof(SharedQueueEntry), __FILE__, __LINE__));
-		if (e)
-		{
-			PX_PLACEMENT_NEW(e, SharedQueueEntry)(objectRef);
-			PX_ASSERT(e->mPooledEntry == false);
-		}
-
-		return e;
+		e = allocateSlab();
+		if (!e)
+			return NULL;
 	}
+
+	e->mObjectRef = objectRef;
+
+	const PxI32 nbUsed = Ps::atomicIncrement(&mNbEntriesUsed);
+	if (nbUsed > mMaxNbEntriesUsed)
+		Ps::atomicMax(&mMaxNbEntriesUsed, nbUsed);
+
+	return e;
 }
 
 
 template <class Alloc>
 void Ext::SharedQueueEntryPool<Alloc>::putEntry(Ext::SharedQueueEntry& entry)
 {
-	if (entry.mPooledEntry)
-	{
-		entry.mObjectRef = NULL;
-		mTaskEntryPtrPool.push(entry);
-	}
-	else
-	{
-		Ps::AlignedAllocator<PX_SLIST_ALIGNMENT, Alloc> alignedAlloc;
-		alignedAlloc.deallocate(&entry);
-	}
+	Ps::atomicDecrement(&mNbEntriesUsed);
+
+	entry.mObjectRef = NULL;
+	mTaskEntryPtrPool.push(entry);
 }
 
 }
@@ -0,0 +1,310 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "ExtWorkStealingCpuDispatcher.h"
+#include "ExtDefaultCpuDispatcher.h"
+#include "ExtTaskQueueHelper.h"
+#include "ExtCpuWorkerWait.h"
+#include "ExtCpuTopology.h"
+#include "PsString.h"
+
+using namespace physx;
+
+Ext::WorkStealingWorkerThread::WorkStealingWorkerThread()
+:	mOwner(NULL),
+	mIndex(0),
+	mRandomState(1),
+	mCpu(PX_MAX_U32),
+	mParked(0)
+{
+	resetStatistics();
+}
+
+Ext::WorkStealingWorkerThread::~WorkStealingWorkerThread()
+{
+}
+
+void Ext::WorkStealingWorkerThread::initialize(WorkStealingCpuDispatcher* ownerDispatcher, PxU32 index)
+{
+	mOwner = ownerDispatcher;
+	mIndex = index;
+	// Different seeds so that the thieves don't all pick the same victims
+	mRandomState = (index + 1) * 0x9E3779B9;
+}
+
+bool Ext::WorkStealingWorkerThread::unpark()
+{
+	if(mParked && Ps::atomicCompareExchange(&mParked, 0, 1) == 1)
+	{
+		Ps::atomicDecrement(&mOwner->mNumParked);
+		mWakeUp.set();
+		return true;
+	}
+	return false;
+}
+
+void Ext::WorkStealingWorkerThread::park()
+{
+	mWakeUp.reset();
+
+	// Announce that we are going to sleep before checking for work one last time. Submitters publish
+	// their task before they look for parked workers, so either they see us parked or we see their task.
+	if(Ps::atomicExchange(&mParked, 1) == 0)
+		Ps::atomicIncrement(&mOwner->mNumParked);
+
+	PxBaseTask* task = mOwner->fetchNextTask(*this);
+	if(!task && !quitIsSignalled())
+	{
+		// Whoever wakes us up also clears the parked flag
+		mStatistics.nbParks++;
+		mWakeUp.wait();
+		return;
+	}
+
+	if(Ps::atomicCompareExchange(&mParked, 0, 1) == 1)
+		Ps::atomicDecrement(&mOwner->mNumParked);
+	else
+		mOwner->wakeOneWorker();	// We consumed a wake-up meant for the task we just took, pass it on
+
+	if(task)
+	{
+		mOwner->runTask(*task);
+		task->release();
+		mStatistics.nbTasks++;
+	}
+}
+
+PxBaseTask* Ext::WorkStealingWorkerThread::pollTask()
+{
+	PxBaseTask* task = mDeque.isEmpty() ? NULL : mDeque.pop();
+
+	if(!task)
+		task = mOwner->fetchNextTask(*this);
+
+	return task;
+}
+
+void Ext::WorkStealingWorkerThread::execute()
+{
+	pinCurrentThread(mCpu);
+	Ps::TlsSet(mOwner->mTlsIndex, this);
+
+	while(!quitIsSignalled())
+	{
+		PxBaseTask* task = mDeque.pop();
+
+		if(!task)
+			task = mOwner->fetchNextTask(*this);
+
+		if(!task)
+			task = waitForTaskActively(*this, *mOwner, mStatistics);
+
+		if(task)
+		{
+			mOwner->runTask(*task);
+			task->release();
+			mStatistics.nbTasks++;
+		}
+		else
+		{
+			park();
+		}
+	}
+
+	Ps::TlsSet(mOwner->mTlsIndex, NULL);
+
+	quit();
+}
+
+Ext::WorkStealingCpuDispatcher::WorkStealingCpuDispatcher(PxU32 numThreads, PxU32* affinityMasks, const PxU32* cpus)
+	: mQueueEntryPool(EXT_TASK_QUEUE_ENTRY_POOL_SIZE, "QueueEntryPool"), mNumThreads(numThreads), mNumParked(0), mNextWakeUp(0), mShuttingDown(false)
+#if PX_PROFILE
+	,mRunProfiled(true)
+#else
+	,mRunProfiled(false)
+#endif
+	,mFrameActive(false)
+{
+	mTlsIndex = Ps::TlsAlloc();
+
+	PxU32* defaultAffinityMasks = NULL;
+
+	if(!affinityMasks)
+	{
+		defaultAffinityMasks = reinterpret_cast<PxU32*>(PX_ALLOC(numThreads * sizeof(PxU32), "ThreadAffinityMasks"));
+		DefaultCpuDispatcher::getAffinityMasks(defaultAffinityMasks, numThreads);
+		affinityMasks = defaultAffinityMasks;
+	}
+
+	// initialize threads first, then start
+
+	mWorkerThreads = reinterpret_cast<WorkStealingWorkerThread*>(PX_ALLOC(numThreads * sizeof(WorkStealingWorkerThread), "WorkStealingWorkerThread"));
+	const PxU32 nameLength = 32;
+	mThreadNames = reinterpret_cast<PxU8*>(PX_ALLOC(nameLength * numThreads, "CpuWorkerThreadName"));
+
+	if (mWorkerThreads)
+	{
+		for(PxU32 i = 0; i < numThreads; ++i)
+		{
+			PX_PLACEMENT_NEW(mWorkerThreads+i, WorkStealingWorkerThread)();
+			mWorkerThreads[i].initialize(this, i);
+		}
+
+		for(PxU32 i = 0; i < numThreads; ++i)
+		{
+			if (mThreadNames)
+			{
+				char* threadName = reinterpret_cast<char*>(mThreadNames + (i*nameLength));
+				Ps::snprintf(threadName, nameLength, "PxWorker%02d", i);
+				mWorkerThreads[i].setName(threadName);
+			}
+
+			if(cpus)
+				mWorkerThreads[i].setCpu(cpus[i]);
+			else
+				mWorkerThreads[i].setAffinityMask(affinityMasks[i]);
+			mWorkerThreads[i].start(Ps::Thread::getDefaultStackSize());
+		}
+	}
+	else
+	{
+		mNumThreads = 0;
+	}
+
+	if (defaultAffinityMasks)
+		PX_FREE(defaultAffinityMasks);
+}
+
+Ext::WorkStealingCpuDispatcher::~WorkStealingCpuDispatcher()
+{
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].signalQuit();
+
+	mShuttingDown = true;
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].forceWakeUp();
+
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].waitForQuit();
+
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].~WorkStealingWorkerThread();
+
+	PX_FREE(mWorkerThreads);
+
+	if (mThreadNames)
+		PX_FREE(mThreadNames);
+
+	Ps::TlsFree(mTlsIndex);
+}
+
+void Ext::WorkStealingCpuDispatcher::submitTask(PxBaseTask& task)
+{
+	if(!mNumThreads)
+	{
+		// no worker threads, run directly
+		runTask(task);
+		task.release();
+		return;
+	}
+
+	// Tasks spawned by our own workers go to their deque, everything else to the shared queue
+	WorkStealingWorkerThread* worker = reinterpret_cast<WorkStealingWorkerThread*>(Ps::TlsGet(mTlsIndex));
+	if(!worker || !worker->pushLocal(task))
+	{
+		SharedQueueEntry* entry = mQueueEntryPool.getEntry(&task);
+		if (entry)
+			mJobList.push(*entry);
+	}
+
+	wakeOneWorker();
+}
+
+void Ext::WorkStealingCpuDispatcher::wakeOneWorker()
+{
+	if(mNumParked <= 0)
+		return;
+
+	const PxU32 start = PxU32(Ps::atomicIncrement(&mNextWakeUp));
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+	{
+		if(mWorkerThreads[(start + i) % mNumThreads].unpark())
+			return;
+	}
+}
+
+PxBaseTask* Ext::WorkStealingCpuDispatcher::fetchNextTask(WorkStealingWorkerThread& thief)
+{
+	PxBaseTask* task = TaskQueueHelper::fetchTask(mJobList, mQueueEntryPool);
+	if(task)
+		return task;
+
+	const PxU32 start = thief.nextRandom() % mNumThreads;
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+	{
+		WorkStealingWorkerThread& victim = mWorkerThreads[(start + i) % mNumThreads];
+		if(&victim == &thief)
+			continue;
+
+		task = victim.steal();
+		if(task)
+		{
+			thief.mStatistics.nbSteals++;
+			return task;
+		}
+	}
+
+	return NULL;
+}
+
+PxU32 Ext::WorkStealingCpuDispatcher::getWorkerStatistics(PxDefaultCpuDispatcherWorkerStatistics* userBuffer, PxU32 bufferSize) const
+{
+	const PxU32 nb = PxMin(bufferSize, mNumThreads);
+	for(PxU32 i = 0; i < nb; ++i)
+		userBuffer[i] = mWorkerThreads[i].getStatistics();
+	return nb;
+}
+
+void Ext::WorkStealingCpuDispatcher::resetWorkerStatistics()
+{
+	for(PxU32 i = 0; i < mNumThreads; ++i)
+		mWorkerThreads[i].resetStatistics();
+}
+
+void Ext::WorkStealingCpuDispatcher::getQueueStatistics(PxDefaultCpuDispatcherQueueStatistics& stats) const
+{
+	stats.nbEntries = mQueueEntryPool.getNbEntries();
+	stats.nbSlabs = mQueueEntryPool.getNbSlabs();
+	stats.maxNbEntriesUsed = mQueueEntryPool.getMaxNbEntriesUsed();
+}
+
+void Ext::WorkStealingCpuDispatcher::release()
+{
+	PX_DELETE(this);
+}
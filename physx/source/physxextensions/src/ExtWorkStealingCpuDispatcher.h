@@ -0,0 +1,194 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef PX_PHYSICS_EXTENSIONS_NP_WORK_STEALING_CPU_DISPATCHER_H
+#define PX_PHYSICS_EXTENSIONS_NP_WORK_STEALING_CPU_DISPATCHER_H
+
+#include "common/PxProfileZone.h"
+#include "task/PxTask.h"
+#include "extensions/PxDefaultCpuDispatcher.h"
+
+#include "CmPhysXCommon.h"
+#include "PsUserAllocated.h"
+#include "PsSync.h"
+#include "PsSList.h"
+#include "PsThread.h"
+#include "foundation/PxMemory.h"
+#include "ExtSharedQueueEntryPool.h"
+#include "ExtWorkStealingDeque.h"
+
+namespace physx
+{
+
+namespace Ext
+{
+	class WorkStealingCpuDispatcher;
+
+#if PX_VC
+#pragma warning(push)
+#pragma warning(disable:4324)	// Padding was added at the end of a structure because of a __declspec(align) value.
+#endif							// Because of the SList member I assume
+
+	class WorkStealingWorkerThread : public Ps::Thread
+	{
+		friend class WorkStealingCpuDispatcher;
+
+	public:
+										WorkStealingWorkerThread();
+										~WorkStealingWorkerThread();
+
+						void			initialize(WorkStealingCpuDispatcher* ownerDispatcher, PxU32 index);
+						void			execute();
+						PxBaseTask*		pollTask();
+
+		PX_FORCE_INLINE	bool			pushLocal(PxBaseTask& task)	{ return mDeque.push(task);	}
+		PX_FORCE_INLINE	PxBaseTask*		steal()						{ return mDeque.steal();	}
+
+						// Wakes the worker up if it is parked. Returns false if it was not parked.
+						bool			unpark();
+		PX_FORCE_INLINE	void			forceWakeUp()				{ mWakeUp.set();			}
+		PX_FORCE_INLINE	void			setCpu(PxU32 cpu)			{ mCpu = cpu;				}
+
+		PX_FORCE_INLINE	const PxDefaultCpuDispatcherWorkerStatistics&	getStatistics() const	{ return mStatistics;	}
+		PX_FORCE_INLINE	void			resetStatistics()			{ PxMemZero(&mStatistics, sizeof(mStatistics));	}
+
+						// Xorshift, only called by the worker itself
+		PX_FORCE_INLINE	PxU32			nextRandom()
+										{
+											PxU32 x = mRandomState;
+											x ^= x << 13;
+											x ^= x >> 17;
+											x ^= x << 5;
+											mRandomState = x;
+											return x;
+										}
+	protected:
+						void			park();
+
+						WorkStealingDeque			mDeque;
+						Ps::Sync					mWakeUp;
+						WorkStealingCpuDispatcher*	mOwner;
+						PxU32						mIndex;
+						PxU32						mRandomState;
+						PxU32						mCpu;	// Logical processor the worker pins itself to, PX_MAX_U32 for none
+						volatile PxI32				mParked;
+						PxDefaultCpuDispatcherWorkerStatistics	mStatistics;
+	};
+
+	class WorkStealingCpuDispatcher : public PxDefaultCpuDispatcher, public Ps::UserAllocated
+	{
+		friend class WorkStealingWorkerThread;
+
+	private:
+												~WorkStealingCpuDispatcher();
+	public:
+												WorkStealingCpuDispatcher(PxU32 numThreads, PxU32* affinityMasks, const PxU32* cpus);
+
+		//---------------------------------------------------------------------------------
+		// PxCpuDispatcher implementation
+		//---------------------------------------------------------------------------------
+		virtual			void					submitTask(PxBaseTask& task);
+		virtual			PxU32					getWorkerCount()	const	{ return mNumThreads;	}
+
+		//---------------------------------------------------------------------------------
+		// PxDefaultCpuDispatcher implementation
+		//---------------------------------------------------------------------------------
+		virtual			void					release();
+
+		virtual			void					setRunProfiled(bool runProfiled) { mRunProfiled = runProfiled; }
+
+		virtual			bool					getRunProfiled() const { return mRunProfiled; }
+
+		virtual			void					setWaitPolicy(const PxDefaultCpuDispatcherWaitPolicy& policy) { mWaitPolicy = policy; }
+
+		virtual			PxDefaultCpuDispatcherWaitPolicy	getWaitPolicy() const { return mWaitPolicy; }
+
+		virtual			void					setFrameActive(bool active) { mFrameActive = active; }
+
+		virtual			bool					isFrameActive() const { return mFrameActive; }
+
+		virtual			PxU32					getWorkerStatistics(PxDefaultCpuDispatcherWorkerStatistics* userBuffer, PxU32 bufferSize) const;
+
+		virtual			void					resetWorkerStatistics();
+
+		virtual			void					getQueueStatistics(PxDefaultCpuDispatcherQueueStatistics& stats) const;
+
+		virtual			bool					setSceneSchedulingParams(PxU64, const PxDefaultCpuDispatcherSceneParams&) { return false; }
+
+		virtual			void					setSceneDeadline(PxU64, PxReal) {}
+
+		virtual			bool					getSceneStatistics(PxU64, PxDefaultCpuDispatcherSceneStatistics&) const { return false; }
+
+		virtual			void					removeScene(PxU64) {}
+
+		//---------------------------------------------------------------------------------
+		// WorkStealingCpuDispatcher
+		//---------------------------------------------------------------------------------
+						// Shared queue first, then steal from randomly chosen victims
+						PxBaseTask*				fetchNextTask(WorkStealingWorkerThread& thief);
+
+						// Unparks one worker if any of them is parked
+						void					wakeOneWorker();
+
+		PX_FORCE_INLINE	void					runTask(PxBaseTask& task)
+												{
+#if PX_SUPPORT_PXTASK_PROFILING
+													if(mRunProfiled)
+													{
+														PX_PROFILE_ZONE(task.getName(), task.getContextId());
+														task.run();
+													}
+													else
+#endif
+														task.run();
+												}
+
+	protected:
+						WorkStealingWorkerThread*	mWorkerThreads;
+						SharedQueueEntryPool<>		mQueueEntryPool;
+						Ps::SList					mJobList;
+						PxU8*						mThreadNames;
+						PxU32						mNumThreads;
+						PxU32						mTlsIndex;			// Identifies the worker a submitting thread belongs to
+						volatile PxI32				mNumParked;
+						volatile PxI32				mNextWakeUp;
+						PxDefaultCpuDispatcherWaitPolicy	mWaitPolicy;
+						bool						mShuttingDown;
+						bool						mRunProfiled;
+						volatile bool				mFrameActive;
+	};
+
+#if PX_VC
+#pragma warning(pop)
+#endif
+
+} // namespace Ext
+}
+
+#endif
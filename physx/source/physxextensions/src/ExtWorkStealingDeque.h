@@ -0,0 +1,140 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+
+#ifndef PX_PHYSICS_EXTENSIONS_NP_WORK_STEALING_DEQUE_H
+#define PX_PHYSICS_EXTENSIONS_NP_WORK_STEALING_DEQUE_H
+
+#include "task/PxTask.h"
+#include "CmPhysXCommon.h"
+#include "PsAtomic.h"
+#include "PsIntrinsics.h"
+
+namespace physx
+{
+
+#define EXT_WORK_STEALING_DEQUE_SIZE 1024	// Must be a power of two
+
+namespace Ext
+{
+	/*
+	Bounded Chase-Lev work-stealing deque.
+
+	The owner thread pushes and pops at the bottom end, any other thread may steal from the top end.
+	Indices are free-running 32bit counters, the differences are evaluated in unsigned arithmetic so that
+	wrapping around is harmless. A full deque rejects the push and the caller falls back to a shared queue.
+	*/
+	class WorkStealingDeque
+	{
+	public:
+		WorkStealingDeque() : mTop(0), mBottom(0)
+		{
+			for(PxU32 i=0; i<EXT_WORK_STEALING_DEQUE_SIZE; i++)
+				mTasks[i] = NULL;
+		}
+
+		// Owner thread only. Returns false if the deque is full.
+		bool push(PxBaseTask& task)
+		{
+			const PxU32 b = PxU32(mBottom);
+			const PxU32 t = PxU32(mTop);
+			if(b - t >= EXT_WORK_STEALING_DEQUE_SIZE)
+				return false;
+
+			mTasks[b & (EXT_WORK_STEALING_DEQUE_SIZE-1)] = &task;
+
+			// Full barrier: the task must be visible before thieves can see the new bottom.
+			Ps::atomicExchange(&mBottom, PxI32(b + 1));
+			return true;
+		}
+
+		// Owner thread only. Returns the most recently pushed task.
+		PxBaseTask* pop()
+		{
+			const PxU32 b = PxU32(mBottom) - 1;
+
+			// Full barrier: the bottom reservation must be visible before top is read.
+			Ps::atomicExchange(&mBottom, PxI32(b));
+
+			const PxU32 t = PxU32(mTop);
+			if(PxI32(b - t) < 0)
+			{
+				// Empty
+				mBottom = PxI32(t);
+				return NULL;
+			}
+
+			PxBaseTask* task = mTasks[b & (EXT_WORK_STEALING_DEQUE_SIZE-1)];
+			if(b != t)
+				return task;
+
+			// Last entry, race against the thieves for it
+			if(Ps::atomicCompareExchange(&mTop, PxI32(t + 1), PxI32(t)) != PxI32(t))
+				task = NULL;
+
+			mBottom = PxI32(t + 1);
+			return task;
+		}
+
+		// Any thread. Returns the oldest task, NULL if the deque is empty.
+		PxBaseTask* steal()
+		{
+			for(;;)
+			{
+				const PxU32 t = PxU32(mTop);
+				Ps::memoryBarrier();
+				const PxU32 b = PxU32(mBottom);
+				if(PxI32(b - t) <= 0)
+					return NULL;
+
+				PxBaseTask* task = mTasks[t & (EXT_WORK_STEALING_DEQUE_SIZE-1)];
+				if(Ps::atomicCompareExchange(&mTop, PxI32(t + 1), PxI32(t)) == PxI32(t))
+					return task;
+
+				// Lost the race against the owner or another thief, someone made progress so try again.
+			}
+		}
+
+		bool isEmpty() const
+		{
+			return PxI32(PxU32(mBottom) - PxU32(mTop)) <= 0;
+		}
+
+	private:
+		volatile PxI32			mTop;
+		PxU8					mPad[60];	// Keep top and bottom on different cache lines, top is written by the thieves
+		volatile PxI32			mBottom;
+		PxBaseTask* volatile	mTasks[EXT_WORK_STEALING_DEQUE_SIZE];
+	};
+
+} // namespace Ext
+
+}
+
+#endif
@@ -46,6 +46,8 @@ namespace physx
 	{
 		class ShapeData;
 		class BVHStructure;
+		struct BuildStats;
+		struct TraversalStats;
 	}
 }
 
@@ -77,8 +79,52 @@ struct PrunerPayload
 
 struct PrunerCallback
 {
+	PrunerCallback() : mTraversalStats(NULL)	{}
 	virtual PxAgain invoke(PxReal& distance, const PrunerPayload& payload) = 0;
     virtual ~PrunerCallback() {}
+
+	Gu::TraversalStats*	mTraversalStats;	// if not NULL, the pruner adds the number of nodes and objects it tested to it
+};
+
+#define SQ_PRUNER_PACKET_SIZE	4
+
+// A packet of rays traversing a pruner together
+struct PrunerRayPacket
+{
+	PxVec3	mOrigins[SQ_PRUNER_PACKET_SIZE];
+	PxVec3	mUnitDirs[SQ_PRUNER_PACKET_SIZE];
+	PxReal	mDistances[SQ_PRUNER_PACKET_SIZE];	// in/out, shrunk as closer hits are found
+	PxU32	mNbRays;							// 1 to SQ_PRUNER_PACKET_SIZE
+	PxU32	mActiveMask;						// bit i is set while ray i keeps looking for hits
+};
+
+// Same as PrunerCallback for ray packets. Returning false stops the query for the given ray only.
+struct PrunerPacketCallback
+{
+	PrunerPacketCallback() : mTraversalStats(NULL)	{}
+	virtual PxAgain invoke(PxU32 rayIndex, PxReal& distance, const PrunerPayload& payload) = 0;
+    virtual ~PrunerPacketCallback() {}
+
+	Gu::TraversalStats*	mTraversalStats;	// same as PrunerCallback::mTraversalStats, for the whole packet
+};
+
+// Forwards the hits of a single ray of a packet, used by the pruners without packet traversal
+struct PrunerPacketRayCallback : PrunerCallback
+{
+	PrunerPacketRayCallback(PrunerPacketCallback& callback, PxU32 rayIndex) : mCallback(callback), mRayIndex(rayIndex)
+	{
+		mTraversalStats = callback.mTraversalStats;
+	}
+
+	virtual PxAgain invoke(PxReal& distance, const PrunerPayload& payload)
+	{
+		return mCallback.invoke(mRayIndex, distance, payload);
+	}
+
+	PrunerPacketCallback&	mCallback;
+	const PxU32				mRayIndex;
+private:
+	PrunerPacketRayCallback& operator=(const PrunerPacketRayCallback&);
 };
 
 class Pruner : public Ps::UserAllocated
@@ -164,6 +210,27 @@ public:
 	virtual	PxAgain						overlap(const Gu::ShapeData& queryVolume, PrunerCallback&) const = 0;
 	virtual	PxAgain						sweep(const Gu::ShapeData& queryVolume, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&) const = 0;
 
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/**
+	 *	Raycasts a packet of rays. Rays whose bit is cleared in the packet's active mask are skipped, and the bit of a ray
+	 *	gets cleared when the callback returns false for it. The default implementation traverses the pruner once per ray.
+	 *	\param		packet		[in/out]	the rays, their distances and active mask
+	 *	\param		pcb			[in]		the callback receiving the hits
+	 */
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	virtual	void						raycastPacket(PrunerRayPacket& packet, PrunerPacketCallback& pcb) const
+										{
+											for(PxU32 i=0;i<packet.mNbRays;i++)
+											{
+												if(!(packet.mActiveMask & (1<<i)))
+													continue;
+
+												PrunerPacketRayCallback rayCallback(pcb, i);
+												if(!raycast(packet.mOrigins[i], packet.mUnitDirs[i], packet.mDistances[i], rayCallback))
+													packet.mActiveMask &= ~(1<<i);
+											}
+										}
+
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	/**
 	 *	Retrieve the object data associated with the handle
@@ -203,6 +270,9 @@ public:
 
 	// additional 'internal' interface		
 	virtual	void						visualize(Cm::RenderOutput&, PxU32) const {}
+
+	// statistics of the last tree build, NULL for pruners without a tree
+	virtual	const Gu::BuildStats*		getBuildStats() const { return NULL; }
 };
 
 //////////////////////////////////////////////////////////////////////////
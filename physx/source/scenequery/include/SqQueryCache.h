@@ -0,0 +1,107 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef SQ_QUERY_CACHE_H
+#define SQ_QUERY_CACHE_H
+
+#include "SqPruner.h"
+#include "PsArray.h"
+#include "PsMutex.h"
+
+namespace physx
+{
+namespace Sq
+{
+	struct QueryCacheStats
+	{
+		PxU32	mNbHits;		// queries served from cached candidates
+		PxU32	mNbMisses;		// queries that gathered new candidates
+		PxU32	mNbStale;		// misses on an entry invalidated by a change to its pruner
+		PxU32	mNbOverflows;	// queries with too many candidates to be cached, run on the pruner directly
+	};
+
+	// Caches the candidate objects returned by a pruner for overlap and sweep queries that are repeated every frame with
+	// similar shapes and poses, e.g. by characters.
+	//
+	// Each entry stores the objects of a single pruner overlapping the query bounds inflated by a tolerance. A later query
+	// of the same type whose bounds are contained in this region reuses the candidates instead of traversing the pruner, as
+	// long as the pruner's timestamp didn't change. The candidates are a superset of what the pruner would return, the narrow
+	// phase filters out the extra objects.
+	//
+	// Entries are direct-mapped on a grid of cells of the tolerance size, a query replaces the entry of its cell on a miss.
+	class QueryCache : public Ps::UserAllocated
+	{
+		PX_NOCOPY(QueryCache)
+	public:
+		enum
+		{
+			MAX_NB_CANDIDATES	= 256	// per entry, queries with more candidates are not cached
+		};
+
+								QueryCache();
+								~QueryCache();
+
+		// maxNbEntries is rounded up to a power of two, 0 disables the cache
+				void			setParams(PxU32 maxNbEntries, PxReal tolerance);
+		PX_FORCE_INLINE	PxU32	getMaxNbEntries()	const	{ return mEntries.size();	}
+		PX_FORCE_INLINE	PxReal	getTolerance()		const	{ return mTolerance;		}
+		PX_FORCE_INLINE	bool	isEnabled()			const	{ return mEntries.size() != 0;	}
+
+		// Reports the candidates of the pruner overlapping queryBounds to the callback, from the cache if possible. queryType
+		// is a small caller-defined id of the query kind and shape. Returns false if the candidates could not be cached, the
+		// caller then runs the query on the pruner itself. Thread safe.
+				bool			query(const Pruner& pruner, PxU32 prunerIndex, PxU32 timestamp, PxU32 queryType,
+									const PxBounds3& queryBounds, PrunerCallback& pcb, PxAgain& again);
+
+				void			getStats(QueryCacheStats& stats)	const;
+				void			resetStats();
+	private:
+		struct Entry
+		{
+			Entry() : mTimestamp(0), mPrunerIndex(0), mQueryType(0), mValid(false)	{}
+
+			PxBounds3					mBounds;		// region the candidates were gathered in
+			PxU32						mTimestamp;		// pruner timestamp at gathering time
+			PxU32						mPrunerIndex;
+			PxU32						mQueryType;
+			bool						mValid;
+			Ps::Array<PrunerPayload>	mCandidates;
+		};
+
+				PxU32			getEntryIndex(const PxBounds3& queryBounds, PxU32 prunerIndex, PxU32 queryType)	const;
+
+		mutable	Ps::Mutex		mMutex;
+				Ps::Array<Entry>	mEntries;
+				PxReal			mTolerance;
+				QueryCacheStats	mStats;
+	};
+}
+}
+
+#endif // SQ_QUERY_CACHE_H
@@ -34,17 +34,22 @@
 @{ */
 
 #include "PxSceneDesc.h"
+#include "PxScene.h"
 #include "CmBitMap.h"
 #include "PsArray.h"
 #include "SqPruner.h"
 #include "PsMutex.h"
 #include "PxActor.h" // needed for offset table
 #include "ScScene.h"
+#include "GuAABBTreeBuild.h"
 // threading
 #include "PsSync.h"
 
 namespace physx
 {
+class PxCpuDispatcher;
+struct PxSceneQueryRebuildStatistics;
+
 namespace Scb
 {
 	class Scene;
@@ -72,7 +77,7 @@ namespace Sq
 														PrunerExt();
 														~PrunerExt();
 
-						void							init(PxPruningStructureType::Enum type, PxU64 contextID, PxU32 sceneLimit);
+						void							init(PxPruningStructureType::Enum type, PxU64 contextID, PxU32 sceneLimit, PxCpuDispatcher* buildDispatcher, PxReal gridCellSize);
 						void							flushMemory();
 						void							preallocate(PxU32 nbShapes);
 						void							flushShapes(PxU32 index);
@@ -94,12 +99,26 @@ namespace Sq
 						Ps::Array<PrunerHandle>			mDirtyList;
 						PxPruningStructureType::Enum	mPrunerType;
 						PxU32							mTimestamp;
+						PxCpuDispatcher*				mDispatcher;	// computes the bounds of large dirty lists in parallel
 
 						PX_NOCOPY(PrunerExt)
 
 		friend class SceneQueryManager;
 	};
 
+	// Costs of a single query in one pruner, gathered by the scene queries when the statistics are enabled. The pruners fill
+	// mTraversal through PrunerCallback::mTraversalStats, the scene queries fill the other counters.
+	struct PrunerQueryStats
+	{
+		PrunerQueryStats() : mNbQueries(0), mNbNarrowTests(0), mNbHits(0), mTicks(0)	{}
+
+		Gu::TraversalStats	mTraversal;
+		PxU32				mNbQueries;
+		PxU32				mNbNarrowTests;
+		PxU32				mNbHits;
+		PxU64				mTicks;		// time spent in the pruner, in counter ticks
+	};
+
 	typedef Ps::Pair<PrunerCompoundId, PrunerHandle>	CompoundPair;
 	typedef Ps::CoalescedHashSet<CompoundPair >			CompoundPrunerSet;
 	// AB: extended compoud pruner structure, buffers compound shape changes and flushes them.
@@ -143,7 +162,8 @@ namespace Sq
 	public:
 														SceneQueryManager(Scb::Scene& scene, PxPruningStructureType::Enum staticStructure, 
 															PxPruningStructureType::Enum dynamicStructure, PxU32 dynamicTreeRebuildRateHint,
-															const PxSceneLimits& limits);
+															const PxSceneLimits& limits, PxCpuDispatcher* buildDispatcher = NULL, PxReal gridPrunerCellSize = 0.0f,
+															PxU32 dynamicTreeRebuildTimeBudget = 0);
 														~SceneQueryManager();
 
 						PrunerData						addPrunerShape(const Scb::Shape& scbShape, const Scb::Actor& scbActor, bool dynamic, PrunerCompoundId compoundId, const PxBounds3* bounds=NULL, bool hasPrunerStructure = false);
@@ -156,6 +176,7 @@ namespace Sq
 	public:
 		PX_FORCE_INLINE	Scb::Scene&						getScene()						const	{ return mScene;			}
 		PX_FORCE_INLINE	PxU32							getDynamicTreeRebuildRateHint()	const	{ return mRebuildRateHint;	}
+		PX_FORCE_INLINE	PxU32							getDynamicTreeRebuildTimeBudget()	const	{ return mRebuildTimeBudget;	}
 
 		PX_FORCE_INLINE	const PrunerExt&				get(PruningIndex::Enum index)	const	{ return mPrunerExt[index];	}
 		PX_FORCE_INLINE	PrunerExt&						get(PruningIndex::Enum index)			{ return mPrunerExt[index];	}
@@ -165,10 +186,21 @@ namespace Sq
 						void							preallocate(PxU32 staticShapes, PxU32 dynamicShapes);
 						void							markForUpdate(PrunerCompoundId compoundId, PrunerData s);
 						void							setDynamicTreeRebuildRateHint(PxU32 dynTreeRebuildRateHint);
+						void							setDynamicTreeRebuildTimeBudget(PxU32 microseconds);
+						void							getRebuildStatistics(PruningIndex::Enum index, PxSceneQueryRebuildStatistics& stats)	const;
+
+		// Scene query statistics. Each query adds its costs itself, from any thread. endQueryStatsFrame() publishes the counters
+		// of the frame that ends to getQueryStats().
+		PX_FORCE_INLINE	bool							getQueryStatsEnabled()			const	{ return mQueryStatsEnabled;		}
+		PX_FORCE_INLINE	const PxSceneQueryStatistics&	getQueryStats()					const	{ return mLastFrameQueryStats;	}
+						void							setQueryStatsEnabled(bool enabled);
+						void							addQueryStats(PxSceneQueryStatistics::QueryType type, const PrunerQueryStats* stats)	const;	// PxSceneQueryStatistics::ePRUNER_COUNT entries
+						void							endQueryStatsFrame();
 						
 						void							flushUpdates();
 						void							forceDynamicTreeRebuild(bool rebuildStaticStructure, bool rebuildDynamicStructure);
 						void							sceneQueryBuildStep(PruningIndex::Enum index);
+						void							commitNewTrees();
 
 						void							updateCompoundActors(Sc::BodyCore*const* bodies, PxU32 numBodies);
 						void							updateCompoundActor(PrunerCompoundId compoundId, const PxTransform& compoundTransform, bool dynamic);						
@@ -188,6 +220,7 @@ namespace Sq
 						CompoundPrunerExt				mCompoundPrunerExt;										
 
 						PxU32							mRebuildRateHint;
+						PxU32							mRebuildTimeBudget;	// in microseconds, 0 to use mRebuildRateHint
 
 						Scb::Scene&						mScene;
 
@@ -196,7 +229,13 @@ namespace Sq
 
 						DynamicBoundsSync				mDynamicBoundsSync;
 
+						bool							mQueryStatsEnabled;
+		mutable			Ps::Mutex						mQueryStatsLock;		// queries are const and can run in parallel
+		mutable			PxSceneQueryStatistics			mQueryStats;			// frame in progress
+						PxSceneQueryStatistics			mLastFrameQueryStats;
+
 						volatile bool					mPrunerNeedsUpdating;
+						volatile bool					mNewTreesReady;	// set by the build tasks, the trees are switched in commitNewTrees()
 
 						void							flushShapes();
 	};
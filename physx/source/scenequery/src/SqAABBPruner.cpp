@@ -34,9 +34,13 @@
 #include "PsUserAllocated.h"
 #include "PsBitUtils.h"
 #include "PsFoundation.h"
+#include "PsTime.h"
 #include "SqAABBPruner.h"
 #include "SqAABBTree.h"
+#include "SqWideAABBTreeQuery.h"
+#include "SqCompressedAABBTreeQuery.h"
 #include "SqPrunerMergeData.h"
+#include "GuParallelJobs.h"
 #include "GuSphere.h"
 #include "GuBox.h"
 #include "GuCapsule.h"
@@ -60,8 +64,10 @@ IncrementalPruner* physx::Sq::createAABBPruner(bool incrementalRebuild)
 // PT: currently limited to 15 max
 #define NB_OBJECTS_PER_NODE	4
 
-AABBPruner::AABBPruner(bool incrementalRebuild, PxU64 contextID) :
+AABBPruner::AABBPruner(bool incrementalRebuild, PxU64 contextID, AABBPrunerLayout::Enum layout, PxCpuDispatcher* buildDispatcher) :
 	mAABBTree			(NULL),
+	mWideTree			(NULL),
+	mCompressedTree		(NULL),
 	mNewTree			(NULL),
 	mCachedBoxes		(NULL),
 	mNbCachedBoxes		(0),
@@ -71,11 +77,16 @@ AABBPruner::AABBPruner(bool incrementalRebuild, PxU64 contextID) :
 	mProgress			(BUILD_NOT_STARTED),
 	mRebuildRateHint	(100),
 	mAdaptiveRebuildTerm(0),
+	mRebuildTimeBudget	(0),
+	mTimePerWorkUnit	(0.0f),
 	mIncrementalRebuild	(incrementalRebuild),
+	mUseWideTree		(layout==AABBPrunerLayout::eWIDE && !incrementalRebuild),
+	mUseCompressedTree	(layout==AABBPrunerLayout::eCOMPRESSED && !incrementalRebuild),
 	mUncommittedChanges	(false),
 	mNeedsNewTree		(false),
 	mNewTreeFixups		(PX_DEBUG_EXP("AABBPruner::mNewTreeFixups")),
-	mContextID			(contextID)
+	mContextID			(contextID),
+	mBuildDispatcher	(buildDispatcher)
 {
 }
 
@@ -158,12 +169,37 @@ void AABBPruner::updateObjectsAfterManualBoundsUpdates(const PrunerHandle* handl
 				PX_UNUSED(found); PX_ASSERT(found);
 			}
 
-			if(mProgress==BUILD_NEW_MAPPING || mProgress==BUILD_FULL_REFIT)
+			// PT: moves after the new mapping are not captured by the full refit of the new tree, they are applied to it before the switch
+			if(mProgress>=BUILD_NEW_MAPPING)
 				mToRefit.pushBack(poolIndex);
 		}
 	}
 }
 
+namespace
+{
+	// Bounds updates are split in batches of this many objects, done in parallel when there are several of them
+	const PxU32 PARALLEL_INFLATE_BATCH_SIZE = 2048;
+
+	struct InflateBoundsParams
+	{
+		PruningPool*		mPool;
+		const PrunerHandle*	mHandles;
+		const PxU32*		mIndices;
+		const PxBounds3*	mNewBounds;
+		PxU32				mCount;
+	};
+}
+
+static void inflateBoundsJob(void* userData, PxU32 jobIndex)
+{
+	const InflateBoundsParams& params = *reinterpret_cast<const InflateBoundsParams*>(userData);
+	const PxU32 start = jobIndex * PARALLEL_INFLATE_BATCH_SIZE;
+	const PxU32 nb = PxMin(params.mCount - start, PARALLEL_INFLATE_BATCH_SIZE);
+	// PT: the indices point into the whole newBounds array, so each batch only needs its own handles and indices
+	params.mPool->updateObjectsAndInflateBounds(params.mHandles + start, params.mIndices + start, params.mNewBounds, nb);
+}
+
 void AABBPruner::updateObjectsAndInflateBounds(const PrunerHandle* handles, const PxU32* indices, const PxBounds3* newBounds, PxU32 count)
 {
 	PX_PROFILE_ZONE("SceneQuery.prunerUpdateObjects", mContextID);
@@ -173,7 +209,20 @@ void AABBPruner::updateObjectsAndInflateBounds(const PrunerHandle* handles, cons
 
 	mUncommittedChanges = true;
 
-	mPool.updateObjectsAndInflateBounds(handles, indices, newBounds, count);
+	// PT: each object is written by a single batch. The tree marking below touches shared data and stays on this thread.
+	const PxU32 nbBatches = (count + PARALLEL_INFLATE_BATCH_SIZE - 1) / PARALLEL_INFLATE_BATCH_SIZE;
+	if(nbBatches>1 && getNbParallelThreads(mBuildDispatcher)>1)
+	{
+		InflateBoundsParams params;
+		params.mPool		= &mPool;
+		params.mHandles		= handles;
+		params.mIndices		= indices;
+		params.mNewBounds	= newBounds;
+		params.mCount		= count;
+		runParallelJobs(mBuildDispatcher, nbBatches, inflateBoundsJob, &params, "SceneQuery.prunerInflateBounds");
+	}
+	else
+		mPool.updateObjectsAndInflateBounds(handles, indices, newBounds, count);
 
 	if(mIncrementalRebuild && mAABBTree)
 	{
@@ -195,7 +244,7 @@ void AABBPruner::updateObjectsAndInflateBounds(const PrunerHandle* handles, cons
 				PX_UNUSED(found); PX_ASSERT(found);
 			}
 
-			if(mProgress == BUILD_NEW_MAPPING || mProgress == BUILD_FULL_REFIT)
+			if(mProgress>=BUILD_NEW_MAPPING)
 				mToRefit.pushBack(poolIndex);
 		}
 	}
@@ -261,13 +310,39 @@ void AABBPruner::removeObjects(const PrunerHandle* handles, PxU32 count)
  */
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+// PT: the compressed tree replaces the binary tree, 'tree' is NULL when it is used
+template<typename Test>
+static PX_FORCE_INLINE PxAgain doOverlap(const PruningPool& pool, const AABBTree* tree, const WideAABBTree* wideTree, const CompressedAABBTree* compressedTree, const Test& test, PrunerCallback& pcb)
+{
+	if(compressedTree)
+		return CompressedAABBTreeOverlap<Test, PrunerPayload, PrunerCallback>()(pool.getObjects(), pool.getCurrentWorldBoxes(), *compressedTree, test, pcb, pcb.mTraversalStats);
+
+	if(wideTree)
+		return WideAABBTreeOverlap<Test, PrunerPayload, PrunerCallback>()(pool.getObjects(), pool.getCurrentWorldBoxes(), *wideTree, test, pcb, pcb.mTraversalStats);
+
+	return AABBTreeOverlap<Test, AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCallback>()(pool.getObjects(), pool.getCurrentWorldBoxes(), *tree, test, pcb, pcb.mTraversalStats);
+}
+
+template<bool tInflate>
+static PX_FORCE_INLINE PxAgain doRaycast(const PruningPool& pool, const AABBTree* tree, const WideAABBTree* wideTree, const CompressedAABBTree* compressedTree,
+										const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, const PxVec3& inflation, PrunerCallback& pcb)
+{
+	if(compressedTree)
+		return CompressedAABBTreeRaycast<tInflate, PrunerPayload, PrunerCallback>()(pool.getObjects(), pool.getCurrentWorldBoxes(), *compressedTree, origin, unitDir, inOutDistance, inflation, pcb, pcb.mTraversalStats);
+
+	if(wideTree)
+		return WideAABBTreeRaycast<tInflate, PrunerPayload, PrunerCallback>()(pool.getObjects(), pool.getCurrentWorldBoxes(), *wideTree, origin, unitDir, inOutDistance, inflation, pcb, pcb.mTraversalStats);
+
+	return AABBTreeRaycast<tInflate, AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCallback>()(pool.getObjects(), pool.getCurrentWorldBoxes(), *tree, origin, unitDir, inOutDistance, inflation, pcb, pcb.mTraversalStats);
+}
+
 PxAgain AABBPruner::overlap(const ShapeData& queryVolume, PrunerCallback& pcb) const
 {
 	PX_ASSERT(!mUncommittedChanges);
 
 	PxAgain again = true;
 
-	if(mAABBTree)
+	if(mAABBTree || mCompressedTree)
 	{
 		switch(queryVolume.getType())
 		{
@@ -276,12 +351,12 @@ PxAgain AABBPruner::overlap(const ShapeData& queryVolume, PrunerCallback& pcb) c
 				if(queryVolume.isOBB())
 				{	
 					const Gu::OBBAABBTest test(queryVolume.getPrunerWorldPos(), queryVolume.getPrunerWorldRot33(), queryVolume.getPrunerBoxGeomExtentsInflated());
-					again = AABBTreeOverlap<Gu::OBBAABBTest, AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, test, pcb);
+					again = doOverlap(mPool, mAABBTree, mWideTree, mCompressedTree, test, pcb);
 				}
 				else
 				{
 					const Gu::AABBAABBTest test(queryVolume.getPrunerInflatedWorldAABB());
-					again = AABBTreeOverlap<Gu::AABBAABBTest, AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, test, pcb);
+					again = doOverlap(mPool, mAABBTree, mWideTree, mCompressedTree, test, pcb);
 				}
 			}
 			break;
@@ -290,20 +365,20 @@ PxAgain AABBPruner::overlap(const ShapeData& queryVolume, PrunerCallback& pcb) c
 				const Gu::Capsule& capsule = queryVolume.getGuCapsule();
 				const Gu::CapsuleAABBTest test(	capsule.p1, queryVolume.getPrunerWorldRot33().column0,
 												queryVolume.getCapsuleHalfHeight()*2.0f, PxVec3(capsule.radius*SQ_PRUNER_INFLATION));
-				again = AABBTreeOverlap<Gu::CapsuleAABBTest, AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, test, pcb);
+				again = doOverlap(mPool, mAABBTree, mWideTree, mCompressedTree, test, pcb);
 			}
 			break;
 		case PxGeometryType::eSPHERE:
 			{
 				const Gu::Sphere& sphere = queryVolume.getGuSphere();
 				Gu::SphereAABBTest test(sphere.center, sphere.radius);
-				again = AABBTreeOverlap<Gu::SphereAABBTest, AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, test, pcb);
+				again = doOverlap(mPool, mAABBTree, mWideTree, mCompressedTree, test, pcb);
 			}
 			break;
 		case PxGeometryType::eCONVEXMESH:
 			{
 				const Gu::OBBAABBTest test(queryVolume.getPrunerWorldPos(), queryVolume.getPrunerWorldRot33(), queryVolume.getPrunerBoxGeomExtentsInflated());
-				again = AABBTreeOverlap<Gu::OBBAABBTest, AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, test, pcb);			
+				again = doOverlap(mPool, mAABBTree, mWideTree, mCompressedTree, test, pcb);			
 			}
 			break;
 		case PxGeometryType::ePLANE:
@@ -327,11 +402,11 @@ PxAgain AABBPruner::sweep(const ShapeData& queryVolume, const PxVec3& unitDir, P
 
 	PxAgain again = true;
 
-	if(mAABBTree)
+	if(mAABBTree || mCompressedTree)
 	{
 		const PxBounds3& aabb = queryVolume.getPrunerInflatedWorldAABB();
 		const PxVec3 extents = aabb.getExtents();
-		again = AABBTreeRaycast<true, AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, aabb.getCenter(), unitDir, inOutDistance, extents, pcb);
+		again = doRaycast<true>(mPool, mAABBTree, mWideTree, mCompressedTree, aabb.getCenter(), unitDir, inOutDistance, extents, pcb);
 	}
 
 	if(again && mIncrementalRebuild && mBucketPruner.getNbObjects())
@@ -346,8 +421,8 @@ PxAgain AABBPruner::raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal&
 
 	PxAgain again = true;
 
-	if(mAABBTree)
-		again = AABBTreeRaycast<false, AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, origin, unitDir, inOutDistance, PxVec3(0.0f), pcb);
+	if(mAABBTree || mCompressedTree)
+		again = doRaycast<false>(mPool, mAABBTree, mWideTree, mCompressedTree, origin, unitDir, inOutDistance, PxVec3(0.0f), pcb);
 		
 	if(again && mIncrementalRebuild && mBucketPruner.getNbObjects())
 		again = mBucketPruner.raycast(origin, unitDir, inOutDistance, pcb);
@@ -355,6 +430,41 @@ PxAgain AABBPruner::raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal&
 	return again;
 }
 
+// PT: the wide tree has no packet traversal, packets always go through the binary tree. The compressed tree has
+// no packet traversal either and no binary tree to fall back to, so its packets are split into single rays.
+void AABBPruner::raycastPacket(PrunerRayPacket& packet, PrunerPacketCallback& pcb) const
+{
+	PX_ASSERT(!mUncommittedChanges);
+
+	if(mAABBTree)
+		AABBTreeRaycastPacket<AABBTree, AABBTreeRuntimeNode, PrunerPayload, PrunerRayPacket, PrunerPacketCallback>()(mPool.getObjects(), mPool.getCurrentWorldBoxes(), *mAABBTree, packet, pcb, pcb.mTraversalStats);
+	else if(mCompressedTree)
+	{
+		for(PxU32 i=0;i<packet.mNbRays;i++)
+		{
+			if(!(packet.mActiveMask & (1<<i)))
+				continue;
+
+			PrunerPacketRayCallback rayCallback(pcb, i);
+			if(!doRaycast<false>(mPool, NULL, NULL, mCompressedTree, packet.mOrigins[i], packet.mUnitDirs[i], packet.mDistances[i], PxVec3(0.0f), rayCallback))
+				packet.mActiveMask &= ~(1<<i);
+		}
+	}
+
+	if(packet.mActiveMask && mIncrementalRebuild && mBucketPruner.getNbObjects())
+	{
+		for(PxU32 i=0;i<packet.mNbRays;i++)
+		{
+			if(!(packet.mActiveMask & (1<<i)))
+				continue;
+
+			PrunerPacketRayCallback rayCallback(pcb, i);
+			if(!mBucketPruner.raycast(packet.mOrigins[i], packet.mUnitDirs[i], packet.mDistances[i], rayCallback))
+				packet.mActiveMask &= ~(1<<i);
+		}
+	}
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 /**
  *	Other methods of Pruner Interface
@@ -397,8 +507,8 @@ void AABBPruner::commit()
 	if(!mAABBTree || !mIncrementalRebuild)
 	{
 #if PX_CHECKED
-		if(!mIncrementalRebuild && mAABBTree)
-			Ps::getFoundation().error(PxErrorCode::ePERF_WARNING, __FILE__, __LINE__, "SceneQuery static AABB Tree rebuilt, because a shape attached to a static actor was added, removed or moved, and PxSceneDesc::staticStructure is set to eSTATIC_AABB_TREE.");
+		if(!mIncrementalRebuild && (mAABBTree || mCompressedTree))
+			Ps::getFoundation().error(PxErrorCode::ePERF_WARNING, __FILE__, __LINE__, "SceneQuery static AABB Tree rebuilt, because a shape attached to a static actor was added, removed or moved, and PxSceneDesc::staticStructure is set to eSTATIC_AABB_TREE, eSTATIC_WIDE_AABB_TREE or eSTATIC_COMPRESSED_AABB_TREE.");
 #endif
 		fullRebuildAABBTree();
 		return;
@@ -427,36 +537,11 @@ void AABBPruner::commit()
 	{
 		PX_PROFILE_ZONE("SceneQuery.prunerNewTreeFinalize", mContextID);
 
-		{
-			PX_PROFILE_ZONE("SceneQuery.prunerNewTreeSwitch", mContextID);
-
-			PX_DELETE(mAABBTree); // delete the old tree
-			PX_FREE_AND_RESET(mCachedBoxes);
-			mProgress = BUILD_NOT_STARTED; // reset the build state to initial
-
-			// Adjust adaptive term to get closer to specified rebuild rate.
-			// perform an even division correction to make sure the rebuild rate adds up
-			if (mNbCalls > mRebuildRateHint)
-				mAdaptiveRebuildTerm++;
-			else if (mNbCalls < mRebuildRateHint)
-				mAdaptiveRebuildTerm--;
-
-			// Switch trees
-#if PX_DEBUG
-			mNewTree->validate();
-#endif
-			mAABBTree = mNewTree; // set current tree to progressively rebuilt tree
-			mNewTree = NULL; // clear out the progressively rebuild tree pointer
-		}
-
 		{
 			PX_PROFILE_ZONE("SceneQuery.prunerNewTreeMapping", mContextID);
 
-			// rebuild the tree map to match the current (newly built) tree
-			mTreeMap.initMap(PxMax(mPool.getNbActiveObjects(), mNbCachedBoxes), *mAABBTree);
-
-			// The new mapping has been computed using only indices stored in the new tree. Those indices map the pruning pool
-			// we had when starting to build the tree. We need to re-apply recorded moves to fix the tree that finished rebuilding.
+			// The new mapping has been computed in the BUILD_NEW_MAPPING stage. We need to re-apply the moves recorded since then
+			// to fix the tree that finished rebuilding.
 			// AP: the problem here is while we are rebuilding the tree there are ongoing modifications to the current tree
 			// but the background build has a cached copy of all the AABBs at the time it was started
 			// (and will produce indices referencing those)
@@ -468,11 +553,11 @@ void AABBPruner::commit()
 				// We must do this before invalidating the corresponding tree nodes in the map, obviously (otherwise we'd be reading node
 				// indices that we already invalidated).
 				const PoolIndex poolIndex = r->removedIndex;
-				const TreeNodeIndex treeNodeIndex = mTreeMap[poolIndex];
+				const TreeNodeIndex treeNodeIndex = mNewTreeMap[poolIndex];
 				if(treeNodeIndex!=INVALID_NODE_ID)
-					mAABBTree->markNodeForRefit(treeNodeIndex);
+					mNewTree->markNodeForRefit(treeNodeIndex);
 
-				mTreeMap.invalidate(r->removedIndex, r->relocatedLastIndex, *mAABBTree);
+				mNewTreeMap.invalidate(r->removedIndex, r->relocatedLastIndex, *mNewTree);
 			}
 			mNewTreeFixups.clear(); // clear out the fixups since we just applied them all
 		}
@@ -484,11 +569,45 @@ void AABBPruner::commit()
 			for(PxU32 i=0;i<size;i++)
 			{
 				const PoolIndex poolIndex = mToRefit[i];
-				const TreeNodeIndex treeNodeIndex = mTreeMap[poolIndex];
+				const TreeNodeIndex treeNodeIndex = mNewTreeMap[poolIndex];
 				if(treeNodeIndex!=INVALID_NODE_ID)
-					mAABBTree->markNodeForRefit(treeNodeIndex);
+					mNewTree->markNodeForRefit(treeNodeIndex);
 			}
 			mToRefit.clear();
+
+			if(mPool.getNbActiveObjects())
+				mNewTree->refitMarkedNodes(mPool.getCurrentWorldBoxes(), mBuildDispatcher);
+		}
+
+		{
+			PX_PROFILE_ZONE("SceneQuery.prunerNewTreeSwitch", mContextID);
+
+			PX_DELETE(mAABBTree); // delete the old tree
+			PX_FREE_AND_RESET(mCachedBoxes);
+			mProgress = BUILD_NOT_STARTED; // reset the build state to initial
+
+			// Adjust adaptive term to get closer to specified rebuild rate.
+			// perform an even division correction to make sure the rebuild rate adds up
+			// PT: with a time budget the number of steps is not a target, the term is left alone
+			if(!mRebuildTimeBudget)
+			{
+				if (mNbCalls > mRebuildRateHint)
+					mAdaptiveRebuildTerm++;
+				else if (mNbCalls < mRebuildRateHint)
+					mAdaptiveRebuildTerm--;
+			}
+			mRebuildStats.mNbRebuilds++;
+
+			// Switch trees
+#if PX_DEBUG
+			mNewTree->validate();
+#endif
+			Ps::memoryBarrier();	// the new tree is complete before it is published
+			mAABBTree = mNewTree; // set current tree to progressively rebuilt tree
+			mNewTree = NULL; // clear out the progressively rebuild tree pointer
+			mTreeMap.swap(mNewTreeMap); // the old map's memory is reused by the next build
+
+			// PT: refits the bucket pruner, the new tree is already up to date
 			refitUpdatedAndRemoved();
 		}
 
@@ -513,6 +632,14 @@ void AABBPruner::shiftOrigin(const PxVec3& shift)
 	if(mAABBTree)
 		mAABBTree->shiftOrigin(shift);
 
+	// PT: the quantized bounds are relative to the nodes' bounds, recomputing them is safer than shifting the nodes
+	rebuildWideTree();
+
+	// PT: same for the compressed tree, but it has no binary tree left to collapse. Shifting the root bounds alone would
+	// break the conservative rounding of the quantized bounds, so the tree is rebuilt from the already shifted pool.
+	if(mCompressedTree)
+		fullRebuildAABBTree();
+
 	if(mIncrementalRebuild)
 		mBucketPruner.shiftOrigin(shift);
 
@@ -543,6 +670,37 @@ void AABBPruner::visualize(Cm::RenderOutput& out, PxU32 color) const
 		out << color;
 		Local::_Draw(tree->getNodes(), tree->getNodes(), out);
 	}
+	else if(mCompressedTree)
+	{
+		struct Local
+		{
+			static void _Draw(const CompressedAABBTreeNode* nodes, const CompressedAABBTreeNode& node, const PxBounds3& bounds, Cm::RenderOutput& out_)
+			{
+				CompressedAABBTreeFrame frame;
+				frame.init(bounds.minimum, bounds.maximum);
+				for(PxU32 i=0;i<2;i++)
+				{
+					if(CompressedAABBTreeNode::isLeaf(node.mData[i]))
+						continue;
+
+					Vec4V minV, maxV;
+					frame.dequantize(node.mMin[i], node.mMax[i], minV, maxV);
+					PxBounds3 childBounds;
+					V3StoreU(Vec3V_From_Vec4V(minV), childBounds.minimum);
+					V3StoreU(Vec3V_From_Vec4V(maxV), childBounds.maximum);
+					out_ << Cm::DebugBox(childBounds, true);
+					_Draw(nodes, nodes[CompressedAABBTreeNode::getChildIndex(node.mData[i])], childBounds, out_);
+				}
+			}
+		};
+		out << PxTransform(PxIdentity);
+		out << color;
+		const PxBounds3& rootBounds = mCompressedTree->getRootBounds();
+		out << Cm::DebugBox(rootBounds, true);
+		const PxU32 rootData = mCompressedTree->getRootData();
+		if(!CompressedAABBTreeNode::isLeaf(rootData))
+			Local::_Draw(mCompressedTree->getNodes(), mCompressedTree->getNodes()[CompressedAABBTreeNode::getChildIndex(rootData)], rootBounds, out);
+	}
 
 	// Render added objects not yet in the tree
 	out << PxTransform(PxIdentity);
@@ -565,113 +723,199 @@ bool AABBPruner::buildStep(bool synchronousCall)
 	PX_ASSERT(mIncrementalRebuild);
 	if(mNeedsNewTree)
 	{
+		Ps::Time timer;
+
 		if(mProgress==BUILD_NOT_STARTED)
 		{
 			if(!synchronousCall || !prepareBuild())
 				return false;
 		}
-		else if(mProgress==BUILD_INIT)
+		else if(mRebuildTimeBudget)
+			runTimedBuildStages();
+		else
+			runBuildStage(1 + (mTotalWorkUnits / mRebuildRateHint));
+
+		const PxReal stepTime = PxReal(timer.getElapsedSeconds());
+		mRebuildStats.mNbSteps++;
+		mRebuildStats.mLastStepTime = stepTime;
+		mRebuildStats.mMaxStepTime = PxMax(mRebuildStats.mMaxStepTime, stepTime);
+		if(mRebuildTimeBudget && stepTime*1000000.0f > PxReal(mRebuildTimeBudget))
+			mRebuildStats.mNbBudgetOverruns++;
+
+		// This is required to be set because commit handles both refit and a portion of build finalization (why?)
+		// This is overly conservative also only necessary in case there were no updates at all to the tree since the last tree swap
+		// It also overly conservative in a sense that it could be set only if mProgress was just set to BUILD_FINISHED
+		// If run asynchronously from a different thread, we touched just the new AABB build phase, we should not mark the main tree as dirty
+		if(synchronousCall)
+			mUncommittedChanges = true;
+
+		return mProgress==BUILD_FINISHED;
+	}
+
+	return false;
+}
+
+// Runs the current stage of the rebuild. BUILD_IN_PROGRESS processes at least 'limit' work units, if there are enough left.
+void AABBPruner::runBuildStage(PxU32 limit)
+{
+	if(mProgress==BUILD_INIT)
+	{
+		mNewTree->progressiveBuild(mBuilder, mBuildStats, 0, 0);
+		mProgress = BUILD_IN_PROGRESS;
+		mNbCalls = 0;
+
+		// Use a heuristic to estimate the number of work units needed for rebuilding the tree.
+		// The general idea is to use the number of work units of the previous tree to build the new tree.
+		// This works fine as long as the number of leaves remains more or less the same for the old and the
+		// new tree. If that is not the case, this estimate can be way off and the work units per step will
+		// be either much too small or too large. Hence, in that case we will try to estimate the number of work
+		// units based on the number of leaves of the new tree as follows:
+ 		//
+		// - Assume new tree with n leaves is perfectly-balanced
+		// - Compute the depth of perfectly-balanced tree with n leaves
+		// - Estimate number of working units for the new tree
+
+		const PxU32 depth = Ps::ilog2(mBuilder.mNbPrimitives);	// Note: This is the depth without counting the leaf layer
+		const PxU32 estimatedNbWorkUnits = depth * mBuilder.mNbPrimitives;	// Estimated number of work units for new tree
+		const PxU32 estimatedNbWorkUnitsOld = mAABBTree ? mAABBTree->getTotalPrims() : 0;
+		if ((estimatedNbWorkUnits <= (estimatedNbWorkUnitsOld << 1)) && (estimatedNbWorkUnits >= (estimatedNbWorkUnitsOld >> 1)))
+			// The two estimates do not differ by more than a factor 2
+			mTotalWorkUnits = estimatedNbWorkUnitsOld;
+ 		else
 		{
-			mNewTree->progressiveBuild(mBuilder, mBuildStats, 0, 0);
-			mProgress = BUILD_IN_PROGRESS;
-			mNbCalls = 0;
-
-			// Use a heuristic to estimate the number of work units needed for rebuilding the tree.
-			// The general idea is to use the number of work units of the previous tree to build the new tree.
-			// This works fine as long as the number of leaves remains more or less the same for the old and the
-			// new tree. If that is not the case, this estimate can be way off and the work units per step will
-			// be either much too small or too large. Hence, in that case we will try to estimate the number of work
-			// units based on the number of leaves of the new tree as follows:
- 			//
-			// - Assume new tree with n leaves is perfectly-balanced
-			// - Compute the depth of perfectly-balanced tree with n leaves
-			// - Estimate number of working units for the new tree
-
-			const PxU32 depth = Ps::ilog2(mBuilder.mNbPrimitives);	// Note: This is the depth without counting the leaf layer
-			const PxU32 estimatedNbWorkUnits = depth * mBuilder.mNbPrimitives;	// Estimated number of work units for new tree
-			const PxU32 estimatedNbWorkUnitsOld = mAABBTree ? mAABBTree->getTotalPrims() : 0;
-			if ((estimatedNbWorkUnits <= (estimatedNbWorkUnitsOld << 1)) && (estimatedNbWorkUnits >= (estimatedNbWorkUnitsOld >> 1)))
-				// The two estimates do not differ by more than a factor 2
-				mTotalWorkUnits = estimatedNbWorkUnitsOld;
- 			else
-			{
- 				mAdaptiveRebuildTerm = 0;
-				mTotalWorkUnits = estimatedNbWorkUnits;
- 			}
+ 			mAdaptiveRebuildTerm = 0;
+			mTotalWorkUnits = estimatedNbWorkUnits;
+ 		}
  
- 			const PxI32 totalWorkUnits = PxI32(mTotalWorkUnits + (mAdaptiveRebuildTerm * mBuilder.mNbPrimitives));
- 			mTotalWorkUnits = PxU32(PxMax(totalWorkUnits, 0));
-		}
-		else if(mProgress==BUILD_IN_PROGRESS)
+ 		const PxI32 totalWorkUnits = PxI32(mTotalWorkUnits + (mAdaptiveRebuildTerm * mBuilder.mNbPrimitives));
+ 		mTotalWorkUnits = PxU32(PxMax(totalWorkUnits, 0));
+
+		// PT: the counters use the estimate for the new tree, the adaptive term only makes sense for the rate hint
+		mRebuildStats.mNbTotalWorkUnits = PxMax(estimatedNbWorkUnits, mBuilder.mNbPrimitives);
+		mRebuildStats.mNbDoneWorkUnits = 0;
+		mRebuildStats.mNbSteps = 0;
+	}
+	else if(mProgress==BUILD_IN_PROGRESS)
+	{
+		mNbCalls++;
+		// looks like progressiveRebuild returns 0 when finished
+		PxU32 nbWorkUnits = 0;
+		const PxU32 status = mNewTree->progressiveBuild(mBuilder, mBuildStats, 1, limit, &nbWorkUnits);
+		mRebuildStats.mNbDoneWorkUnits += nbWorkUnits;
+		if(!status)
 		{
-			mNbCalls++;
-			const PxU32 Limit = 1 + (mTotalWorkUnits / mRebuildRateHint);
-			// looks like progressiveRebuild returns 0 when finished
-			if (!mNewTree->progressiveBuild(mBuilder, mBuildStats, 1, Limit))
-			{
-				// Done
-				mProgress = BUILD_NEW_MAPPING;
+			// Done
+			mProgress = BUILD_NEW_MAPPING;
 #if PX_DEBUG
-				mNewTree->validate();
+			mNewTree->validate();
 #endif
-			}
 		}
-		else if(mProgress==BUILD_NEW_MAPPING)
-		{
-			mNbCalls++;
-			mProgress = BUILD_FULL_REFIT;
+	}
+	else if(mProgress==BUILD_NEW_MAPPING)
+	{
+		mNbCalls++;
+		mProgress = BUILD_FULL_REFIT;
 
-			// PT: we can't call fullRefit without creating the new mapping first: the refit function will fetch boxes from
-			// the pool using "primitive indices" captured in the tree. But some of these indices may have been invalidated
-			// if objects got removed while the tree was built. So we need to invalidate the corresponding nodes before refit,
-			// that way the #prims will be zero and the code won't fetch a wrong box (which may now below to a different object).
-			{
-				PX_PROFILE_ZONE("SceneQuery.prunerNewTreeMapping", mContextID);
+		// PT: we can't call fullRefit without creating the new mapping first: the refit function will fetch boxes from
+		// the pool using "primitive indices" captured in the tree. But some of these indices may have been invalidated
+		// if objects got removed while the tree was built. So we need to invalidate the corresponding nodes before refit,
+		// that way the #prims will be zero and the code won't fetch a wrong box (which may now below to a different object).
+		{
+			PX_PROFILE_ZONE("SceneQuery.prunerNewTreeMapping", mContextID);
 
-				if(mNewTreeFixups.size())
-				{
-					mNewTreeMap.initMap(PxMax(mPool.getNbActiveObjects(), mNbCachedBoxes), *mNewTree);
+			// PT: the map is created even without fixups, it becomes the tree map when switching to the new tree
+			mNewTreeMap.initMap(PxMax(mPool.getNbActiveObjects(), mNbCachedBoxes), *mNewTree);
 
-					// The new mapping has been computed using only indices stored in the new tree. Those indices map the pruning pool
-					// we had when starting to build the tree. We need to re-apply recorded moves to fix the tree.
-					for(NewTreeFixup* r = mNewTreeFixups.begin(); r < mNewTreeFixups.end(); r++)
-						mNewTreeMap.invalidate(r->removedIndex, r->relocatedLastIndex, *mNewTree);
+			// The new mapping has been computed using only indices stored in the new tree. Those indices map the pruning pool
+			// we had when starting to build the tree. We need to re-apply recorded moves to fix the tree.
+			for(NewTreeFixup* r = mNewTreeFixups.begin(); r < mNewTreeFixups.end(); r++)
+				mNewTreeMap.invalidate(r->removedIndex, r->relocatedLastIndex, *mNewTree);
 
-					mNewTreeFixups.clear();
+			mNewTreeFixups.clear();
 #if PX_DEBUG
-					mNewTree->validate();
+			mNewTree->validate();
 #endif
-				}
-			}
 		}
-		else if(mProgress==BUILD_FULL_REFIT)
-		{
-			mNbCalls++;
-			mProgress = BUILD_LAST_FRAME;
+	}
+	else if(mProgress==BUILD_FULL_REFIT)
+	{
+		mNbCalls++;
+		mProgress = BUILD_LAST_FRAME;
 
-			{
-				PX_PROFILE_ZONE("SceneQuery.prunerNewTreeFullRefit", mContextID);
+		{
+			PX_PROFILE_ZONE("SceneQuery.prunerNewTreeFullRefit", mContextID);
 
-				// We need to refit the new tree because objects may have moved while we were building it.
-				mNewTree->fullRefit(mPool.getCurrentWorldBoxes());
-			}
+			// We need to refit the new tree because objects may have moved while we were building it.
+			mNewTree->fullRefit(mPool.getCurrentWorldBoxes());
 		}
-		else if(mProgress==BUILD_LAST_FRAME)
+	}
+	else if(mProgress==BUILD_LAST_FRAME)
+	{
+		mProgress = BUILD_FINISHED;
+	}
+}
+
+namespace
+{
+	// Work units processed between two checks of the time budget. A work unit is about one object moved down one level of the tree.
+	const PxU32 TIMED_BUILD_SLICE_SIZE = 512;
+}
+
+// Runs the stages of the rebuild until the time budget is used or the new tree is ready
+void AABBPruner::runTimedBuildStages()
+{
+	Ps::Time timer;
+	const Ps::Time::Second budget = Ps::Time::Second(mRebuildTimeBudget) * 0.000001;
+
+	Ps::Time::Second elapsed = 0.0;
+	bool firstStage = true;
+	while(mProgress!=BUILD_FINISHED)
+	{
+		// PT: these stages process all the objects at once, starting them late in the step would likely exceed the budget
+		if(!firstStage && (mProgress==BUILD_NEW_MAPPING || mProgress==BUILD_FULL_REFIT))
+			break;
+
+		if(mProgress==BUILD_IN_PROGRESS)
 		{
-			mProgress = BUILD_FINISHED;
+			// PT: a node is subdivided at once, the nodes near the root can be much larger than a slice. We don't start
+			// one that would not fit in the rest of the budget, unless nothing has been done yet in this step.
+			const PxU32 sliceSize = PxMax(mNewTree->getNextBuildNodeSize(), TIMED_BUILD_SLICE_SIZE);
+			if(!firstStage && Ps::Time::Second(sliceSize * mTimePerWorkUnit) > budget - elapsed)
+				break;
+
+			const PxU32 nbDone = mRebuildStats.mNbDoneWorkUnits;
+			runBuildStage(TIMED_BUILD_SLICE_SIZE);
+			const Ps::Time::Second sliceTime = timer.peekElapsedSeconds() - elapsed;
+			const PxU32 nbSliceWorkUnits = mRebuildStats.mNbDoneWorkUnits - nbDone;
+			if(nbSliceWorkUnits)
+			{
+				const PxReal timePerWorkUnit = PxReal(sliceTime / Ps::Time::Second(nbSliceWorkUnits));
+				mTimePerWorkUnit = mTimePerWorkUnit!=0.0f ? (mTimePerWorkUnit + timePerWorkUnit) * 0.5f : timePerWorkUnit;
+			}
 		}
+		else
+			runBuildStage(TIMED_BUILD_SLICE_SIZE);
 
-		// This is required to be set because commit handles both refit and a portion of build finalization (why?)
-		// This is overly conservative also only necessary in case there were no updates at all to the tree since the last tree swap
-		// It also overly conservative in a sense that it could be set only if mProgress was just set to BUILD_FINISHED
-		// If run asynchronously from a different thread, we touched just the new AABB build phase, we should not mark the main tree as dirty
-		if(synchronousCall)
-			mUncommittedChanges = true;
+		firstStage = false;
 
-		return mProgress==BUILD_FINISHED;
+		elapsed = timer.peekElapsedSeconds();
+		if(elapsed>=budget)
+			break;
 	}
+}
 
-	return false;
+PxU32 AABBPruner::getNbRemainingWorkUnits() const
+{
+	if(!mNeedsNewTree || mProgress>=BUILD_NEW_MAPPING)
+		return 0;
+
+	if(mProgress!=BUILD_IN_PROGRESS)
+		return mRebuildStats.mNbTotalWorkUnits ? mRebuildStats.mNbTotalWorkUnits : mPool.getNbActiveObjects();
+
+	// PT: the total is an estimate, there is always some work left until the tree is built
+	const PxU32 total = mRebuildStats.mNbTotalWorkUnits;
+	const PxU32 done = mRebuildStats.mNbDoneWorkUnits;
+	return done<total ? total - done : 1;
 }
 
 bool AABBPruner::prepareBuild()
@@ -737,6 +981,8 @@ bool AABBPruner::fullRebuildAABBTree()
 	PX_PROFILE_ZONE("SceneQuery.prunerFullRebuildAABBTree", mContextID);
 
 	// Release possibly already existing tree
+	PX_DELETE_AND_RESET(mCompressedTree);
+	PX_DELETE_AND_RESET(mWideTree);
 	PX_DELETE_AND_RESET(mAABBTree);
 
 	// Don't bother building an AABB-tree if there isn't a single static object
@@ -753,6 +999,7 @@ bool AABBPruner::fullRebuildAABBTree()
 		TB.mNbPrimitives	= nbObjects;
 		TB.mAABBArray		= mPool.getCurrentWorldBoxes();
 		TB.mLimit			= NB_OBJECTS_PER_NODE;
+		TB.mDispatcher		= mBuildDispatcher;
 		Status = mAABBTree->build(TB);
 	}
 
@@ -760,6 +1007,9 @@ bool AABBPruner::fullRebuildAABBTree()
 	if(mIncrementalRebuild)
 		mTreeMap.initMap(PxMax(nbObjects,mNbCachedBoxes),*mAABBTree);
 
+	rebuildWideTree();
+	buildCompressedTree();
+
 	return Status;
 }
 
@@ -789,6 +1039,8 @@ void AABBPruner::release() // this can be called from purge()
 	PX_FREE_AND_RESET(mCachedBoxes);
 	mBuilder.reset();
 	PX_DELETE_AND_RESET(mNewTree);
+	PX_DELETE_AND_RESET(mCompressedTree);
+	PX_DELETE_AND_RESET(mWideTree);
 	PX_DELETE_AND_RESET(mAABBTree);
 
 	mNbCachedBoxes = 0;
@@ -819,7 +1071,44 @@ void AABBPruner::refitUpdatedAndRemoved()
 		return;
 
 	mBucketPruner.refitMarkedNodes(mPool.getCurrentWorldBoxes());
-	tree->refitMarkedNodes(mPool.getCurrentWorldBoxes());
+	tree->refitMarkedNodes(mPool.getCurrentWorldBoxes(), mBuildDispatcher);
+}
+
+// Collapses the current tree into the wide tree used for queries
+void AABBPruner::rebuildWideTree()
+{
+	if(!mUseWideTree || !mAABBTree)
+		return;
+
+	PX_PROFILE_ZONE("SceneQuery.prunerRebuildWideTree", mContextID);
+
+	if(!mWideTree)
+		mWideTree = PX_NEW(WideAABBTree);
+
+	if(!mWideTree->build(*mAABBTree))
+		PX_DELETE_AND_RESET(mWideTree);	// queries fall back to the binary tree
+}
+
+// Converts the current tree into the compressed tree used for queries and releases it. The pool is sorted in the tree's
+// order first, so that the compressed leaves can reference contiguous ranges of pool objects instead of an index array.
+void AABBPruner::buildCompressedTree()
+{
+	if(!mUseCompressedTree || !mAABBTree)
+		return;
+
+	PX_PROFILE_ZONE("SceneQuery.prunerBuildCompressedTree", mContextID);
+
+	PX_ASSERT(!mCompressedTree);
+	mCompressedTree = PX_NEW(CompressedAABBTree);
+
+	if(mAABBTree->getTotalPrims()!=mPool.getNbActiveObjects() || !mCompressedTree->build(*mAABBTree) || !mPool.reorder(mAABBTree->getIndices()))
+	{
+		PX_DELETE_AND_RESET(mCompressedTree);	// queries fall back to the binary tree
+		return;
+	}
+
+	mBuildStats = mAABBTree->getBuildStats();
+	PX_DELETE_AND_RESET(mAABBTree);
 }
 
 void AABBPruner::merge(const void* mergeParams)
@@ -838,7 +1127,8 @@ void AABBPruner::merge(const void* mergeParams)
 		if (!mIncrementalRebuild)
 		{
 			// merge tree directly
-			mAABBTree->mergeTree(aabbTreeMergeParams);		
+			mAABBTree->mergeTree(aabbTreeMergeParams);
+			rebuildWideTree();
 		}
 		else
 		{
@@ -34,10 +34,14 @@
 #include "SqExtendedBucketPruner.h"
 #include "SqAABBTreeUpdateMap.h"
 #include "SqAABBTree.h"
+#include "SqWideAABBTree.h"
+#include "SqCompressedAABBTree.h"
 
 namespace physx
 {
 
+class PxCpuDispatcher;
+
 namespace Sq
 {
 	// PT: we build the new tree over a number of frames/states, in order to limit perf spikes in 'updatePruningTrees'.
@@ -69,7 +73,8 @@ namespace Sq
 	// We need to do that before doing a full refit in the next stage/frame. If we don't do that, the refit code will fetch a wrong box,
 	// that may very well belong to an entirely new object.
 	//
-	// Note that this mapping/update map (mNewTreeMap) is temporary, and only needed for the next stage.
+	// This mapping/update map (mNewTreeMap) is kept up to date until the switch, where it becomes the tree map. This way the switch
+	// doesn't need to recreate a map for the whole tree.
 	//
 	// BUILD_FULL_REFIT (1 frame, AABBPruner):
 	//
@@ -85,15 +90,24 @@ namespace Sq
 	//
 	// BUILD_FINISHED (1 frame, AABBPruner):
 	//
-	// Several things happen in this 'finalization' frame/stage:
-	// - We switch the trees (old one is deleted, cached boxes are deleted, new tree pointer is setup)
-	// - A new (final) update map is created (mTreeMap). The map is used to invalidate objects that may have been removed during
-	//   the BUILD_NEW_MAPPING and BUILD_FULL_REFIT frames. The nodes containing these removed objects are marked for refit.
-	// - Nodes containing objects that have moved during the BUILD_NEW_MAPPING and BUILD_FULL_REFIT frames are marked for refit.
+	// Several things happen in this 'finalization' frame/stage, in commit():
+	// - The new update map is used to invalidate objects that have been removed since the BUILD_NEW_MAPPING frame. The nodes
+	//   containing these removed objects are marked for refit.
+	// - Nodes containing objects that have moved since the BUILD_NEW_MAPPING frame are marked for refit.
 	// - We do a partial refit on the new tree, to take these final changes into account. This small partial refit is usually much
 	//   cheaper than the full refit we previously performed here.
+	// - We switch the trees (old one is deleted, cached boxes are deleted, new tree pointer and map are setup). The new tree is
+	//   complete before it is published, the switch itself is a pointer swap.
 	// - We remove old objects from the bucket pruner
 	//
+	// With PxScene::sceneQueriesUpdate() the build steps run in tasks, and queries keep using the current tree until the switch
+	// in PxScene::fetchQueries().
+	//
+	// With a rebuild time budget, each build step runs as many stages as the budget allows instead of one, and BUILD_IN_PROGRESS
+	// processes small slices of work units until the budget is used. BUILD_NEW_MAPPING and BUILD_FULL_REFIT cannot be sliced, they
+	// only start at the beginning of a step. A single stage or slice can still exceed the budget, e.g. splitting the root node of a
+	// large tree, this is recorded in AABBPrunerRebuildStats::mNbBudgetOverruns.
+	//
 	enum BuildStatus
 	{
 		BUILD_NOT_STARTED,
@@ -107,6 +121,31 @@ namespace Sq
 		BUILD_FORCE_DWORD	= 0xffffffff
 	};
 
+	// Counters of the progressive rebuilds, see AABBPruner::setRebuildTimeBudget()
+	struct AABBPrunerRebuildStats
+	{
+		PxU32	mNbTotalWorkUnits;	// estimated number of work units of the rebuild in progress or the last one
+		PxU32	mNbDoneWorkUnits;	// work units processed so far by this rebuild
+		PxU32	mNbSteps;			// build steps run by this rebuild
+		PxU32	mNbRebuilds;		// number of new trees switched in
+		PxU32	mNbBudgetOverruns;	// build steps that took longer than the time budget
+		PxReal	mLastStepTime;		// in seconds
+		PxReal	mMaxStepTime;		// in seconds
+
+		AABBPrunerRebuildStats()	{ PxMemZero(this, sizeof(AABBPrunerRebuildStats));	}
+	};
+
+	// Structure used for the queries of the static pruner. The dynamic pruner always uses the binary tree.
+	struct AABBPrunerLayout
+	{
+		enum Enum
+		{
+			eBINARY,		// the built binary tree
+			eWIDE,			// the built tree collapsed into a 4-wide quantized tree
+			eCOMPRESSED		// the built tree converted to a compressed tree, see CompressedAABBTree. The binary tree is then released.
+		};
+	};
+
 	// This class implements the Pruner interface for internal SQ use with some additional specialized functions
 	// The underlying data structure is a binary AABB tree
 	// AABBPruner supports insertions, removals and updates for dynamic objects
@@ -121,10 +160,14 @@ namespace Sq
 	// queries can be issued on multiple threads after commit is called
 	// commit, buildStep, add/remove/update have to be called from the same thread or otherwise strictly serialized by external code
 	// and cannot be issued while a query is running
+	// With the wide tree option (static pruner only) the built tree is also collapsed into a 4-wide quantized tree, which is
+	// then used for the queries instead of the binary tree
+	// With the compressed tree option (static pruner only) the built tree is converted to a tree with 16-bit quantized bounds,
+	// the pruning pool is sorted in the tree's order and the binary tree is released, to save memory
 	class AABBPruner : public IncrementalPruner
 	{
 		public:
-												AABBPruner(bool incrementalRebuild, PxU64 contextID); // true is equivalent to former dynamic pruner
+												AABBPruner(bool incrementalRebuild, PxU64 contextID, AABBPrunerLayout::Enum layout = AABBPrunerLayout::eBINARY, PxCpuDispatcher* buildDispatcher = NULL); // true is equivalent to former dynamic pruner
 		virtual									~AABBPruner();
 
 		// Pruner
@@ -136,12 +179,14 @@ namespace Sq
 		virtual			PxAgain					raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&)	const;
 		virtual			PxAgain					overlap(const Gu::ShapeData& queryVolume, PrunerCallback&)	const;
 		virtual			PxAgain					sweep(const Gu::ShapeData& queryVolume, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&)	const;
+		virtual			void					raycastPacket(PrunerRayPacket& packet, PrunerPacketCallback& pcb)	const;
 		virtual			const PrunerPayload&	getPayload(PrunerHandle handle)						const	{ return mPool.getPayload(handle);			}
 		virtual			const PrunerPayload&	getPayload(PrunerHandle handle, PxBounds3*& bounds)	const	{ return mPool.getPayload(handle, bounds);	}
 		virtual			void					preallocate(PxU32 entries)									{ mPool.preallocate(entries);				}
 		virtual			void					shiftOrigin(const PxVec3& shift);
 		virtual			void					visualize(Cm::RenderOutput& out, PxU32 color) const;		
 		virtual			void					merge(const void* mergeParams);		
+		virtual			const Gu::BuildStats*	getBuildStats()	const	{ return mAABBTree ? &mAABBTree->getBuildStats() : mCompressedTree ? &mBuildStats : NULL;	}
 		//~Pruner
 		
 		// IncrementalPruner
@@ -151,6 +196,14 @@ namespace Sq
 		virtual			bool					prepareBuild();	// returns true if new tree is needed
 		//~IncrementalPruner
 
+		// Limits the time of each build step, instead of spreading the rebuild over the number of steps given by the rebuild rate
+		// hint. 0 disables the budget.
+						void					setRebuildTimeBudget(PxU32 microseconds)	{ mRebuildTimeBudget = microseconds;	}
+		PX_FORCE_INLINE	PxU32					getRebuildTimeBudget()	const				{ return mRebuildTimeBudget;			}
+		PX_FORCE_INLINE	const AABBPrunerRebuildStats&	getRebuildStats()	const			{ return mRebuildStats;					}
+		// estimated number of work units left before the new tree is built, 0 if no rebuild is in progress
+						PxU32					getNbRemainingWorkUnits()	const;
+
 		// direct access for test code
 
 		PX_FORCE_INLINE	PxU32					getNbAddedObjects()	const		{ return mBucketPruner.getNbObjects();					}
@@ -158,11 +211,17 @@ namespace Sq
 		PX_FORCE_INLINE	Sq::AABBTree*			getAABBTree()					{ PX_ASSERT(!mUncommittedChanges); return mAABBTree;	}
 		PX_FORCE_INLINE	void					setAABBTree(Sq::AABBTree* tree)	{ mAABBTree = tree; }
 		PX_FORCE_INLINE	const Sq::AABBTree*		hasAABBTree()		const		{ return mAABBTree;	}
+		PX_FORCE_INLINE	const Sq::WideAABBTree*	getWideAABBTree()	const		{ return mWideTree;	}
+		PX_FORCE_INLINE	const Sq::CompressedAABBTree*	getCompressedAABBTree()	const	{ return mCompressedTree;	}
 		PX_FORCE_INLINE	BuildStatus				getBuildStatus()	const		{ return mProgress;	}
 				
 		// local functions
 //		private:
 						Sq::AABBTree*			mAABBTree; // current active tree
+		// 4-wide version of mAABBTree used for queries, only with the wide tree option. Rebuilt each time mAABBTree changes.
+						Sq::WideAABBTree*		mWideTree;
+		// Compressed version of mAABBTree used for queries, only with the compressed tree option. mAABBTree is released once it is built.
+						Sq::CompressedAABBTree*	mCompressedTree;
 						Gu::AABBTreeBuildParams	mBuilder; // this class deals with the details of the actual tree building
 						Gu::BuildStats			mBuildStats;
 
@@ -203,6 +262,12 @@ namespace Sq
 		// Term to correct the work unit estimate if the rebuild rate is not matched
 						PxI32					mAdaptiveRebuildTerm;
 
+		// Time budget of a build step in microseconds, 0 to use mRebuildRateHint instead
+						PxU32					mRebuildTimeBudget;
+		// Measured build time per work unit in seconds, used to avoid starting nodes that would exceed the budget
+						PxReal					mTimePerWorkUnit;
+						AABBPrunerRebuildStats	mRebuildStats;
+
 						PruningPool				mPool; // Pool of AABBs
 
 		// maps pruning pool indices to aabb tree indices
@@ -220,6 +285,10 @@ namespace Sq
 		// bucket pruner is only used with incremental rebuild
 						bool					mIncrementalRebuild;
 
+		// Set once in the constructor, only supported by the static pruner (mIncrementalRebuild false)
+						bool					mUseWideTree;
+						bool					mUseCompressedTree;
+
 		// A rebuild can be triggered even when the Pruner is not dirty
 		// mUncommittedChanges is set to true in add, remove, update and buildStep
 		// mUncommittedChanges is set to false in commit
@@ -254,10 +323,17 @@ namespace Sq
 
 						PxU64					mContextID;
 
+		// Optional, builds the subtrees of the full rebuilds in parallel. Also used for large refits and bounds updates.
+						PxCpuDispatcher*		mBuildDispatcher;
+
 		// Internal methods
 						bool					fullRebuildAABBTree(); // full rebuild function, used with static pruner mode
 						void					release();
 						void					refitUpdatedAndRemoved();
+						void					rebuildWideTree();
+						void					runBuildStage(PxU32 limit);
+						void					runTimedBuildStages();
+						void					buildCompressedTree();
 						void					updateBucketPruner();
 						PxBounds3				getAABB(PrunerHandle h);
 	};
@@ -30,9 +30,12 @@
 #include "SqAABBTree.h"
 #include "SqAABBTreeUpdateMap.h"
 #include "SqBounds.h"
+#include "GuParallelJobs.h"
 
 #include "PsMathUtils.h"
 #include "PsFoundation.h"
+#include "PsTime.h"
+#include "PsBitUtils.h"
 #include "GuInternal.h"
 
 using namespace physx;
@@ -50,6 +53,7 @@ public:
 
 	PX_FORCE_INLINE	PxU32				getNbEntries() const { return mStack.size(); }
 	PX_FORCE_INLINE	void				push(AABBTreeBuildNode* entry) { mStack.pushBack(entry); }
+	PX_FORCE_INLINE	AABBTreeBuildNode*	peek() const { return mStack.size() ? mStack[mCurIndex] : NULL; }
 	bool				pop(AABBTreeBuildNode*& entry);
 private:
 	Ps::Array<AABBTreeBuildNode*>	mStack;
@@ -149,6 +153,7 @@ void AABBTree::release(bool clearRefitMap)
 	PX_FREE_AND_RESET(mIndices);
 	mTotalNbNodes = 0;
 	mNbIndices = 0;
+	mBuildStats.reset();
 
 // REFIT
 	if(clearRefitMap)
@@ -205,6 +210,7 @@ void AABBTree::buildEnd(AABBTreeBuildParams& params, BuildStats& stats)
 	// Get back total number of nodes
 	mTotalNbNodes	= stats.getCount();
 	mTotalPrims		= stats.mTotalPrims;
+	mBuildStats		= stats;
 
 	mRuntimePool = PX_NEW(AABBTreeRuntimeNode)[mTotalNbNodes];
 	PX_ASSERT(mTotalNbNodes==mNodeAllocator.mTotalNbNodes);
@@ -271,8 +277,17 @@ static PxU32 incrementalBuildHierarchy(FIFOStack& stack, AABBTreeBuildNode* node
 	return node->mNbPrimitives;
 }
 
-PxU32 AABBTree::progressiveBuild(AABBTreeBuildParams& params, BuildStats& stats, PxU32 progress, PxU32 limit)
+PxU32 AABBTree::getNextBuildNodeSize() const
 {
+	const AABBTreeBuildNode* node = mStack ? mStack->peek() : NULL;
+	return node ? node->mNbPrimitives : 0;
+}
+
+PxU32 AABBTree::progressiveBuild(AABBTreeBuildParams& params, BuildStats& stats, PxU32 progress, PxU32 limit, PxU32* nbWorkUnits)
+{
+	// the build time adds up over the steps
+	Ps::Time timer;
+
 	if(progress==0)
 	{
 		if(!buildInit(params, stats))
@@ -280,6 +295,7 @@ PxU32 AABBTree::progressiveBuild(AABBTreeBuildParams& params, BuildStats& stats,
 
 		mStack = PX_NEW(FIFOStack);
 		mStack->push(mNodeAllocator.mPool);
+		stats.mBuildTime += float(timer.getElapsedSeconds());
 		return progress++;
 	}
 	else if(progress==1)
@@ -297,9 +313,13 @@ PxU32 AABBTree::progressiveBuild(AABBTreeBuildParams& params, BuildStats& stats,
 				else
 					break;
 			}
+			stats.mBuildTime += float(timer.getElapsedSeconds());
+			if(nbWorkUnits)
+				*nbWorkUnits = Total;
 			return progress;
 		}
 
+		computeAABBTreeQuality(mNodeAllocator, stats);
 		buildEnd(params, stats);
 
 		PX_DELETE_AND_RESET(mStack);
@@ -489,13 +509,128 @@ void AABBTree::markNodeForRefit(TreeNodeIndex nodeIndex)
 	}
 }
 
+namespace
+{
+	// Refits with fewer marked nodes than this are done on the calling thread
+	const PxU32 PARALLEL_REFIT_MIN_NB_MARKED_NODES = 4096;
+	// The top of the tree is opened until there are this many subtrees per thread
+	const PxU32 PARALLEL_REFIT_NB_SUBTREES_PER_THREAD = 4;
+
+	struct ParallelRefitParams
+	{
+		const PxU32*			mBits;
+		const PxBounds3*		mBoxes;
+		const PxU32*			mIndices;
+		AABBTreeRuntimeNode*	mNodeBase;
+		const PxU32*			mSubtrees;
+	};
+}
+
+static PX_FORCE_INLINE bool isMarked(const PxU32* bits, PxU32 index)
+{
+	return (bits[index>>5] & (1<<(index&31)))!=0;
+}
+
+// Refits the marked nodes of a subtree, children first. Marking a node also marks its parents, so an unmarked node
+// can be skipped along with its whole subtree.
+static void refitMarkedSubtree(const ParallelRefitParams& params, PxU32 index)
+{
+	if(!isMarked(params.mBits, index))
+		return;
+
+	AABBTreeRuntimeNode* current = params.mNodeBase + index;
+	if(!current->isLeaf())
+	{
+		const PxU32 posIndex = current->getPosIndex();
+		refitMarkedSubtree(params, posIndex);
+		refitMarkedSubtree(params, posIndex+1);
+	}
+	refitNode(current, params.mBoxes, params.mIndices, params.mNodeBase);
+}
+
+static void refitSubtreeJob(void* userData, PxU32 jobIndex)
+{
+	const ParallelRefitParams& params = *reinterpret_cast<const ParallelRefitParams*>(userData);
+	refitMarkedSubtree(params, params.mSubtrees[jobIndex]);
+}
+
+// The top of the tree is opened breadth-first on the calling thread, the marked subtrees below it are refit in parallel,
+// then the opened nodes are refit in reverse order, i.e. children first. Each node is written by a single thread, and
+// the results do not depend on the scheduling.
+static void refitMarkedNodesParallel(const PxU32* bits, const PxBounds3* boxes, const PxU32* indices, AABBTreeRuntimeNode* nodeBase, PxCpuDispatcher* dispatcher)
+{
+	const PxU32 maxNbSubtrees = getNbParallelThreads(dispatcher) * PARALLEL_REFIT_NB_SUBTREES_PER_THREAD;
+
+	Ps::Array<PxU32> topNodes;
+	Ps::Array<PxU32> subtrees;
+	Ps::Array<PxU32> nextSubtrees;
+	subtrees.pushBack(0);
+
+	bool opened = true;
+	while(opened && subtrees.size() < maxNbSubtrees)
+	{
+		opened = false;
+		nextSubtrees.clear();
+		for(PxU32 i=0;i<subtrees.size();i++)
+		{
+			const PxU32 index = subtrees[i];
+			const AABBTreeRuntimeNode* node = nodeBase + index;
+			if(node->isLeaf())
+			{
+				nextSubtrees.pushBack(index);
+				continue;
+			}
+
+			topNodes.pushBack(index);
+			const PxU32 posIndex = node->getPosIndex();
+			if(isMarked(bits, posIndex))
+				nextSubtrees.pushBack(posIndex);
+			if(isMarked(bits, posIndex+1))
+				nextSubtrees.pushBack(posIndex+1);
+			opened = true;
+		}
+		subtrees.swap(nextSubtrees);
+	}
+
+	ParallelRefitParams params;
+	params.mBits		= bits;
+	params.mBoxes		= boxes;
+	params.mIndices		= indices;
+	params.mNodeBase	= nodeBase;
+	params.mSubtrees	= subtrees.begin();
+	runParallelJobs(dispatcher, subtrees.size(), refitSubtreeJob, &params, "SceneQuery.refitSubtrees");
+
+	PxU32 nbTopNodes = topNodes.size();
+	while(nbTopNodes--)
+		refitNode(nodeBase + topNodes[nbTopNodes], boxes, indices, nodeBase);
+}
+
 #define FIRST_VERSION
 #ifdef FIRST_VERSION
-void AABBTree::refitMarkedNodes(const PxBounds3* boxes)
+void AABBTree::refitMarkedNodes(const PxBounds3* boxes, PxCpuDispatcher* dispatcher)
 {
 	if(!mRefitBitmask.getBits())
 		return;	// No refit needed
 
+	if(getNbParallelThreads(dispatcher)>1 && mRefitBitmask.isSet(0))
+	{
+		PxU32* bits = const_cast<PxU32*>(mRefitBitmask.getBits());
+		const PxU32 size = mRefitHighestSetWord+1;
+
+		PxU32 nbMarked = 0;
+		for(PxU32 i=0;i<size;i++)
+			nbMarked += Ps::bitCount(bits[i]);
+
+		if(nbMarked >= PARALLEL_REFIT_MIN_NB_MARKED_NODES)
+		{
+			refitMarkedNodesParallel(bits, boxes, mIndices, mRuntimePool, dispatcher);
+
+			PxMemZero(bits, size*sizeof(PxU32));
+			mRefitHighestSetWord = 0;
+			return;
+		}
+	}
+
 	{
 		/*const*/ PxU32* bits = const_cast<PxU32*>(mRefitBitmask.getBits());
 		PxU32 size = mRefitHighestSetWord+1;
@@ -190,7 +190,9 @@ namespace Sq
 		// Build
 						bool						build(Gu::AABBTreeBuildParams& params);
 		// Progressive building
-						PxU32						progressiveBuild(Gu::AABBTreeBuildParams& params, Gu::BuildStats& stats, PxU32 progress, PxU32 limit);
+						PxU32						progressiveBuild(Gu::AABBTreeBuildParams& params, Gu::BuildStats& stats, PxU32 progress, PxU32 limit, PxU32* nbWorkUnits=NULL);
+		// Number of primitives of the node the next progressiveBuild() call starts with, i.e. the work units it can't split
+						PxU32						getNextBuildNodeSize()	const;
 		//~Progressive building
 						void						release(bool clearRefitMap=true);
 
@@ -208,6 +210,7 @@ namespace Sq
 		PX_FORCE_INLINE	AABBTreeRuntimeNode*		getNodes()					{ return mRuntimePool;	}		
 		PX_FORCE_INLINE	void						setNodes(AABBTreeRuntimeNode* nodes) { mRuntimePool = nodes;	}		
 		PX_FORCE_INLINE	PxU32						getTotalPrims()		const	{ return mTotalPrims;	}
+		PX_FORCE_INLINE	const Gu::BuildStats&		getBuildStats()		const	{ return mBuildStats;	}
 
 #if PX_DEBUG 
 						void						validate()			const;
@@ -226,6 +229,7 @@ namespace Sq
 		// Stats
 						PxU32						mTotalNbNodes;		//!< Number of nodes in the tree.
 						PxU32						mTotalPrims;		//!< Copy of final BuildStats::mTotalPrims
+						Gu::BuildStats				mBuildStats;		//!< Copy of final BuildStats, including build time and tree quality
 
 	// Progressive building
 						FIFOStack*					mStack;
@@ -245,7 +249,8 @@ namespace Sq
 		// adds node[index] to a list of nodes to refit when refitMarkedNodes is called
 		// Note that this includes updating the hierarchy up the chain
 						void						markNodeForRefit(TreeNodeIndex nodeIndex);
-						void						refitMarkedNodes(const PxBounds3* boxes);
+		// With a dispatcher, large refits are split into subtrees refit in parallel by the dispatcher's worker threads
+						void						refitMarkedNodes(const PxBounds3* boxes, PxCpuDispatcher* dispatcher = NULL);
 		private:
 						BitArray					mRefitBitmask; //!< bit is set for each node index in markForRefit
 						PxU32						mRefitHighestSetWord;
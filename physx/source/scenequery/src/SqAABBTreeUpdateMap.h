@@ -66,6 +66,11 @@ namespace Sq
 
 						void					invalidate(PoolIndex poolIndex, PoolIndex replacementPoolIndex, Sq::AABBTree& tree);
 
+						void					swap(AABBTreeUpdateMap& other)
+												{
+													mMapping.swap(other.mMapping);
+												}
+
 		PX_FORCE_INLINE TreeNodeIndex operator[](PxU32 poolIndex) const
 												{ 
 													return poolIndex < mMapping.size() ? mMapping[poolIndex] : INVALID_NODE_ID;
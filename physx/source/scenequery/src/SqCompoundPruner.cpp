@@ -249,7 +249,7 @@ struct MainTreeRaycastCompoundPrunerCallback
 
 		// raycast the merged tree
 		return AABBTreeRaycast<tInflate, IncrementalAABBTree, IncrementalAABBTreeNode, PrunerPayload, PrunerCallback>()
-			(compoundTree.mPruningPool->getObjects(), compoundTree.mPruningPool->getCurrentWorldBoxes(), *compoundTree.mTree, localOrigin, localDir, distance, localExtent, mPrunerCallback);
+			(compoundTree.mPruningPool->getObjects(), compoundTree.mPruningPool->getCurrentWorldBoxes(), *compoundTree.mTree, localOrigin, localDir, distance, localExtent, mPrunerCallback, mPrunerCallback.mTraversalStats);
 	}
 
 	PX_NOCOPY(MainTreeRaycastCompoundPrunerCallback)
@@ -276,7 +276,7 @@ PxAgain BVHCompoundPruner::raycast(const PxVec3& origin, const PxVec3& unitDir,
 		MainTreeRaycastCompoundPrunerCallback<false> pcb(origin, unitDir, extent, prunerCallback, flags);
 		// traverse the main tree
 		again = AABBTreeRaycast<false, IncrementalAABBTree, IncrementalAABBTreeNode, CompoundTree, MainTreeRaycastCompoundPrunerCallback<false> >()
-			(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, origin, unitDir, inOutDistance, extent, pcb);
+			(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, origin, unitDir, inOutDistance, extent, pcb, prunerCallback.mTraversalStats);
 	}
 
 	return again;
@@ -319,7 +319,7 @@ struct MainTreeOBBOverlapCompoundPrunerCallback: public MainTreeOverlapCompoundP
 		const Gu::OBBAABBTest localTest(localPos, localRot, mQueryVolume.getPrunerBoxGeomExtentsInflated());		
 		// overlap the compound local tree
 		return AABBTreeOverlap<Gu::OBBAABBTest, IncrementalAABBTree, IncrementalAABBTreeNode, PrunerPayload, PrunerCallback>()
-			(compoundTree.mPruningPool->getObjects(), compoundTree.mPruningPool->getCurrentWorldBoxes(), *compoundTree.mTree, localTest, mPrunerCallback);
+			(compoundTree.mPruningPool->getObjects(), compoundTree.mPruningPool->getCurrentWorldBoxes(), *compoundTree.mTree, localTest, mPrunerCallback, mPrunerCallback.mTraversalStats);
 	}
 
 	PX_NOCOPY(MainTreeOBBOverlapCompoundPrunerCallback)
@@ -345,7 +345,7 @@ struct MainTreeAABBOverlapCompoundPrunerCallback: public MainTreeOverlapCompound
 		const Gu::OBBAABBTest localTest(localPos, localRot, mQueryVolume.getPrunerBoxGeomExtentsInflated());		
 		// overlap the compound local tree
 		return AABBTreeOverlap<Gu::OBBAABBTest, IncrementalAABBTree, IncrementalAABBTreeNode, PrunerPayload, PrunerCallback>()
-			(compoundTree.mPruningPool->getObjects(), compoundTree.mPruningPool->getCurrentWorldBoxes(), *compoundTree.mTree, localTest, mPrunerCallback);
+			(compoundTree.mPruningPool->getObjects(), compoundTree.mPruningPool->getCurrentWorldBoxes(), *compoundTree.mTree, localTest, mPrunerCallback, mPrunerCallback.mTraversalStats);
 	}
 
 	PX_NOCOPY(MainTreeAABBOverlapCompoundPrunerCallback)
@@ -371,7 +371,7 @@ struct MainTreeCapsuleOverlapCompoundPrunerCallback: public MainTreeOverlapCompo
 
 		// overlap the compound local tree
 		return AABBTreeOverlap<Gu::CapsuleAABBTest, IncrementalAABBTree, IncrementalAABBTreeNode, PrunerPayload, PrunerCallback>()
-			(compoundTree.mPruningPool->getObjects(), compoundTree.mPruningPool->getCurrentWorldBoxes(), *compoundTree.mTree, localTest, mPrunerCallback);
+			(compoundTree.mPruningPool->getObjects(), compoundTree.mPruningPool->getCurrentWorldBoxes(), *compoundTree.mTree, localTest, mPrunerCallback, mPrunerCallback.mTraversalStats);
 	}
 
 	PX_NOCOPY(MainTreeCapsuleOverlapCompoundPrunerCallback)
@@ -393,7 +393,7 @@ struct MainTreeSphereOverlapCompoundPrunerCallback: public MainTreeOverlapCompou
 
 		// overlap the compound local tree
 		return AABBTreeOverlap<Gu::SphereAABBTest, IncrementalAABBTree, IncrementalAABBTreeNode, PrunerPayload, PrunerCallback>()
-			(compoundTree.mPruningPool->getObjects(), compoundTree.mPruningPool->getCurrentWorldBoxes(), *compoundTree.mTree, localTest, mPrunerCallback);
+			(compoundTree.mPruningPool->getObjects(), compoundTree.mPruningPool->getCurrentWorldBoxes(), *compoundTree.mTree, localTest, mPrunerCallback, mPrunerCallback.mTraversalStats);
 	}
 
 	PX_NOCOPY(MainTreeSphereOverlapCompoundPrunerCallback)
@@ -417,14 +417,14 @@ PxAgain BVHCompoundPruner::overlap(const Gu::ShapeData& queryVolume, PrunerCallb
 				const Gu::OBBAABBTest test(queryVolume.getPrunerWorldPos(), queryVolume.getPrunerWorldRot33(), queryVolume.getPrunerBoxGeomExtentsInflated());
 				MainTreeOBBOverlapCompoundPrunerCallback pcb(queryVolume, prunerCallback, flags);
 				again = AABBTreeOverlap<Gu::OBBAABBTest, IncrementalAABBTree, IncrementalAABBTreeNode, CompoundTree, MainTreeOBBOverlapCompoundPrunerCallback>()
-					(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, test, pcb);
+					(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, test, pcb, prunerCallback.mTraversalStats);
 			}
 			else
 			{
 				const Gu::AABBAABBTest test(queryVolume.getPrunerInflatedWorldAABB());
 				MainTreeAABBOverlapCompoundPrunerCallback pcb(queryVolume, prunerCallback, flags);
 				again = AABBTreeOverlap<Gu::AABBAABBTest, IncrementalAABBTree, IncrementalAABBTreeNode, CompoundTree, MainTreeAABBOverlapCompoundPrunerCallback>()
-					(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, test, pcb);				
+					(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, test, pcb, prunerCallback.mTraversalStats);				
 			}
 		}
 		break;
@@ -435,7 +435,7 @@ PxAgain BVHCompoundPruner::overlap(const Gu::ShapeData& queryVolume, PrunerCallb
 				queryVolume.getCapsuleHalfHeight()*2.0f, PxVec3(capsule.radius*SQ_PRUNER_INFLATION));
 			MainTreeCapsuleOverlapCompoundPrunerCallback pcb(queryVolume, prunerCallback, flags);			
 			again = AABBTreeOverlap<Gu::CapsuleAABBTest, IncrementalAABBTree, IncrementalAABBTreeNode, CompoundTree, MainTreeCapsuleOverlapCompoundPrunerCallback >()
-				(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, test, pcb);				
+				(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, test, pcb, prunerCallback.mTraversalStats);				
 		}
 		break;
 		case PxGeometryType::eSPHERE:
@@ -444,7 +444,7 @@ PxAgain BVHCompoundPruner::overlap(const Gu::ShapeData& queryVolume, PrunerCallb
 			Gu::SphereAABBTest test(sphere.center, sphere.radius);
 			MainTreeSphereOverlapCompoundPrunerCallback pcb(queryVolume, prunerCallback, flags);
 			again = AABBTreeOverlap<Gu::SphereAABBTest, IncrementalAABBTree, IncrementalAABBTreeNode, CompoundTree, MainTreeSphereOverlapCompoundPrunerCallback>()
-				(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, test, pcb);				
+				(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, test, pcb, prunerCallback.mTraversalStats);				
 		}
 		break;
 		case PxGeometryType::eCONVEXMESH:
@@ -452,7 +452,7 @@ PxAgain BVHCompoundPruner::overlap(const Gu::ShapeData& queryVolume, PrunerCallb
 			const Gu::OBBAABBTest test(queryVolume.getPrunerWorldPos(), queryVolume.getPrunerWorldRot33(), queryVolume.getPrunerBoxGeomExtentsInflated());
 			MainTreeOBBOverlapCompoundPrunerCallback pcb(queryVolume, prunerCallback, flags);			
 			again = AABBTreeOverlap<Gu::OBBAABBTest, IncrementalAABBTree, IncrementalAABBTreeNode, CompoundTree, MainTreeOBBOverlapCompoundPrunerCallback>()
-				(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, test, pcb);				
+				(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, test, pcb, prunerCallback.mTraversalStats);				
 		}
 		break;
 		case PxGeometryType::ePLANE:
@@ -480,7 +480,7 @@ PxAgain BVHCompoundPruner::sweep(const Gu::ShapeData& queryVolume, const PxVec3&
 		const PxVec3 center = aabb.getCenter();
 		MainTreeRaycastCompoundPrunerCallback<true> pcb(center, unitDir, extents, prunerCallback, flags);
 		again = AABBTreeRaycast<true, IncrementalAABBTree, IncrementalAABBTreeNode, CompoundTree, MainTreeRaycastCompoundPrunerCallback<true> >()
-			(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, center, unitDir, inOutDistance, extents, pcb);
+			(mCompoundTreePool.getCompoundTrees(), mCompoundTreePool.getCurrentCompoundBounds(), mMainTree, center, unitDir, inOutDistance, extents, pcb, prunerCallback.mTraversalStats);
 	}
 	return again;
 }
@@ -0,0 +1,178 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "foundation/PxMath.h"
+#include "SqCompressedAABBTree.h"
+#include "SqAABBTree.h"
+#include "PsArray.h"
+
+using namespace physx;
+using namespace Sq;
+
+CompressedAABBTree::CompressedAABBTree() :
+	mNodes		(NULL),
+	mNbNodes	(0),
+	mRootData	(0xffffffff)
+{
+	mRootBounds.setEmpty();
+}
+
+CompressedAABBTree::~CompressedAABBTree()
+{
+	release();
+}
+
+void CompressedAABBTree::release()
+{
+	PX_FREE_AND_RESET(mNodes);
+	mNbNodes = 0;
+	mRootData = 0xffffffff;
+	mRootBounds.setEmpty();
+}
+
+// PT: the quantized bounds must always enclose the source bounds. We round outwards, then fix the results
+// with the same math as the dequantization code, to catch the cases where the float rounding goes the wrong way.
+static PX_FORCE_INLINE PxU16 quantizeMin(PxReal value, PxReal origin, PxReal scale)
+{
+	if(scale==0.0f)
+		return 0;
+
+	PxI32 q = PxI32(PxFloor((value - origin)/scale));
+	q = PxClamp(q, 0, PxI32(CompressedAABBTreeNode::eQUANTIZATION));
+	while(q>0 && PxF32(q)*scale + origin > value)
+		q--;
+	return PxU16(q);
+}
+
+static PX_FORCE_INLINE PxU16 quantizeMax(PxReal value, PxReal origin, PxReal scale)
+{
+	if(scale==0.0f)
+		return 0;
+
+	PxI32 q = PxI32(PxCeil((value - origin)/scale));
+	q = PxClamp(q, 0, PxI32(CompressedAABBTreeNode::eQUANTIZATION));
+	while(q<PxI32(CompressedAABBTreeNode::eQUANTIZATION) && PxF32(q)*scale + origin < value)
+		q++;
+	return PxU16(q);
+}
+
+namespace
+{
+	// (binary node index, compressed node index) of a node left to convert, and its decoded bounds
+	struct BuildEntry
+	{
+		PxU32		mBinaryIndex;
+		PxU32		mCompressedIndex;
+		PxBounds3	mDecoded;
+	};
+}
+
+bool CompressedAABBTree::build(const AABBTree& tree)
+{
+	release();
+
+	const AABBTreeRuntimeNode* nodes = tree.getNodes();
+	const PxU32 nbBinaryNodes = tree.getNbNodes();
+	if(!nodes || !nbBinaryNodes)
+		return false;
+
+	mRootBounds = nodes[0].mBV;
+
+	if(nodes[0].isLeaf())
+	{
+		mRootData = nodes[0].mData;
+		return true;
+	}
+
+	// Each compressed node holds the two children of a binary internal node, i.e. there is one per internal node
+	const PxU32 nbInternalNodes = nbBinaryNodes/2;
+	mNodes = reinterpret_cast<CompressedAABBTreeNode*>(PX_ALLOC(sizeof(CompressedAABBTreeNode)*nbInternalNodes, "CompressedAABBTreeNode"));
+	if(!mNodes)
+		return false;
+
+	mRootData = 0;
+	mNbNodes = 1;
+
+	Ps::Array<BuildEntry> stack;
+	BuildEntry root;
+	root.mBinaryIndex = 0;
+	root.mCompressedIndex = 0;
+	root.mDecoded = mRootBounds;
+	stack.pushBack(root);
+
+	while(stack.size())
+	{
+		const BuildEntry entry = stack.popBack();
+		const AABBTreeRuntimeNode& binaryNode = nodes[entry.mBinaryIndex];
+		PX_ASSERT(!binaryNode.isLeaf());
+
+		CompressedAABBTreeFrame frame;
+		frame.init(entry.mDecoded.minimum, entry.mDecoded.maximum);
+
+		PX_ALIGN(16, PxReal origin[4]);
+		PX_ALIGN(16, PxReal scale[4]);
+		V4StoreA(frame.mOrigin, origin);
+		V4StoreA(frame.mScale, scale);
+
+		CompressedAABBTreeNode& node = mNodes[entry.mCompressedIndex];
+		for(PxU32 i=0;i<2;i++)
+		{
+			const PxU32 childIndex = i ? binaryNode.getNegIndex() : binaryNode.getPosIndex();
+			const AABBTreeRuntimeNode& child = nodes[childIndex];
+			const PxBounds3& bounds = child.mBV;
+			for(PxU32 j=0;j<3;j++)
+			{
+				node.mMin[i][j] = quantizeMin(bounds.minimum[j], origin[j], scale[j]);
+				node.mMax[i][j] = quantizeMax(bounds.maximum[j], origin[j], scale[j]);
+			}
+
+			if(child.isLeaf())
+			{
+				node.mData[i] = child.mData;
+				continue;
+			}
+
+			PX_ASSERT(mNbNodes<nbInternalNodes);
+			const PxU32 compressedIndex = mNbNodes++;
+			node.mData[i] = compressedIndex<<1;
+
+			// PT: the children of this child are quantized in its decoded bounds, exactly as the queries will see them
+			Vec4V minV, maxV;
+			frame.dequantize(node.mMin[i], node.mMax[i], minV, maxV);
+
+			BuildEntry childEntry;
+			childEntry.mBinaryIndex = childIndex;
+			childEntry.mCompressedIndex = compressedIndex;
+			V3StoreU(Vec3V_From_Vec4V(minV), childEntry.mDecoded.minimum);
+			V3StoreU(Vec3V_From_Vec4V(maxV), childEntry.mDecoded.maximum);
+			stack.pushBack(childEntry);
+		}
+	}
+	return true;
+}
@@ -0,0 +1,126 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef SQ_COMPRESSED_AABBTREE_H
+#define SQ_COMPRESSED_AABBTREE_H
+
+#include "foundation/PxBounds3.h"
+#include "PsUserAllocated.h"
+#include "PsVecMath.h"
+#include "SqTypedef.h"
+
+namespace physx
+{
+using namespace shdfnd::aos;
+
+namespace Sq
+{
+	class AABBTree;
+
+	//! Compressed binary AABB tree node. The bounds of both children are quantized to 16 bits relative to the node's own
+	//! bounds, which are themselves decoded from the parent node. So the nodes don't store any float and fit in 32 bytes,
+	//! for two children.
+	class CompressedAABBTreeNode
+	{
+		public:
+		enum
+		{
+			eQUANTIZATION	= 65535
+		};
+
+		PX_FORCE_INLINE	static PxU32	isLeaf(PxU32 data)					{ return data&1;			}
+		PX_FORCE_INLINE	static PxU32	getChildIndex(PxU32 data)			{ return data>>1;			}
+
+		// Same encoding as AABBTreeRuntimeNode::mData for leaves, except that the primitives are a range of the pruning pool
+		PX_FORCE_INLINE	static PxU32	getNbPrimitives(PxU32 data)			{ return (data>>1)&15;		}
+		PX_FORCE_INLINE	static PxU32	getFirstPrimitive(PxU32 data)		{ return data>>5;			}
+
+						PxU16			mMin[2][3];	// Quantized child bounds, dequantized as origin + q * scale, see CompressedAABBTreeFrame
+						PxU16			mMax[2][3];
+						PxU32			mData[2];	// 31 bits node index|1 bit leaf, or leaf data
+	};
+
+	PX_COMPILE_TIME_ASSERT(sizeof(CompressedAABBTreeNode)==32);
+
+	//! Decoded bounds of a node, i.e. the frame in which its children's bounds are quantized
+	struct CompressedAABBTreeFrame
+	{
+		Vec4V	mOrigin;	// minimum of the decoded bounds
+		Vec4V	mScale;		// size of a quantization step on each axis
+
+		// PT: the scale is slightly enlarged so that the last quantized value always reaches the maximum, despite the float rounding
+		PX_FORCE_INLINE	void	init(const Vec4V minV, const Vec4V maxV)
+		{
+			mOrigin = minV;
+			mScale = V4Scale(V4Sub(maxV, minV), FLoad((1.0f + 1.0f/4096.0f)/PxReal(CompressedAABBTreeNode::eQUANTIZATION)));
+		}
+
+		PX_FORCE_INLINE	void	init(const PxVec3& minimum, const PxVec3& maximum)
+		{
+			init(V4LoadXYZW(minimum.x, minimum.y, minimum.z, 0.0f), V4LoadXYZW(maximum.x, maximum.y, maximum.z, 0.0f));
+		}
+
+		PX_FORCE_INLINE	void	dequantize(const PxU16* qMin, const PxU16* qMax, Vec4V& minV, Vec4V& maxV)	const
+		{
+			minV = V4MulAdd(V4LoadXYZW(PxF32(qMin[0]), PxF32(qMin[1]), PxF32(qMin[2]), 0.0f), mScale, mOrigin);
+			maxV = V4MulAdd(V4LoadXYZW(PxF32(qMax[0]), PxF32(qMax[1]), PxF32(qMax[2]), 0.0f), mScale, mOrigin);
+		}
+	};
+
+	//! Compressed binary AABB tree, converted from a built AABBTree. The tree doesn't store primitive indices: the leaves
+	//! reference ranges of the pruning pool, which must be sorted in the order of the source tree's indices, see
+	//! PruningPool::reorder(). The tree cannot be refit, it has to be rebuilt whenever the objects change.
+	class CompressedAABBTree : public Ps::UserAllocated
+	{
+		public:
+													CompressedAABBTree();
+													~CompressedAABBTree();
+
+							bool					build(const AABBTree& tree);
+							void					release();
+
+		PX_FORCE_INLINE	const CompressedAABBTreeNode*	getNodes()		const	{ return mNodes;		}
+		PX_FORCE_INLINE	PxU32						getNbNodes()		const	{ return mNbNodes;		}
+		// Data of the root, i.e. either the root node or a leaf if the source tree has a single leaf. 0xffffffff for empty trees.
+		PX_FORCE_INLINE	PxU32						getRootData()		const	{ return mRootData;		}
+		// The root bounds are the only ones stored in full precision
+		PX_FORCE_INLINE	const PxBounds3&			getRootBounds()		const	{ return mRootBounds;	}
+		PX_FORCE_INLINE	PxU32						getUsedBytes()		const	{ return sizeof(CompressedAABBTree) + mNbNodes*sizeof(CompressedAABBTreeNode);	}
+		private:
+							CompressedAABBTreeNode*	mNodes;			//!< Linear pool of nodes
+							PxU32					mNbNodes;
+							PxU32					mRootData;
+							PxBounds3				mRootBounds;
+	};
+
+} // namespace Sq
+
+}
+
+#endif // SQ_COMPRESSED_AABBTREE_H
@@ -0,0 +1,254 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef SQ_COMPRESSED_AABBTREE_QUERY_H
+#define SQ_COMPRESSED_AABBTREE_QUERY_H
+
+#include "SqCompressedAABBTree.h"
+#include "GuAABBTreeQuery.h"
+#include "PsInlineArray.h"
+
+namespace physx
+{
+namespace Sq
+{
+	// PT: traversal stack entry. The node's decoded bounds are needed to decode its children.
+	struct CompressedAABBTreeStackEntry
+	{
+		PxVec3	mMin;
+		PxU32	mData;
+		PxVec3	mMax;
+	};
+
+	PX_FORCE_INLINE void pushCompressedAABBTreeEntry(CompressedAABBTreeStackEntry& entry, PxU32 data, const Vec4V minV, const Vec4V maxV)
+	{
+		V3StoreU(Vec3V_From_Vec4V(minV), entry.mMin);
+		V3StoreU(Vec3V_From_Vec4V(maxV), entry.mMax);
+		entry.mData = data;
+	}
+
+	//////////////////////////////////////////////////////////////////////////
+
+	// PT: the primitives of a leaf are a range of the pruning pool, so their bounds are read sequentially
+	template<typename Test, typename Payload, typename QueryCallback>
+	class CompressedAABBTreeOverlap
+	{
+	public:
+		bool operator()(const Payload* objects, const PxBounds3* boxes, const CompressedAABBTree& tree, const Test& test, QueryCallback& visitor, Gu::TraversalStats* stats = NULL)
+		{
+			const PxU32 rootData = tree.getRootData();
+			if(rootData==0xffffffff)
+				return true;
+
+			Gu::TraversalCounter counter(stats);
+			counter.mNbVisitedNodes++;
+
+			const PxBounds3& rootBounds = tree.getRootBounds();
+			if(!test(V3LoadU(rootBounds.getCenter()), V3LoadU(rootBounds.getExtents())))
+				return true;
+
+			Ps::InlineArray<CompressedAABBTreeStackEntry, RAW_TRAVERSAL_STACK_SIZE> stack;
+			stack.forceSize_Unsafe(RAW_TRAVERSAL_STACK_SIZE);
+			stack[0].mMin = rootBounds.minimum;
+			stack[0].mMax = rootBounds.maximum;
+			stack[0].mData = rootData;
+			PxU32 stackIndex = 1;
+
+			const CompressedAABBTreeNode* const nodeBase = tree.getNodes();
+			const FloatV halfV = FLoad(0.5f);
+
+			while(stackIndex > 0)
+			{
+				const CompressedAABBTreeStackEntry entry = stack[--stackIndex];
+				const PxU32 data = entry.mData;
+
+				if(CompressedAABBTreeNode::isLeaf(data))
+				{
+					// PT: same as the binary traversal, single primitives are covered by the leaf test
+					PxU32 nbPrims = CompressedAABBTreeNode::getNbPrimitives(data);
+					counter.mNbLeafTests += nbPrims;
+					const bool doBoxTest = nbPrims > 1;
+					PxU32 poolIndex = CompressedAABBTreeNode::getFirstPrimitive(data);
+					while(nbPrims--)
+					{
+						if(doBoxTest)
+						{
+							Vec4V center2, extents2;
+							Gu::getBoundsTimesTwo(center2, extents2, boxes, poolIndex);
+							if(!test(Vec3V_From_Vec4V(V4Scale(center2, halfV)), Vec3V_From_Vec4V(V4Scale(extents2, halfV))))
+							{
+								poolIndex++;
+								continue;
+							}
+						}
+
+						PxReal unusedDistance;
+						if(!visitor.invoke(unusedDistance, objects[poolIndex++]))
+							return false;
+					}
+					continue;
+				}
+
+				CompressedAABBTreeFrame frame;
+				frame.init(entry.mMin, entry.mMax);
+
+				const CompressedAABBTreeNode& node = nodeBase[CompressedAABBTreeNode::getChildIndex(data)];
+				counter.mNbVisitedNodes += 2;
+
+				if(stackIndex + 2 > stack.capacity())
+					stack.resizeUninitialized(stack.capacity() * 2);
+
+				// PT: pushed in reverse order so that the children are visited in order
+				for(PxU32 i=2;i--;)
+				{
+					Vec4V minV, maxV;
+					frame.dequantize(node.mMin[i], node.mMax[i], minV, maxV);
+					if(test(Vec3V_From_Vec4V(V4Scale(V4Add(maxV, minV), halfV)), Vec3V_From_Vec4V(V4Scale(V4Sub(maxV, minV), halfV))))
+						pushCompressedAABBTreeEntry(stack[stackIndex++], node.mData[i], minV, maxV);
+				}
+			}
+			return true;
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template <bool tInflate, typename Payload, typename QueryCallback> // use inflate=true for sweeps, inflate=false for raycasts
+	class CompressedAABBTreeRaycast
+	{
+	public:
+		bool operator()(
+			const Payload* objects, const PxBounds3* boxes, const CompressedAABBTree& tree,
+			const PxVec3& origin, const PxVec3& unitDir, PxReal& maxDist, const PxVec3& inflation,
+			QueryCallback& pcb, Gu::TraversalStats* stats = NULL)
+		{
+			const PxU32 rootData = tree.getRootData();
+			if(rootData==0xffffffff)
+				return true;
+
+			Gu::TraversalCounter counter(stats);
+			counter.mNbVisitedNodes++;
+
+			// PT: same as the binary traversal, the boxes are tested with center*2 and extents*2
+			Gu::RayAABBTest test(origin*2.0f, unitDir*2.0f, maxDist, inflation*2.0f);
+
+			const PxBounds3& rootBounds = tree.getRootBounds();
+			if(!test.check<tInflate>(V3LoadU(rootBounds.getCenter()*2.0f), V3LoadU(rootBounds.getExtents()*2.0f)))
+				return true;
+
+			Ps::InlineArray<CompressedAABBTreeStackEntry, RAW_TRAVERSAL_STACK_SIZE> stack;
+			stack.forceSize_Unsafe(RAW_TRAVERSAL_STACK_SIZE);
+			stack[0].mMin = rootBounds.minimum;
+			stack[0].mMax = rootBounds.maximum;
+			stack[0].mData = rootData;
+			PxU32 stackIndex = 1;
+
+			const CompressedAABBTreeNode* const nodeBase = tree.getNodes();
+
+			while(stackIndex > 0)
+			{
+				const CompressedAABBTreeStackEntry entry = stack[--stackIndex];
+				const PxU32 data = entry.mData;
+
+				if(CompressedAABBTreeNode::isLeaf(data))
+				{
+					PxU32 nbPrims = CompressedAABBTreeNode::getNbPrimitives(data);
+					counter.mNbLeafTests += nbPrims;
+					const bool doBoxTest = nbPrims > 1;
+					PxU32 poolIndex = CompressedAABBTreeNode::getFirstPrimitive(data);
+					for(; nbPrims--; poolIndex++)
+					{
+						if(doBoxTest)
+						{
+							Vec4V center2, extents2;
+							Gu::getBoundsTimesTwo(center2, extents2, boxes, poolIndex);
+							if(!test.check<tInflate>(Vec3V_From_Vec4V(center2), Vec3V_From_Vec4V(extents2)))
+								continue;
+						}
+
+						const PxReal oldMaxDist = maxDist;
+						PxReal md = maxDist;
+						if(!pcb.invoke(md, objects[poolIndex]))
+							return false;
+
+						if(md < oldMaxDist)
+						{
+							maxDist = md;
+							test.setDistance(md);
+						}
+					}
+					continue;
+				}
+
+				CompressedAABBTreeFrame frame;
+				frame.init(entry.mMin, entry.mMax);
+
+				const CompressedAABBTreeNode& node = nodeBase[CompressedAABBTreeNode::getChildIndex(data)];
+				counter.mNbVisitedNodes += 2;
+
+				Vec4V min0, max0, min1, max1;
+				frame.dequantize(node.mMin[0], node.mMax[0], min0, max0);
+				frame.dequantize(node.mMin[1], node.mMax[1], min1, max1);
+
+				const Vec4V c0 = V4Add(max0, min0);
+				const Vec4V c1 = V4Add(max1, min1);
+				const PxU32 b0 = test.check<tInflate>(Vec3V_From_Vec4V(c0), Vec3V_From_Vec4V(V4Sub(max0, min0)));
+				const PxU32 b1 = test.check<tInflate>(Vec3V_From_Vec4V(c1), Vec3V_From_Vec4V(V4Sub(max1, min1)));
+
+				if(stackIndex + 2 > stack.capacity())
+					stack.resizeUninitialized(stack.capacity() * 2);
+
+				if(b0 && b1)
+				{
+					// PT: push the one with the further center first, so that the closest one is visited first
+					// & 1 because FAllGrtr behavior differs across platforms
+					const PxU32 bit = FAllGrtr(V3Dot(Vec3V_From_Vec4V(V4Sub(c1, c0)), test.mDir), FZero()) & 1;
+					if(bit)
+					{
+						pushCompressedAABBTreeEntry(stack[stackIndex++], node.mData[1], min1, max1);
+						pushCompressedAABBTreeEntry(stack[stackIndex++], node.mData[0], min0, max0);
+					}
+					else
+					{
+						pushCompressedAABBTreeEntry(stack[stackIndex++], node.mData[0], min0, max0);
+						pushCompressedAABBTreeEntry(stack[stackIndex++], node.mData[1], min1, max1);
+					}
+				}
+				else if(b0)
+					pushCompressedAABBTreeEntry(stack[stackIndex++], node.mData[0], min0, max0);
+				else if(b1)
+					pushCompressedAABBTreeEntry(stack[stackIndex++], node.mData[1], min1, max1);
+			}
+			return true;
+		}
+	};
+}
+}
+
+#endif   // SQ_COMPRESSED_AABBTREE_QUERY_H
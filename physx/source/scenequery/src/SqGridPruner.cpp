@@ -0,0 +1,780 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "common/PxProfileZone.h"
+#include "SqGridPruner.h"
+#include "PsVecMath.h"
+
+namespace physx
+{
+	using namespace shdfnd::aos;
+}
+
+#include "GuAABBTreeQuery.h"
+#include "GuSphere.h"
+#include "GuBox.h"
+#include "GuCapsule.h"
+#include "GuBounds.h"
+#include "CmRenderOutput.h"
+
+using namespace physx;
+using namespace Gu;
+using namespace Sq;
+using namespace Cm;
+
+namespace
+{
+	const PxU32 INVALID_ID = 0xffffffff;
+
+	// PT: index of the "cell" containing the objects that are too large (or too far away) for the grid
+	const PxU32 LARGE_OBJECTS_CELL = 0;
+
+	// PT: objects whose largest half-extent is below this fraction of the cell size are stored in the grid. Keeping it below 1
+	// leaves some room for the rounding errors of the ray walk, which then never needs to look further than the neighbor cells.
+	const PxReal GRID_LOOSENESS = 0.9f;
+
+	// PT: cell coordinates are packed in 21 bits per axis to form the hash keys
+	const PxI32 COORD_BIAS = 1<<20;
+	const PxI32 COORD_LIMIT = COORD_BIAS - 1;
+
+	// PT: used when automatic cell size is requested but all objects are points
+	const PxReal FALLBACK_CELL_SIZE = 1.0f;
+}
+
+static PX_FORCE_INLINE PxU64 getCellKey(const PxI32* coords)
+{
+	return	(PxU64(PxU32(coords[0] + COORD_BIAS))<<42)
+		|	(PxU64(PxU32(coords[1] + COORD_BIAS))<<21)
+		|	 PxU64(PxU32(coords[2] + COORD_BIAS));
+}
+
+// PT: coordinates of the cell containing 'x', clamped to the [lo, hi] range. The float comparisons also take care of NaNs and infinities.
+static PX_FORCE_INLINE PxI32 getClampedCoord(PxReal x, PxI32 lo, PxI32 hi)
+{
+	const PxReal f = PxFloor(x);
+	if(!(f > PxReal(lo)))
+		return lo;
+	if(!(f < PxReal(hi)))
+		return hi;
+	return PxI32(f);
+}
+
+GridPruner::GridPruner(PxU64 contextID, PxReal cellSize) :
+	mObjects			(PX_DEBUG_EXP("GridPruner::mObjects")),
+	mCells				(PX_DEBUG_EXP("GridPruner::mCells")),
+	mFirstFreeCell		(INVALID_ID),
+	mCellSize			(cellSize>0.0f ? cellSize : 0.0f),
+	mInvCellSize		(cellSize>0.0f ? 1.0f/cellSize : 0.0f),
+	mContextID			(contextID),
+	mAutomaticCellSize	(!(cellSize>0.0f)),
+	mOccupiedBoundsDirty(false)
+{
+	rehash();
+}
+
+GridPruner::~GridPruner()
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void GridPruner::computeCoords(const PxBounds3& bounds, PxI32* coords, bool& isLarge) const
+{
+	isLarge = true;
+
+	// PT: in automatic mode the cell size is not known until the first commit, all objects are "large" until then
+	if(mCellSize==0.0f)
+		return;
+
+	const PxVec3 extents = bounds.getExtents();
+	if(!(extents.maxElement() <= mCellSize*GRID_LOOSENESS))
+		return;
+
+	const PxVec3 center = bounds.getCenter() * mInvCellSize;
+	for(PxU32 i=0;i<3;i++)
+	{
+		const PxReal f = PxFloor(center[i]);
+		if(!(f >= -PxReal(COORD_LIMIT) && f <= PxReal(COORD_LIMIT)))
+			return;
+		coords[i] = PxI32(f);
+	}
+	isLarge = false;
+}
+
+void GridPruner::growOccupiedBounds(const PxI32* coords)
+{
+	for(PxU32 i=0;i<3;i++)
+	{
+		mOccupiedMin[i] = PxMin(mOccupiedMin[i], coords[i]);
+		mOccupiedMax[i] = PxMax(mOccupiedMax[i], coords[i]);
+	}
+}
+
+void GridPruner::computeOccupiedBounds()
+{
+	for(PxU32 i=0;i<3;i++)
+	{
+		mOccupiedMin[i] = COORD_LIMIT;
+		mOccupiedMax[i] = -COORD_LIMIT;
+	}
+
+	const PxU32 nbCells = mCells.size();
+	for(PxU32 i=LARGE_OBJECTS_CELL+1;i<nbCells;i++)
+	{
+		if(mCells[i].mNbObjects)
+			growOccupiedBounds(mCells[i].mCoords);
+	}
+	mOccupiedBoundsDirty = false;
+}
+
+PxU32 GridPruner::findOrCreateCell(const PxI32* coords)
+{
+	const PxU64 key = getCellKey(coords);
+	const CellMap::Entry* entry = mCellMap.find(key);
+	if(entry)
+		return entry->second;
+
+	PxU32 cellIndex;
+	if(mFirstFreeCell!=INVALID_ID)
+	{
+		cellIndex = mFirstFreeCell;
+		mFirstFreeCell = mCells[cellIndex].mFirst;
+	}
+	else
+	{
+		cellIndex = mCells.size();
+		mCells.insert();
+	}
+
+	GridCell& cell = mCells[cellIndex];
+	cell.mCoords[0] = coords[0];
+	cell.mCoords[1] = coords[1];
+	cell.mCoords[2] = coords[2];
+	cell.mFirst = INVALID_ID;
+	cell.mNbObjects = 0;
+
+	mCellMap.insert(key, cellIndex);
+	growOccupiedBounds(coords);
+	return cellIndex;
+}
+
+void GridPruner::releaseCell(PxU32 cellIndex)
+{
+	PX_ASSERT(cellIndex!=LARGE_OBJECTS_CELL);
+	GridCell& cell = mCells[cellIndex];
+	PX_ASSERT(!cell.mNbObjects);
+
+	mCellMap.erase(getCellKey(cell.mCoords));
+	cell.mFirst = mFirstFreeCell;
+	mFirstFreeCell = cellIndex;
+
+	// PT: the occupied range stays conservative, it is tightened in the next commit
+	mOccupiedBoundsDirty = true;
+}
+
+void GridPruner::insertObject(PoolIndex poolIndex)
+{
+	PxI32 coords[3];
+	bool isLarge;
+	computeCoords(mPool.getCurrentWorldBoxes()[poolIndex], coords, isLarge);
+
+	const PxU32 cellIndex = isLarge ? LARGE_OBJECTS_CELL : findOrCreateCell(coords);
+	GridCell& cell = mCells[cellIndex];
+
+	GridObject& object = mObjects[poolIndex];
+	object.mCell = cellIndex;
+	object.mPrev = INVALID_ID;
+	object.mNext = cell.mFirst;
+	if(cell.mFirst!=INVALID_ID)
+		mObjects[cell.mFirst].mPrev = poolIndex;
+	cell.mFirst = poolIndex;
+	cell.mNbObjects++;
+}
+
+void GridPruner::unlinkObject(PoolIndex poolIndex)
+{
+	const GridObject& object = mObjects[poolIndex];
+	GridCell& cell = mCells[object.mCell];
+
+	if(object.mPrev!=INVALID_ID)
+		mObjects[object.mPrev].mNext = object.mNext;
+	else
+		cell.mFirst = object.mNext;
+
+	if(object.mNext!=INVALID_ID)
+		mObjects[object.mNext].mPrev = object.mPrev;
+
+	PX_ASSERT(cell.mNbObjects);
+	if(!--cell.mNbObjects && object.mCell!=LARGE_OBJECTS_CELL)
+		releaseCell(object.mCell);
+}
+
+void GridPruner::moveObject(PoolIndex poolIndex)
+{
+	PxI32 coords[3];
+	bool isLarge;
+	computeCoords(mPool.getCurrentWorldBoxes()[poolIndex], coords, isLarge);
+
+	// PT: early exit for the common case, i.e. the object stays in the same cell
+	const PxU32 currentCell = mObjects[poolIndex].mCell;
+	if(currentCell==LARGE_OBJECTS_CELL)
+	{
+		if(isLarge)
+			return;
+	}
+	else if(!isLarge)
+	{
+		const PxI32* currentCoords = mCells[currentCell].mCoords;
+		if(currentCoords[0]==coords[0] && currentCoords[1]==coords[1] && currentCoords[2]==coords[2])
+			return;
+	}
+
+	unlinkObject(poolIndex);
+	insertObject(poolIndex);
+}
+
+// PT: the pruning pool moves its last object to the hole left by a removed object. We do the same here and patch the links to the moved object.
+void GridPruner::relocateObject(PoolIndex from, PoolIndex to)
+{
+	const GridObject& object = mObjects[from];
+
+	if(object.mPrev!=INVALID_ID)
+		mObjects[object.mPrev].mNext = to;
+	else
+		mCells[object.mCell].mFirst = to;
+
+	if(object.mNext!=INVALID_ID)
+		mObjects[object.mNext].mPrev = to;
+
+	mObjects[to] = object;
+}
+
+void GridPruner::rehash()
+{
+	mCellMap.clear();
+	mCells.clear();
+	mFirstFreeCell = INVALID_ID;
+
+	GridCell& largeObjects = mCells.insert();
+	largeObjects.mCoords[0] = largeObjects.mCoords[1] = largeObjects.mCoords[2] = 0;
+	largeObjects.mFirst = INVALID_ID;
+	largeObjects.mNbObjects = 0;
+
+	for(PxU32 i=0;i<3;i++)
+	{
+		mOccupiedMin[i] = COORD_LIMIT;
+		mOccupiedMax[i] = -COORD_LIMIT;
+	}
+	mOccupiedBoundsDirty = false;
+
+	const PxU32 nbObjects = mPool.getNbActiveObjects();
+	for(PxU32 i=0;i<nbObjects;i++)
+		insertObject(i);
+}
+
+// PT: the automatic cell size is twice the average largest half-extent of the objects, i.e. an "average" object fits in a cell.
+// It is computed once, from the objects available in the first commit.
+void GridPruner::computeAutomaticCellSize()
+{
+	const PxU32 nbObjects = mPool.getNbActiveObjects();
+	const PxBounds3* boxes = mPool.getCurrentWorldBoxes();
+
+	PxF64 sum = 0.0;
+	PxU32 nbValid = 0;
+	for(PxU32 i=0;i<nbObjects;i++)
+	{
+		const PxReal e = boxes[i].getExtents().maxElement();
+		if(PxIsFinite(e) && e>=0.0f)
+		{
+			sum += PxF64(e);
+			nbValid++;
+		}
+	}
+
+	const PxReal averageExtent = nbValid ? PxReal(sum/PxF64(nbValid)) : 0.0f;
+	mCellSize = averageExtent>0.0f ? averageExtent*2.0f : FALLBACK_CELL_SIZE;
+	mInvCellSize = 1.0f/mCellSize;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool GridPruner::addObjects(PrunerHandle* results, const PxBounds3* bounds, const PrunerPayload* payload, PxU32 count, bool)
+{
+	PX_PROFILE_ZONE("SceneQuery.prunerAddObjects", mContextID);
+
+	if(!count)
+		return true;
+
+	// PT: objects coming from a pruning structure are inserted in the grid like the others, see merge()
+	const PxU32 valid = mPool.addObjects(results, bounds, payload, count);
+
+	mObjects.resizeUninitialized(mPool.getNbActiveObjects());
+	for(PxU32 i=0;i<valid;i++)
+		insertObject(mPool.getIndex(results[i]));
+
+	return valid==count;
+}
+
+void GridPruner::removeObjects(const PrunerHandle* handles, PxU32 count)
+{
+	PX_PROFILE_ZONE("SceneQuery.prunerRemoveObjects", mContextID);
+
+	for(PxU32 i=0;i<count;i++)
+	{
+		const PrunerHandle h = handles[i];
+		const PoolIndex poolIndex = mPool.getIndex(h);
+		unlinkObject(poolIndex);
+
+		const PoolIndex poolRelocatedLastIndex = mPool.removeObject(h);
+		if(poolRelocatedLastIndex!=poolIndex)
+			relocateObject(poolRelocatedLastIndex, poolIndex);
+		mObjects.popBack();
+	}
+}
+
+void GridPruner::updateObjectsAfterManualBoundsUpdates(const PrunerHandle* handles, PxU32 count)
+{
+	PX_PROFILE_ZONE("SceneQuery.prunerUpdateObjects", mContextID);
+
+	for(PxU32 i=0;i<count;i++)
+		moveObject(mPool.getIndex(handles[i]));
+}
+
+void GridPruner::updateObjectsAndInflateBounds(const PrunerHandle* handles, const PxU32* indices, const PxBounds3* newBounds, PxU32 count)
+{
+	PX_PROFILE_ZONE("SceneQuery.prunerUpdateObjects", mContextID);
+
+	if(!count)
+		return;
+
+	mPool.updateObjectsAndInflateBounds(handles, indices, newBounds, count);
+
+	for(PxU32 i=0;i<count;i++)
+		moveObject(mPool.getIndex(handles[i]));
+}
+
+void GridPruner::commit()
+{
+	PX_PROFILE_ZONE("SceneQuery.prunerCommit", mContextID);
+
+	if(mAutomaticCellSize && mCellSize==0.0f && mPool.getNbActiveObjects())
+	{
+		computeAutomaticCellSize();
+		rehash();
+	}
+
+	if(mOccupiedBoundsDirty)
+		computeOccupiedBounds();
+}
+
+void GridPruner::preallocate(PxU32 entries)
+{
+	mPool.preallocate(entries);
+	mObjects.reserve(entries);
+}
+
+void GridPruner::shiftOrigin(const PxVec3& shift)
+{
+	mPool.shiftOrigin(shift);
+
+	// PT: the shift is usually not a multiple of the cell size so the objects are redistributed
+	rehash();
+}
+
+void GridPruner::merge(const void*)
+{
+	// PT: the objects of the pruning structure have already been inserted in the grid by addObjects(), the structure's tree is not needed
+}
+
+void GridPruner::visualize(Cm::RenderOutput& out, PxU32 color) const
+{
+	out << PxTransform(PxIdentity);
+	out << color;
+
+	const PxU32 nbCells = mCells.size();
+	for(PxU32 i=LARGE_OBJECTS_CELL+1;i<nbCells;i++)
+	{
+		const GridCell& cell = mCells[i];
+		if(!cell.mNbObjects)
+			continue;
+
+		const PxVec3 minimum(PxReal(cell.mCoords[0]), PxReal(cell.mCoords[1]), PxReal(cell.mCoords[2]));
+		out << Cm::DebugBox(PxBounds3(minimum * mCellSize, (minimum + PxVec3(1.0f)) * mCellSize), true);
+	}
+
+	// Render large objects
+	out << PxU32(PxDebugColor::eARGB_WHITE);
+	for(PxU32 i=mCells[LARGE_OBJECTS_CELL].mFirst; i!=INVALID_ID; i=mObjects[i].mNext)
+		out << Cm::DebugBox(mPool.getCurrentWorldBoxes()[i], true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+/**
+ *	Queries
+ */
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+	typedef GridPruner::GridObject	GridObject;
+	typedef GridPruner::GridCell	GridCell;
+
+	template<class Test>
+	struct OverlapCellVisitor
+	{
+		OverlapCellVisitor(const Test& test, const GridObject* objects, const PxBounds3* boxes, const PrunerPayload* payloads, PrunerCallback& pcb) :
+			mTest(test), mObjects(objects), mBoxes(boxes), mPayloads(payloads), mCallback(pcb), mCounter(pcb.mTraversalStats)	{}
+
+		PX_FORCE_INLINE bool visit(PxU32 first)
+		{
+			const float half = 0.5f;
+			const FloatV halfV = FLoad(half);
+
+			mCounter.mNbVisitedNodes++;
+			for(PxU32 poolIndex=first; poolIndex!=INVALID_ID; poolIndex=mObjects[poolIndex].mNext)
+			{
+				mCounter.mNbLeafTests++;
+				Vec4V center2, extents2;
+				getBoundsTimesTwo(center2, extents2, mBoxes, poolIndex);
+
+				const Vec4V extents_ = V4Scale(extents2, halfV);
+				const Vec4V center_ = V4Scale(center2, halfV);
+
+				if(!mTest(Vec3V_From_Vec4V(center_), Vec3V_From_Vec4V(extents_)))
+					continue;
+
+				PxReal unusedDistance;
+				if(!mCallback.invoke(unusedDistance, mPayloads[poolIndex]))
+					return false;
+			}
+			return true;
+		}
+
+		const Test&				mTest;
+		const GridObject*		mObjects;
+		const PxBounds3*		mBoxes;
+		const PrunerPayload*	mPayloads;
+		PrunerCallback&			mCallback;
+		TraversalCounter		mCounter;	// cells and objects visited by the query
+
+		PX_NOCOPY(OverlapCellVisitor)
+	};
+
+	template<bool tInflate>
+	struct RaycastCellVisitor
+	{
+		RaycastCellVisitor(RayAABBTest& test, const GridObject* objects, const PxBounds3* boxes, const PrunerPayload* payloads, PxReal& maxDist, PrunerCallback& pcb) :
+			mTest(test), mObjects(objects), mBoxes(boxes), mPayloads(payloads), mMaxDist(maxDist), mCallback(pcb), mCounter(pcb.mTraversalStats)	{}
+
+		PX_FORCE_INLINE bool visit(PxU32 first)
+		{
+			mCounter.mNbVisitedNodes++;
+			for(PxU32 poolIndex=first; poolIndex!=INVALID_ID; poolIndex=mObjects[poolIndex].mNext)
+			{
+				mCounter.mNbLeafTests++;
+				// PT: the test has been initialized with values multiplied by 2, see AABBTreeRaycast
+				Vec4V center2, extents2;
+				getBoundsTimesTwo(center2, extents2, mBoxes, poolIndex);
+
+				if(!mTest.check<tInflate>(Vec3V_From_Vec4V(center2), Vec3V_From_Vec4V(extents2)))
+					continue;
+
+				const PxReal oldMaxDist = mMaxDist;	// we copy since mMaxDist can be updated in the callback
+				PxReal md = mMaxDist;
+				if(!mCallback.invoke(md, mPayloads[poolIndex]))
+					return false;
+
+				if(md < oldMaxDist)
+				{
+					mMaxDist = md;
+					mTest.setDistance(md);
+				}
+			}
+			return true;
+		}
+
+		RayAABBTest&			mTest;
+		const GridObject*		mObjects;
+		const PxBounds3*		mBoxes;
+		const PrunerPayload*	mPayloads;
+		PxReal&					mMaxDist;
+		PrunerCallback&			mCallback;
+		TraversalCounter		mCounter;
+
+		PX_NOCOPY(RaycastCellVisitor)
+	};
+}
+
+// PT: visits the occupied cells in the [lo, hi] range of coordinates. Empty ranges are allowed.
+template<class Visitor>
+static bool visitCells(const Ps::HashMap<PxU64, PxU32>& cellMap, const GridCell* cells, const PxI32* lo, const PxI32* hi, Visitor& visitor)
+{
+	PxI32 coords[3];
+	for(coords[0]=lo[0]; coords[0]<=hi[0]; coords[0]++)
+	{
+		for(coords[1]=lo[1]; coords[1]<=hi[1]; coords[1]++)
+		{
+			for(coords[2]=lo[2]; coords[2]<=hi[2]; coords[2]++)
+			{
+				const Ps::HashMap<PxU64, PxU32>::Entry* entry = cellMap.find(getCellKey(coords));
+				if(entry && !visitor.visit(cells[entry->second].mFirst))
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+template<class Test>
+PxAgain GridPruner::overlapT(const Test& test, const PxBounds3& queryBounds, PrunerCallback& pcb) const
+{
+	OverlapCellVisitor<Test> visitor(test, mObjects.begin(), mPool.getCurrentWorldBoxes(), mPool.getObjects(), pcb);
+
+	if(!visitor.visit(mCells[LARGE_OBJECTS_CELL].mFirst))
+		return false;
+
+	const PxU32 nbOccupiedCells = mCellMap.size();
+	if(!nbOccupiedCells)
+		return true;
+
+	// PT: the objects stick out of their cell by less than a cell, so we look one cell further than the query bounds
+	PxI32 lo[3], hi[3];
+	PxReal nbCellsInRange = 1.0f;
+	for(PxU32 i=0;i<3;i++)
+	{
+		const PxReal fLo = PxFloor((queryBounds.minimum[i] - mCellSize) * mInvCellSize);
+		const PxReal fHi = PxFloor((queryBounds.maximum[i] + mCellSize) * mInvCellSize);
+		if(!(fLo <= PxReal(mOccupiedMax[i]) && fHi >= PxReal(mOccupiedMin[i])))
+			return true;
+
+		lo[i] = getClampedCoord(fLo, mOccupiedMin[i], mOccupiedMax[i]);
+		hi[i] = getClampedCoord(fHi, mOccupiedMin[i], mOccupiedMax[i]);
+		nbCellsInRange *= PxReal(hi[i] - lo[i] + 1);
+	}
+
+	// PT: for large queries it is cheaper to go through the occupied cells than to hash all the cells in range
+	if(nbCellsInRange > PxReal(nbOccupiedCells))
+	{
+		const PxU32 nbCells = mCells.size();
+		for(PxU32 i=LARGE_OBJECTS_CELL+1;i<nbCells;i++)
+		{
+			const GridCell& cell = mCells[i];
+			if(!cell.mNbObjects)
+				continue;
+
+			const PxI32* coords = cell.mCoords;
+			if(		coords[0]<lo[0] || coords[0]>hi[0]
+				||	coords[1]<lo[1] || coords[1]>hi[1]
+				||	coords[2]<lo[2] || coords[2]>hi[2])
+				continue;
+
+			if(!visitor.visit(cell.mFirst))
+				return false;
+		}
+		return true;
+	}
+
+	return visitCells(mCellMap, mCells.begin(), lo, hi, visitor);
+}
+
+// PT: walks the cells along the ray with a 3D DDA. Objects can be found up to 'reach' cells away from the cell containing the ray,
+// because they stick out of their cell and because of the sweep inflation. So we visit the block of cells around the first
+// cell, then for each step of the walk, the slab of cells that enters the block in the direction of the step. No cell is
+// visited twice. The walk stops when the next cell starts beyond the closest hit found so far.
+template<bool tInflate>
+PxAgain GridPruner::raycastT(const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, const PxVec3& inflation, PrunerCallback& pcb) const
+{
+	PxReal& maxDist = inOutDistance;
+
+	// PT: we will pass center*2 and extents*2 to the ray-box code, to save some work per-box
+	RayAABBTest test(origin*2.0f, unitDir*2.0f, maxDist, inflation*2.0f);
+	RaycastCellVisitor<tInflate> visitor(test, mObjects.begin(), mPool.getCurrentWorldBoxes(), mPool.getObjects(), maxDist, pcb);
+
+	if(!visitor.visit(mCells[LARGE_OBJECTS_CELL].mFirst))
+		return false;
+
+	if(!mCellMap.size())
+		return true;
+
+	PxI32 reach[3];
+	for(PxU32 i=0;i<3;i++)
+		reach[i] = tInflate ? 1 + PxI32(PxMin(PxCeil(inflation[i] * mInvCellSize), PxReal(COORD_LIMIT))) : 1;
+
+	// PT: clip the ray against the occupied part of the grid, expanded by the reach
+	PxReal tEnter = 0.0f;
+	PxReal tExit = maxDist;
+	for(PxU32 i=0;i<3;i++)
+	{
+		const PxReal lo = PxReal(mOccupiedMin[i] - reach[i]) * mCellSize;
+		const PxReal hi = PxReal(mOccupiedMax[i] + reach[i] + 1) * mCellSize;
+		if(unitDir[i]==0.0f)
+		{
+			if(origin[i]<lo || origin[i]>hi)
+				return true;
+		}
+		else
+		{
+			const PxReal invDir = 1.0f/unitDir[i];
+			PxReal t0 = (lo - origin[i]) * invDir;
+			PxReal t1 = (hi - origin[i]) * invDir;
+			if(t0>t1)
+				Ps::swap(t0, t1);
+			tEnter = PxMax(tEnter, t0);
+			tExit = PxMin(tExit, t1);
+		}
+	}
+	if(!(tEnter<=tExit))
+		return true;
+
+	const PxVec3 entry = origin + unitDir * tEnter;
+
+	PxI32 cell[3], step[3];
+	PxReal tMax[3], tDelta[3];
+	for(PxU32 i=0;i<3;i++)
+	{
+		cell[i] = getClampedCoord(entry[i] * mInvCellSize, mOccupiedMin[i] - reach[i], mOccupiedMax[i] + reach[i]);
+		if(unitDir[i]>0.0f)
+		{
+			step[i] = 1;
+			tDelta[i] = mCellSize / unitDir[i];
+			tMax[i] = (PxReal(cell[i] + 1) * mCellSize - origin[i]) / unitDir[i];
+		}
+		else if(unitDir[i]<0.0f)
+		{
+			step[i] = -1;
+			tDelta[i] = -mCellSize / unitDir[i];
+			tMax[i] = (PxReal(cell[i]) * mCellSize - origin[i]) / unitDir[i];
+		}
+		else
+		{
+			step[i] = 0;
+			tDelta[i] = PX_MAX_F32;
+			tMax[i] = PX_MAX_F32;
+		}
+	}
+
+	PxI32 lo[3], hi[3];
+	for(PxU32 i=0;i<3;i++)
+	{
+		lo[i] = PxMax(cell[i] - reach[i], mOccupiedMin[i]);
+		hi[i] = PxMin(cell[i] + reach[i], mOccupiedMax[i]);
+	}
+	if(!visitCells(mCellMap, mCells.begin(), lo, hi, visitor))
+		return false;
+
+	for(;;)
+	{
+		const PxU32 axis = tMax[0]<tMax[1] ? (tMax[0]<tMax[2] ? 0u : 2u) : (tMax[1]<tMax[2] ? 1u : 2u);
+		if(tMax[axis] > PxMin(tExit, maxDist))
+			break;
+
+		cell[axis] += step[axis];
+		tMax[axis] += tDelta[axis];
+
+		for(PxU32 i=0;i<3;i++)
+		{
+			lo[i] = PxMax(cell[i] - reach[i], mOccupiedMin[i]);
+			hi[i] = PxMin(cell[i] + reach[i], mOccupiedMax[i]);
+		}
+
+		const PxI32 slab = cell[axis] + step[axis] * reach[axis];
+		if(slab<mOccupiedMin[axis] || slab>mOccupiedMax[axis])
+			continue;
+		lo[axis] = hi[axis] = slab;
+
+		if(!visitCells(mCellMap, mCells.begin(), lo, hi, visitor))
+			return false;
+	}
+	return true;
+}
+
+PxAgain GridPruner::overlap(const ShapeData& queryVolume, PrunerCallback& pcb) const
+{
+	const PxBounds3& queryBounds = queryVolume.getPrunerInflatedWorldAABB();
+
+	PxAgain again = true;
+	switch(queryVolume.getType())
+	{
+	case PxGeometryType::eBOX:
+		{
+			if(queryVolume.isOBB())
+			{	
+				const Gu::OBBAABBTest test(queryVolume.getPrunerWorldPos(), queryVolume.getPrunerWorldRot33(), queryVolume.getPrunerBoxGeomExtentsInflated());
+				again = overlapT(test, queryBounds, pcb);
+			}
+			else
+			{
+				const Gu::AABBAABBTest test(queryBounds);
+				again = overlapT(test, queryBounds, pcb);
+			}
+		}
+		break;
+	case PxGeometryType::eCAPSULE:
+		{
+			const Gu::Capsule& capsule = queryVolume.getGuCapsule();
+			const Gu::CapsuleAABBTest test(	capsule.p1, queryVolume.getPrunerWorldRot33().column0,
+											queryVolume.getCapsuleHalfHeight()*2.0f, PxVec3(capsule.radius*SQ_PRUNER_INFLATION));
+			again = overlapT(test, queryBounds, pcb);
+		}
+		break;
+	case PxGeometryType::eSPHERE:
+		{
+			const Gu::Sphere& sphere = queryVolume.getGuSphere();
+			const Gu::SphereAABBTest test(sphere.center, sphere.radius);
+			again = overlapT(test, queryBounds, pcb);
+		}
+		break;
+	case PxGeometryType::eCONVEXMESH:
+		{
+			const Gu::OBBAABBTest test(queryVolume.getPrunerWorldPos(), queryVolume.getPrunerWorldRot33(), queryVolume.getPrunerBoxGeomExtentsInflated());
+			again = overlapT(test, queryBounds, pcb);
+		}
+		break;
+	case PxGeometryType::ePLANE:
+	case PxGeometryType::eTRIANGLEMESH:
+	case PxGeometryType::eHEIGHTFIELD:
+	case PxGeometryType::eGEOMETRY_COUNT:
+	case PxGeometryType::eINVALID:
+		PX_ALWAYS_ASSERT_MESSAGE("unsupported overlap query volume geometry type");
+	}
+
+	return again;
+}
+
+PxAgain GridPruner::sweep(const ShapeData& queryVolume, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback& pcb) const
+{
+	const PxBounds3& aabb = queryVolume.getPrunerInflatedWorldAABB();
+	const PxVec3 extents = aabb.getExtents();
+	return raycastT<true>(aabb.getCenter(), unitDir, inOutDistance, extents, pcb);
+}
+
+PxAgain GridPruner::raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback& pcb) const
+{
+	return raycastT<false>(origin, unitDir, inOutDistance, PxVec3(0.0f), pcb);
+}
@@ -0,0 +1,130 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef SQ_GRID_PRUNER_H
+#define SQ_GRID_PRUNER_H
+
+#include "SqPruner.h"
+#include "SqPruningPool.h"
+#include "PsArray.h"
+#include "PsHashMap.h"
+
+namespace physx
+{
+
+namespace Sq
+{
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+	// PT: hashed uniform grid pruner. This is a "loose" grid: each object is stored in the single cell that contains the center of its
+	// bounds, as long as its largest half-extent is smaller than the cell size. Queries then look at the cells touched by the query volume,
+	// expanded by one cell. Objects too large for the grid go to a separate list that is always tested linearly.
+	//
+	// Only the occupied cells exist, they are found by hashing their integer coordinates. Adding, removing or moving an object is O(1),
+	// there is no tree to rebuild or refit, which makes the structure a good fit for many small dynamic objects of similar sizes, spread
+	// uniformly over the scene. Raycasts and sweeps walk the cells along the ray (3D DDA) and stop as soon as the closest hit is found.
+	class GridPruner : public Pruner
+	{
+		public:
+												GridPruner(PxU64 contextID, PxReal cellSize);
+		virtual									~GridPruner();
+
+		// Pruner
+		virtual			bool					addObjects(PrunerHandle* results, const PxBounds3* bounds, const PrunerPayload* userData, PxU32 count, bool hasPruningStructure);
+		virtual			void					removeObjects(const PrunerHandle* handles, PxU32 count);
+		virtual			void					updateObjectsAfterManualBoundsUpdates(const PrunerHandle* handles, PxU32 count);
+		virtual			void					updateObjectsAndInflateBounds(const PrunerHandle* handles, const PxU32* indices, const PxBounds3* newBounds, PxU32 count);
+		virtual			void					commit();
+		virtual			PxAgain					raycast(const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&)	const;
+		virtual			PxAgain					overlap(const Gu::ShapeData& queryVolume, PrunerCallback&)	const;
+		virtual			PxAgain					sweep(const Gu::ShapeData& queryVolume, const PxVec3& unitDir, PxReal& inOutDistance, PrunerCallback&)	const;
+		virtual			const PrunerPayload&	getPayload(PrunerHandle handle)						const	{ return mPool.getPayload(handle);			}
+		virtual			const PrunerPayload&	getPayload(PrunerHandle handle, PxBounds3*& bounds)	const	{ return mPool.getPayload(handle, bounds);	}
+		virtual			void					preallocate(PxU32 entries);
+		virtual			void					shiftOrigin(const PxVec3& shift);
+		virtual			void					visualize(Cm::RenderOutput& out, PxU32 color) const;
+		virtual			void					merge(const void* mergeParams);
+		//~Pruner
+
+		PX_FORCE_INLINE	PxReal					getCellSize()		const	{ return mCellSize;				}
+		PX_FORCE_INLINE	PxU32					getNbCells()		const	{ return mCellMap.size();		}
+
+		// PT: per-object data, parallel to the pruning pool. Objects of the same cell are linked together.
+		struct GridObject
+		{
+			PxU32	mCell;	// index in mCells
+			PxU32	mPrev;	// previous object (pool index) in the cell, or INVALID_ID
+			PxU32	mNext;	// next object (pool index) in the cell, or INVALID_ID
+		};
+
+		struct GridCell
+		{
+			PxI32	mCoords[3];
+			PxU32	mFirst;	// first object (pool index) in the cell, or INVALID_ID. For free cells, next free cell.
+			PxU32	mNbObjects;
+		};
+
+		private:
+		typedef Ps::HashMap<PxU64, PxU32>	CellMap;
+
+						void					computeCoords(const PxBounds3& bounds, PxI32* coords, bool& isLarge)	const;
+						PxU32					findOrCreateCell(const PxI32* coords);
+						void					releaseCell(PxU32 cellIndex);
+						void					insertObject(PoolIndex poolIndex);
+						void					unlinkObject(PoolIndex poolIndex);
+						void					moveObject(PoolIndex poolIndex);
+						void					relocateObject(PoolIndex from, PoolIndex to);
+						void					rehash();
+						void					computeAutomaticCellSize();
+						void					computeOccupiedBounds();
+						void					growOccupiedBounds(const PxI32* coords);
+		template<class Test>
+						PxAgain					overlapT(const Test& test, const PxBounds3& queryBounds, PrunerCallback& pcb)	const;
+		template<bool tInflate>
+						PxAgain					raycastT(const PxVec3& origin, const PxVec3& unitDir, PxReal& inOutDistance, const PxVec3& inflation, PrunerCallback& pcb)	const;
+
+						PruningPool				mPool;
+						Ps::Array<GridObject>	mObjects;		// parallel to the pool
+						Ps::Array<GridCell>		mCells;			// cell 0 is the list of large objects
+						CellMap					mCellMap;		// cell coordinates => index in mCells
+						PxU32					mFirstFreeCell;
+						PxI32					mOccupiedMin[3];	// conservative range of occupied cell coordinates
+						PxI32					mOccupiedMax[3];
+						PxReal					mCellSize;
+						PxReal					mInvCellSize;
+						PxU64					mContextID;
+						bool					mAutomaticCellSize;
+						bool					mOccupiedBoundsDirty;
+	};
+
+} // namespace Sq
+
+} // namespace physx
+
+#endif // SQ_GRID_PRUNER_H
@@ -172,6 +172,43 @@ PoolIndex PruningPool::removeObject(PrunerHandle h)
 	return indexOfLastObject;
 }
 
+bool PruningPool::reorder(const PoolIndex* order)
+{
+	if(mNbObjects<2)
+		return true;
+
+	PxBounds3*		tmpBoxes	= reinterpret_cast<PxBounds3*>(PX_ALLOC_TEMP(sizeof(PxBounds3)*mNbObjects, "PxBounds3"));
+	PrunerPayload*	tmpData		= reinterpret_cast<PrunerPayload*>(PX_ALLOC_TEMP(sizeof(PrunerPayload)*mNbObjects, "PrunerPayload*"));
+	PrunerHandle*	tmpHandles	= reinterpret_cast<PrunerHandle*>(PX_ALLOC_TEMP(sizeof(PrunerHandle)*mNbObjects, "Pruner Index Mapping"));
+	if((NULL==tmpBoxes) || (NULL==tmpData) || (NULL==tmpHandles))
+	{
+		PX_FREE_AND_RESET(tmpBoxes);
+		PX_FREE_AND_RESET(tmpData);
+		PX_FREE_AND_RESET(tmpHandles);
+		return false;
+	}
+
+	PxMemCopy(tmpBoxes, mWorldBoxes, mNbObjects*sizeof(PxBounds3));
+	PxMemCopy(tmpData, mObjects, mNbObjects*sizeof(PrunerPayload));
+	PxMemCopy(tmpHandles, mIndexToHandle, mNbObjects*sizeof(PrunerHandle));
+
+	for(PxU32 i=0; i<mNbObjects; i++)
+	{
+		const PoolIndex oldIndex = order[i];
+		PX_ASSERT(oldIndex<mNbObjects);
+		const PrunerHandle handle = tmpHandles[oldIndex];
+		mWorldBoxes[i]			= tmpBoxes[oldIndex];
+		mObjects[i]				= tmpData[oldIndex];
+		mIndexToHandle[i]		= handle;
+		mHandleToIndex[handle]	= i;
+	}
+
+	PX_FREE(tmpBoxes);
+	PX_FREE(tmpData);
+	PX_FREE(tmpHandles);
+	return true;
+}
+
 void PruningPool::shiftOrigin(const PxVec3& shift)
 {
 	for(PxU32 i=0; i < mNbObjects; i++)
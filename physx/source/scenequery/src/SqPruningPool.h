@@ -93,6 +93,10 @@ namespace Sq
 												}
 
 						void					preallocate(PxU32 entries);
+
+		// PT: sorts the objects so that new index i holds the object previously at index order[i]. The handles are preserved.
+		// Returns false if the temporary memory could not be allocated, the pool is then left unchanged.
+						bool					reorder(const PoolIndex* order);
 //	protected:
 
 						PxU32					mNbObjects;			//!< Current number of objects
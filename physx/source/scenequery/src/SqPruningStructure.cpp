@@ -146,7 +146,7 @@ static void getShapeBounds(PxRigidActor* actor, bool dynamic, PxBounds3* bounds,
 }
 
 //////////////////////////////////////////////////////////////////////////
-bool PruningStructure::build(PxRigidActor*const* actors, PxU32 nbActors)
+bool PruningStructure::build(PxRigidActor*const* actors, PxU32 nbActors, PxCpuDispatcher* dispatcher)
 {
 	PX_ASSERT(actors);
 	PX_ASSERT(nbActors > 0);
@@ -257,6 +257,7 @@ bool PruningStructure::build(PxRigidActor*const* actors, PxU32 nbActors)
 			sTB.mNbPrimitives = numShapes[i];
 			sTB.mAABBArray = bounds[i];
 			sTB.mLimit = NB_OBJECTS_PER_NODE;
+			sTB.mDispatcher = dispatcher;
 			bool status = aabbTrees[i].build(sTB);
 
 			PX_UNUSED(status);
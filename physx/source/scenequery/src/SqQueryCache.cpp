@@ -0,0 +1,219 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "SqQueryCache.h"
+#include "PsInlineArray.h"
+#include "PsBitUtils.h"
+#include "GuBounds.h"
+#include "geometry/PxBoxGeometry.h"
+#include "foundation/PxMemory.h"
+
+using namespace physx;
+using namespace Sq;
+
+namespace
+{
+	typedef Ps::InlineArray<PrunerPayload, 64> CandidateArray;
+
+	struct GatherCallback : public PrunerCallback
+	{
+		GatherCallback(CandidateArray& candidates) : mCandidates(candidates), mOverflow(false)	{}
+
+		virtual PxAgain invoke(PxReal&, const PrunerPayload& payload)
+		{
+			if(mCandidates.size() == QueryCache::MAX_NB_CANDIDATES)
+			{
+				mOverflow = true;
+				return false;
+			}
+			mCandidates.pushBack(payload);
+			return true;
+		}
+
+		CandidateArray&	mCandidates;
+		bool			mOverflow;
+	private:
+		GatherCallback& operator=(const GatherCallback&);
+	};
+
+	PX_FORCE_INLINE PxAgain reportCandidates(const CandidateArray& candidates, PrunerCallback& pcb)
+	{
+		for(PxU32 i=0;i<candidates.size();i++)
+		{
+			PxReal unusedDistance = PX_MAX_REAL;
+			if(!pcb.invoke(unusedDistance, candidates[i]))
+				return false;
+		}
+		return true;
+	}
+
+	PX_FORCE_INLINE bool contains(const PxBounds3& region, const PxBounds3& bounds)
+	{
+		return	region.minimum.x <= bounds.minimum.x && region.minimum.y <= bounds.minimum.y && region.minimum.z <= bounds.minimum.z
+			&&	region.maximum.x >= bounds.maximum.x && region.maximum.y >= bounds.maximum.y && region.maximum.z >= bounds.maximum.z;
+	}
+
+	PX_FORCE_INLINE PxU32 getCellCoordinate(PxReal value, PxReal invCellSize)
+	{
+		// PT: clamped so that the conversion is defined for far away queries, these just share the border cells
+		const PxReal cell = PxClamp(PxFloor(value * invCellSize), -1e9f, 1e9f);
+		return PxU32(PxI32(cell));
+	}
+}
+
+QueryCache::QueryCache() : mEntries(PX_DEBUG_EXP("QueryCache::mEntries")), mTolerance(0.0f)
+{
+	resetStats();
+}
+
+QueryCache::~QueryCache()
+{
+}
+
+void QueryCache::setParams(PxU32 maxNbEntries, PxReal tolerance)
+{
+	PX_ASSERT(tolerance > 0.0f);
+
+	Ps::Mutex::ScopedLock lock(mMutex);
+
+	mTolerance = tolerance;
+
+	const PxU32 nbEntries = maxNbEntries ? Ps::nextPowerOfTwo(maxNbEntries - 1) : 0;
+	if(nbEntries != mEntries.size())
+	{
+		mEntries.reset();
+		if(nbEntries)
+			mEntries.resize(nbEntries, Entry());
+	}
+	else
+	{
+		// PT: the regions depend on the tolerance
+		for(PxU32 i=0;i<mEntries.size();i++)
+			mEntries[i].mValid = false;
+	}
+}
+
+PxU32 QueryCache::getEntryIndex(const PxBounds3& queryBounds, PxU32 prunerIndex, PxU32 queryType) const
+{
+	const PxVec3 center = queryBounds.getCenter();
+	const PxReal invCellSize = 1.0f / mTolerance;
+
+	PxU32 hash = getCellCoordinate(center.x, invCellSize) * 73856093u;
+	hash ^= getCellCoordinate(center.y, invCellSize) * 19349663u;
+	hash ^= getCellCoordinate(center.z, invCellSize) * 83492791u;
+	hash ^= (queryType * 2 + prunerIndex) * 2654435761u;
+	hash ^= hash >> 16;
+	return hash & (mEntries.size() - 1);
+}
+
+bool QueryCache::query(const Pruner& pruner, PxU32 prunerIndex, PxU32 timestamp, PxU32 queryType, const PxBounds3& queryBounds, PrunerCallback& pcb, PxAgain& again)
+{
+	// PT: the candidates are reported from a copy, so that the lock is not held while running the narrow phase and the
+	// user's filter callbacks. These can issue nested queries replacing the entry.
+	CandidateArray candidates;
+
+	PxU32 entryIndex;
+	PxReal tolerance;
+	bool hit = false;
+	bool stale = false;
+	{
+		Ps::Mutex::ScopedLock lock(mMutex);
+		if(!mEntries.size())
+			return false;
+
+		entryIndex = getEntryIndex(queryBounds, prunerIndex, queryType);
+		tolerance = mTolerance;
+
+		const Entry& entry = mEntries[entryIndex];
+		if(entry.mValid && entry.mPrunerIndex == prunerIndex && entry.mQueryType == queryType && contains(entry.mBounds, queryBounds))
+		{
+			if(entry.mTimestamp == timestamp)
+			{
+				mStats.mNbHits++;
+				hit = true;
+				candidates.resizeUninitialized(entry.mCandidates.size());
+				if(entry.mCandidates.size())
+					PxMemCopy(candidates.begin(), entry.mCandidates.begin(), sizeof(PrunerPayload)*entry.mCandidates.size());
+			}
+			else
+				stale = true;
+		}
+	}
+
+	if(!hit)
+	{
+		PxBounds3 region = queryBounds;
+		region.fattenFast(tolerance);
+
+		GatherCallback gather(candidates);
+		const Gu::ShapeData sd(PxBoxGeometry(region.getExtents()), PxTransform(region.getCenter()), 0.0f);
+		pruner.overlap(sd, gather);
+
+		Ps::Mutex::ScopedLock lock(mMutex);
+		if(gather.mOverflow)
+		{
+			mStats.mNbOverflows++;
+			return false;
+		}
+
+		mStats.mNbMisses++;
+		if(stale)
+			mStats.mNbStale++;
+
+		// PT: setParams() may have resized the cache in the meantime
+		if(entryIndex < mEntries.size() && tolerance == mTolerance)
+		{
+			Entry& entry = mEntries[entryIndex];
+			entry.mBounds		= region;
+			entry.mTimestamp	= timestamp;
+			entry.mPrunerIndex	= prunerIndex;
+			entry.mQueryType	= queryType;
+			entry.mValid		= true;
+			entry.mCandidates.clear();
+			entry.mCandidates.reserve(candidates.size());
+			for(PxU32 i=0;i<candidates.size();i++)
+				entry.mCandidates.pushBack(candidates[i]);
+		}
+	}
+
+	again = reportCandidates(candidates, pcb);
+	return true;
+}
+
+void QueryCache::getStats(QueryCacheStats& stats) const
+{
+	Ps::Mutex::ScopedLock lock(mMutex);
+	stats = mStats;
+}
+
+void QueryCache::resetStats()
+{
+	Ps::Mutex::ScopedLock lock(mMutex);
+	PxMemZero(&mStats, sizeof(QueryCacheStats));
+}
@@ -31,8 +31,10 @@
 #include "SqAABBPruner.h"
 #include "SqIncrementalAABBPruner.h"
 #include "SqBucketPruner.h"
+#include "SqGridPruner.h"
 #include "SqPrunerMergeData.h"
 #include "SqBounds.h"
+#include "GuParallelJobs.h"
 #include "NpBatchQuery.h"
 #include "PxFiltering.h"
 #include "NpRigidDynamic.h"
@@ -40,6 +42,7 @@
 #include "NpArticulationLink.h"
 #include "CmTransformUtils.h"
 #include "PsAllocator.h"
+#include "PsTime.h"
 #include "PxSceneDesc.h"
 #include "ScBodyCore.h"
 #include "SqPruner.h"
@@ -56,7 +59,8 @@ PrunerExt::PrunerExt() :
 	mPruner		(NULL),
 	mDirtyList	(PX_DEBUG_EXP("SQmDirtyList")),
 	mPrunerType	(PxPruningStructureType::eLAST),
-	mTimestamp	(0xffffffff)
+	mTimestamp	(0xffffffff),
+	mDispatcher	(NULL)
 {
 }
 
@@ -65,7 +69,7 @@ PrunerExt::~PrunerExt()
 	PX_DELETE_AND_RESET(mPruner);
 }
 
-void PrunerExt::init(PxPruningStructureType::Enum type, PxU64 contextID, PxU32 )
+void PrunerExt::init(PxPruningStructureType::Enum type, PxU64 contextID, PxU32 , PxCpuDispatcher* buildDispatcher, PxReal gridCellSize)
 {
 	if(0)	// PT: to force testing the bucket pruner
 	{
@@ -77,13 +81,17 @@ void PrunerExt::init(PxPruningStructureType::Enum type, PxU64 contextID, PxU32 )
 
 	mPrunerType = type;
 	mTimestamp	= 0;
+	mDispatcher	= buildDispatcher;
 	Pruner* pruner = NULL;
 	switch(type)
 	{
-		case PxPruningStructureType::eNONE:					{ pruner = PX_NEW(BucketPruner);					break;	}
-		case PxPruningStructureType::eDYNAMIC_AABB_TREE:	{ pruner = PX_NEW(AABBPruner)(true, contextID);		break;	}
-		case PxPruningStructureType::eSTATIC_AABB_TREE:		{ pruner = PX_NEW(AABBPruner)(false, contextID);	break;	}
-		case PxPruningStructureType::eLAST:					break;
+		case PxPruningStructureType::eNONE:							{ pruner = PX_NEW(BucketPruner);																break;	}
+		case PxPruningStructureType::eDYNAMIC_AABB_TREE:			{ pruner = PX_NEW(AABBPruner)(true, contextID, AABBPrunerLayout::eBINARY, buildDispatcher);		break;	}
+		case PxPruningStructureType::eSTATIC_AABB_TREE:				{ pruner = PX_NEW(AABBPruner)(false, contextID, AABBPrunerLayout::eBINARY, buildDispatcher);	break;	}
+		case PxPruningStructureType::eSTATIC_WIDE_AABB_TREE:		{ pruner = PX_NEW(AABBPruner)(false, contextID, AABBPrunerLayout::eWIDE, buildDispatcher);		break;	}
+		case PxPruningStructureType::eSTATIC_COMPRESSED_AABB_TREE:	{ pruner = PX_NEW(AABBPruner)(false, contextID, AABBPrunerLayout::eCOMPRESSED, buildDispatcher);	break;	}
+		case PxPruningStructureType::eHASHED_GRID:					{ pruner = PX_NEW(GridPruner)(contextID, gridCellSize);											break;	}
+		case PxPruningStructureType::eLAST:							break;
 	}
 	mPruner = pruner;
 }
@@ -107,6 +115,39 @@ void PrunerExt::flushMemory()
 	// PT: TODO: flush pruner here?
 }
 
+namespace
+{
+	// Dirty lists are split in batches of this many shapes, whose bounds are computed in parallel when there are several of them
+	const PxU32 PARALLEL_FLUSH_BATCH_SIZE = 512;
+
+	struct ComputeDirtyBoundsParams
+	{
+		Pruner*				mPruner;
+		const PrunerHandle*	mHandles;
+		ComputeBoundsFunc	mFunc;
+		PxU32				mCount;
+	};
+}
+
+static void computeDirtyBounds(Pruner& pruner, const PrunerHandle* prunerHandles, PxU32 nb, ComputeBoundsFunc func)
+{
+	for(PxU32 i=0; i<nb; i++)
+	{
+		// PT: we compute the new bounds and store them directly in the pruner structure to avoid copies. We delay the updateObjects() call
+		// to take advantage of batching.
+		PxBounds3* bounds;
+		const PrunerPayload& pp = pruner.getPayload(prunerHandles[i], bounds);
+		(func)(*bounds, *(reinterpret_cast<Scb::Shape*>(pp.data[0])), *(reinterpret_cast<Scb::Actor*>(pp.data[1])));	//PAYLOAD
+	}
+}
+
+static void computeDirtyBoundsJob(void* userData, PxU32 jobIndex)
+{
+	const ComputeDirtyBoundsParams& params = *reinterpret_cast<const ComputeDirtyBoundsParams*>(userData);
+	const PxU32 start = jobIndex * PARALLEL_FLUSH_BATCH_SIZE;
+	computeDirtyBounds(*params.mPruner, params.mHandles + start, PxMin(params.mCount - start, PARALLEL_FLUSH_BATCH_SIZE), params.mFunc);
+}
+
 void PrunerExt::flushShapes(PxU32 index)
 {
 	const PxU32 numDirtyList = mDirtyList.size();
@@ -117,16 +158,21 @@ void PrunerExt::flushShapes(PxU32 index)
 	const ComputeBoundsFunc func = gComputeBoundsTable[index];
 
 	for(PxU32 i=0; i<numDirtyList; i++)
-	{
-		const PrunerHandle handle = prunerHandles[i];
-		mDirtyMap.reset(handle);
+		mDirtyMap.reset(prunerHandles[i]);
 
-		// PT: we compute the new bounds and store them directly in the pruner structure to avoid copies. We delay the updateObjects() call
-		// to take advantage of batching.
-		PxBounds3* bounds;
-		const PrunerPayload& pp = mPruner->getPayload(handle, bounds);
-		(func)(*bounds, *(reinterpret_cast<Scb::Shape*>(pp.data[0])), *(reinterpret_cast<Scb::Actor*>(pp.data[1])));	//PAYLOAD
+	// PT: each batch writes the bounds of its own shapes, which are all different since the dirty list has no duplicates
+	const PxU32 nbBatches = (numDirtyList + PARALLEL_FLUSH_BATCH_SIZE - 1) / PARALLEL_FLUSH_BATCH_SIZE;
+	if(nbBatches>1 && Gu::getNbParallelThreads(mDispatcher)>1)
+	{
+		ComputeDirtyBoundsParams params;
+		params.mPruner	= mPruner;
+		params.mHandles	= prunerHandles;
+		params.mFunc	= func;
+		params.mCount	= numDirtyList;
+		Gu::runParallelJobs(mDispatcher, nbBatches, computeDirtyBoundsJob, &params, "SceneQuery.flushShapes");
 	}
+	else
+		computeDirtyBounds(*mPruner, prunerHandles, numDirtyList, func);
 	// PT: batch update happens after the loop instead of once per loop iteration
 	mPruner->updateObjectsAfterManualBoundsUpdates(prunerHandles, numDirtyList);
 	mTimestamp += numDirtyList;
@@ -252,13 +298,15 @@ void CompoundPrunerExt::removeFromDirtyList(PrunerCompoundId compoundId, PrunerH
 
 SceneQueryManager::SceneQueryManager(	Scb::Scene& scene, PxPruningStructureType::Enum staticStructure, 
 										PxPruningStructureType::Enum dynamicStructure, PxU32 dynamicTreeRebuildRateHint,
-										const PxSceneLimits& limits) :
+										const PxSceneLimits& limits, PxCpuDispatcher* buildDispatcher, PxReal gridPrunerCellSize,
+										PxU32 dynamicTreeRebuildTimeBudget) :
 	mScene			(scene)	
 {
-	mPrunerExt[PruningIndex::eSTATIC].init(staticStructure, scene.getContextId(), limits.maxNbStaticShapes ? limits.maxNbStaticShapes : 1024);
-	mPrunerExt[PruningIndex::eDYNAMIC].init(dynamicStructure, scene.getContextId(), limits.maxNbDynamicShapes ? limits.maxNbDynamicShapes : 1024);
+	mPrunerExt[PruningIndex::eSTATIC].init(staticStructure, scene.getContextId(), limits.maxNbStaticShapes ? limits.maxNbStaticShapes : 1024, buildDispatcher, gridPrunerCellSize);
+	mPrunerExt[PruningIndex::eDYNAMIC].init(dynamicStructure, scene.getContextId(), limits.maxNbDynamicShapes ? limits.maxNbDynamicShapes : 1024, buildDispatcher, gridPrunerCellSize);
 
 	setDynamicTreeRebuildRateHint(dynamicTreeRebuildRateHint);
+	setDynamicTreeRebuildTimeBudget(dynamicTreeRebuildTimeBudget);
 
 	preallocate(limits.maxNbStaticShapes, limits.maxNbDynamicShapes);
 
@@ -269,6 +317,11 @@ SceneQueryManager::SceneQueryManager(	Scb::Scene& scene, PxPruningStructureType:
 	mCompoundPrunerExt.preallocate(32);
 
 	mPrunerNeedsUpdating = false;
+	mNewTreesReady = false;
+
+	mQueryStatsEnabled = false;
+	PxMemZero(&mQueryStats, sizeof(PxSceneQueryStatistics));
+	PxMemZero(&mLastFrameQueryStats, sizeof(PxSceneQueryStatistics));
 }
 
 SceneQueryManager::~SceneQueryManager()
@@ -390,6 +443,72 @@ void SceneQueryManager::setDynamicTreeRebuildRateHint(PxU32 rebuildRateHint)
 	}
 }
 
+void SceneQueryManager::setDynamicTreeRebuildTimeBudget(PxU32 microseconds)
+{
+	mRebuildTimeBudget = microseconds;
+
+	for(PxU32 i=0;i<PruningIndex::eCOUNT;i++)
+	{
+		if(mPrunerExt[i].pruner() && mPrunerExt[i].type() == PxPruningStructureType::eDYNAMIC_AABB_TREE)
+			static_cast<AABBPruner*>(mPrunerExt[i].pruner())->setRebuildTimeBudget(microseconds);
+	}
+}
+
+void SceneQueryManager::getRebuildStatistics(PruningIndex::Enum index, PxSceneQueryRebuildStatistics& stats) const
+{
+	if(!mPrunerExt[index].pruner() || mPrunerExt[index].type() != PxPruningStructureType::eDYNAMIC_AABB_TREE)
+	{
+		PxMemZero(&stats, sizeof(PxSceneQueryRebuildStatistics));
+		return;
+	}
+
+	const AABBPruner* pruner = static_cast<const AABBPruner*>(mPrunerExt[index].pruner());
+	const AABBPrunerRebuildStats& rebuildStats = pruner->getRebuildStats();
+	stats.nbRemainingWorkUnits	= pruner->getNbRemainingWorkUnits();
+	stats.nbTotalWorkUnits		= rebuildStats.mNbTotalWorkUnits;
+	stats.nbSteps				= rebuildStats.mNbSteps;
+	stats.nbRebuilds			= rebuildStats.mNbRebuilds;
+	stats.nbBudgetOverruns		= rebuildStats.mNbBudgetOverruns;
+	stats.lastStepTime			= rebuildStats.mLastStepTime;
+	stats.maxStepTime			= rebuildStats.mMaxStepTime;
+}
+
+void SceneQueryManager::setQueryStatsEnabled(bool enabled)
+{
+	mQueryStatsEnabled = enabled;
+}
+
+void SceneQueryManager::addQueryStats(PxSceneQueryStatistics::QueryType type, const PrunerQueryStats* stats) const
+{
+	PX_COMPILE_TIME_ASSERT(PxSceneQueryStatistics::eSTATIC == PxU32(PruningIndex::eSTATIC));
+	PX_COMPILE_TIME_ASSERT(PxSceneQueryStatistics::eDYNAMIC == PxU32(PruningIndex::eDYNAMIC));
+
+	const Ps::CounterFrequencyToTensOfNanos& freq = Ps::Time::getBootCounterFrequency();
+
+	Ps::Mutex::ScopedLock lock(mQueryStatsLock);
+	for(PxU32 i=0;i<PxSceneQueryStatistics::ePRUNER_COUNT;i++)
+	{
+		const PrunerQueryStats& src = stats[i];
+		if(!src.mNbQueries)
+			continue;
+
+		PxSceneQueryStatistics::Counters& dst = mQueryStats.counters[i][type];
+		dst.nbQueries		+= src.mNbQueries;
+		dst.nbVisitedNodes	+= src.mTraversal.mNbVisitedNodes;
+		dst.nbLeafTests		+= src.mTraversal.mNbLeafTests;
+		dst.nbNarrowTests	+= src.mNbNarrowTests;
+		dst.nbHits			+= src.mNbHits;
+		dst.time			+= PxReal(freq.toTensOfNanos(src.mTicks)) * 1e-8f;
+	}
+}
+
+void SceneQueryManager::endQueryStatsFrame()
+{
+	Ps::Mutex::ScopedLock lock(mQueryStatsLock);
+	mLastFrameQueryStats = mQueryStats;
+	PxMemZero(&mQueryStats, sizeof(PxSceneQueryStatistics));
+}
+
 void SceneQueryManager::afterSync(PxSceneQueryUpdateMode::Enum updateMode)
 {
 	PX_PROFILE_ZONE("Sim.sceneQueryBuildStep", mScene.getContextId());
@@ -481,11 +600,25 @@ void SceneQueryManager::sceneQueryBuildStep(PruningIndex::Enum index)
 		const bool buildFinished = static_cast<AABBPruner*>(mPrunerExt[index].pruner())->buildStep(false);
 		if(buildFinished)
 		{
-			mPrunerNeedsUpdating = true;
+			// PT: this runs in a task while queries may run on other threads. We don't set mPrunerNeedsUpdating here, otherwise
+			// the next query would switch the trees while other queries are still traversing the old one. Instead the new tree
+			// is published by commitNewTrees(), from fetchQueries().
+			mNewTreesReady = true;
 		}
 	}
 }
 
+void SceneQueryManager::commitNewTrees()
+{
+	if(mNewTreesReady)
+	{
+		mNewTreesReady = false;
+		mPrunerNeedsUpdating = true;
+	}
+
+	flushUpdates();
+}
+
 bool SceneQueryManager::prepareSceneQueriesUpdate(PruningIndex::Enum index)
 {
 	bool retVal = false;
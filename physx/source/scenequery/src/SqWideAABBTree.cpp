@@ -0,0 +1,215 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#include "foundation/PxMath.h"
+#include "SqWideAABBTree.h"
+#include "SqAABBTree.h"
+#include "PsArray.h"
+#include "PsBasicTemplates.h"
+
+using namespace physx;
+using namespace Sq;
+
+WideAABBTree::WideAABBTree() :
+	mIndices	(NULL),
+	mNodes		(NULL),
+	mNbNodes	(0),
+	mRootData	(WideAABBTreeNode::eEMPTY_CHILD)
+{
+	mRootBounds.setEmpty();
+}
+
+WideAABBTree::~WideAABBTree()
+{
+	release();
+}
+
+void WideAABBTree::release()
+{
+	PX_FREE_AND_RESET(mNodes);
+	mIndices = NULL;
+	mNbNodes = 0;
+	mRootData = WideAABBTreeNode::eEMPTY_CHILD;
+	mRootBounds.setEmpty();
+}
+
+// PT: the quantized bounds must always enclose the source bounds. We round outwards, then fix the results
+// with the exact same math as the dequantization code, to catch the cases where the float rounding goes
+// the wrong way.
+static PX_FORCE_INLINE PxU8 quantizeMin(PxReal value, PxReal origin, PxReal scale)
+{
+	if(scale==0.0f)
+		return 0;
+
+	PxI32 q = PxI32(PxFloor((value - origin)/scale));
+	q = PxClamp(q, 0, PxI32(WideAABBTreeNode::eQUANTIZATION));
+	while(q>0 && PxF32(q)*scale + origin > value)
+		q--;
+	return PxU8(q);
+}
+
+static PX_FORCE_INLINE PxU8 quantizeMax(PxReal value, PxReal origin, PxReal scale)
+{
+	if(scale==0.0f)
+		return 0;
+
+	PxI32 q = PxI32(PxCeil((value - origin)/scale));
+	q = PxClamp(q, 0, PxI32(WideAABBTreeNode::eQUANTIZATION));
+	while(q<PxI32(WideAABBTreeNode::eQUANTIZATION) && PxF32(q)*scale + origin < value)
+		q++;
+	return PxU8(q);
+}
+
+static PX_FORCE_INLINE PxReal computeScale(PxReal minimum, PxReal maximum)
+{
+	const PxReal nbSteps = PxReal(WideAABBTreeNode::eQUANTIZATION);
+	PxReal scale = (maximum - minimum)/nbSteps;
+	// make sure the last quantized value reaches the maximum
+	while(nbSteps*scale + minimum < maximum)
+		scale *= 1.0f + 1e-6f;
+	return scale;
+}
+
+static PX_FORCE_INLINE PxReal getSurface(const PxBounds3& bounds)
+{
+	const PxVec3 d = bounds.maximum - bounds.minimum;
+	return d.x*d.y + d.y*d.z + d.z*d.x;
+}
+
+bool WideAABBTree::build(const AABBTree& tree)
+{
+	release();
+
+	const AABBTreeRuntimeNode* nodes = tree.getNodes();
+	const PxU32 nbBinaryNodes = tree.getNbNodes();
+	if(!nodes || !nbBinaryNodes)
+		return false;
+
+	mIndices = tree.getIndices();
+	mRootBounds = nodes[0].mBV;
+
+	if(nodes[0].isLeaf())
+	{
+		mRootData = nodes[0].mData;
+		return true;
+	}
+
+	// Each wide node collapses at least one internal node of the binary tree
+	const PxU32 maxNbNodes = nbBinaryNodes/2 + 1;
+	mNodes = reinterpret_cast<WideAABBTreeNode*>(PX_ALLOC(sizeof(WideAABBTreeNode)*maxNbNodes, "WideAABBTreeNode"));
+	if(!mNodes)
+		return false;
+
+	mRootData = 0;
+	mNbNodes = 1;
+
+	// (binary node index, wide node index) of the nodes left to collapse
+	Ps::Array<Ps::Pair<PxU32, PxU32> > stack;
+	stack.pushBack(Ps::Pair<PxU32, PxU32>(0, 0));
+
+	while(stack.size())
+	{
+		const Ps::Pair<PxU32, PxU32> entry = stack.popBack();
+		const AABBTreeRuntimeNode& binaryNode = nodes[entry.first];
+
+		// Open the internal child with the largest surface until we have 4 children or only leaves
+		PxU32 children[WideAABBTreeNode::eNB_CHILDREN];
+		children[0] = binaryNode.getPosIndex();
+		children[1] = binaryNode.getNegIndex();
+		PxU32 nbChildren = 2;
+		while(nbChildren<WideAABBTreeNode::eNB_CHILDREN)
+		{
+			PxU32 best = 0xffffffff;
+			PxReal bestSurface = -1.0f;
+			for(PxU32 i=0;i<nbChildren;i++)
+			{
+				const AABBTreeRuntimeNode& child = nodes[children[i]];
+				if(child.isLeaf())
+					continue;
+
+				const PxReal surface = getSurface(child.mBV);
+				if(surface>bestSurface)
+				{
+					bestSurface = surface;
+					best = i;
+				}
+			}
+			if(best==0xffffffff)
+				break;
+
+			const AABBTreeRuntimeNode& opened = nodes[children[best]];
+			children[best] = opened.getPosIndex();
+			children[nbChildren++] = opened.getNegIndex();
+		}
+
+		// The node's frame is the union of the children's bounds
+		PxBounds3 frame = nodes[children[0]].mBV;
+		for(PxU32 i=1;i<nbChildren;i++)
+			frame.include(nodes[children[i]].mBV);
+
+		WideAABBTreeNode& wideNode = mNodes[entry.second];
+		wideNode.mOrigin = frame.minimum;
+		wideNode.mScale = PxVec3(	computeScale(frame.minimum.x, frame.maximum.x),
+									computeScale(frame.minimum.y, frame.maximum.y),
+									computeScale(frame.minimum.z, frame.maximum.z));
+
+		for(PxU32 i=0;i<WideAABBTreeNode::eNB_CHILDREN;i++)
+		{
+			if(i>=nbChildren)
+			{
+				wideNode.mData[i] = WideAABBTreeNode::eEMPTY_CHILD;
+				wideNode.mMinX[i] = wideNode.mMinY[i] = wideNode.mMinZ[i] = 0;
+				wideNode.mMaxX[i] = wideNode.mMaxY[i] = wideNode.mMaxZ[i] = 0;
+				continue;
+			}
+
+			const AABBTreeRuntimeNode& child = nodes[children[i]];
+			const PxBounds3& bounds = child.mBV;
+			wideNode.mMinX[i] = quantizeMin(bounds.minimum.x, wideNode.mOrigin.x, wideNode.mScale.x);
+			wideNode.mMinY[i] = quantizeMin(bounds.minimum.y, wideNode.mOrigin.y, wideNode.mScale.y);
+			wideNode.mMinZ[i] = quantizeMin(bounds.minimum.z, wideNode.mOrigin.z, wideNode.mScale.z);
+			wideNode.mMaxX[i] = quantizeMax(bounds.maximum.x, wideNode.mOrigin.x, wideNode.mScale.x);
+			wideNode.mMaxY[i] = quantizeMax(bounds.maximum.y, wideNode.mOrigin.y, wideNode.mScale.y);
+			wideNode.mMaxZ[i] = quantizeMax(bounds.maximum.z, wideNode.mOrigin.z, wideNode.mScale.z);
+
+			if(child.isLeaf())
+			{
+				wideNode.mData[i] = child.mData;
+			}
+			else
+			{
+				PX_ASSERT(mNbNodes<maxNbNodes);
+				const PxU32 wideIndex = mNbNodes++;
+				wideNode.mData[i] = wideIndex<<1;
+				stack.pushBack(Ps::Pair<PxU32, PxU32>(children[i], wideIndex));
+			}
+		}
+	}
+	return true;
+}
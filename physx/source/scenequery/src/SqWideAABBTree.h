@@ -0,0 +1,128 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef SQ_WIDE_AABBTREE_H
+#define SQ_WIDE_AABBTREE_H
+
+#include "foundation/PxBounds3.h"
+#include "PsUserAllocated.h"
+#include "PsVecMath.h"
+#include "SqTypedef.h"
+
+namespace physx
+{
+using namespace shdfnd::aos;
+
+namespace Sq
+{
+	class AABBTree;
+
+	//! 4-wide AABB tree node used for runtime. Child bounds are stored in SoA layout, quantized to 8 bits
+	//! relative to the node's own bounds, so that a node fits in a single 64 bytes cache line.
+	PX_ALIGN_PREFIX(16)
+	class WideAABBTreeNode
+	{
+		public:
+		enum
+		{
+			eNB_CHILDREN	= 4,
+			eQUANTIZATION	= 255,
+			eEMPTY_CHILD	= 0xffffffff
+		};
+
+		PX_FORCE_INLINE	bool			isChildValid(PxU32 i)		const	{ return mData[i]!=eEMPTY_CHILD;	}
+		// PT: the first two children are always valid
+		PX_FORCE_INLINE	PxU32			getNbValidChildren()		const	{ return 2 + PxU32(isChildValid(2)) + PxU32(isChildValid(3));	}
+		PX_FORCE_INLINE	static PxU32	isLeaf(PxU32 data)					{ return data&1;					}
+		PX_FORCE_INLINE	static PxU32	getChildIndex(PxU32 data)			{ return data>>1;					}
+
+		// Same encoding as AABBTreeRuntimeNode::mData for leaves, so the primitives are fetched from the source tree's indices
+		PX_FORCE_INLINE	static PxU32	getNbPrimitives(PxU32 data)			{ return (data>>1)&15;				}
+		PX_FORCE_INLINE	static const PxU32*	getPrimitives(const PxU32* base, PxU32 data)	{ return base + (data>>5);	}
+
+						PxU32			mData[eNB_CHILDREN];	// 31 bits wide node index|1 bit leaf, or leaf data from the source tree, or eEMPTY_CHILD
+						PxU8			mMinX[eNB_CHILDREN];	// Quantized child bounds, dequantized as mOrigin + q * mScale
+						PxU8			mMinY[eNB_CHILDREN];
+						PxU8			mMinZ[eNB_CHILDREN];
+						PxU8			mMaxX[eNB_CHILDREN];
+						PxU8			mMaxY[eNB_CHILDREN];
+						PxU8			mMaxZ[eNB_CHILDREN];
+						PxVec3			mOrigin;				// Minimum of the node's bounds
+						PxVec3			mScale;					// Size of a quantization step on each axis
+	}
+	PX_ALIGN_SUFFIX(16);
+
+	PX_COMPILE_TIME_ASSERT(sizeof(WideAABBTreeNode)==64);
+
+	//! 4-wide AABB tree, collapsed from a built binary AABBTree. The wide tree does not own the primitive
+	//! indices, it references the ones of the source tree which must outlive it. It cannot be refit, it has
+	//! to be rebuilt whenever the source tree changes.
+	class WideAABBTree : public Ps::UserAllocated
+	{
+		public:
+												WideAABBTree();
+												~WideAABBTree();
+
+						bool					build(const AABBTree& tree);
+						void					release();
+
+		PX_FORCE_INLINE	const PxU32*			getIndices()		const	{ return mIndices;		}
+		PX_FORCE_INLINE	const WideAABBTreeNode*	getNodes()			const	{ return mNodes;		}
+		PX_FORCE_INLINE	PxU32					getNbNodes()		const	{ return mNbNodes;		}
+		// Data of the root's single child, i.e. either the wide root node or a leaf if the source tree has a single leaf
+		PX_FORCE_INLINE	PxU32					getRootData()		const	{ return mRootData;		}
+		PX_FORCE_INLINE	const PxBounds3&		getRootBounds()		const	{ return mRootBounds;	}
+		private:
+						const PxU32*			mIndices;		//!< Indices of the source tree
+						WideAABBTreeNode*		mNodes;			//!< Linear pool of nodes
+						PxU32					mNbNodes;
+						PxU32					mRootData;
+						PxBounds3				mRootBounds;
+	};
+
+	//! Dequantizes one axis of the four children of a node
+	PX_FORCE_INLINE Vec4V dequantize4(const PxU8* q, const FloatV origin, const FloatV scale)
+	{
+#if COMPILE_VECTOR_INTRINSICS && PX_INTEL_FAMILY
+		const __m128i zero = _mm_setzero_si128();
+		__m128i qi = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(q));
+		qi = _mm_unpacklo_epi8(qi, zero);
+		qi = _mm_unpacklo_epi16(qi, zero);
+		const Vec4V qV = _mm_cvtepi32_ps(qi);
+#else
+		const Vec4V qV = V4LoadXYZW(PxF32(q[0]), PxF32(q[1]), PxF32(q[2]), PxF32(q[3]));
+#endif
+		return V4ScaleAdd(qV, scale, V4Splat(origin));
+	}
+
+} // namespace Sq
+
+}
+
+#endif // SQ_WIDE_AABBTREE_H
@@ -0,0 +1,285 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+// Copyright (c) 2004-2008 AGEIA Technologies, Inc. All rights reserved.
+// Copyright (c) 2001-2004 NovodeX AG. All rights reserved.  
+
+#ifndef SQ_WIDE_AABBTREE_QUERY_H
+#define SQ_WIDE_AABBTREE_QUERY_H
+
+#include "SqWideAABBTree.h"
+#include "GuAABBTreeQuery.h"
+#include "PsInlineArray.h"
+
+namespace physx
+{
+namespace Sq
+{
+	//////////////////////////////////////////////////////////////////////////
+
+	// PT: the quantized bounds are conservative, so unlike the binary traversal we always test the primitives' own bounds
+	template<typename Test, typename Payload, typename QueryCallback>
+	class WideAABBTreeOverlap
+	{
+	public:
+		bool operator()(const Payload* objects, const PxBounds3* boxes, const WideAABBTree& tree, const Test& test, QueryCallback& visitor, Gu::TraversalStats* stats = NULL)
+		{
+			const PxU32 rootData = tree.getRootData();
+			if(rootData==WideAABBTreeNode::eEMPTY_CHILD)
+				return true;
+
+			Gu::TraversalCounter counter(stats);
+			counter.mNbVisitedNodes++;
+			{
+				const PxBounds3& rootBounds = tree.getRootBounds();
+				if(!test(V3LoadU(rootBounds.getCenter()), V3LoadU(rootBounds.getExtents())))
+					return true;
+			}
+
+			Ps::InlineArray<PxU32, RAW_TRAVERSAL_STACK_SIZE> stack;
+			stack.forceSize_Unsafe(RAW_TRAVERSAL_STACK_SIZE);
+			stack[0] = rootData;
+			PxU32 stackIndex = 1;
+
+			const WideAABBTreeNode* const nodeBase = tree.getNodes();
+			const FloatV halfV = FLoad(0.5f);
+
+			while(stackIndex > 0)
+			{
+				const PxU32 data = stack[--stackIndex];
+
+				if(WideAABBTreeNode::isLeaf(data))
+				{
+					PxU32 nbPrims = WideAABBTreeNode::getNbPrimitives(data);
+					const PxU32* prims = WideAABBTreeNode::getPrimitives(tree.getIndices(), data);
+					counter.mNbLeafTests += nbPrims;
+					while(nbPrims--)
+					{
+						const PxU32 poolIndex = *prims++;
+
+						Vec4V center2, extents2;
+						Gu::getBoundsTimesTwo(center2, extents2, boxes, poolIndex);
+						if(!test(Vec3V_From_Vec4V(V4Scale(center2, halfV)), Vec3V_From_Vec4V(V4Scale(extents2, halfV))))
+							continue;
+
+						PxReal unusedDistance;
+						if(!visitor.invoke(unusedDistance, objects[poolIndex]))
+							return false;
+					}
+					continue;
+				}
+
+				const WideAABBTreeNode& node = nodeBase[WideAABBTreeNode::getChildIndex(data)];
+				counter.mNbVisitedNodes += node.getNbValidChildren();
+
+				const FloatV originX = FLoad(node.mOrigin.x), scaleX = FLoad(node.mScale.x);
+				const FloatV originY = FLoad(node.mOrigin.y), scaleY = FLoad(node.mScale.y);
+				const FloatV originZ = FLoad(node.mOrigin.z), scaleZ = FLoad(node.mScale.z);
+				const Vec4V minX = dequantize4(node.mMinX, originX, scaleX);
+				const Vec4V minY = dequantize4(node.mMinY, originY, scaleY);
+				const Vec4V minZ = dequantize4(node.mMinZ, originZ, scaleZ);
+				const Vec4V maxX = dequantize4(node.mMaxX, originX, scaleX);
+				const Vec4V maxY = dequantize4(node.mMaxY, originY, scaleY);
+				const Vec4V maxZ = dequantize4(node.mMaxZ, originZ, scaleZ);
+
+				// SoA to AoS: one center/extents pair per child
+				Vec4V center0 = V4Scale(V4Add(maxX, minX), halfV);
+				Vec4V center1 = V4Scale(V4Add(maxY, minY), halfV);
+				Vec4V center2 = V4Scale(V4Add(maxZ, minZ), halfV);
+				Vec4V center3 = V4Zero();
+				V4Transpose(center0, center1, center2, center3);
+
+				Vec4V extents0 = V4Scale(V4Sub(maxX, minX), halfV);
+				Vec4V extents1 = V4Scale(V4Sub(maxY, minY), halfV);
+				Vec4V extents2 = V4Scale(V4Sub(maxZ, minZ), halfV);
+				Vec4V extents3 = V4Zero();
+				V4Transpose(extents0, extents1, extents2, extents3);
+
+				if(stackIndex + WideAABBTreeNode::eNB_CHILDREN > stack.capacity())
+					stack.resizeUninitialized(stack.capacity() * 2);
+
+				// PT: pushed in reverse order so that the children are visited in order
+				if(node.isChildValid(3) && test(Vec3V_From_Vec4V(center3), Vec3V_From_Vec4V(extents3)))
+					stack[stackIndex++] = node.mData[3];
+				if(node.isChildValid(2) && test(Vec3V_From_Vec4V(center2), Vec3V_From_Vec4V(extents2)))
+					stack[stackIndex++] = node.mData[2];
+				if(test(Vec3V_From_Vec4V(center1), Vec3V_From_Vec4V(extents1)))
+					stack[stackIndex++] = node.mData[1];
+				if(test(Vec3V_From_Vec4V(center0), Vec3V_From_Vec4V(extents0)))
+					stack[stackIndex++] = node.mData[0];
+			}
+			return true;
+		}
+	};
+
+	//////////////////////////////////////////////////////////////////////////
+
+	template <bool tInflate, typename Payload, typename QueryCallback> // use inflate=true for sweeps, inflate=false for raycasts
+	class WideAABBTreeRaycast
+	{
+		struct StackEntry
+		{
+			PxU32	mData;
+			PxReal	mDistance;	// distance at which the ray enters the child's bounds
+		};
+
+	public:
+		bool operator()(
+			const Payload* objects, const PxBounds3* boxes, const WideAABBTree& tree,
+			const PxVec3& origin, const PxVec3& unitDir, PxReal& maxDist, const PxVec3& inflation,
+			QueryCallback& pcb, Gu::TraversalStats* stats = NULL)
+		{
+			const PxU32 rootData = tree.getRootData();
+			if(rootData==WideAABBTreeNode::eEMPTY_CHILD)
+				return true;
+
+			Gu::TraversalCounter counter(stats);
+			counter.mNbVisitedNodes++;
+
+			// PT: same as the binary traversal, the primitives are tested with center*2 and extents*2
+			Gu::RayAABBTest test(origin*2.0f, unitDir*2.0f, maxDist, inflation*2.0f);
+
+			{
+				const PxBounds3& rootBounds = tree.getRootBounds();
+				if(!test.check<tInflate>(V3LoadU(rootBounds.getCenter()*2.0f), V3LoadU(rootBounds.getExtents()*2.0f)))
+					return true;
+			}
+
+			// Slab test setup. Null direction components are clamped to a tiny value with the proper sign,
+			// which keeps the math free of NaNs.
+			PxVec3 invDir;
+			for(PxU32 i=0;i<3;i++)
+			{
+				const PxReal d = unitDir[i];
+				const PxReal eps = 1e-9f;
+				invDir[i] = 1.0f / (PxAbs(d)>eps ? d : (d<0.0f ? -eps : eps));
+			}
+			const FloatV originX = FLoad(origin.x), originY = FLoad(origin.y), originZ = FLoad(origin.z);
+			const FloatV invDirX = FLoad(invDir.x), invDirY = FLoad(invDir.y), invDirZ = FLoad(invDir.z);
+			const FloatV inflationX = FLoad(tInflate ? inflation.x : 0.0f);
+			const FloatV inflationY = FLoad(tInflate ? inflation.y : 0.0f);
+			const FloatV inflationZ = FLoad(tInflate ? inflation.z : 0.0f);
+			const Vec4V zeroV = V4Zero();
+
+			Ps::InlineArray<StackEntry, RAW_TRAVERSAL_STACK_SIZE> stack;
+			stack.forceSize_Unsafe(RAW_TRAVERSAL_STACK_SIZE);
+			stack[0].mData = rootData;
+			stack[0].mDistance = 0.0f;
+			PxU32 stackIndex = 1;
+
+			const WideAABBTreeNode* const nodeBase = tree.getNodes();
+
+			while(stackIndex > 0)
+			{
+				const StackEntry entry = stack[--stackIndex];
+				if(entry.mDistance > maxDist)
+					continue;
+
+				if(WideAABBTreeNode::isLeaf(entry.mData))
+				{
+					PxU32 nbPrims = WideAABBTreeNode::getNbPrimitives(entry.mData);
+					const PxU32* prims = WideAABBTreeNode::getPrimitives(tree.getIndices(), entry.mData);
+					counter.mNbLeafTests += nbPrims;
+					while(nbPrims--)
+					{
+						const PxU32 poolIndex = *prims++;
+
+						Vec4V center_, extents_;
+						Gu::getBoundsTimesTwo(center_, extents_, boxes, poolIndex);
+						if(!test.check<tInflate>(Vec3V_From_Vec4V(center_), Vec3V_From_Vec4V(extents_)))
+							continue;
+
+						const PxReal oldMaxDist = maxDist;
+						PxReal md = maxDist;
+						if(!pcb.invoke(md, objects[poolIndex]))
+							return false;
+
+						if(md < oldMaxDist)
+						{
+							maxDist = md;
+							test.setDistance(md);
+						}
+					}
+					continue;
+				}
+
+				const WideAABBTreeNode& node = nodeBase[WideAABBTreeNode::getChildIndex(entry.mData)];
+				counter.mNbVisitedNodes += node.getNbValidChildren();
+
+				const FloatV nodeOriginX = FLoad(node.mOrigin.x), scaleX = FLoad(node.mScale.x);
+				const FloatV nodeOriginY = FLoad(node.mOrigin.y), scaleY = FLoad(node.mScale.y);
+				const FloatV nodeOriginZ = FLoad(node.mOrigin.z), scaleZ = FLoad(node.mScale.z);
+
+				// Kay & Kajiya slabs, 4 children at a time
+				const Vec4V tMinX = V4Scale(V4Sub(V4Sub(dequantize4(node.mMinX, nodeOriginX, scaleX), V4Splat(inflationX)), V4Splat(originX)), invDirX);
+				const Vec4V tMaxX = V4Scale(V4Sub(V4Add(dequantize4(node.mMaxX, nodeOriginX, scaleX), V4Splat(inflationX)), V4Splat(originX)), invDirX);
+				const Vec4V tMinY = V4Scale(V4Sub(V4Sub(dequantize4(node.mMinY, nodeOriginY, scaleY), V4Splat(inflationY)), V4Splat(originY)), invDirY);
+				const Vec4V tMaxY = V4Scale(V4Sub(V4Add(dequantize4(node.mMaxY, nodeOriginY, scaleY), V4Splat(inflationY)), V4Splat(originY)), invDirY);
+				const Vec4V tMinZ = V4Scale(V4Sub(V4Sub(dequantize4(node.mMinZ, nodeOriginZ, scaleZ), V4Splat(inflationZ)), V4Splat(originZ)), invDirZ);
+				const Vec4V tMaxZ = V4Scale(V4Sub(V4Add(dequantize4(node.mMaxZ, nodeOriginZ, scaleZ), V4Splat(inflationZ)), V4Splat(originZ)), invDirZ);
+
+				const Vec4V tNear = V4Max(V4Max(V4Min(tMinX, tMaxX), V4Min(tMinY, tMaxY)), V4Max(V4Min(tMinZ, tMaxZ), zeroV));
+				const Vec4V tFar = V4Min(V4Min(V4Max(tMinX, tMaxX), V4Max(tMinY, tMaxY)), V4Min(V4Max(tMinZ, tMaxZ), V4Load(maxDist)));
+
+				PxU32 hitMask = BGetBitMask(V4IsGrtrOrEq(tFar, tNear));
+				for(PxU32 i=0;i<WideAABBTreeNode::eNB_CHILDREN;i++)
+				{
+					if(!node.isChildValid(i))
+						hitMask &= ~(1<<i);
+				}
+				if(!hitMask)
+					continue;
+
+				PX_ALIGN(16, PxReal distances[4]);
+				V4StoreA(tNear, distances);
+
+				if(stackIndex + WideAABBTreeNode::eNB_CHILDREN > stack.capacity())
+					stack.resizeUninitialized(stack.capacity() * 2);
+
+				// Push the hit children sorted by decreasing entry distance, so that the closest one is popped first
+				const PxU32 first = stackIndex;
+				for(PxU32 i=0;i<WideAABBTreeNode::eNB_CHILDREN;i++)
+				{
+					if(!(hitMask & (1<<i)))
+						continue;
+
+					PxU32 j = stackIndex++;
+					while(j>first && stack[j-1].mDistance < distances[i])
+					{
+						stack[j] = stack[j-1];
+						j--;
+					}
+					stack[j].mData = node.mData[i];
+					stack[j].mDistance = distances[i];
+				}
+			}
+			return true;
+		}
+	};
+}
+}
+
+#endif   // SQ_WIDE_AABBTREE_QUERY_H
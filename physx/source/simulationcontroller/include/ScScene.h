@@ -381,6 +381,7 @@ namespace Sc
 					PxU32						getMaxNbConstraintDataBlocksUsed() const;
 
 					void						setScratchBlock(void* addr, PxU32 size);
+					void						getFrameArenaStatistics(PxFrameArenaStatistics& stats) const;
 
 // PX_ENABLE_SIM_STATS
 					void						getStats(PxSimulationStatistics& stats) const;
@@ -528,6 +529,7 @@ namespace Sc
 	public:
 						PxBroadPhaseType::Enum		getBroadPhaseType()																				const;
 						bool						getBroadPhaseCaps(PxBroadPhaseCaps& caps)														const;
+						bool						getBroadPhasePairStatistics(PxBroadPhasePairStatistics& stats)									const;
 						PxU32						getNbBroadPhaseRegions()																		const;
 						PxU32						getBroadPhaseRegions(PxBroadPhaseRegionInfo* userBuffer, PxU32 bufferSize, PxU32 startIndex)	const;
 						PxU32						addBroadPhaseRegion(const PxBroadPhaseRegion& region, bool populateRegion);
@@ -748,7 +748,8 @@ Sc::Scene::Scene(const PxSceneDesc& desc, PxU64 contextID) :
 			desc.limits.maxNbBroadPhaseOverlaps, 
 			desc.limits.maxNbStaticShapes, 
 			desc.limits.maxNbDynamicShapes,
-			contextID);
+			contextID,
+			!!(desc.flags & PxSceneFlag::eENABLE_PERSISTENT_BROADPHASE_PAIRS));
 	}
 	else
 	{
@@ -1372,6 +1373,12 @@ bool Sc::Scene::getBroadPhaseCaps(PxBroadPhaseCaps& caps) const
 	return bp->getCaps(caps);
 }
 
+bool Sc::Scene::getBroadPhasePairStatistics(PxBroadPhasePairStatistics& stats) const
+{
+	Bp::BroadPhase* bp = mAABBManager->getBroadPhase();
+	return bp->getPairStatistics(stats);
+}
+
 PxU32 Sc::Scene::getNbBroadPhaseRegions() const
 {
 	Bp::BroadPhase* bp = mAABBManager->getBroadPhase();
@@ -4772,6 +4779,16 @@ void Sc::Scene::setScratchBlock(void* addr, PxU32 size)
 	return mLLContext->setScratchBlock(addr, size);
 }
 
+void Sc::Scene::getFrameArenaStatistics(PxFrameArenaStatistics& stats) const
+{
+	const PxcScratchAllocator& scratchAllocator = mLLContext->getScratchAllocator();
+	stats.blockSize			= scratchAllocator.getSize();
+	stats.lastStepUsage		= scratchAllocator.getUsage();
+	stats.peakUsage			= scratchAllocator.getPeakUsage();
+	stats.nbHeapFallbacks	= scratchAllocator.getNbHeapFallbacks();
+	stats.heapFallbackBytes	= scratchAllocator.getHeapFallbackBytes();
+}
+
 void Sc::Scene::checkConstraintBreakage()
 {
 	PX_PROFILE_ZONE("Sim.checkConstraintBreakage", getContextId());
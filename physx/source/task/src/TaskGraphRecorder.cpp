@@ -0,0 +1,368 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+
+#include "TaskGraphRecorder.h"
+#include "foundation/PxIO.h"
+#include "foundation/PxMath.h"
+
+#include "PsAtomic.h"
+#include "PsIntrinsics.h"
+#include "PsString.h"
+#include "PsTime.h"
+
+#include <string.h>
+
+namespace physx
+{
+	static const PxU32 INVALID_EVENT = 0xffffffff;
+
+void PxRecordedTask::run()
+{
+	PxTaskGraphRecorder* owner = mOwner;
+
+	// Tasks submitted while this one runs were spawned by it
+	const size_t previous = shdfnd::TlsGetValue(owner->mTlsIndex);
+	shdfnd::TlsSetValue(owner->mTlsIndex, size_t(mIndex) + 1);
+
+	mThreadId = shdfnd::Thread::getId();
+	mStartTime = shdfnd::Time::getCurrentCounterValue();
+	mTask->run();
+	mEndTime = shdfnd::Time::getCurrentCounterValue();
+
+	shdfnd::TlsSetValue(owner->mTlsIndex, previous);
+}
+
+void PxRecordedTask::release()
+{
+	PxTaskGraphRecorder* owner = mOwner;
+
+	// Tasks made ready by the release of this one depend on it
+	const size_t previous = shdfnd::TlsGetValue(owner->mTlsIndex);
+	shdfnd::TlsSetValue(owner->mTlsIndex, size_t(mIndex) + 1);
+
+	mTask->release();
+
+	shdfnd::TlsSetValue(owner->mTlsIndex, previous);
+
+	// The slot may be reused by the next frame, don't touch it after this
+	shdfnd::memoryBarrier();
+	mBusy = 0;
+	shdfnd::atomicDecrement(&owner->mNbInFlight);
+}
+
+PxTaskGraphRecorder::PxTaskGraphRecorder()
+	: mNbSlots(0)
+	, mNbInFlight(0)
+	, mNbDropped(0)
+	, mFrameIndex(0)
+	, mFrameStartTime(0)
+	, mFrameOpen(false)
+	, mEvents(PX_DEBUG_EXP("PxTaskGraphRecordEvents"))
+	, mCriticalPath(PX_DEBUG_EXP("PxTaskGraphCriticalPath"))
+	, mThreadBusyTime(PX_DEBUG_EXP("PxTaskGraphThreadBusyTime"))
+	, mThreadUtilization(PX_DEBUG_EXP("PxTaskGraphThreadUtilization"))
+	, mThreadIds(PX_DEBUG_EXP("PxTaskGraphThreadIds"))
+	, mSlotToEvent(PX_DEBUG_EXP("PxTaskGraphSlotToEvent"))
+	, mHasRecord(false)
+{
+	for(PxU32 i = 0; i < MAX_NB_CHUNKS; i++)
+		mChunks[i] = NULL;
+
+	mTlsIndex = shdfnd::TlsAlloc();
+}
+
+PxTaskGraphRecorder::~PxTaskGraphRecorder()
+{
+	PX_ASSERT(!mNbInFlight);
+
+	for(PxU32 i = 0; i < MAX_NB_CHUNKS && mChunks[i]; i++)
+	{
+		PxRecordedTask* chunk = mChunks[i];
+		for(PxU32 j = 0; j < CHUNK_SIZE; j++)
+			chunk[j].~PxRecordedTask();
+		PX_FREE(chunk);
+	}
+
+	shdfnd::TlsFree(mTlsIndex);
+}
+
+PxRecordedTask* PxTaskGraphRecorder::getSlot(PxU32 index)
+{
+	const PxU32 chunkIndex = index / CHUNK_SIZE;
+	if(chunkIndex >= MAX_NB_CHUNKS)
+		return NULL;
+
+	PxRecordedTask* chunk = mChunks[chunkIndex];
+	if(!chunk)
+	{
+		shdfnd::Mutex::ScopedLock lock(mChunkMutex);
+
+		chunk = mChunks[chunkIndex];
+		if(!chunk)
+		{
+			chunk = reinterpret_cast<PxRecordedTask*>(PX_ALLOC(sizeof(PxRecordedTask) * CHUNK_SIZE, "PxRecordedTask"));
+			for(PxU32 i = 0; i < CHUNK_SIZE; i++)
+				PX_PLACEMENT_NEW(chunk + i, PxRecordedTask)();
+
+			// The tasks must be constructed before other threads can see the chunk
+			shdfnd::memoryBarrier();
+			mChunks[chunkIndex] = chunk;
+		}
+	}
+
+	return chunk + (index % CHUNK_SIZE);
+}
+
+PxReal PxTaskGraphRecorder::toMicroseconds(uint64_t ticks) const
+{
+	return PxReal(double(shdfnd::Time::getBootCounterFrequency().toTensOfNanos(ticks)) * 0.01);
+}
+
+void PxTaskGraphRecorder::beginFrame()
+{
+	// The owner may start the task graph several times per frame
+	if(mFrameOpen)
+		return;
+
+	// Slots still held by tasks of previous frames are skipped by submit()
+	mNbSlots = 0;
+	mFrameIndex++;
+	mNbDropped = 0;
+	mFrameStartTime = shdfnd::Time::getCurrentCounterValue();
+	mFrameOpen = true;
+}
+
+void PxTaskGraphRecorder::submit(PxCpuDispatcher& dispatcher, PxBaseTask& task)
+{
+	if(mFrameOpen)
+	{
+		PxRecordedTask* recorded = NULL;
+		PxU32 index = 0;
+		while(PxU32(mNbSlots) < CHUNK_SIZE * MAX_NB_CHUNKS)
+		{
+			index = PxU32(shdfnd::atomicIncrement(&mNbSlots)) - 1;
+			recorded = getSlot(index);
+			if(!recorded || !shdfnd::atomicCompareExchange(&recorded->mBusy, 1, 0))
+				break;
+
+			// Still in flight from a previous frame
+			recorded = NULL;
+		}
+
+		if(recorded)
+		{
+			const size_t current = shdfnd::TlsGetValue(mTlsIndex);
+
+			recorded->mTask = &task;
+			recorded->mOwner = this;
+			recorded->mName = task.getName();
+			recorded->mSubmitTime = shdfnd::Time::getCurrentCounterValue();
+			recorded->mStartTime = 0;
+			recorded->mEndTime = 0;
+			recorded->mThreadId = 0;
+			recorded->mIndex = index;
+			recorded->mDependency = current ? PxU32(current - 1) : INVALID_EVENT;
+			recorded->mFrame = mFrameIndex;
+			recorded->setContextId(task.getContextId());
+
+			shdfnd::atomicIncrement(&mNbInFlight);
+			dispatcher.submitTask(*recorded);
+			return;
+		}
+
+		shdfnd::atomicIncrement(&mNbDropped);
+	}
+
+	dispatcher.submitTask(task);
+}
+
+void PxTaskGraphRecorder::endFrame()
+{
+	if(!mFrameOpen)
+		return;
+
+	mFrameOpen = false;
+
+	const uint64_t frameEndTime = shdfnd::Time::getCurrentCounterValue();
+	const PxU32 lastSlot = PxMin(PxU32(mNbSlots), CHUNK_SIZE * MAX_NB_CHUNKS);
+
+	mEvents.clear();
+	mCriticalPath.clear();
+	mThreadBusyTime.clear();
+	mThreadUtilization.clear();
+	mThreadIds.clear();
+	mSlotToEvent.resize(lastSlot);
+
+	PxU32 nbDropped = PxU32(mNbDropped);
+	PxU32 lastEvent = INVALID_EVENT;
+
+	for(PxU32 slot = 0; slot < lastSlot; slot++)
+	{
+		const PxRecordedTask& recorded = *getSlot(slot);
+
+		// Held by a task of a previous frame
+		if(recorded.mFrame != mFrameIndex)
+		{
+			mSlotToEvent[slot] = INVALID_EVENT;
+			continue;
+		}
+
+		// Still running, don't report partial data
+		if(!recorded.mEndTime)
+		{
+			mSlotToEvent[slot] = INVALID_EVENT;
+			nbDropped++;
+			continue;
+		}
+
+		PxU32 threadIndex = 0;
+		while(threadIndex < mThreadIds.size() && mThreadIds[threadIndex] != recorded.mThreadId)
+			threadIndex++;
+		if(threadIndex == mThreadIds.size())
+		{
+			mThreadIds.pushBack(recorded.mThreadId);
+			mThreadBusyTime.pushBack(0.0f);
+		}
+
+		PxTaskGraphRecordEvent event;
+		event.name			= recorded.mName;
+		event.contextId		= recorded.getContextId();
+		event.submitTime	= toMicroseconds(recorded.mSubmitTime - mFrameStartTime);
+		event.startTime		= toMicroseconds(recorded.mStartTime - mFrameStartTime);
+		event.endTime		= toMicroseconds(recorded.mEndTime - mFrameStartTime);
+		event.threadIndex	= threadIndex;
+		event.dependency	= recorded.mDependency < slot ? mSlotToEvent[recorded.mDependency] : INVALID_EVENT;
+
+		mThreadBusyTime[threadIndex] += event.endTime - event.startTime;
+
+		if(lastEvent == INVALID_EVENT || event.endTime > mEvents[lastEvent].endTime)
+			lastEvent = mEvents.size();
+
+		mSlotToEvent[slot] = mEvents.size();
+		mEvents.pushBack(event);
+	}
+
+	const PxReal frameDuration = toMicroseconds(frameEndTime - mFrameStartTime);
+
+	// Walk back from the task that finished last
+	PxReal criticalPathBusyTime = 0.0f;
+	for(PxU32 i = lastEvent; i != INVALID_EVENT; i = mEvents[i].dependency)
+	{
+		mCriticalPath.pushBack(i);
+		criticalPathBusyTime += mEvents[i].endTime - mEvents[i].startTime;
+	}
+	for(PxU32 i = 0, j = mCriticalPath.size(); i + 1 < j; i++, j--)
+		shdfnd::swap(mCriticalPath[i], mCriticalPath[j - 1]);
+
+	for(PxU32 i = 0; i < mThreadBusyTime.size(); i++)
+		mThreadUtilization.pushBack(frameDuration > 0.0f ? mThreadBusyTime[i] / frameDuration : 0.0f);
+
+	mRecord.events					= mEvents.begin();
+	mRecord.nbEvents				= mEvents.size();
+	mRecord.nbDroppedEvents			= nbDropped;
+	mRecord.frameDuration			= frameDuration;
+	mRecord.criticalPath			= mCriticalPath.begin();
+	mRecord.criticalPathLength		= mCriticalPath.size();
+	mRecord.criticalPathBusyTime	= criticalPathBusyTime;
+	mRecord.threadBusyTime			= mThreadBusyTime.begin();
+	mRecord.threadUtilization		= mThreadUtilization.begin();
+	mRecord.nbThreads				= mThreadBusyTime.size();
+	mHasRecord = true;
+}
+
+static void writeString(PxOutputStream& stream, const char* string)
+{
+	stream.write(string, PxU32(strlen(string)));
+}
+
+// Task names are identifiers in practice, only escape what would break the JSON document
+static void escapeJsonString(char* dst, PxU32 dstSize, const char* src)
+{
+	PxU32 length = 0;
+	for(; src && *src && length + 2 < dstSize; src++)
+	{
+		if(*src == '"' || *src == '\\')
+			dst[length++] = '\\';
+		dst[length++] = (*src < ' ') ? ' ' : *src;
+	}
+	dst[length] = 0;
+}
+
+bool PxTaskGraphRecorder::writeChromeTrace(PxOutputStream& stream) const
+{
+	if(!mHasRecord)
+		return false;
+
+	char buffer[512];
+	char name[256];
+
+	shdfnd::Array<bool> onCriticalPath;
+	onCriticalPath.resize(mEvents.size(), false);
+	for(PxU32 i = 0; i < mCriticalPath.size(); i++)
+		onCriticalPath[mCriticalPath[i]] = true;
+
+	writeString(stream, "{\"traceEvents\":[\n");
+
+	for(PxU32 i = 0; i < mThreadIds.size(); i++)
+	{
+		shdfnd::snprintf(buffer, sizeof(buffer), "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"Thread %u\"}},\n", i, i);
+		writeString(stream, buffer);
+	}
+
+	for(PxU32 i = 0; i < mEvents.size(); i++)
+	{
+		const PxTaskGraphRecordEvent& event = mEvents[i];
+		escapeJsonString(name, sizeof(name), event.name);
+
+		shdfnd::snprintf(buffer, sizeof(buffer), "{\"name\":\"%s\",\"cat\":\"task\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f,"
+			"\"args\":{\"event\":%u,\"submit\":%.3f,\"dependency\":%d,\"critical\":%s}},\n",
+			name, event.threadIndex, double(event.startTime), double(event.endTime - event.startTime),
+			i, double(event.submitTime), event.dependency == INVALID_EVENT ? -1 : int(event.dependency), onCriticalPath[i] ? "true" : "false");
+		writeString(stream, buffer);
+
+		if(event.dependency != INVALID_EVENT)
+		{
+			// Flow arrow from the end of the dependency to the start of the task
+			const PxTaskGraphRecordEvent& dependency = mEvents[event.dependency];
+			const PxReal flowStart = PxMax(dependency.startTime, dependency.endTime - 0.001f);
+
+			shdfnd::snprintf(buffer, sizeof(buffer), "{\"name\":\"dependency\",\"cat\":\"dependency\",\"ph\":\"s\",\"id\":%u,\"pid\":0,\"tid\":%u,\"ts\":%.3f},\n"
+				"{\"name\":\"dependency\",\"cat\":\"dependency\",\"ph\":\"f\",\"bp\":\"e\",\"id\":%u,\"pid\":0,\"tid\":%u,\"ts\":%.3f},\n",
+				i, dependency.threadIndex, double(flowStart), i, event.threadIndex, double(event.startTime));
+			writeString(stream, buffer);
+		}
+	}
+
+	shdfnd::snprintf(buffer, sizeof(buffer), "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"PhysX task graph\"}}\n],\n"
+		"\"otherData\":{\"frameDuration\":%.3f,\"criticalPathBusyTime\":%.3f,\"criticalPathLength\":%u,\"droppedEvents\":%u}\n}\n",
+		double(mRecord.frameDuration), double(mRecord.criticalPathBusyTime), mRecord.criticalPathLength, mRecord.nbDroppedEvents);
+	writeString(stream, buffer);
+
+	return true;
+}
+
+}// end physx namespace
@@ -0,0 +1,126 @@
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of NVIDIA CORPORATION nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ''AS IS'' AND ANY
+// EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+// PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+// CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+// OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Copyright (c) 2008-2021 NVIDIA Corporation. All rights reserved.
+
+#ifndef PXTASK_TASKGRAPHRECORDER_H
+#define PXTASK_TASKGRAPHRECORDER_H
+
+#include "task/PxTask.h"
+#include "task/PxTaskGraphRecord.h"
+
+#include "PsUserAllocated.h"
+#include "PsMutex.h"
+#include "PsArray.h"
+#include "PsThread.h"
+
+namespace physx
+{
+	class PxOutputStream;
+	class PxTaskGraphRecorder;
+
+	/*
+	Stands in for a task while it is in the CPU dispatcher, timestamps it and tracks which recorded task
+	is running on the current thread, so that the tasks it submits can be linked back to it.
+	*/
+	class PxRecordedTask : public PxBaseTask
+	{
+	public:
+							PxRecordedTask() : mFrame(0xffffffff), mBusy(0)	{}
+
+		virtual void		run();
+		virtual void		release();
+
+		virtual const char*	getName() const			{ return mName;						}
+		virtual void		addReference()			{ mTask->addReference();			}
+		virtual void		removeReference()		{ mTask->removeReference();			}
+		virtual int32_t		getReference() const	{ return mTask->getReference();		}
+
+		PxBaseTask*				mTask;
+		PxTaskGraphRecorder*	mOwner;
+		const char*				mName;			// Captured at submission, the task may be gone by the end of the frame
+		uint64_t				mSubmitTime;
+		uint64_t				mStartTime;
+		uint64_t				mEndTime;
+		shdfnd::Thread::Id		mThreadId;
+		PxU32					mIndex;
+		PxU32					mDependency;
+		PxU32					mFrame;			// Frame the slot was last used in
+		volatile int32_t		mBusy;			// Set from submission until the task is released
+	};
+
+	/*
+	Records the tasks of a frame in a chunked buffer. Chunks are never moved or freed while recording. The buffer
+	is rewound every frame, slots still held by late tasks of previous frames are skipped so they can't be corrupted.
+	*/
+	class PxTaskGraphRecorder : public shdfnd::UserAllocated
+	{
+		PX_NOCOPY(PxTaskGraphRecorder)
+	public:
+		PxTaskGraphRecorder();
+		~PxTaskGraphRecorder();
+
+		void						beginFrame();
+		void						endFrame();
+
+		// Submits the task to the dispatcher, wrapped if it can be recorded
+		void						submit(PxCpuDispatcher& dispatcher, PxBaseTask& task);
+
+		const PxTaskGraphRecord*	getRecord()	const	{ return mHasRecord ? &mRecord : NULL;	}
+		bool						writeChromeTrace(PxOutputStream& stream) const;
+
+	private:
+		PxRecordedTask*				getSlot(PxU32 index);
+		PxReal						toMicroseconds(uint64_t ticks) const;
+
+		static const PxU32			CHUNK_SIZE = 1024;
+		static const PxU32			MAX_NB_CHUNKS = 1024;
+
+		PxRecordedTask* volatile	mChunks[MAX_NB_CHUNKS];
+		shdfnd::Mutex				mChunkMutex;
+		uint32_t					mTlsIndex;				// Stores the index+1 of the recorded task running on the thread
+		volatile int32_t			mNbSlots;
+		volatile int32_t			mNbInFlight;
+		volatile int32_t			mNbDropped;
+		PxU32						mFrameIndex;
+		uint64_t					mFrameStartTime;
+		bool						mFrameOpen;
+
+		// Analysis of the last completed frame
+		shdfnd::Array<PxTaskGraphRecordEvent>	mEvents;
+		shdfnd::Array<PxU32>					mCriticalPath;
+		shdfnd::Array<PxReal>					mThreadBusyTime;
+		shdfnd::Array<PxReal>					mThreadUtilization;
+		shdfnd::Array<shdfnd::Thread::Id>		mThreadIds;
+		shdfnd::Array<PxU32>					mSlotToEvent;
+		PxTaskGraphRecord						mRecord;
+		bool									mHasRecord;
+
+		friend class PxRecordedTask;
+	};
+
+}// end physx namespace
+
+#endif // PXTASK_TASKGRAPHRECORDER_H
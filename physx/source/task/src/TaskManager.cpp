@@ -36,6 +36,8 @@
 #include "PsArray.h"
 #include "PsAllocator.h"
 
+#include "TaskGraphRecorder.h"
+
 #define DOT_LOG 0
 
 #define LOCK()  shdfnd::Mutex::ScopedLock __lock__(mMutex)
@@ -117,6 +119,16 @@ public:
 
 	void    release();
 
+	void	submitReadyTask( PxBaseTask& task );
+
+	void	setTaskGraphRecording( bool enable );
+	bool	getTaskGraphRecording() const
+	{
+		return mRecording;
+	}
+	const PxTaskGraphRecord*	getTaskGraphRecord() const;
+	bool	writeTaskGraphRecordAsChromeTrace( PxOutputStream& stream ) const;
+
 	void	finishBefore( PxTask& task, PxTaskID taskID );
 	void	startAfter( PxTask& task, PxTaskID taskID );
 
@@ -137,6 +149,9 @@ public:
 	PxTaskTable				 mTaskTable;
 
 	shdfnd::Array<PxTaskID>	 mStartDispatch;
+
+	PxTaskGraphRecorder*		mRecorder;		// Created on first use, kept until release so that in-flight tasks stay valid
+	bool						mRecording;
 	};
 
 PxTaskManager* PxTaskManager::createTaskManager(PxErrorCallback& errorCallback, PxCpuDispatcher* cpuDispatcher)
@@ -151,11 +166,14 @@ PxTaskMgr::PxTaskMgr(PxErrorCallback& errorCallback, PxCpuDispatcher* cpuDispatc
 	, mDepTable(PX_DEBUG_EXP("PxTaskDepTable"))
 	, mTaskTable(PX_DEBUG_EXP("PxTaskTable"))	
 	, mStartDispatch(PX_DEBUG_EXP("StartDispatch"))
+	, mRecorder(NULL)
+	, mRecording(false)
 {
 }
 
 PxTaskMgr::~PxTaskMgr()
 {
+	PX_DELETE(mRecorder);
 }
 
 void PxTaskMgr::release()
@@ -171,7 +189,7 @@ void PxTaskMgr::decrReference(PxLightCpuTask& lighttask)
 		PX_ASSERT(mCpuDispatcher);
 		if (mCpuDispatcher)
 		{
-			mCpuDispatcher->submitTask(lighttask);
+			submitReadyTask(lighttask);
 		}
 		else
 		{
@@ -180,6 +198,35 @@ void PxTaskMgr::decrReference(PxLightCpuTask& lighttask)
 	}
 }
 
+/*
+ * Hands a task to the dispatcher, through the recorder when the task graph is recorded.
+ */
+void PxTaskMgr::submitReadyTask(PxBaseTask& task)
+{
+	if (mRecording)
+		mRecorder->submit(*mCpuDispatcher, task);
+	else
+		mCpuDispatcher->submitTask(task);
+}
+
+void PxTaskMgr::setTaskGraphRecording(bool enable)
+{
+	if (enable && !mRecorder)
+		mRecorder = PX_NEW(PxTaskGraphRecorder)();
+
+	mRecording = enable;
+}
+
+const PxTaskGraphRecord* PxTaskMgr::getTaskGraphRecord() const
+{
+	return mRecorder ? mRecorder->getRecord() : NULL;
+}
+
+bool PxTaskMgr::writeTaskGraphRecordAsChromeTrace(PxOutputStream& stream) const
+{
+	return mRecorder ? mRecorder->writeChromeTrace(stream) : false;
+}
+
 void PxTaskMgr::addReference(PxLightCpuTask& lighttask)
 {
 	/* This does not need a lock! */
@@ -208,6 +255,11 @@ void PxTaskMgr::startSimulation()
 {
     PX_ASSERT( mCpuDispatcher );
 
+	if( mRecording )
+	{
+		mRecorder->beginFrame();
+	}
+
 	/* Handle empty task graph */
 	if( mPendingTasks == 0 )
     {
@@ -236,6 +288,10 @@ void PxTaskMgr::startSimulation()
 
 void PxTaskMgr::stopSimulation()
 {
+	if( mRecorder )
+	{
+		mRecorder->endFrame();
+	}
 }
 
 PxTaskID PxTaskMgr::getNamedTask( const char *name )
@@ -435,7 +491,7 @@ void PxTaskMgr::dispatchTask( PxTaskID taskID )
     switch ( tt.mType )
     {
     case PxTaskType::TT_CPU:
-        mCpuDispatcher->submitTask( *tt.mTask );
+        submitReadyTask( *tt.mTask );
         break;
     case PxTaskType::TT_NOT_PRESENT:
 		/* No task registered with this taskID, resolve its dependencies */